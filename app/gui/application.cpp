@@ -405,9 +405,10 @@ void simulation_to_cpp::show(const project_editor& ed) noexcept
 
     static const char* names[] = { "models and connections",
                                    "and final tests",
-                                   "and tests in progress" };
+                                   "and tests in progress",
+                                   "standalone simulator" };
 
-    debug::ensure(options <= 2u);
+    debug::ensure(options <= 3u);
 
     auto opt = static_cast<int>(options);
     if (ImGui::Combo("##", &opt, names, length(names))) {
@@ -423,13 +424,20 @@ void simulation_to_cpp::show(const project_editor& ed) noexcept
         auto& app = container_of(this, &application::sim_to_cpp);
 
         app.add_gui_task([&]() {
-            const auto ret = write_test_simulation(
-              stdout,
-              ed.pj.name.sv(),
-              ed.pj.sim,
-              ed.pj.sim.limits.begin(),
-              ed.pj.sim.limits.end(),
-              enum_cast<write_test_simulation_options>(options));
+            const auto ret =
+              options == 3u
+                ? write_standalone_simulation(stdout,
+                                              ed.pj.name.sv(),
+                                              ed.pj.sim,
+                                              ed.pj.sim.limits.begin(),
+                                              ed.pj.sim.limits.end())
+                : write_test_simulation(
+                    stdout,
+                    ed.pj.name.sv(),
+                    ed.pj.sim,
+                    ed.pj.sim.limits.begin(),
+                    ed.pj.sim.limits.end(),
+                    enum_cast<write_test_simulation_options>(options));
 
             std::fflush(stdout);
 
@@ -525,6 +533,11 @@ unordered_task_list& application::get_unordered_task_list() noexcept
     return task_mgr.unordered(0);
 }
 
+simulation_bag_executor application::get_unordered_executor() noexcept
+{
+    return simulation_bag_executor(task_mgr, 0);
+}
+
 void application::try_set_component_as_project(const file_access& /*files*/,
                                                const component_access& ids,
                                                const component_id id) noexcept
@@ -677,7 +690,9 @@ bool application::init() noexcept
           });
       });
 
-    if (auto ret = mod.fill_components(jn); ret.has_error()) {
+    auto executor             = get_unordered_executor();
+    mod.save_component_caches = config.vars.save_component_caches.load();
+    if (auto ret = mod.fill_components(jn, &executor); ret.has_error()) {
         jn.push(log_level::warning, [&](auto& title, auto& msg) noexcept {
             title = "Modeling initialization error";
             msg   = "Fail to fill read component list";
@@ -1333,6 +1333,10 @@ struct project_editor {
 
     raw_data_type save_simulation_raw_data = raw_data_type::none;
 
+    /// Writes the oldest samples of the observers into the @c spill
+    /// directory of the observation directory.
+    bool spill_observations = false;
+
     bool is_dock_init = false;
 
     /** Return true if a simulation is currently running.
@@ -1411,6 +1415,9 @@ struct project_editor {
     /// an output stream to store all model state during simulation.
     file raw_ofs;
 
+    /// The spill files of the observers if @a spill_observations is enabled.
+    vector<history_spill> spills;
+
     /** A local @c graph_editor to display the simulation graph component editor
      * (without observation). */
     graph_editor graph_ed;
@@ -1952,6 +1959,10 @@ public:
      */
     unordered_task_list& get_unordered_task_list() noexcept;
 
+    /// Returns an executor on the @a unordered_task_list for the coarse
+    /// parallel loops of the library (see @c irt::drain_observers).
+    simulation_bag_executor get_unordered_executor() noexcept;
+
     /// Allocate a new @c project_editor and read the file @c file_path_id.
     void start_load_project(const project_id f_id) noexcept;
 
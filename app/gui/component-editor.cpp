@@ -517,6 +517,9 @@ static bool display_text_source(
                 txt.file = undefined<file_path_id>();
                 return txt.file != undefined<file_path_id>();
             });
+
+            if (ImGui::Checkbox("binary cache", &txt.use_binary_cache))
+                ++u;
         }
 
         ImGui::TreePop();
@@ -41,6 +41,18 @@ static void show_observers_table(application& app, project_editor& ed) noexcept
             ImGui::TableNextColumn();
             ImGui::TextUnformatted("-");
 
+            // The lost samples and the highest occupancy of the raw buffer
+            // help to size the raw buffer or to enable the lossless mode.
+            ImGui::TableNextColumn();
+            if (const auto* obs = ed.pj.sim.observers.try_to_get(
+                  vobs.subs.template get<observer_id>(id)))
+                ImGui::TextFormat("{} lost, peak {}/{}",
+                                  obs->overflows(),
+                                  obs->raw_buffer_peak(),
+                                  obs->raw_buffer_capacity());
+            else
+                ImGui::TextUnformatted("-");
+
             ImGui::TableNextColumn();
             int plot_type =
               ordinal(vobs.subs.template get<plot_type_options>(id));
@@ -78,7 +90,7 @@ static void show_observers_table(application& app, project_editor& ed) noexcept
 
             obs->read_history(
               [&](const auto& lbuf, const auto /*version*/) noexcept {
-                  new_obs.linear_outputs = lbuf;
+                  new_obs.linear_outputs = lbuf.samples();
               });
         }
     }
@@ -108,6 +120,9 @@ static void show_copy_table(application& app) noexcept
         ImGui::TableNextColumn();
         ImGui::TextFormat("{}", copy.linear_outputs.size());
 
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted("-");
+
         ImGui::TableNextColumn();
         int plot_type = ordinal(copy.plot_type);
         if (ImGui::Combo(
@@ -136,12 +151,14 @@ static void show_observation_table(application& app) noexcept
       ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable |
       ImGuiTableFlags_Reorderable;
 
-    if (ImGui::BeginTable("Observations", 6, flags)) {
+    if (ImGui::BeginTable("Observations", 7, flags)) {
         ImGui::TableSetupColumn("name", ImGuiTableColumnFlags_WidthFixed, 80.f);
         ImGui::TableSetupColumn("id", ImGuiTableColumnFlags_WidthFixed, 60.f);
         ImGui::TableSetupColumn(
           "time-step", ImGuiTableColumnFlags_WidthFixed, 80.f);
         ImGui::TableSetupColumn("size", ImGuiTableColumnFlags_WidthFixed, 60.f);
+        ImGui::TableSetupColumn(
+          "raw buffer", ImGuiTableColumnFlags_WidthFixed, 140.f);
         ImGui::TableSetupColumn(
           "plot", ImGuiTableColumnFlags_WidthFixed, 180.f);
         ImGui::TableSetupColumn("actions", ImGuiTableColumnFlags_WidthStretch);
@@ -172,6 +189,16 @@ static void write(project&                        pj,
     ofs << "t," << vobs.subs.template get<name_str>(id).sv() << '\n';
 
     obs->read_history([&](const auto& lbuf, const auto /*version*/) noexcept {
+        lbuf.for_each_spilled_page([&](const auto dates, const auto values) {
+            for (sz i = 0, e = dates.size(); i != e; ++i)
+                ofs << dates[i] << ',' << values[i] << '\n';
+        });
+
+        // The summarized old dates (if any) are written with their mean.
+        for (int i = observer_history::lod_levels - 1; i >= 0; --i)
+            for (const auto& b : lbuf.level(i))
+                ofs << b.t_begin << ',' << b.mean << '\n';
+
         for (const auto& v : lbuf)
             ofs << v.t << ',' << v.value << '\n';
     });
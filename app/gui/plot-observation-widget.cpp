@@ -10,6 +10,38 @@
 
 namespace irt {
 
+/// Plots the levels of details of the history visible in the current plot:
+/// the min/max range and the mean of the buckets. Only the visible buckets
+/// are sent to ImPlot.
+static void plot_levels(const char*             name,
+                        const observer_history& h,
+                        const ImPlotRect&       limits) noexcept
+{
+    for (int i = observer_history::lod_levels - 1; i >= 0; --i) {
+        const auto b = h.level(i,
+                               static_cast<real>(limits.X.Min),
+                               static_cast<real>(limits.X.Max));
+        if (b.empty())
+            continue;
+
+        ImPlot::PlotShaded(name,
+                           &b[0].t_begin,
+                           &b[0].min,
+                           &b[0].max,
+                           static_cast<int>(b.size()),
+                           0,
+                           0,
+                           sizeof(resampled_bucket));
+        ImPlot::PlotLine(name,
+                         &b[0].t_begin,
+                         &b[0].mean,
+                         static_cast<int>(b.size()),
+                         0,
+                         0,
+                         sizeof(resampled_bucket));
+    }
+}
+
 void plot_observation_widget::show(project& pj) noexcept
 {
     for (auto& v_obs : pj.variable_observers) {
@@ -38,12 +70,18 @@ void plot_observation_widget::show(project& pj) noexcept
 
                 obs->read_history(
                   [&](const auto& h, const auto /*version*/) noexcept {
+                      const auto limits = ImPlot::GetPlotLimits();
+                      const auto v      = h.samples(
+                        static_cast<real>(limits.X.Min),
+                        static_cast<real>(limits.X.Max));
+
                       switch (opt) {
                       case plot_type_options::line:
+                          plot_levels(name.c_str(), h, limits);
                           ImPlot::PlotLine(name.c_str(),
-                                           &h[0].t,
-                                           &h[0].value,
-                                           h.size(),
+                                           &v[0].t,
+                                           &v[0].value,
+                                           static_cast<int>(v.size()),
                                            0,
                                            0,
                                            sizeof(resampled_sample));
@@ -51,9 +89,9 @@ void plot_observation_widget::show(project& pj) noexcept
 
                       case plot_type_options::dash:
                           ImPlot::PlotScatter(name.c_str(),
-                                              &h[0].t,
-                                              &h[0].value,
-                                              h.size(),
+                                              &v[0].t,
+                                              &v[0].value,
+                                              static_cast<int>(v.size()),
                                               0,
                                               0,
                                               sizeof(resampled_sample));
@@ -115,12 +153,17 @@ static void show_continuous_plot_line(const plot_type_options options,
                                       const observer&         obs) noexcept
 {
     obs.read_history([&](const auto& lbuf, const auto /*version*/) noexcept {
+        const auto limits = ImPlot::GetPlotLimits();
+        const auto v      = lbuf.samples(static_cast<real>(limits.X.Min),
+                                    static_cast<real>(limits.X.Max));
+
         switch (options) {
         case plot_type_options::line:
+            plot_levels(name.c_str(), lbuf, limits);
             ImPlot::PlotLine(name.c_str(),
-                             &lbuf[0].t,
-                             &lbuf[0].value,
-                             lbuf.ssize(),
+                             &v[0].t,
+                             &v[0].value,
+                             static_cast<int>(v.size()),
                              0,
                              0,
                              sizeof(resampled_sample));
@@ -128,9 +171,9 @@ static void show_continuous_plot_line(const plot_type_options options,
 
         case plot_type_options::dash:
             ImPlot::PlotScatter(name.c_str(),
-                                &lbuf[0].t,
-                                &lbuf[0].value,
-                                lbuf.ssize(),
+                                &v[0].t,
+                                &v[0].value,
+                                static_cast<int>(v.size()),
                                 0,
                                 0,
                                 sizeof(resampled_sample));
@@ -422,11 +422,13 @@ static bool show_simulation_table_grid_observers(application& /*app*/,
     auto to_delete   = undefined<grid_observer_id>();
     bool is_modified = false;
 
-    if (ImGui::BeginTable("Grid observers", 5)) {
+    if (ImGui::BeginTable("Grid observers", 7)) {
         ImGui::TableSetupColumn("name");
         ImGui::TableSetupColumn("scale");
         ImGui::TableSetupColumn("color");
         ImGui::TableSetupColumn("time-step");
+        ImGui::TableSetupColumn("history (KiB)");
+        ImGui::TableSetupColumn("lossless");
         ImGui::TableSetupColumn("delete");
         ImGui::TableHeadersRow();
 
@@ -460,6 +462,19 @@ static bool show_simulation_table_grid_observers(application& /*app*/,
                 is_modified = true;
             ImGui::PopItemWidth();
 
+            ImGui::TableNextColumn();
+            ImGui::PushItemWidth(-1);
+            if (auto budget = grid.history_budget.value();
+                ImGui::InputInt("##history", &budget)) {
+                grid.history_budget.set(budget);
+                is_modified = true;
+            }
+            ImGui::PopItemWidth();
+
+            ImGui::TableNextColumn();
+            if (ImGui::Checkbox("##lossless", &grid.lossless))
+                is_modified = true;
+
             ImGui::TableNextColumn();
             if (ImGui::Button("del"))
                 to_delete = ed.pj.grid_observers.get_id(grid);
@@ -484,11 +499,13 @@ static bool show_simulation_table_graph_observers(application& /*app*/,
     auto to_delete   = undefined<graph_observer_id>();
     bool is_modified = false;
 
-    if (ImGui::BeginTable("Graph observers", 5)) {
+    if (ImGui::BeginTable("Graph observers", 7)) {
         ImGui::TableSetupColumn("name");
         ImGui::TableSetupColumn("child");
         ImGui::TableSetupColumn("enable");
         ImGui::TableSetupColumn("time-step");
+        ImGui::TableSetupColumn("history (KiB)");
+        ImGui::TableSetupColumn("lossless");
         ImGui::TableSetupColumn("delete");
         ImGui::TableHeadersRow();
 
@@ -522,6 +539,19 @@ static bool show_simulation_table_graph_observers(application& /*app*/,
                 is_modified = true;
             ImGui::PopItemWidth();
 
+            ImGui::TableNextColumn();
+            ImGui::PushItemWidth(-1);
+            if (auto budget = graph.history_budget.value();
+                ImGui::InputInt("##history", &budget)) {
+                graph.history_budget.set(budget);
+                is_modified = true;
+            }
+            ImGui::PopItemWidth();
+
+            ImGui::TableNextColumn();
+            if (ImGui::Checkbox("##lossless", &graph.lossless))
+                is_modified = true;
+
             ImGui::TableNextColumn();
             if (ImGui::Button("del"))
                 to_delete = ed.pj.graph_observers.get_id(graph);
@@ -554,11 +584,13 @@ static bool show_simulation_table_variable_observers(
           "Can not allocate more multi-plot observers (max reached: {})",
           ed.pj.variable_observers.capacity());
 
-    if (ImGui::BeginTable("Plot observers", 5)) {
+    if (ImGui::BeginTable("Plot observers", 7)) {
         ImGui::TableSetupColumn("name");
         ImGui::TableSetupColumn("child");
         ImGui::TableSetupColumn("enable");
         ImGui::TableSetupColumn("time-step");
+        ImGui::TableSetupColumn("history (KiB)");
+        ImGui::TableSetupColumn("lossless");
         ImGui::TableSetupColumn("delete");
         ImGui::TableHeadersRow();
 
@@ -592,6 +624,19 @@ static bool show_simulation_table_variable_observers(
                 is_modified = true;
             ImGui::PopItemWidth();
 
+            ImGui::TableNextColumn();
+            ImGui::PushItemWidth(-1);
+            if (auto budget = variable.history_budget.value();
+                ImGui::InputInt("##history", &budget)) {
+                variable.history_budget.set(budget);
+                is_modified = true;
+            }
+            ImGui::PopItemWidth();
+
+            ImGui::TableNextColumn();
+            if (ImGui::Checkbox("##lossless", &variable.lossless))
+                is_modified = true;
+
             ImGui::TableNextColumn();
             if (ImGui::Button("del"))
                 to_delete = ed.pj.variable_observers.get_id(variable);
@@ -711,6 +711,7 @@ void project_external_source_editor::show(application&    app,
                                        ImGuiInputTextFlags_ReadOnly);
 
                     ImGui::InputSmallString("name", ptr->name);
+                    ImGui::Checkbox("binary cache", &ptr->use_binary_cache);
 
                     // ImGui::Text("%s",
                     // text_file_ptr->file_path.string().c_str());
@@ -736,16 +737,7 @@ void project_external_source_editor::show(application&    app,
 
                     ImGui::InputSmallString("name", ptr->name);
 
-                    if (ImGui::InputScalar(
-                          "max source",
-                          ImGuiDataType_U32,
-                          reinterpret_cast<void*>(&ptr->max_clients))) {
-                        if (auto ret = ptr->init(); !ret) {
-                            app.jn.push(log_level::error, [](auto& t, auto&) {
-                                t = "Fail to initialize binary file source";
-                            });
-                        }
-                    }
+                    ImGui::LabelFormat("reals", "{}", ptr->max_reals);
 
                     // ImGui::Text("%s",
                     // binary_file_ptr->file_path.string().c_str());
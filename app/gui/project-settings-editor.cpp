@@ -537,6 +537,15 @@ static bool show_project_simulation_settings(application&    app,
       "the observation directroy defined above.\nPlease note, the file "
       "may be large.");
 
+    if (ImGui::Checkbox("Spill observations", &ed.spill_observations))
+        ++up;
+
+    ImGui::SameLine();
+    HelpMarker(
+      "Writes the oldest samples of the observers into memory-mapped files "
+      "of the `spill' directory of the observation directory defined above. "
+      "Use it for long simulations or for a lot of observers.");
+
     app.sim_to_cpp.show(std::as_const(ed));
 
     return up > 0;
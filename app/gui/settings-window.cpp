@@ -216,6 +216,17 @@ void settings_window::show() noexcept
         });
     }
 
+    auto save_caches = app.config.vars.save_component_caches.load();
+    if (ImGui::Checkbox("Save component caches", &save_caches)) {
+        app.config.vars.save_component_caches = save_caches;
+        changes++;
+    }
+
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Write a cache of the decoded components into each "
+                          "registred path at startup. Used at the next "
+                          "startup.");
+
     ImGui::Separator();
     ImGui::Text("Graphics");
 
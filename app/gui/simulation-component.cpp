@@ -162,6 +162,14 @@ static void simulation_init(application& app, project_editor& ed) noexcept
         return;
     }
 
+    if (ed.spill_observations) {
+        if (const auto path = ed.pj.get_observation_dir(app.mod);
+            path.has_value()) {
+            if (not ed.pj.sim.spill_observers(*path / "spill", ed.spills))
+                make_init_error_msg(app, "Fail to open the spill files");
+        }
+    }
+
     if (ed.save_simulation_raw_data != project_editor::raw_data_type::none)
         if (const auto path = ed.pj.get_observation_dir(app.mod);
             path.has_value())
@@ -710,39 +718,15 @@ void project_editor::start_simulation_start(application& app) noexcept
 void project_editor::start_simulation_observation(application& app) noexcept
 {
     auto& task_list = app.get_unordered_task_list();
+    auto  executor  = app.get_unordered_executor();
 
     debug::ensure(simulation_state != simulation_status::finished);
 
+    pj.sim.tick_resamplers(pj.sim.immediate_observers, executor);
+
     constexpr sz capacity = 255;
-    sz           obs_max  = pj.sim.immediate_observers.size();
     sz           current  = 0;
 
-    while (obs_max > 0) {
-        const auto loop = std::min(obs_max, capacity);
-
-        for (sz i = 0; i != loop; ++i) {
-            auto obs_id = pj.sim.immediate_observers[i + current];
-
-            task_list.add([&, obs_id]() noexcept {
-                if (auto* obs = pj.sim.observers.try_to_get(obs_id)) {
-                    auto& res = pj.sim.observers.get<resampler>(obs_id);
-
-                    res.tick(*obs, pj.sim.current_time());
-                }
-            });
-        }
-
-        task_list.submit();
-        task_list.wait_completion();
-
-        current += loop;
-        if (obs_max > capacity)
-            obs_max -= capacity;
-        else
-            obs_max = 0;
-    }
-
-    current = 0;
     for (auto& g : pj.grid_observers) {
         const auto g_id = pj.grid_observers.get_id(g);
         task_list.add([&, g_id]() noexcept {
@@ -751,7 +735,7 @@ void project_editor::start_simulation_observation(application& app) noexcept
         });
 
         ++current;
-        if (current == obs_max) {
+        if (current == capacity) {
             task_list.submit();
             task_list.wait_completion();
             current = 0;
@@ -765,7 +749,7 @@ void project_editor::start_simulation_observation(application& app) noexcept
                 g->update(pj.sim);
         });
         ++current;
-        if (current == obs_max) {
+        if (current == capacity) {
             task_list.submit();
             task_list.wait_completion();
             current = 0;
@@ -783,41 +767,11 @@ void project_editor::start_simulation_observation(application& app) noexcept
 
 void project_editor::stop_simulation_observation(application& app) noexcept
 {
-    auto& task_list = app.get_unordered_task_list();
+    auto executor = app.get_unordered_executor();
 
     debug::ensure(simulation_state == simulation_status::finishing);
 
-    constexpr int capacity = 255;
-    auto          obs_max  = pj.sim.observers.ssize();
-
-    auto it = pj.sim.observers.begin();
-    auto et = pj.sim.observers.end();
-
-    while (it != et) {
-        const auto loop = std::min(obs_max, capacity);
-
-        for (int i = 0; i != loop; ++i) {
-            const auto obs_id = pj.sim.observers.get_id(*it);
-
-            task_list.add([&, obs_id]() noexcept {
-                if (auto* obs = pj.sim.observers.try_to_get(obs_id)) {
-                    auto& res = pj.sim.observers.get<resampler>(obs_id);
-
-                    res.tick(*obs, pj.sim.current_time());
-                }
-            });
-
-            ++it;
-        }
-
-        task_list.submit();
-        task_list.wait_completion();
-
-        if (obs_max >= capacity)
-            obs_max -= capacity;
-        else
-            obs_max = 0;
-    }
+    pj.sim.tick_resamplers(executor);
 
     pj.file_obs.finalize();
 }
@@ -1083,7 +1037,7 @@ void project_editor::start_simulation_advance(application& app) noexcept
         if (current_snap >= 0) {
             const auto* snap = snaps.ptr_from_index(current_snap);
             if (snaps.previous(snap)) {
-                pj.sim       = *snap;
+                snaps.restore(pj.sim, *snap);
                 current_snap = snaps.index_of(snap);
             }
         }
@@ -1099,7 +1053,7 @@ void project_editor::start_simulation_back(application& app) noexcept
         if (current_snap >= 0) {
             const auto* snap = snaps.ptr_from_index(current_snap);
             if (snaps.next(snap)) {
-                pj.sim       = *snap;
+                snaps.restore(pj.sim, *snap);
                 current_snap = snaps.index_of(snap);
             }
         }
@@ -8,7 +8,9 @@
 #include <irritator/global.hpp>
 #include <irritator/io.hpp>
 #include <irritator/observation.hpp>
+#include <irritator/thread.hpp>
 
+#include <algorithm>
 #include <charconv>
 #include <filesystem>
 #include <string>
@@ -22,13 +24,17 @@
 static void show_help() noexcept
 {
     std::puts(R"(
-irritator-cli [-h][-v][-tmin:max]
+irritator-cli [-h][-v][-c][-s][-tmin:max]
 
 Options:
   -h,--help                This help message
+  -c, --cache              Write a cache of the decoded components into each
+                           registred path. The cache is used at the next run.
   -v, --version            The version of irritator
   -o path                  The output path of the simulation result.
   --output path            If path does not exist, current dir is used.
+  -s, --spill              Write the oldest samples of the observers into
+                           the `spill' directory of the output path.
   -t:begin[,duration]      Define the beginning date of the simulation and
   --time begin[,duration]  ptionaly the duration. The begin date default is
                            0.0, the duration is +infiny. Duration can only
@@ -132,7 +138,16 @@ static constexpr auto error(Ret&& ret, Args&&... args) noexcept -> Ret
     return ret;
 }
 
-enum class option_id : irt::u8 { unknown, help, memory, output, time, version };
+enum class option_id : irt::u8 {
+    unknown,
+    cache,
+    help,
+    memory,
+    output,
+    spill,
+    time,
+    version
+};
 
 struct option {
     const std::string_view short_opt;
@@ -143,9 +158,11 @@ struct option {
 };
 
 static inline constexpr option options[] = {
+    { "c", "cache", option_id::cache, 0, 0 },
     { "h", "help", option_id::help, 0, 0 },
     { "m", "memory", option_id::memory, 1, 1 },
     { "o", "output", option_id::output, 1, 1 },
+    { "s", "spill", option_id::spill, 0, 0 },
     { "t", "time", option_id::time, 1, 2 },
     { "v", "version", option_id::version, 0, 0 },
 };
@@ -194,7 +211,10 @@ static constexpr const option* get_from_long(
 
 class main_parameters
 {
-    irt::sz memory = 1024 * 1024 * 8;
+    irt::sz memory      = 1024 * 1024 * 8;
+    bool    spill       = false;
+    bool    cache       = false;
+    bool    initialized = false;
 
     irt::journal_handler jn;
 
@@ -202,6 +222,11 @@ class main_parameters
     irt::json_dearchiver json;
     irt::project         pj;
 
+    irt::task_manager            tm{ 0, 1 };
+    irt::simulation_bag_executor executor{ tm, 0 };
+
+    irt::vector<irt::history_spill> spills;
+
     std::span<const char*> args;
     std::string_view       front;
 
@@ -213,12 +238,31 @@ public:
       : args{ av + 1, static_cast<std::size_t>(ac - 1) }
       , r{ 0.0 }
     {
+        tm.start();
+
         mod.files.write([&](auto& fs) noexcept {
             registred_path_add(fs);
             fs.browse_registreds(jn);
         });
 
-        if (auto ret = mod.fill_components(jn); ret.has_error()) {
+        load_next_token();
+    }
+
+    ~main_parameters() noexcept { tm.shutdown(); }
+
+    /** Reads the components of the registred paths before the first
+     * simulation file, after the options like @c --cache.
+     * @return false if the components can not be read.
+     */
+    bool fill_components() noexcept
+    {
+        if (initialized)
+            return true;
+
+        initialized               = true;
+        mod.save_component_caches = cache;
+
+        if (auto ret = mod.fill_components(jn, &executor); ret.has_error()) {
             switch (ret.error().cat()) {
             case irt::category::modeling:
                 warning<ec::modeling_init_error>(ret.error().value());
@@ -233,9 +277,11 @@ public:
                 warning<ec::unknown_error>();
                 break;
             }
-        } else {
-            load_next_token();
+
+            return false;
         }
+
+        return true;
     }
 
     void observation_initialize() noexcept
@@ -261,6 +307,8 @@ public:
 
     void observation_update() noexcept
     {
+        pj.sim.tick_resamplers(pj.sim.immediate_observers, executor);
+
         for (auto& g : pj.grid_observers) {
             const auto g_id = pj.grid_observers.get_id(g);
             if (auto* g = pj.grid_observers.try_to_get(g_id))
@@ -280,9 +328,15 @@ public:
     irt::expected<void> run() noexcept
     {
         observation_initialize();
+        pj.sim.embedded_executor = &executor;
         irt_check(pj.sim.srcs.prepare());
         irt_check(pj.sim.initialize());
 
+        if (spill) {
+            if (const auto path = pj.get_observation_dir(mod); path)
+                irt_check(pj.sim.spill_observers(*path / "spill", spills));
+        }
+
         fmt::print("grid-observers: {}\n"
                    "graph-observers: {}\n"
                    "plot-observers: {}\n"
@@ -298,8 +352,23 @@ public:
         } while (not pj.sim.current_time_expired());
 
         irt_check(pj.sim.finalize());
+        pj.sim.tick_resamplers(executor);
         observation_update();
 
+        // Lost samples show a raw buffer too small for the observers which
+        // are not lossless.
+        irt::u64 overflows = 0;
+        irt::u32 peak      = 0;
+        for (const auto& obs : pj.sim.observers) {
+            overflows += obs.overflows();
+            peak = std::max(peak, obs.raw_buffer_peak());
+        }
+
+        fmt::print("observers-lost-samples: {}\n"
+                   "observers-raw-buffer-peak: {}\n",
+                   overflows,
+                   peak);
+
         return irt::success();
     }
 
@@ -520,6 +589,10 @@ public:
     constexpr bool dispatch(const option& opt) noexcept
     {
         switch (opt.id) {
+        case option_id::cache:
+            cache = true;
+            return true;
+
         case option_id::help:
             show_help();
             return true;
@@ -536,6 +609,10 @@ public:
 
             return read_output_dir();
 
+        case option_id::spill:
+            spill = true;
+            return true;
+
         case option_id::version:
             show_version();
             return true;
@@ -590,6 +667,9 @@ public:
     {
         irt::debug::ensure(not front.empty());
 
+        if (not fill_components())
+            return false;
+
         if (auto ret = prepare_and_run(); not ret) {
             switch (ret.error().cat()) {
             case irt::category::json:
@@ -11,6 +11,40 @@
 
 namespace irt {
 
+//! A component json buffer parsed once. The referenced files and the
+//! component are both read from this document without a second parse.
+//! Documents can be parsed concurrently from several threads.
+class json_component_document
+{
+public:
+    json_component_document() noexcept = default;
+    ~json_component_document() noexcept;
+
+    json_component_document(const json_component_document&) = delete;
+    json_component_document& operator=(const json_component_document&) =
+      delete;
+    json_component_document(json_component_document&& other) noexcept;
+    json_component_document& operator=(
+      json_component_document&& other) noexcept;
+
+    //! Parse the json buffer @c io. On error, the document is empty.
+    status parse(std::span<const char> io) noexcept;
+
+    //! Read the files referenced by the document (objects with @c path, @c
+    //! directory and @c file members) into the sorted @c deps.
+    void read_dependencies(const file_access&    files,
+                           vector<file_path_id>& deps) const noexcept;
+
+    bool empty() const noexcept { return m_impl == nullptr; }
+    void clear() noexcept;
+
+private:
+    struct impl;
+    impl* m_impl = nullptr;
+
+    friend class json_dearchiver;
+};
+
 class json_dearchiver
 {
 private:
@@ -36,7 +70,8 @@ public:
                       file&              io,
                       journal_handler&   jn) noexcept;
 
-    //! Load a project from a project json file.
+    //! Load a project from a project json file. The file is streamed: only
+    //! one parameter or observation is decoded in memory at a time.
     status operator()(project&                pj,
                       const file_access&      files,
                       const component_access& ids,
@@ -52,6 +87,14 @@ public:
                       std::span<char>    io,
                       journal_handler&   jn) noexcept;
 
+    //! Load a component structure from an already parsed json document.
+    status operator()(const file_access&             files,
+                      component_access&              ids,
+                      const component_id             compo_id,
+                      component&                     compo,
+                      const json_component_document& doc,
+                      journal_handler&               jn) noexcept;
+
     //! Load a project from a project json file.
     status operator()(project&                pj,
                       const file_access&      files,
@@ -59,6 +102,12 @@ public:
                       std::span<char>         io,
                       journal_handler&        jn) noexcept;
 
+    //! Read the files referenced by a component json buffer (objects with
+    //! @c path, @c directory and @c file members) into the sorted @c deps.
+    static status read_dependencies(const file_access&    files,
+                                    std::span<const char> io,
+                                    vector<file_path_id>& deps) noexcept;
+
     void destroy() noexcept;
     void clear() noexcept;
 };
@@ -118,6 +167,11 @@ public:
     void clear() noexcept;
 };
 
+//! Saves and loads the models, connections, hierarchical state machines and
+//! external sources of a simulation. The version 2 format is a header, a
+//! table of contents and independent chunks (sources, state machines, blocks
+//! of models and connections) optionally compressed. Chunks are encoded and
+//! decoded in parallel. Version 1 files are still readable.
 class binary_archiver
 {
 public:
@@ -136,11 +190,24 @@ public:
     bool simulation_load(simulation& sim, file& io) noexcept;
     bool simulation_load(simulation& sim, memory& io) noexcept;
 
+    //! Maps read-only the file @c path and decodes the chunks directly from
+    //! the mapped pages.
+    bool simulation_load(simulation&                  sim,
+                         const std::filesystem::path& path) noexcept;
+
     void clear_cache() noexcept;
 
     error_code ec; //!< If main functions returns false, @c ec variable stores
                    //!< the error code.
 
+    //! If @c true, chunks are compressed with a fast LZ77 codec when it
+    //! reduces their size.
+    bool compress = false;
+
+    //! If not null, the chunks are encoded, decompressed and decoded onto
+    //! the workers of this executor, else on the caller thread.
+    simulation_bag_executor* executor = nullptr;
+
 private:
     struct impl; //!< Get access to observation attributes without complex code.
 
@@ -154,6 +221,89 @@ private:
     table<u32, random_source_id>      to_random;
 };
 
+//! A binary cache of the generic, grid and graph components decoded from the
+//! files of a registred path. The cache is stored in the @c .irritator-cache
+//! file at the root of the registred path and is memory-mapped by @c open().
+//! An entry is reused while the size and the modification time of its
+//! component file are unchanged or while the hash of its content is the
+//! same. References to other files are stored by name and resolved with the
+//! @c file_access at read time.
+class component_cache
+{
+public:
+    static constexpr std::string_view filename = ".irritator-cache";
+
+    struct entry {
+        std::string_view      dir;
+        std::string_view      file;
+        u64                   size  = 0;
+        i64                   mtime = 0;
+        u64                   hash  = 0;
+        std::span<const char> deps;
+        std::span<const char> data;
+    };
+
+    //! The file information and the dependencies of a component to write.
+    struct record {
+        component_id                  id = undefined<component_id>();
+        u64                           size  = 0;
+        i64                           mtime = 0;
+        u64                           hash  = 0;
+        std::span<const file_path_id> deps;
+    };
+
+    component_cache() noexcept = default;
+    ~component_cache() noexcept;
+
+    component_cache(const component_cache&) noexcept            = delete;
+    component_cache& operator=(const component_cache&) noexcept = delete;
+    component_cache(component_cache&& other) noexcept;
+    component_cache& operator=(component_cache&& other) noexcept;
+
+    //! Maps the cache file of the registred path @c reg. A missing, truncated
+    //! or older version of the cache file gives an empty cache.
+    status open(const registred_path& reg) noexcept;
+    void   close() noexcept;
+
+    //! Returns the entry of the file @c dir / @c file or @c nullptr.
+    const entry* find(std::string_view dir,
+                      std::string_view file) const noexcept;
+
+    //! Appends to @c deps the files referenced by the component of @c e.
+    static void read_dependencies(const file_access&    files,
+                                  const entry&          e,
+                                  vector<file_path_id>& deps) noexcept;
+
+    //! Builds the component @c id from the entry @c e. Returns @c
+    //! modeling_errc::component_not_found if a referenced component is not
+    //! yet read.
+    static status read(const file_access& files,
+                       component_access&  ids,
+                       const component_id id,
+                       const entry&       e) noexcept;
+
+    //! Writes the cache file of the registred path @c reg with the cacheable
+    //! components of @c records.
+    static status write(const file_access&      files,
+                        const component_access& ids,
+                        const registred_path&   reg,
+                        std::span<const record> records) noexcept;
+
+    //! @c true for generic, grid and graph components without external
+    //! sources.
+    static bool is_cacheable(const component& compo) noexcept;
+
+    //! 64-bits FNV-1a hash of a component file content.
+    static u64 hash(std::span<const char> buffer) noexcept;
+
+    //! Returns the size and the modification time of the file @c p.
+    static std::pair<u64, i64> stat(const std::filesystem::path& p) noexcept;
+
+private:
+    vector<entry> m_entries;
+    mapped_file   m_map;
+};
+
 } // namespace irt
 
 #endif
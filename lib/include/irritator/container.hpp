@@ -750,6 +750,7 @@ public:
     ~spin_mutex() noexcept = default;
 
     spin_mutex(const spin_mutex& other) noexcept;
+    spin_mutex& operator=(const spin_mutex& other) noexcept;
 
     void lock() noexcept;
     bool try_lock() noexcept;
@@ -868,6 +869,78 @@ protected:
     T* m_buffer = nullptr;
 };
 
+/**
+ * A heap allocated buffer where the capacity is defined at runtime. Used with
+ * @c circular_buffer_base, a copy of the circular buffer allocates a buffer
+ * with the same capacity.
+ */
+template<typename T, typename A = allocator<new_delete_memory_resource>>
+class heap_buffer
+{
+public:
+    static_assert(std::is_default_constructible_v<T>,
+                  "T must be default-constructible for heap_buffer");
+
+    using size_type  = std::uint32_t;
+    using index_type = std::make_signed_t<size_type>;
+
+    /// Allocates a buffer of @c capacity elements, at least two since the
+    /// @c circular_buffer_base keeps one free element.
+    explicit heap_buffer(const size_type capacity) noexcept
+      : m_capacity(std::max(capacity, size_type(2)))
+    {
+        m_buffer = static_cast<T*>(A::allocate(sizeof(T) * m_capacity));
+        std::uninitialized_default_construct_n(m_buffer, m_capacity);
+    }
+
+    heap_buffer(const heap_buffer& o) noexcept            = delete;
+    heap_buffer& operator=(const heap_buffer& o) noexcept = delete;
+
+    heap_buffer(heap_buffer&& o) noexcept
+      : m_buffer(std::exchange(o.m_buffer, nullptr))
+      , m_capacity(std::exchange(o.m_capacity, 0))
+    {}
+
+    heap_buffer& operator=(heap_buffer&& o) noexcept
+    {
+        if (this == &o)
+            return *this;
+
+        if (m_buffer)
+            A::deallocate(m_buffer, m_capacity * sizeof(T));
+
+        m_buffer   = std::exchange(o.m_buffer, nullptr);
+        m_capacity = std::exchange(o.m_capacity, 0);
+
+        return *this;
+    }
+
+    ~heap_buffer() noexcept
+    {
+        if (m_buffer)
+            A::deallocate(m_buffer, m_capacity * sizeof(T));
+
+        m_buffer = nullptr;
+    }
+
+    T& operator[](std::integral auto position) noexcept
+    {
+        return *(m_buffer + position);
+    }
+
+    const T& operator[](std::integral auto position) const noexcept
+    {
+        return *(m_buffer + position);
+    }
+
+    size_type capacity() const noexcept { return m_capacity; }
+    bool      good() const noexcept { return m_buffer != nullptr; }
+
+protected:
+    T*        m_buffer   = nullptr;
+    size_type m_capacity = 0;
+};
+
 /**
  * The @c circular_buffer_base class provides a single-writer/single-reader fifo
  * queue where pushing and popping is wait-free.
@@ -890,7 +963,16 @@ public:
                   std::is_nothrow_move_assignable_v<T> ||
                   std::is_trivially_move_assignable_v<T>);
 
-    constexpr circular_buffer_base() noexcept = default;
+    constexpr circular_buffer_base() noexcept
+        requires(std::is_default_constructible_v<underlying_memory_type>)
+    = default;
+
+    /// Builds a circular buffer with a runtime @c capacity (for example with
+    /// a @c heap_buffer).
+    explicit constexpr circular_buffer_base(const size_type capacity) noexcept
+        requires(std::is_constructible_v<underlying_memory_type, size_type>)
+      : m_buffer(capacity)
+    {}
 
     constexpr ~circular_buffer_base() noexcept
     {
@@ -902,6 +984,7 @@ public:
     }
 
     constexpr circular_buffer_base(const circular_buffer_base& other) noexcept
+      : m_buffer(make_memory(other))
     {
         copy_from(other);
     }
@@ -913,6 +996,16 @@ public:
             return *this;
 
         clear();
+
+        if constexpr (std::is_constructible_v<underlying_memory_type,
+                                              size_type>) {
+            if (capacity() != other.capacity()) {
+                m_buffer = make_memory(other);
+                m_head.store(0, std::memory_order_relaxed);
+                m_tail.store(0, std::memory_order_relaxed);
+            }
+        }
+
         copy_from(other);
         return *this;
     }
@@ -1037,6 +1130,16 @@ private:
         return (current + 1) % capacity();
     }
 
+    static underlying_memory_type make_memory(
+      const circular_buffer_base& other) noexcept
+    {
+        if constexpr (std::is_constructible_v<underlying_memory_type,
+                                              size_type>)
+            return underlying_memory_type(other.capacity());
+        else
+            return underlying_memory_type();
+    }
+
     void copy_from(const circular_buffer_base& other) noexcept
     {
         other.for_each(
@@ -2586,6 +2689,15 @@ public:
     template<int Num, int Denum = 1>
     bool grow(size_type count = 1) noexcept;
 
+    //! Replaces the content with a copy of the elements of @c other where
+    //! @c pred(id) returns true. Elements keep their identifiers and the
+    //! capacity is the highest copied index plus one. @c pred may be called
+    //! more than once for an identifier.
+    //!
+    //! @return false if the allocation failed, the container is unchanged.
+    template<typename Predicate>
+    bool assign_if(const data_array& other, Predicate&& pred) noexcept;
+
     //! @brief Destroy all items in the data_array but keep memory
     //!  allocation.
     //!
@@ -2739,7 +2851,7 @@ public:
           , id{ id_ }
         {}
 
-        reference operator*() const noexcept { return *self->try_to_get(id); }
+        reference operator*() const noexcept { return self->get(id); }
         pointer   operator->() const noexcept { return self->try_to_get(id); }
 
         iterator_base& operator++() noexcept
@@ -4790,6 +4902,46 @@ bool data_array<T, Identifier, A>::grow(size_type count) noexcept
     return reserve(std::max(required, ratio_cap));
 }
 
+template<typename T, typename Identifier, typename A>
+template<typename Predicate>
+bool data_array<T, Identifier, A>::assign_if(const data_array& other,
+                                             Predicate&&       pred) noexcept
+{
+    const auto accepted = [&](const index_type i) noexcept -> bool {
+        return is_valid(other.m_items[i].id) and pred(other.m_items[i].id);
+    };
+
+    index_type last = other.m_max_used;
+    while (last > 0 and not accepted(last - 1))
+        --last;
+
+    data_array copy(last);
+    if (last > 0 and copy.m_items == nullptr)
+        return false;
+
+    // Walks down the items to build the free list in increasing order of
+    // index like the @c free() function.
+    for (index_type i = last; i > 0; --i) {
+        const auto idx = static_cast<index_type>(i - 1);
+
+        if (accepted(idx)) {
+            std::construct_at(std::addressof(copy.m_items[idx].item),
+                              other.m_items[idx].item);
+            copy.m_items[idx].id = other.m_items[idx].id;
+            ++copy.m_max_size;
+        } else {
+            copy.m_items[idx].id = static_cast<Identifier>(copy.m_free_head);
+            copy.m_free_head     = idx;
+        }
+    }
+
+    copy.m_max_used = last;
+    copy.m_next_key = other.m_next_key;
+    copy.swap(*this);
+
+    return true;
+}
+
 template<typename T, typename Identifier, typename A>
 void data_array<T, Identifier, A>::clear() noexcept
 {
@@ -5161,6 +5313,12 @@ inline spin_mutex::spin_mutex(const spin_mutex& /*other*/) noexcept
   : spin_mutex()
 {}
 
+inline spin_mutex& spin_mutex::operator=(
+  const spin_mutex& /*other*/) noexcept
+{
+    return *this;
+}
+
 inline void spin_mutex::lock() noexcept
 {
     while (m_flag.test_and_set(std::memory_order_acquire))
@@ -11,12 +11,14 @@
 
 #include <array>
 #include <atomic>
+#include <bit>
 #include <filesystem>
 #include <fstream>
 #include <limits>
 #include <memory>
 #include <span>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -299,9 +301,15 @@ using dated_message = std::array<real, 4>;
 struct parameter;
 struct model;
 class simulation;
+class simulation_bag_executor;
+struct simulation_snapshot;
 class hierarchical_state_machine;
 struct source_data;
 class source;
+struct dynamics_table;
+
+template<typename... Dynamics>
+struct dynamics_set;
 
 enum class registred_path_id : u32;
 enum class dir_path_id : u32;
@@ -324,6 +332,56 @@ enum class random_source_id : u32;
 enum class factor_id : u32;
 enum class selection_id : u32;
 
+/*****************************************************************************
+ *
+ * @c mapped_file maps a file into the memory.
+ *
+ ****************************************************************************/
+
+/// A file mapped into the memory. The file handle is closed as soon as the
+/// file is mapped, only the view remains. A read-only mapping shares its
+/// pages with the other mappings of the same file. A read-write mapping
+/// writes through its pages into the file. Implemented in @c file.cpp next
+/// to the @c file class.
+class mapped_file
+{
+public:
+    mapped_file() noexcept = default;
+    ~mapped_file() noexcept;
+
+    mapped_file(const mapped_file&)            = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file(mapped_file&& other) noexcept;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+
+    /// Maps read-only the entire file @c path. An empty file returns @c
+    /// file_errc::empty.
+    static expected<mapped_file> open(
+      const std::filesystem::path& path) noexcept;
+
+    /// Creates the file @c path if necessary, grows it to at least @c offset
+    /// + @c bytes and maps read-write the @c bytes bytes at @c offset. The @c
+    /// offset must be a multiple of 64 KiB. If @c truncate is true, the
+    /// previous content is dropped. The file is sparse: disk blocks are
+    /// allocated by the writes.
+    static expected<mapped_file> open(const std::filesystem::path& path,
+                                      const u64                    offset,
+                                      const u64                    bytes,
+                                      const bool truncate) noexcept;
+
+    /// Unmaps the file. All the pointers into the view become invalid.
+    void close() noexcept;
+
+    bool             is_open() const noexcept { return m_data != nullptr; }
+    u64              size() const noexcept { return m_size; }
+    std::byte*       data() noexcept { return m_data; }
+    const std::byte* data() const noexcept { return m_data; }
+
+private:
+    std::byte* m_data = nullptr;
+    u64        m_size = 0;
+};
+
 /*****************************************************************************
  *
  * @c source and @c source_id are data from files or random generators.
@@ -437,7 +495,8 @@ struct external_source_definition {
     };
 
     struct text_source {
-        file_path_id file = undefined<file_path_id>();
+        file_path_id file             = undefined<file_path_id>();
+        bool         use_binary_cache = false;
     };
 
     struct random_source {
@@ -514,28 +573,28 @@ public:
 };
 
 //! Use a file with a set of double real in binary mode (little endian) to
-//! produce external data. This external source can be shared between @c
-//! max_clients sources. Each client read a @c external_source_chunk_size
-//! real of the set.
+//! produce external data. The file is mapped read-only into memory and the
+//! @c source::buffer of each client points directly into the mapped pages.
+//! The number of clients is unlimited: all clients attach with @c
+//! init(source&, source_data&) before the first @c update() and, for @c
+//! next_client clients, the client @c k reads the chunks @c k, @c k +
+//! next_client, etc. of @c external_source_chunk_size real and only stores
+//! its offset.
 //!
 //! source::chunk_id[0] is used to store the client identifier.
 //! source::chunk_id[1] is used to store the current position in the file.
 class binary_file_source
 {
 public:
-    name_str           name;
-    vector<chunk_type> buffers; // buffer, size is defined by max_clients
-    vector<u64>        offsets; // offset, size is defined by max_clients
-    u32                max_clients = 1; // number of source max (must be >= 1).
-    u64                max_reals   = 0; // number of real in the file.
+    name_str name;
+    u64      max_reals = 0; // number of real in the file.
 
     std::filesystem::path file_path;
-    std::ifstream         ifs;
-    u32                   next_client = 0;
-    u64                   next_offset = 0;
+    u64                   next_client = 0;
 
     binary_file_source() noexcept = default;
     explicit binary_file_source(const std::filesystem::path& p) noexcept;
+    ~binary_file_source() noexcept;
 
     binary_file_source(const binary_file_source& other) noexcept;
     binary_file_source(binary_file_source&& other) noexcept = delete;
@@ -544,35 +603,49 @@ public:
 
     void swap(binary_file_source& other) noexcept;
 
+    /// Maps the @c file_path file. Copies of the @c binary_file_source map
+    /// the same file and share the read-only pages.
     status init() noexcept;
+
+    /// Unmaps the file. All @c source::buffer becomes invalid.
     void   finalize() noexcept;
     status init(source& src, source_data& data) noexcept;
     status update(source& src, source_data& data) noexcept;
     status restore(source& src, source_data& data) noexcept;
     status finalize(source& src, source_data& data) noexcept;
 
-    bool seekg(const long to_seek) noexcept;
-    bool read(source& src, const int length) noexcept;
-    int  tellg() noexcept;
+    bool is_mapped() const noexcept { return m_reals != nullptr; }
+
+private:
+    mapped_file   m_map;             // read-only mapping of the file.
+    const double* m_reals = nullptr; // reals of the mapped file.
 };
 
 //! Use a file with a set of double real in ascii text file to produce
 //! external data. This external source can not be shared between @c source.
+//! The text is read by large blocks and parsed with @c std::from_chars. If
+//! @c use_binary_cache is true, the text file is converted once into a binary
+//! file (see @c binary_cache_path()) reused by the next initializations and
+//! the @c source::buffer points into this mapped binary file.
 //!
-//! source::chunk_id[0] is used to store the current position in the file to
-//! simplify restore operation.
+//! source::chunk_id[0] is used to store the current position in the file (or
+//! in the binary cache) to simplify restore operation.
 class text_file_source
 {
 public:
+    static constexpr u32 block_size = 64u * 1024u; // bytes read at once.
+
     name_str   name;
     chunk_type buffer;
-    u64        offset = 0u;
+    u64        offset           = 0u;
+    bool       use_binary_cache = false;
 
     std::filesystem::path file_path;
     std::ifstream         ifs;
 
     text_file_source() noexcept = default;
     explicit text_file_source(const std::filesystem::path& p) noexcept;
+    ~text_file_source() noexcept;
 
     text_file_source(const text_file_source& other) noexcept;
     text_file_source(text_file_source&& other) noexcept = delete;
@@ -588,17 +661,46 @@ public:
     status restore(source& src, source_data& data) noexcept;
     status finalize(source& src, source_data& data) noexcept;
 
+    /// Fills the @c buffer with the next @c external_source_chunk_size reals
+    /// of the text file.
     bool read_chunk() noexcept;
+
+    /// Returns the path of the binary cache: @c file_path with a @c .bin
+    /// extension appended.
+    std::filesystem::path binary_cache_path() const noexcept;
+
+private:
+    bool fill_block() noexcept;
+    bool read_real(double& value) noexcept;
+    bool seek(const u64 position) noexcept;
+    u64  tell() const noexcept { return m_block_offset + m_block_pos; }
+
+    status convert_to_binary_cache() noexcept;
+
+    vector<char> m_block;            // text read ahead from @c ifs.
+    u64          m_block_offset = 0; // position in the file of m_block[0].
+    u32          m_block_pos    = 0;
+    u32          m_block_len    = 0;
+
+    mapped_file   m_map;               // read-only mapped binary cache.
+    const double* m_reals     = nullptr; // reals of the mapped cache.
+    u64           m_max_reals = 0;
 };
 
 //! Use a prng to produce set of double real. This external source can be
-//! shared between multiple sources. Each client read a @c
-//! external_source_chunk_size real of the set.
+//! shared between an unlimited number of sources. Each client reads a block
+//! of @c external_source_chunk_size reals generated at once by a @c
+//! philox_64_block.
 //!
-//! The source::chunk_id[0-5] array is used to store the prng state.
+//! The source::chunk_id[0-5] array is used to store the prng state: the seed,
+//! the model identifier, the step of the current block, the client
+//! identifier and the step of the next block. The block is regenerated from
+//! the step of the current block to restore the source.
 class random_source
 {
 public:
+    static constexpr u32 page_size = 16u; // client buffers allocated at once.
+
     name_str name;
 
     std::array<real, 2> reals; // reals parameters for distribution
@@ -611,6 +713,9 @@ public:
                            std::span<const real, 2> reals_,
                            std::span<const i32, 2>  ints_) noexcept;
 
+    /// Copies the buffers and the steps of the clients. The @c
+    /// source::buffer of the clients still point into the buffers of @c
+    /// other: use @c restore() to point them into the copy.
     random_source(const random_source& other) noexcept;
     random_source(random_source&& other) noexcept = delete;
     random_source& operator=(const random_source& other) noexcept;
@@ -633,6 +738,13 @@ public:
     void fill(std::span<real>    buffer,
               const source&      src,
               const source_data& data) noexcept;
+
+private:
+    std::span<real> client_buffer(const u64 client) noexcept;
+    void            fill_client(source& src, source_data& data) noexcept;
+
+    vector<vector<chunk_type>> m_pages; // buffers of clients, never moved.
+    vector<u64>                m_steps; // step of the block of each client.
 };
 
 /// @brief Stores random source generator state, text and binary files
@@ -1099,6 +1211,396 @@ struct resampled_sample {
     real value = zero;
 };
 
+/// A summary of consecutive resampled samples of an observer history: the
+/// dates of the first and the last samples and the minimum, maximum and mean
+/// values of the samples.
+struct resampled_bucket {
+    real t_begin = zero;
+    real t_end   = zero;
+    real min     = zero;
+    real max     = zero;
+    real mean    = zero;
+    real count   = zero; //!< Number of resampled samples summarized.
+};
+
+/// Columnar pages of resampled samples stored into a memory-mapped file.
+///
+/// A page stores @c page_size dates followed by @c page_size values. The
+/// sparse file is mapped by segments: the segment @c k maps @c first << @c k
+/// pages and a new segment is mapped when the writer reaches the end of the
+/// previous one. Segments are never remapped, the views returned to the
+/// readers remain valid while the writer appends pages. Written pages are
+/// file-backed and may be evicted from the memory by the system.
+class history_spill
+{
+public:
+    static inline constexpr u32 page_size    = 4096;
+    static inline constexpr u64 page_bytes   = 2u * page_size * sizeof(real);
+    static inline constexpr int max_segments = 32;
+
+    history_spill() noexcept = default;
+    ~history_spill() noexcept;
+
+    history_spill(const history_spill&) noexcept            = delete;
+    history_spill& operator=(const history_spill&) noexcept = delete;
+    history_spill(history_spill&& other) noexcept;
+    history_spill& operator=(history_spill&& other) noexcept;
+
+    /// Creates or truncates the file @c path and maps the first segment of
+    /// @c initial_samples samples (rounded up to pages).
+    status open(const std::filesystem::path& path,
+                const u64                    initial_samples) noexcept;
+
+    /// Unmaps the file and truncates it to the written pages.
+    void close() noexcept;
+
+    /// Writes the @c page_size samples @c samples into the page @c page and
+    /// maps new segments if necessary. Returns @c false if the file cannot
+    /// grow, the caller keeps the samples.
+    bool write(const u64                         page,
+               std::span<const resampled_sample> samples) noexcept;
+
+    bool is_open() const noexcept { return m_segments[0].is_open(); }
+    u64  capacity() const noexcept { return m_capacity; }
+
+    /// The dates of the page @c page.
+    std::span<const real> dates(const u64 page) const noexcept
+    {
+        debug::ensure(page < m_capacity);
+
+        const auto [k, index] = locate(page);
+        const auto* first     = m_segments[k].data() + index * page_bytes;
+
+        return std::span(reinterpret_cast<const real*>(first), page_size);
+    }
+
+    /// The values of the page @c page.
+    std::span<const real> values(const u64 page) const noexcept
+    {
+        return std::span(dates(page).data() + page_size, page_size);
+    }
+
+private:
+    /// The segment of the page @c page and the index of the page into it.
+    std::pair<int, u64> locate(const u64 page) const noexcept
+    {
+        const auto k = std::bit_width(page / m_first + 1u) - 1;
+
+        return { k, page - m_first * ((u64(1) << k) - 1u) };
+    }
+
+    /// Maps the segment following the last mapped segment.
+    bool grow() noexcept;
+
+    std::array<mapped_file, max_segments> m_segments;
+    std::filesystem::path                 m_path;
+
+    u64 m_first    = 0; //!< Number of pages of the first segment.
+    u64 m_capacity = 0; //!< Number of pages mapped.
+    u64 m_pages    = 0; //!< Number of pages written.
+    int m_mapped   = 0; //!< Number of segments mapped.
+};
+
+/// The resampled samples of an observer.
+///
+/// Without memory budget, the history stores all the resampled samples. With
+/// a budget, the recent samples are kept at full resolution and the older
+/// ones are folded into @c lod_levels levels of @c resampled_bucket. A bucket
+/// of the level @c i + 1 summarizes @c lod_factor buckets of the level @c i
+/// and the last level halves its resolution when it is full: the whole time
+/// range remains available with a bounded memory. The levels store older
+/// dates than the samples and the level @c i + 1 older dates than the level
+/// @c i.
+///
+/// With a @c history_spill, the oldest samples are written page by page at
+/// full resolution into the spill file instead of being folded. The spilled
+/// pages store older dates than the levels.
+class observer_history
+{
+public:
+    static inline constexpr int lod_levels = 4;
+    static inline constexpr int lod_factor = 8;
+
+    using value_type     = resampled_sample;
+    using size_type      = vector<resampled_sample>::size_type;
+    using index_type     = vector<resampled_sample>::index_type;
+    using const_iterator = vector<resampled_sample>::const_iterator;
+
+    /// The @c shared_buffer merge policy: appends the new samples if no
+    /// sample was folded into the levels since the @c dst copy, copies the
+    /// whole history otherwise.
+    struct merge_policy {
+        static void merge(observer_history&       dst,
+                          const observer_history& src) noexcept
+        {
+            if (dst.m_generation == src.m_generation and
+                dst.m_samples.size() <= src.m_samples.size()) {
+                dst.m_samples.insert(
+                  dst.m_samples.end(),
+                  src.m_samples.begin() +
+                    static_cast<std::ptrdiff_t>(dst.m_samples.size()),
+                  src.m_samples.end());
+            } else {
+                dst = src;
+            }
+        }
+
+        static void reset(observer_history& dst) noexcept { dst.clear(); }
+    };
+
+    /// Appends the samples of @c batch. If @c spill is not null, the oldest
+    /// pages of samples are written into the @c spill file. If @c budget is
+    /// not null, the oldest samples are folded into the levels to keep the
+    /// history near @c budget bytes. Returns @c false if the allocation
+    /// fails.
+    bool append(std::span<const resampled_sample> batch,
+                const std::size_t                 budget,
+                history_spill*                    spill = nullptr) noexcept
+    {
+        if (not m_samples.can_alloc(batch.size()) and
+            not m_samples.template grow<2, 1>(batch.size()))
+            return false;
+
+        m_samples.insert(m_samples.end(), batch.begin(), batch.end());
+
+        if (spill)
+            write_pages(*spill);
+
+        if (budget > 0)
+            decimate(budget);
+
+        return true;
+    }
+
+    void clear() noexcept
+    {
+        m_samples.clear();
+        for (auto& level : m_levels)
+            level.clear();
+        m_generation = 0;
+        m_spill      = nullptr;
+        m_pages      = 0;
+    }
+
+    /// Number of samples stored in the spill file.
+    u64 spilled() const noexcept { return m_pages * history_spill::page_size; }
+
+    /// Calls @c fn(dates, values) with the memory-mapped columns of each
+    /// spilled page from the oldest to the latest.
+    template<typename Fn>
+    void for_each_spilled_page(Fn&& fn) const noexcept
+    {
+        for (u64 i = 0; i < m_pages; ++i)
+            fn(m_spill->dates(i), m_spill->values(i));
+    }
+
+    /// The full resolution samples.
+    const vector<resampled_sample>& samples() const noexcept
+    {
+        return m_samples;
+    }
+
+    /// The full resolution samples in the range [@c t_begin, @c t_end] with
+    /// the samples just before and just after the range.
+    std::span<const resampled_sample> samples(const real t_begin,
+                                              const real t_end) const noexcept
+    {
+        return find(std::span(m_samples.data(), m_samples.size()),
+                    t_begin,
+                    t_end,
+                    [](const auto& s) noexcept { return s.t; });
+    }
+
+    /// The buckets of the level @c i ordered by date.
+    std::span<const resampled_bucket> level(const int i) const noexcept
+    {
+        debug::ensure(0 <= i and i < lod_levels);
+
+        return std::span(m_levels[i].data(), m_levels[i].size());
+    }
+
+    /// The buckets of the level @c i in the range [@c t_begin, @c t_end] with
+    /// the buckets just before and just after the range.
+    std::span<const resampled_bucket> level(const int  i,
+                                            const real t_begin,
+                                            const real t_end) const noexcept
+    {
+        return find(level(i), t_begin, t_end, [](const auto& b) noexcept {
+            return b.t_begin;
+        });
+    }
+
+    /// Returns the number of bytes allocated by the history.
+    std::size_t allocated() const noexcept
+    {
+        auto bytes = m_samples.capacity() * sizeof(resampled_sample);
+        for (const auto& level : m_levels)
+            bytes += level.capacity() * sizeof(resampled_bucket);
+
+        return bytes;
+    }
+
+    size_type      size() const noexcept { return m_samples.size(); }
+    index_type     ssize() const noexcept { return m_samples.ssize(); }
+    bool           empty() const noexcept { return m_samples.empty(); }
+    const_iterator begin() const noexcept { return m_samples.begin(); }
+    const_iterator end() const noexcept { return m_samples.end(); }
+
+    const resampled_sample& front() const noexcept { return m_samples.front(); }
+    const resampled_sample& back() const noexcept { return m_samples.back(); }
+
+    const resampled_sample& operator[](std::integral auto i) const noexcept
+    {
+        return m_samples[i];
+    }
+
+private:
+    template<typename T, typename Fn>
+    static std::span<const T> find(std::span<const T> v,
+                                   const real         t_begin,
+                                   const real         t_end,
+                                   Fn&&               date) noexcept
+    {
+        auto first = std::lower_bound(
+          v.begin(), v.end(), t_begin, [&](const auto& e, const real t) {
+              return date(e) < t;
+          });
+        auto last = std::upper_bound(
+          first, v.end(), t_end, [&](const real t, const auto& e) {
+              return t < date(e);
+          });
+
+        if (first != v.begin())
+            --first;
+        if (last != v.end())
+            ++last;
+
+        return std::span<const T>(first, last);
+    }
+
+    static resampled_bucket make_bucket(
+      std::span<const resampled_sample> samples) noexcept
+    {
+        resampled_bucket b{ .t_begin = samples.front().t,
+                            .t_end   = samples.back().t,
+                            .min     = samples.front().value,
+                            .max     = samples.front().value,
+                            .mean    = zero,
+                            .count   = zero };
+
+        for (const auto& s : samples) {
+            b.min = std::min(b.min, s.value);
+            b.max = std::max(b.max, s.value);
+            b.mean += s.value;
+        }
+
+        b.count = static_cast<real>(samples.size());
+        b.mean /= b.count;
+
+        return b;
+    }
+
+    static resampled_bucket make_bucket(
+      std::span<const resampled_bucket> buckets) noexcept
+    {
+        resampled_bucket b{ .t_begin = buckets.front().t_begin,
+                            .t_end   = buckets.back().t_end,
+                            .min     = buckets.front().min,
+                            .max     = buckets.front().max,
+                            .mean    = zero,
+                            .count   = zero };
+
+        for (const auto& e : buckets) {
+            b.min = std::min(b.min, e.min);
+            b.max = std::max(b.max, e.max);
+            b.mean += e.mean * e.count;
+            b.count += e.count;
+        }
+
+        b.mean /= b.count;
+
+        return b;
+    }
+
+    /// Folds the @c n oldest elements of @c from into buckets of @c
+    /// lod_factor elements appended to @c to.
+    template<typename T>
+    static void fold(vector<T>&                from,
+                     vector<resampled_bucket>& to,
+                     const size_type           n) noexcept
+    {
+        if (not to.can_alloc(n / lod_factor) and
+            not to.template grow<2, 1>(n / lod_factor))
+            return;
+
+        for (size_type i = 0; i < n; i += lod_factor)
+            to.push_back(make_bucket(std::span<const T>(from.data() + i,
+                                                        lod_factor)));
+
+        from.erase(from.begin(), from.begin() + n);
+    }
+
+    /// Writes the oldest samples into the spill file and keeps at least one
+    /// page of samples in memory.
+    void write_pages(history_spill& spill) noexcept
+    {
+        if (m_spill != &spill) {
+            m_spill = &spill;
+            m_pages = 0;
+            ++m_generation;
+        }
+
+        constexpr auto n = history_spill::page_size;
+
+        while (m_samples.size() >= 2 * n and
+               spill.write(m_pages, std::span(m_samples.data(), n))) {
+            m_samples.erase(m_samples.begin(), m_samples.begin() + n);
+            ++m_pages;
+            ++m_generation;
+        }
+    }
+
+    void decimate(const std::size_t budget) noexcept
+    {
+        const auto window = std::max<size_type>(
+          2 * lod_factor, budget / 2 / sizeof(resampled_sample));
+        const auto capacity = std::max<size_type>(
+          2 * lod_factor, budget / 2 / lod_levels / sizeof(resampled_bucket));
+
+        if (m_samples.size() > window) {
+            const auto n =
+              (m_samples.size() - window / 2) / lod_factor * lod_factor;
+            fold(m_samples, m_levels[0], n);
+            ++m_generation;
+        }
+
+        for (int i = 0; i + 1 < lod_levels; ++i) {
+            if (m_levels[i].size() > capacity) {
+                const auto n =
+                  (m_levels[i].size() - capacity / 2) / lod_factor * lod_factor;
+                fold(m_levels[i], m_levels[i + 1], n);
+            }
+        }
+
+        auto& last = m_levels[lod_levels - 1];
+        if (last.size() > capacity) {
+            size_type j = 0;
+            for (size_type i = 0; i < last.size(); i += 2, ++j)
+                last[j] = i + 1 < last.size()
+                            ? make_bucket(std::span(last.data() + i, 2))
+                            : last[i];
+
+            last.resize(j);
+        }
+    }
+
+    vector<resampled_sample>                         m_samples;
+    std::array<vector<resampled_bucket>, lod_levels> m_levels;
+    u64                                              m_generation = 0;
+    const history_spill*                             m_spill      = nullptr;
+    u64                                              m_pages      = 0;
+};
+
 class qss_interpolator
 {
 public:
@@ -1218,20 +1720,28 @@ private:
 class observer
 {
 public:
-    static inline constexpr auto raw_buffer_size = 256;
+    /// Default number of samples of the raw buffer.
+    static inline constexpr u32 raw_buffer_size = 256;
 
-    using raw_buffer_type = circular_buffer<raw_sample, raw_buffer_size>;
+    using raw_buffer_type =
+      circular_buffer_base<raw_sample, heap_buffer<raw_sample>>;
 
-    observer(const model_id mdl) noexcept
+    /// Builds an observer of the model @c mdl with a raw buffer of @c
+    /// raw_capacity samples (see @c raw_buffer_capacity()).
+    observer(const model_id mdl,
+             const u32      raw_capacity = raw_buffer_size) noexcept
       : m_model(mdl)
+      , m_raw(raw_capacity + 1u)
     {}
 
     /// Push a raw sample. Called from the simulation task for each state
     /// change. O(1), no resampling logic here anymore.
     ///
-    /// @return buffer_status::overflow if the sample was lost (raw_buffer
-    /// full and not drained in time by the copy task), near_full if the
-    /// occupancy threshold was crossed, ok otherwise.
+    /// @return buffer_status::overflow if the sample was not pushed
+    /// (raw_buffer full and not drained in time by the copy task),
+    /// near_full if the occupancy threshold was crossed, ok otherwise. In
+    /// lossless mode, the simulation drains the raw buffer and pushes the
+    /// sample again.
     buffer_status observe(const raw_sample& s) noexcept
     {
         debug::ensure(s.t >= m_last_t and
@@ -1239,8 +1749,12 @@ public:
                       "observation -- violates DEVS causality");
         m_last_t = s.t;
 
-        if (not m_raw.push(s))
+        if (not m_raw.push(s)) {
+            ++m_overflows;
             return buffer_status::overflow;
+        }
+
+        m_raw_peak = std::max(m_raw_peak, static_cast<u32>(m_raw.size()));
 
         return raw_fill_status();
     }
@@ -1248,13 +1762,53 @@ public:
     void reset() noexcept
     {
         m_raw.clear();
-        m_last_t = -std::numeric_limits<real>::infinity();
+        m_last_t    = -std::numeric_limits<real>::infinity();
+        m_overflows = 0;
+        m_raw_peak  = 0;
         m_history.reset();
     }
 
+    /// Number of raw samples that can be stored before an overflow.
+    u32 raw_buffer_capacity() const noexcept { return m_raw.capacity() - 1; }
+
+    /// Replaces the raw buffer with a buffer of @c capacity samples. The
+    /// pending raw samples are lost: call this function before the
+    /// simulation starts.
+    void raw_buffer_capacity(const u32 capacity) noexcept
+    {
+        if (capacity != raw_buffer_capacity())
+            m_raw = raw_buffer_type(capacity + 1);
+    }
+
+    /// In lossless mode, the simulation drains the raw buffer with the
+    /// resampler of this observer instead of dropping a sample when the
+    /// raw buffer is full.
+    bool lossless() const noexcept { return m_lossless; }
+    void lossless(const bool enable) noexcept { m_lossless = enable; }
+
+    /// Number of samples that did not fit in the raw buffer. These samples
+    /// are lost unless the observer is in lossless mode.
+    u64 overflows() const noexcept { return m_overflows; }
+
+    /// Maximum number of samples in the raw buffer since the last reset.
+    u32 raw_buffer_peak() const noexcept { return m_raw_peak; }
+
     /// Retrieves the underlying model identifier.
     model_id model() const noexcept { return m_model; }
 
+    /// Memory budget in bytes of each copy of the history, @c 0 for an
+    /// unbounded history. See @c observer_history.
+    std::size_t history_budget() const noexcept { return m_history_budget; }
+    void history_budget(const std::size_t bytes) noexcept
+    {
+        m_history_budget = bytes;
+    }
+
+    /// The file where the oldest samples of the history are written or @c
+    /// nullptr. The @c history_spill must outlive the observer.
+    history_spill* spill() const noexcept { return m_spill; }
+    void           spill(history_spill* s) noexcept { m_spill = s; }
+
     /// Designated single reader: the copy task's resampler for this
     /// model. Justified now (unlike before) because a real, dedicated
     /// consumer exists on the other side of the SPSC contract.
@@ -1272,7 +1826,8 @@ public:
         });
     }
 
-    /// Only @c resampler can call the write_history function.
+    /// Only @c resampler can call the write_history and consumer
+    /// functions.
     class write_key
     {
         friend class resampler;
@@ -1280,6 +1835,10 @@ public:
         write_key() noexcept = default;
     };
 
+    /// Locked by the resampler while it drains the raw buffer: the copy task
+    /// and the simulation (in lossless mode) are never both consumers.
+    spin_mutex& consumer(write_key) noexcept { return m_consumer; }
+
     /// Used exclusively by this model's resampler (copy task side) to
     /// publish a batch of resampled points in a single write() -- never
     /// called from the simulation thread.
@@ -1304,14 +1863,18 @@ private:
                                     : buffer_status::ok;
     }
 
-    model_id m_model  = undefined<model_id>();
-    real     m_last_t = -std::numeric_limits<real>::infinity();
+    model_id       m_model          = undefined<model_id>();
+    real           m_last_t         = -std::numeric_limits<real>::infinity();
+    std::size_t    m_history_budget = 0;
+    history_spill* m_spill          = nullptr;
+    u64            m_overflows      = 0;
+    u32            m_raw_peak       = 0;
+    bool           m_lossless       = false;
 
-    circular_buffer<raw_sample, raw_buffer_size> m_raw;
+    raw_buffer_type m_raw;
+    spin_mutex      m_consumer;
 
-    shared_buffer<vector<resampled_sample>,
-                  append_only_merge_policy<vector<resampled_sample>>>
-      m_history;
+    shared_buffer<observer_history, observer_history::merge_policy> m_history;
 };
 
 /// Resampler -- owned exclusively by the copy task, ONE instance per
@@ -1332,6 +1895,9 @@ public:
       , m_interp(order)
     {}
 
+    /// The time step of the resampled samples.
+    real time_step() const noexcept { return m_dt; }
+
     /// Call periodically (e.g. once per UI refresh, or once per completed
     /// global simulation step) for this model. Drains everything currently
     /// available in raw_buffer, confirms the pending point once `now` has
@@ -1340,6 +1906,8 @@ public:
     /// resampled points to obs.write_history() in a single batched call.
     void tick(observer& obs, const real now) noexcept
     {
+        std::lock_guard<spin_mutex> lock(obs.consumer(observer::write_key{}));
+
         raw_sample s;
         while (obs.raw_buffer().pop(s))
             ingest(s);
@@ -1428,17 +1996,14 @@ private:
         if (m_batch.empty())
             return;
 
+        const auto budget = obs.history_budget();
+        auto*      spill  = obs.spill();
+
         obs.write_history(
           [&](auto& history) {
-              const auto n = m_batch.size();
-
-              if (not history.can_alloc(n) and
-                  not history.template grow<2, 1>(n)) {
+              if (not history.append(
+                    std::span(m_batch.data(), m_batch.size()), budget, spill))
                   debug::print("fail to allocate more observer history\n");
-                  return;
-              }
-
-              history.insert(history.end(), m_batch.begin(), m_batch.end());
           },
           observer::write_key{});
 
@@ -1458,6 +2023,20 @@ private:
     bool             m_has_last_pushed = false;
 };
 
+/// The elements of a container changed since the previous snapshot: the
+/// positions in the container and the copies of the elements.
+template<typename T>
+struct simulation_snapshot_delta {
+    vector<u32> positions;
+    vector<T>   items;
+
+    void clear() noexcept
+    {
+        positions.clear();
+        items.clear();
+    }
+};
+
 static inline constexpr u32 invalid_heap_handle = 0xffffffff;
 
 /**
@@ -1554,6 +2133,26 @@ public:
     constexpr const node& operator[](handle h) const noexcept;
     constexpr node&       operator[](handle h) noexcept;
 
+    /** The nodes changed since a shadow copy of the heap and the state of
+     * the heap. */
+    struct delta {
+        simulation_snapshot_delta<node> nodes;
+
+        u32 size      = 0;
+        u32 free_list = invalid_heap_handle;
+        u32 root      = invalid_heap_handle;
+    };
+
+    /**
+       Stores into @c d the nodes different from the nodes of the @c shadow
+       copy and updates the @c shadow. Returns false if a node was allocated
+       since the copy: a delta cannot be stored.
+     */
+    bool make_delta(heap& shadow, delta& d) const noexcept;
+
+    /** Assigns the delta @c d to a copy of the shadow of @c make_delta(). */
+    void apply_delta(const delta& d) noexcept;
+
 private:
     constexpr handle merge(handle a, handle b) noexcept;
     constexpr handle merge_right(handle a) noexcept;
@@ -1562,6 +2161,166 @@ private:
     constexpr void   detach_subheap(handle elem) noexcept;
 };
 
+/**
+   A calendar queue (R. Brown, 1988) stores nodes into an array of buckets
+   sorted by @c tn, each bucket covering a @c width of time. With a @c width
+   close to the separation of the next events, @c pop and @c insert have an
+   O(1) amortized complexity. This queue is efficient for clustered @c tn like
+   models firing on fixed timesteps (@c generator, @c time_func etc.).
+
+   Nodes with the same @c tn are grouped: only the first node (the leader) is
+   linked into the bucket, the others are linked into the @c child list of
+   the leader. Buckets only store distinct @c tn and a @c pop detaches a whole
+   group.
+
+   The number of buckets grows with the number of finite nodes. The @c width
+   is recomputed from the nodes when the number of buckets grows or when the
+   scan cost per popped node becomes too high. Nodes with an infinite @c tn
+   are stored in a dedicated list.
+
+   The handles are stable as for the @c heap and are reused after a @c
+   destroy(handle) via a free list.
+ */
+template<typename A = allocator<new_delete_memory_resource>>
+class calendar_queue
+{
+public:
+    using this_container = calendar_queue<A>;
+    using allocator_type = A;
+    using index_type     = u32;
+    using handle         = u32;
+
+    struct node {
+        time     tn;
+        model_id id;
+        i64      day; /**< `floor(tn / width)` computed at insertion. */
+
+        u32 prev   = invalid_heap_handle;
+        u32 next   = invalid_heap_handle;
+        u32 child  = invalid_heap_handle; /**< First node of the group. */
+        u32 bucket = invalid_heap_handle;
+    };
+
+    /** A doubly linked list of group leaders sorted by @c tn. */
+    struct bucket_list {
+        u32 head = invalid_heap_handle;
+        u32 tail = invalid_heap_handle;
+    };
+
+private:
+    vector<node, A>        nodes;
+    vector<bucket_list, A> buckets;
+    vector<u32, A>         scratch;
+    bucket_list            infinity_list;
+
+    u32 free_list{ invalid_heap_handle };
+    u32 m_size{ 0 };
+    u32 m_finite_size{ 0 };
+
+    mutable u32 m_top{ invalid_heap_handle };
+    mutable i64 m_day{ 0 };
+    mutable u64 m_visited{ 0 };
+    u64         m_popped{ 0 };
+
+    time m_width{ one };
+
+public:
+    calendar_queue() noexcept = default;
+
+    explicit calendar_queue(
+      constrained_value<int, 512, INT_MAX> pcapacity) noexcept;
+
+    /** Clear and free the allocated buffers. */
+    void destroy() noexcept;
+
+    /** Clear the buffers. The number of buckets and the width are kept. */
+    void clear() noexcept;
+
+    bool reserve(std::integral auto new_capacity) noexcept;
+
+    /**
+       Allocate a new node into the queue and insert the @c model_id and the
+       @c time into the calendar.
+     */
+    handle alloc(time tn, model_id id) noexcept;
+
+    void destroy(handle elem) noexcept;
+    void insert(handle elem) noexcept;
+    void reintegrate(time tn, handle elem) noexcept;
+    void remove(handle elem) noexcept;
+    void decrease(time tn, handle elem) noexcept;
+    void increase(time tn, handle elem) noexcept;
+
+    /**
+       Detach all nodes with the lowest @c tn from the calendar and stores
+       their @c model_id into the @c out vector.
+     */
+    void pop(vector<model_id>& out) noexcept;
+
+    time tn(handle elem) const noexcept;
+
+    unsigned size() const noexcept;
+    int      ssize() const noexcept;
+
+    bool empty() const noexcept;
+    bool is_in_tree(handle h) const noexcept;
+
+    /** Returns the handle of a node with the lowest @c tn. */
+    handle top() const noexcept;
+
+    const node& operator[](handle h) const noexcept;
+    node&       operator[](handle h) noexcept;
+
+    /** The nodes and buckets changed since a shadow copy of the calendar and
+     * the state of the calendar. */
+    struct delta {
+        simulation_snapshot_delta<node>        nodes;
+        simulation_snapshot_delta<bucket_list> buckets;
+
+        bucket_list infinity_list;
+
+        u32  free_list   = invalid_heap_handle;
+        u32  size        = 0;
+        u32  finite_size = 0;
+        u32  top         = invalid_heap_handle;
+        i64  day         = 0;
+        u64  visited     = 0;
+        u64  popped      = 0;
+        time width       = one;
+    };
+
+    /**
+       Stores into @c d the nodes and buckets different from the @c shadow
+       copy and updates the @c shadow. Returns false if a node was allocated
+       or if the buckets were resized since the copy: a delta cannot be
+       stored.
+     */
+    bool make_delta(calendar_queue& shadow, delta& d) const noexcept;
+
+    /** Assigns the delta @c d to a copy of the shadow of @c make_delta(). */
+    void apply_delta(const delta& d) noexcept;
+
+private:
+    static constexpr u32 infinity_bucket = 0xfffffffe;
+    static constexpr u32 follower        = 0xfffffffd;
+    static constexpr u32 min_buckets     = 16;
+
+    i64          day(time tn) const noexcept;
+    u32          bucket(i64 day) const noexcept;
+    bucket_list& list(const node& n) noexcept;
+    void         push_back(bucket_list& l, handle elem) noexcept;
+    void         push_follower(handle leader, handle elem) noexcept;
+    void         link(handle elem) noexcept;
+    void         unlink(handle elem) noexcept;
+    void         resize(u32 bucket_number) noexcept;
+};
+
+/// Container used by the @c scheduller to sort the @c model::tn.
+enum class scheduller_policy : u8 {
+    pairing_heap,   ///< O(log n) amortized, efficient for any @c tn.
+    calendar_queue, ///< O(1) amortized, efficient for clustered @c tn.
+};
+
 /*****************************************************************************
  *
  * scheduler
@@ -1581,6 +2340,10 @@ private:
    `node::next` and `node::prev` are null (`irt::invalid_heap_handle`). To
    detach a node, you can use the `heap::pop()` or `heap::remove()`
    functions.
+
+   The @c scheduller_policy selects the container used to sort the nodes. The
+   policy can only be changed before the @c simulation::initialize() since
+   all handles are invalidated.
  */
 template<typename A = allocator<new_delete_memory_resource>>
 class scheduller
@@ -1590,7 +2353,10 @@ public:
     using allocator_type = A;
 
 private:
-    heap<A> m_heap;
+    heap<A>           m_heap;
+    calendar_queue<A> m_calendar;
+    u32               m_capacity = 0;
+    scheduller_policy m_policy   = scheduller_policy::pairing_heap;
 
 public:
     using internal_value_type = heap<A>;
@@ -1603,6 +2369,14 @@ public:
     void clear() noexcept;
     void destroy() noexcept;
 
+    /**
+       Change the container used to store the nodes. All nodes are cleared
+       and the models handles must be reset (see @c
+       simulation::initialize()).
+     */
+    bool              set_policy(scheduller_policy policy) noexcept;
+    scheduller_policy policy() const noexcept;
+
     /**
        Allocate a new @c heap::node and makes a link between @c heap::node
        and
@@ -1665,10 +2439,34 @@ public:
 
     inline unsigned size() const noexcept;
     int             ssize() const noexcept;
-};
 
-/// Stores two simulation time values, the begin `]-oo, +oo[` and the end
-/// value
+    /** The changes of the container of the scheduller since a shadow copy
+     * (see @c simulation_snapshot_handler). */
+    struct delta {
+        typename heap<A>::delta           heap;
+        typename calendar_queue<A>::delta calendar;
+
+        void clear() noexcept
+        {
+            heap.nodes.clear();
+            calendar.nodes.clear();
+            calendar.buckets.clear();
+        }
+    };
+
+    /**
+       Stores into @c d the changes since the @c shadow copy and updates the
+       @c shadow. Returns false if the policy changed or if the container
+       cannot store a delta: the scheduller must be copied.
+     */
+    bool make_delta(scheduller& shadow, delta& d) const noexcept;
+
+    /** Assigns the delta @c d to a copy of the shadow of @c make_delta(). */
+    void apply_delta(const delta& d) noexcept;
+};
+
+/// Stores two simulation time values, the begin `]-oo, +oo[` and the end
+/// value
 /// `]begin, +oo]`. This function take care to keep @c begin less than @c
 /// end value.
 class time_limit
@@ -1760,27 +2558,96 @@ using observation_system = id_data_array<observer,
                                          allocator<new_delete_memory_resource>,
                                          resampler>;
 
-/// Stores a copy main data simulation.
-///
-/// This class is used to dump a snapshot of the simulation keeping all
-/// identifiants.
-struct simulation_snapshot {
+/// Minimum number of observers drained by a task of the @c drain_observers
+/// functions: under this size, the task dispatch costs more than the
+/// resampling.
+inline constexpr unsigned observers_per_task = 512u;
 
-    simulation_snapshot() noexcept = default;
+/// Ticks with the date @c now the resamplers of the observers @c ids (see
+/// @c resampler::tick).
+inline void drain_observers(observation_system&          observers,
+                            std::span<const observer_id> ids,
+                            const real                   now) noexcept
+{
+    auto& resamplers = observers.get<resampler>();
 
-    explicit simulation_snapshot(const simulation& sim) noexcept;
+    for (const auto id : ids)
+        if (auto* obs = observers.try_to_get(id))
+            resamplers[get_index(id)].tick(*obs, now);
+}
 
-    /// Reuse the allocated snapshot and copy simulation data
-    simulation_snapshot& operator=(const simulation& sim) noexcept;
+/// Ticks with the date @c now the resamplers of all the observers.
+inline void drain_observers(observation_system& observers,
+                            const real          now) noexcept
+{
+    auto& resamplers = observers.get<resampler>();
 
-    data_array<model, model_id>                              models;
-    observation_system                                       observers;
-    data_array<block_node, block_node_id>                    nodes;
-    data_array<output_port, output_port_id>                  output_ports;
-    data_array<ring_buffer<dated_message>, dated_message_id> dated_messages;
-    scheduller<allocator<new_delete_memory_resource>>        sched;
-    time                                                     t{};
-};
+    for (auto& obs : observers)
+        resamplers[get_index(observers.get_id(obs))].tick(obs, now);
+}
+
+/// Returns the number of observers drained by each task of the @c
+/// drain_observers functions for @c n observers and @c concurrency workers.
+inline unsigned observers_chunk_size(const unsigned n,
+                                     const unsigned concurrency) noexcept
+{
+    const auto workers = std::max(concurrency, 1u);
+
+    return std::max(observers_per_task, (n + workers - 1u) / workers);
+}
+
+/// Same as @c drain_observers(observers, ids, now) but the identifiers are
+/// split into at most `executor.concurrency()` contiguous ranges and each
+/// range is drained by one task of `executor.parallel_for()` (see @c
+/// simulation::run(Executor&)).
+template<typename Executor>
+void drain_observers(observation_system&          observers,
+                     std::span<const observer_id> ids,
+                     const real                   now,
+                     Executor&                    executor) noexcept
+{
+    const auto n          = static_cast<unsigned>(ids.size());
+    const auto chunk_size = observers_chunk_size(n, executor.concurrency());
+    const auto chunks     = (n + chunk_size - 1u) / chunk_size;
+
+    if (chunks <= 1u)
+        return drain_observers(observers, ids, now);
+
+    executor.parallel_for(chunks, [&](const unsigned chunk) noexcept {
+        const auto first = chunk * chunk_size;
+        const auto last  = std::min(first + chunk_size, n);
+
+        drain_observers(observers, ids.subspan(first, last - first), now);
+    });
+}
+
+/// Same as @c drain_observers(observers, now) but the slots of the @c
+/// observation_system are split into contiguous ranges drained by the tasks
+/// of the @c executor.
+template<typename Executor>
+void drain_observers(observation_system& observers,
+                     const real          now,
+                     Executor&           executor) noexcept
+{
+    const auto n = static_cast<unsigned>(observers.get_ids().max_used());
+    const auto chunk_size = observers_chunk_size(n, executor.concurrency());
+    const auto chunks     = (n + chunk_size - 1u) / chunk_size;
+
+    if (chunks <= 1u)
+        return drain_observers(observers, now);
+
+    const auto& slots      = observers.get_ids();
+    auto&       resamplers = observers.get<resampler>();
+
+    executor.parallel_for(chunks, [&](const unsigned chunk) noexcept {
+        const auto first = chunk * chunk_size;
+        const auto last  = std::min(first + chunk_size, n);
+
+        for (auto i = first; i < last; ++i)
+            if (auto* obs = slots.try_to_get_from_pos(i))
+                resamplers[i].tick(*obs, now);
+    });
+}
 
 enum class criteria_type {
     min_last, //!< Min value for the last observation value (one real).
@@ -1931,6 +2798,14 @@ using simulation_selection =
                 criteria_type //!< observation trajectory selection function
                 >;
 
+/// Algorithm used by the @c simulation to copy the messages of the active
+/// output ports into the input ports.
+enum class message_routing_policy : u8 {
+    two_pass,    ///< Count the messages per input port then copy them.
+    single_pass, ///< Copy the messages into regions precomputed at
+                 ///< initialization from the number of connections.
+};
+
 class simulation
 {
 public:
@@ -1940,6 +2815,11 @@ public:
     vector<parameter>      parameters;
     vector<observer_id>    immediate_observers;
 
+    /// The models changed by the @c run() functions since the last clear of
+    /// the vector: the imminent models and the receivers of messages, with
+    /// duplicates. Filled only if @c track_changed_models is true.
+    vector<model_id> changed_models;
+
     data_array<model, model_id>                    models;
     data_array<hierarchical_state_machine, hsm_id> hsms;
     data_array<simulation, simulation_id>          sims;
@@ -1964,7 +2844,53 @@ public:
 
     time_limit limits;
 
+    /// Minimum number of models in a bag to use the parallel transitions in
+    /// the @c run(Executor&) function. Under this threshold, the bag is
+    /// executed sequentially.
+    u32 parallel_bag_threshold = 1024;
+
+    /// If not null, the @c simulation_wrapper models run their embedded
+    /// simulations onto the workers of this executor, else on the caller
+    /// thread. The executor is owned by the caller and is not copied.
+    simulation_bag_executor* embedded_executor = nullptr;
+
+    /// If true, the @c run() functions append the changed models to @c
+    /// changed_models (see @c simulation_snapshot_handler). The @c
+    /// initialize() function and the assignment of a snapshot reset it to
+    /// false, like a @c changed_models vector larger than twice the models.
+    bool track_changed_models = false;
+
+    /// Select the algorithm of the messages routing at the end of the @c
+    /// run() functions. With @c message_routing_policy::single_pass, each
+    /// input port owns a region of the @c message_buffer sized with the
+    /// number of connections to this port and messages are copied in one pass
+    /// over the @c active_output_ports. If an output port sends more than one
+    /// message during a step, the routing of this step uses the two pass
+    /// algorithm.
+    message_routing_policy routing = message_routing_policy::two_pass;
+
 private:
+    /// A compressed sparse row copy of the connections of the output ports
+    /// used by the @c route_messages() function. Destinations of the output
+    /// port @c id are the @c connection_targets in the range
+    /// `[connection_offsets[get_index(id)], connection_offsets[get_index(id)
+    /// + 1][`. The graph is rebuilt by the @c initialize() function and
+    /// after a @c connect(), @c disconnect() or @c deallocate().
+    vector<u32>  connection_offsets;
+    vector<node> connection_targets;
+    bool         connection_graph_outdated = true;
+
+    /// Region of the @c message_buffer of the destination input port of each
+    /// @c connection_targets. @c capacity is the number of connections to the
+    /// input port. Used by the @c message_routing_policy::single_pass.
+    struct input_region {
+        u32 position;
+        u32 capacity;
+    };
+
+    vector<input_region> connection_regions;
+    u32                  connection_regions_size = 0;
+
     std::atomic<real> t = time_domain<time>::infinity;
 
     /**
@@ -2085,6 +3011,16 @@ public:
 
     void unobserve(model& mdl) noexcept;
 
+    /// Writes the oldest samples of the history of each observer into a
+    /// memory-mapped file of the directory @c dir (one file per observer).
+    /// Each file maps @c initial_samples samples and grows with the history.
+    /// The @c spills vector is resized to the observers and must outlive
+    /// them. Use it for long simulations or for a lot of observers.
+    status spill_observers(
+      const std::filesystem::path& dir,
+      vector<history_spill>&       spills,
+      const u64 initial_samples = history_spill::page_size * 16u) noexcept;
+
     void deallocate(model_id id) noexcept;
 
     template<typename Dynamics>
@@ -2200,30 +3136,31 @@ public:
     /// For each observer fills the history
     void tick_resamplers() noexcept
     {
-        const auto now        = t.load(std::memory_order_acquire);
-        auto&      resamplers = observers.get<resampler>();
-
-        for (auto& obs : observers) {
-            const auto obs_id  = observers.get_id(obs);
-            const auto obs_idx = get_index(obs_id);
-
-            resamplers[obs_idx].tick(obs, now);
-        }
+        drain_observers(observers, t.load(std::memory_order_acquire));
     }
 
     /// For each observer in the vector transfert data
     void tick_resamplers(std::span<const observer_id> v) noexcept
     {
-        const auto now        = t.load(std::memory_order_acquire);
-        auto&      resamplers = observers.get<resampler>();
+        drain_observers(observers, v, t.load(std::memory_order_acquire));
+    }
 
-        for (const auto obs_id : v) {
-            if (auto* obs = observers.try_to_get(obs_id)) {
-                const auto obs_idx = get_index(obs_id);
+    /// Same as @c tick_resamplers() with coarse parallel tasks of the @c
+    /// executor (see @c drain_observers).
+    template<typename Executor>
+        requires requires(Executor& e) { e.concurrency(); }
+    void tick_resamplers(Executor& executor) noexcept
+    {
+        drain_observers(
+          observers, t.load(std::memory_order_acquire), executor);
+    }
 
-                resamplers[obs_idx].tick(*obs, now);
-            }
-        }
+    template<typename Executor>
+    void tick_resamplers(std::span<const observer_id> v,
+                         Executor&                    executor) noexcept
+    {
+        drain_observers(
+          observers, v, t.load(std::memory_order_acquire), executor);
     }
 
     /** Call the initialize member function for each model of the
@@ -2233,9 +3170,39 @@ public:
 
     status run() noexcept;
 
+    /// Same as @c run() but, if the bag of imminent models is greater than
+    /// @c parallel_bag_threshold, the transition functions of the models are
+    /// split into chunks and executed concurrently by the @c executor. The
+    /// observation, lambda and scheduler operations stay sequential in the
+    /// bag order so results are bit-identical to the @c run() function.
+    ///
+    /// @param executor Must provide a `unsigned concurrency() const` and a
+    /// `void parallel_for(unsigned n, Fn&& fn)` functions. `parallel_for`
+    /// must call `fn(i)` for each `i` in `[0, n[` and return when all calls
+    /// are finished (see @c irt::simulation_bag_executor).
+    template<typename Executor>
+    status run(Executor& executor) noexcept;
+
+    /// Same as @c run() for a simulation where all the models are of the
+    /// @c Dynamics types (see @c fixed_simulation): the transitions and the
+    /// message routing dispatch the models with a switch over these types
+    /// only instead of the @c dynamics_functions table.
+    template<typename... Dynamics>
+    status run(dynamics_set<Dynamics...> set) noexcept;
+
     template<typename Fn, typename... Args>
     status run_with_cb(Fn&& fn, Args&&... args) noexcept;
 
+    /// Append the message @c msg to the input port @c port of the model @c
+    /// mdl and wake up the model at @c date. Used to deliver messages from
+    /// outside of the simulation (see @c optimistic_simulation). Must be
+    /// called between two @c run() with @c date in the range
+    /// `[current_time(), sched.tn()]`.
+    status push_message(model&         mdl,
+                        int            port,
+                        const message& msg,
+                        time           date) noexcept;
+
     template<typename Dynamics>
     status make_initialize(model& mdl, Dynamics& dyn, time t) noexcept;
 
@@ -2246,11 +3213,65 @@ public:
 
     status make_transition(model& mdl, time t) noexcept;
 
+    /// First part of the @c make_transition function: observes the model
+    /// and calls the lambda function if the model is imminent.
+    template<typename Dynamics>
+    status make_output(model& mdl, Dynamics& dyn, time t) noexcept;
+
+    /// Second part of the @c make_transition function: calls the transition
+    /// function, cleans the input ports and computes the new @c model::tl
+    /// and @c model::tn. The scheduler is not updated.
+    template<typename Dynamics>
+    status make_state_transition(model& mdl, Dynamics& dyn, time t) noexcept;
+
     template<typename Dynamics>
     status make_finalize(Dynamics& dyn, observer* obs, time t) noexcept;
 
+    /// Pushes the sample @c s into the raw buffer of the observer @c obs. If
+    /// the raw buffer is full and the observer is lossless, the resampler
+    /// of the observer drains the raw buffer before pushing the sample
+    /// again, otherwise the sample is lost.
+    void push_observation(observer&         obs,
+                          const observer_id id,
+                          const raw_sample& s,
+                          time              t) noexcept;
+
     bool current_time_expired() const noexcept { return limits.expired(t); }
 
+private:
+    template<typename Executor>
+    status make_parallel_transitions(Executor& executor) noexcept;
+
+    /// Last part of the @c make_state_transition function: cleans the input
+    /// ports and computes the new @c model::tl and @c model::tn.
+    template<typename Dynamics>
+    void end_state_transition(model& mdl, Dynamics& dyn, time t) noexcept;
+
+    /// Appends the model @c mdl to the @c changed_models if @c
+    /// track_changed_models is true.
+    void mark_changed(const model& mdl) noexcept;
+
+    /// Wakes up at @c date the model @c mdl receiving a message.
+    void wake_up(model& mdl, time date) noexcept;
+
+    /// Copy the @c output_port::msg of the @c active_output_ports into the
+    /// @c message_buffer and wake up the receivers. The input ports of the
+    /// receivers are read with the @c Set dispatch policy.
+    template<typename Set = dynamics_table>
+    status route_messages() noexcept;
+
+    /// Copy the messages into the @c connection_regions. Returns false if an
+    /// input port region overflows, in this case the two pass routing must
+    /// be used.
+    template<typename Set = dynamics_table>
+    bool route_messages_single_pass() noexcept;
+
+    /// Fill the @c connection_offsets and @c connection_targets vectors from
+    /// the @c output_ports and @c nodes. Destinations with an undefined
+    /// model are removed from the output ports.
+    status build_connection_graph() noexcept;
+
+public:
     /** Finalize and cleanup simulation objects.
      *
      * Clean:
@@ -8726,6 +9747,45 @@ struct model {
 static_assert(std::is_standard_layout_v<model>,
               "model must be standard-layout");
 
+/// Stores a copy main data simulation.
+///
+/// This class is used to dump a snapshot of the simulation keeping all
+/// identifiants. A snapshot built by the @c simulation_snapshot_handler may be
+/// a delta: the @c models, @c nodes, @c output_ports, @c dated_messages and
+/// @c sched are empty and the elements changed since the previous snapshot
+/// are stored into the @c *_delta members. Use @c
+/// simulation_snapshot_handler::restore() to assign a delta snapshot to a
+/// simulation.
+struct simulation_snapshot {
+
+    simulation_snapshot() noexcept = default;
+
+    explicit simulation_snapshot(const simulation& sim) noexcept;
+
+    /// Reuse the allocated snapshot and copy simulation data
+    simulation_snapshot& operator=(const simulation& sim) noexcept;
+
+    data_array<model, model_id>                              models;
+    observation_system                                       observers;
+    data_array<block_node, block_node_id>                    nodes;
+    data_array<output_port, output_port_id>                  output_ports;
+    data_array<ring_buffer<dated_message>, dated_message_id> dated_messages;
+    scheduller<allocator<new_delete_memory_resource>>        sched;
+    time                                                     t{};
+
+    simulation_snapshot_delta<model>                      models_delta;
+    simulation_snapshot_delta<block_node>                 nodes_delta;
+    simulation_snapshot_delta<output_port>                output_ports_delta;
+    simulation_snapshot_delta<ring_buffer<dated_message>> dated_messages_delta;
+
+    scheduller<allocator<new_delete_memory_resource>>::delta sched_delta;
+
+    /// @c false if the @c models, @c nodes, @c output_ports, @c
+    /// dated_messages and @c sched are stored as deltas from the previous
+    /// snapshot.
+    bool keyframe = true;
+};
+
 template<dynamics Dynamics>
 static constexpr dynamics_type dynamics_typeof() noexcept
 {
@@ -10309,6 +11369,359 @@ constexpr const model& get_model(const Dynamics& d) noexcept
       reinterpret_cast<const char*>(&d) - offsetof(model, dyn)));
 }
 
+/// The dynamics types in the order of the @c dynamics_type enumeration.
+using dynamics_types = std::tuple<qss1_integrator,
+                                  qss1_multiplier,
+                                  qss1_cross,
+                                  qss1_max_hold,
+                                  qss1_min_hold,
+                                  qss1_flipflop,
+                                  qss1_filter,
+                                  qss1_power,
+                                  qss1_square,
+                                  qss1_sum_2,
+                                  qss1_sum_3,
+                                  qss1_sum_4,
+                                  qss1_wsum_2,
+                                  qss1_wsum_3,
+                                  qss1_wsum_4,
+                                  qss1_inverse,
+                                  qss1_integer,
+                                  qss1_compare,
+                                  qss1_gain,
+                                  qss1_sin,
+                                  qss1_cos,
+                                  qss1_log,
+                                  qss1_exp,
+                                  qss1_sample_hold,
+                                  qss1_quantizer,
+                                  qss1_integrate_and_fire,
+                                  qss1_threshold_crossing,
+                                  qss1_pwm,
+                                  qss1_abs,
+                                  qss1_atan,
+                                  qss1_atan2,
+                                  qss1_dead_zone,
+                                  qss1_division,
+                                  qss1_hysteresis,
+                                  qss1_maximum,
+                                  qss1_minimum,
+                                  qss1_saturation,
+                                  qss1_sigmoid,
+                                  qss1_sign,
+                                  qss1_sqrt,
+                                  qss1_tan,
+                                  qss1_tanh,
+                                  qss1_wrap,
+                                  qss2_integrator,
+                                  qss2_multiplier,
+                                  qss2_cross,
+                                  qss2_max_hold,
+                                  qss2_min_hold,
+                                  qss2_flipflop,
+                                  qss2_filter,
+                                  qss2_power,
+                                  qss2_square,
+                                  qss2_sum_2,
+                                  qss2_sum_3,
+                                  qss2_sum_4,
+                                  qss2_wsum_2,
+                                  qss2_wsum_3,
+                                  qss2_wsum_4,
+                                  qss2_inverse,
+                                  qss2_integer,
+                                  qss2_compare,
+                                  qss2_gain,
+                                  qss2_sin,
+                                  qss2_cos,
+                                  qss2_log,
+                                  qss2_exp,
+                                  qss2_sample_hold,
+                                  qss2_quantizer,
+                                  qss2_integrate_and_fire,
+                                  qss2_threshold_crossing,
+                                  qss2_pwm,
+                                  qss2_abs,
+                                  qss2_atan,
+                                  qss2_atan2,
+                                  qss2_dead_zone,
+                                  qss2_division,
+                                  qss2_hysteresis,
+                                  qss2_maximum,
+                                  qss2_minimum,
+                                  qss2_saturation,
+                                  qss2_sigmoid,
+                                  qss2_sign,
+                                  qss2_sqrt,
+                                  qss2_tan,
+                                  qss2_tanh,
+                                  qss2_wrap,
+                                  qss3_integrator,
+                                  qss3_multiplier,
+                                  qss3_cross,
+                                  qss3_max_hold,
+                                  qss3_min_hold,
+                                  qss3_flipflop,
+                                  qss3_filter,
+                                  qss3_power,
+                                  qss3_square,
+                                  qss3_sum_2,
+                                  qss3_sum_3,
+                                  qss3_sum_4,
+                                  qss3_wsum_2,
+                                  qss3_wsum_3,
+                                  qss3_wsum_4,
+                                  qss3_inverse,
+                                  qss3_integer,
+                                  qss3_compare,
+                                  qss3_gain,
+                                  qss3_sin,
+                                  qss3_cos,
+                                  qss3_log,
+                                  qss3_exp,
+                                  qss3_sample_hold,
+                                  qss3_quantizer,
+                                  qss3_integrate_and_fire,
+                                  qss3_threshold_crossing,
+                                  qss3_pwm,
+                                  qss3_abs,
+                                  qss3_atan,
+                                  qss3_atan2,
+                                  qss3_dead_zone,
+                                  qss3_division,
+                                  qss3_hysteresis,
+                                  qss3_maximum,
+                                  qss3_minimum,
+                                  qss3_saturation,
+                                  qss3_sigmoid,
+                                  qss3_sign,
+                                  qss3_sqrt,
+                                  qss3_tan,
+                                  qss3_tanh,
+                                  qss3_wrap,
+                                  counter,
+                                  queue,
+                                  dynamic_queue,
+                                  priority_queue,
+                                  generator,
+                                  constant,
+                                  time_func,
+                                  accumulator_2,
+                                  logical_and_2,
+                                  logical_and_3,
+                                  logical_or_2,
+                                  logical_or_3,
+                                  logical_invert,
+                                  hsm_wrapper,
+                                  simulation_wrapper,
+                                  zero_order_hold>;
+
+static_assert(std::tuple_size_v<dynamics_types> == dynamics_type_size());
+static_assert([]<std::size_t... Is>(std::index_sequence<Is...>) {
+    return ((dynamics_typeof<std::tuple_element_t<Is, dynamics_types>>() ==
+             static_cast<dynamics_type>(Is)) and
+            ...);
+}(std::make_index_sequence<dynamics_type_size()>()));
+
+/// Type-erased entry points of a dynamics. The @c dynamics_functions table
+/// stores one entry per @c dynamics_type and is built at compile time: the
+/// inner loop of the simulation calls the function pointers instead of
+/// instantiating the @c dispatch switch for each lambda.
+struct dynamics_function_table {
+    /// Calls @c simulation::make_output(): observation and lambda.
+    status (*output)(simulation& sim, model& mdl, time t) noexcept;
+
+    /// Calls @c simulation::make_state_transition().
+    status (*transition)(simulation& sim, model& mdl, time t) noexcept;
+
+    /// Returns the observation of the model or @c nullptr if the dynamics
+    /// is not observable.
+    raw_sample (*observation)(const model& mdl, time t, time e) noexcept;
+
+    /// Returns the input ports of the model, an empty span if the dynamics
+    /// does not have input port.
+    std::span<input_port> (*input_ports)(model& mdl) noexcept;
+};
+
+template<typename Dynamics>
+status dynamics_output(simulation& sim, model& mdl, time t) noexcept
+{
+    return sim.make_output(mdl, get_dyn<Dynamics>(mdl), t);
+}
+
+template<typename Dynamics>
+status dynamics_transition(simulation& sim, model& mdl, time t) noexcept
+{
+    return sim.make_state_transition(mdl, get_dyn<Dynamics>(mdl), t);
+}
+
+template<typename Dynamics>
+raw_sample dynamics_observation(const model& mdl, time t, time e) noexcept
+{
+    return get_dyn<Dynamics>(mdl).observation(t, e);
+}
+
+template<typename Dynamics>
+std::span<input_port> dynamics_input_ports(model& mdl) noexcept
+{
+    if constexpr (has_input_port<Dynamics>)
+        return std::span<input_port>(get_dyn<Dynamics>(mdl).x);
+    else
+        return std::span<input_port>();
+}
+
+template<typename Dynamics>
+constexpr dynamics_function_table make_dynamics_function_table() noexcept
+{
+    dynamics_function_table ret{};
+
+    ret.output      = &dynamics_output<Dynamics>;
+    ret.transition  = &dynamics_transition<Dynamics>;
+    ret.input_ports = &dynamics_input_ports<Dynamics>;
+
+    if constexpr (has_observation_function<Dynamics>)
+        ret.observation = &dynamics_observation<Dynamics>;
+
+    return ret;
+}
+
+template<std::size_t... Is>
+constexpr auto make_dynamics_functions(std::index_sequence<Is...>) noexcept
+{
+    return std::array<dynamics_function_table, sizeof...(Is)>{
+        make_dynamics_function_table<
+          std::tuple_element_t<Is, dynamics_types>>()...
+    };
+}
+
+/// The entry points of each dynamics indexed by @c dynamics_type.
+inline constexpr auto dynamics_functions =
+  make_dynamics_functions(std::make_index_sequence<dynamics_type_size()>());
+
+/// Returns the entry points of the dynamics of the model @c mdl.
+inline const dynamics_function_table& get_dynamics_functions(
+  const model& mdl) noexcept
+{
+    return dynamics_functions[ordinal(mdl.type)];
+}
+
+/// The @c dynamics_functions table as a dispatch policy for all the dynamics
+/// types.
+struct dynamics_table {
+    static std::span<input_port> input_ports(model& mdl) noexcept
+    {
+        return get_dynamics_functions(mdl).input_ports(mdl);
+    }
+};
+
+/// A compile-time set of dynamics types. The dispatch of a model is a chain
+/// of comparisons over the types of the set only, the compiler turns it into
+/// a small switch and inlines the transition functions. Used as dispatch
+/// policy by the @c fixed_simulation.
+template<typename... Dynamics>
+struct dynamics_set {
+    static_assert(sizeof...(Dynamics) > 0);
+
+    static constexpr bool contains(const dynamics_type type) noexcept
+    {
+        return ((dynamics_typeof<Dynamics>() == type) or ...);
+    }
+
+    template<typename T>
+    static constexpr bool contains() noexcept
+    {
+        return (std::is_same_v<T, Dynamics> or ...);
+    }
+
+    /// Calls @c f with the dynamics of the model @c mdl and returns its
+    /// result. If the type of the model is not in the set, returns @c
+    /// simulation_errc::dynamics_unknown when @c f returns a @c status and a
+    /// default constructed value otherwise.
+    template<typename Function>
+    static auto dispatch(model& mdl, Function&& f) noexcept
+    {
+        using first_type  = std::tuple_element_t<0, std::tuple<Dynamics...>>;
+        using return_type = std::invoke_result_t<Function&, first_type&>;
+
+        return_type ret{};
+
+        const bool found =
+          ((mdl.type == dynamics_typeof<Dynamics>()
+              ? (ret = f(get_dyn<Dynamics>(mdl)), true)
+              : false) or
+           ...);
+
+        if constexpr (std::is_same_v<return_type, status>) {
+            if (not found)
+                return status(make_error(simulation_errc::dynamics_unknown));
+        } else {
+            debug::ensure(found);
+        }
+
+        return ret;
+    }
+
+    static std::span<input_port> input_ports(model& mdl) noexcept
+    {
+        return dispatch(mdl, [&]<typename T>(T&) {
+            return dynamics_input_ports<T>(mdl);
+        });
+    }
+};
+
+/// A simulation specialized at compile time for the @c Dynamics types: the
+/// models can only be allocated with these types and the @c run() function
+/// dispatches the models with the @c dynamics_set switch. The models, ports
+/// and observers are stored like in the @c simulation.
+///
+/// The @c alloc(), @c initialize() and @c run() functions of the @c
+/// simulation are not virtual: a call through a @c simulation reference uses
+/// the functions of the @c simulation and skips the checks of the types. The
+/// @c run(executor) function is the one of the @c simulation and dispatches
+/// the models with the @c dynamics_functions table.
+template<typename... Dynamics>
+class fixed_simulation : public simulation
+{
+public:
+    using dynamics = dynamics_set<Dynamics...>;
+
+    using simulation::simulation;
+    using simulation::run;
+
+    template<typename T>
+    T& alloc() noexcept
+    {
+        static_assert(dynamics::template contains<T>(),
+                      "dynamics not in the fixed_simulation types");
+
+        return simulation::alloc<T>();
+    }
+
+    /// The @c type must be one of the @c Dynamics types. In release mode, a
+    /// model of another type is reported by the @c initialize() function.
+    model& alloc(const dynamics_type type) noexcept
+    {
+        debug::ensure(dynamics::contains(type));
+
+        return simulation::alloc(type);
+    }
+
+    /// Returns @c simulation_errc::dynamics_unknown if a model (for example
+    /// a clone) is not of the @c Dynamics types, otherwise calls the @c
+    /// simulation::initialize() function.
+    status initialize() noexcept
+    {
+        for (const auto& mdl : models)
+            if (not dynamics::contains(mdl.type))
+                return make_error(simulation_errc::dynamics_unknown);
+
+        return simulation::initialize();
+    }
+
+    /// Runs a bag of the simulation.
+    status run() noexcept { return simulation::run(dynamics{}); }
+};
+
 // inline expected<message_id> get_input_port(model& src, int port_src)
 // noexcept;
 //
@@ -11185,6 +12598,46 @@ constexpr typename heap<A>::node& heap<A>::operator[](handle h) noexcept
     return nodes[h];
 }
 
+template<typename A>
+bool heap<A>::make_delta(heap& shadow, delta& d) const noexcept
+{
+    if (shadow.capacity != capacity or shadow.max_size != max_size)
+        return false;
+
+    d.nodes.clear();
+
+    for (u32 i = 0; i < max_size; ++i) {
+        const auto& a = nodes[i];
+        const auto& b = shadow.nodes[i];
+
+        if (a.tn != b.tn or a.id != b.id or a.prev != b.prev or
+            a.next != b.next or a.child != b.child) {
+            d.nodes.positions.emplace_back(i);
+            d.nodes.items.emplace_back(a);
+        }
+    }
+
+    d.size      = m_size;
+    d.free_list = free_list;
+    d.root      = root;
+    shadow.apply_delta(d);
+
+    return true;
+}
+
+template<typename A>
+void heap<A>::apply_delta(const delta& d) noexcept
+{
+    for (int i = 0, e = d.nodes.positions.ssize(); i < e; ++i) {
+        debug::ensure(d.nodes.positions[i] < max_size);
+        nodes[d.nodes.positions[i]] = d.nodes.items[i];
+    }
+
+    m_size    = d.size;
+    free_list = d.free_list;
+    root      = d.root;
+}
+
 template<typename A>
 constexpr typename heap<A>::handle heap<A>::merge(handle a, handle b) noexcept
 {
@@ -11270,63 +12723,672 @@ constexpr void heap<A>::detach_subheap(handle elem) noexcept
 
 //
 // template<typename A>
-// scheduller<A>
+// calendar_queue<A>
 //
 
 template<typename A>
-inline scheduller<A>::scheduller(
-  constrained_value<int, 512, INT_MAX> capacity) noexcept
-  : m_heap(capacity)
-{}
+inline calendar_queue<A>::calendar_queue(
+  constrained_value<int, 512, INT_MAX> pcapacity) noexcept
+{
+    reserve(pcapacity.value());
+}
 
 template<typename A>
-inline bool scheduller<A>::reserve(std::integral auto new_capacity) noexcept
+inline void calendar_queue<A>::destroy() noexcept
 {
-    return m_heap.reserve(new_capacity);
+    nodes.destroy();
+    buckets.destroy();
+    scratch.destroy();
+
+    infinity_list = bucket_list{};
+    free_list     = invalid_heap_handle;
+    m_size        = 0;
+    m_finite_size = 0;
+    m_top         = invalid_heap_handle;
+    m_day         = 0;
+    m_visited     = 0;
+    m_popped      = 0;
+    m_width       = one;
 }
 
 template<typename A>
-inline void scheduller<A>::clear() noexcept
+inline void calendar_queue<A>::clear() noexcept
 {
-    m_heap.clear();
+    nodes.clear();
+    std::fill_n(buckets.data(), buckets.size(), bucket_list{});
+
+    infinity_list = bucket_list{};
+    free_list     = invalid_heap_handle;
+    m_size        = 0;
+    m_finite_size = 0;
+    m_top         = invalid_heap_handle;
+    m_day         = 0;
+    m_visited     = 0;
+    m_popped      = 0;
 }
 
 template<typename A>
-inline void scheduller<A>::destroy() noexcept
+inline bool calendar_queue<A>::reserve(
+  std::integral auto new_capacity) noexcept
 {
-    m_heap.destroy();
+    debug::ensure(
+      std::cmp_less(new_capacity, std::numeric_limits<index_type>::max()));
+
+    return nodes.reserve(new_capacity);
 }
 
 template<typename A>
-inline void scheduller<A>::alloc(model& mdl, model_id id, time tn) noexcept
+inline typename calendar_queue<A>::handle calendar_queue<A>::alloc(
+  time     tn,
+  model_id id) noexcept
 {
-    debug::ensure(mdl.handle == invalid_heap_handle);
+    u32 new_node;
+
+    if (free_list != invalid_heap_handle) {
+        new_node  = free_list;
+        free_list = nodes[free_list].next;
+    } else {
+        new_node = static_cast<u32>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    nodes[new_node] = node{ .tn = tn, .id = id, .day = 0 };
 
-    mdl.handle = m_heap.alloc(tn, id);
+    insert(new_node);
+
+    return new_node;
 }
 
 template<typename A>
-inline void scheduller<A>::reintegrate(model& mdl, time tn) noexcept
+inline void calendar_queue<A>::destroy(handle elem) noexcept
 {
-    debug::ensure(mdl.handle != invalid_heap_handle);
+    debug::ensure(elem != invalid_heap_handle);
+
+    if (is_in_tree(elem))
+        unlink(elem);
+
+    nodes[elem].id   = static_cast<model_id>(0);
+    nodes[elem].next = free_list;
 
-    m_heap.reintegrate(tn, mdl.handle);
+    free_list = elem;
 }
 
 template<typename A>
-inline void scheduller<A>::remove(model& mdl) noexcept
+inline void calendar_queue<A>::insert(handle elem) noexcept
 {
-    if (mdl.handle != invalid_heap_handle)
-        m_heap.remove(mdl.handle);
+    debug::ensure(not is_in_tree(elem));
+
+    if (buckets.empty())
+        buckets.resize(min_buckets);
+
+    link(elem);
+
+    if (m_finite_size > 2u * buckets.size())
+        resize(static_cast<u32>(buckets.size() * 2u));
 }
 
 template<typename A>
-inline void scheduller<A>::free(model& mdl) noexcept
+inline void calendar_queue<A>::reintegrate(time tn, handle elem) noexcept
 {
-    if (mdl.handle != invalid_heap_handle) {
-        m_heap.remove(mdl.handle);
-        m_heap.destroy(mdl.handle);
-        mdl.handle = invalid_heap_handle;
+    debug::ensure(elem != invalid_heap_handle);
+
+    nodes[elem].tn = tn;
+
+    insert(elem);
+}
+
+template<typename A>
+inline void calendar_queue<A>::remove(handle elem) noexcept
+{
+    debug::ensure(elem != invalid_heap_handle);
+
+    if (is_in_tree(elem))
+        unlink(elem);
+}
+
+template<typename A>
+inline void calendar_queue<A>::decrease(time tn, handle elem) noexcept
+{
+    if (is_in_tree(elem)) {
+        unlink(elem);
+        nodes[elem].tn = tn;
+        link(elem);
+    } else {
+        nodes[elem].tn = tn;
+    }
+}
+
+template<typename A>
+inline void calendar_queue<A>::increase(time tn, handle elem) noexcept
+{
+    decrease(tn, elem);
+}
+
+template<typename A>
+inline void calendar_queue<A>::pop(vector<model_id>& out) noexcept
+{
+    const auto first = top();
+    debug::ensure(first != invalid_heap_handle);
+
+    out.clear();
+
+    // The group of nodes with the lowest @c tn is at the head of the bucket.
+    for (auto h = nodes[first].child; h != invalid_heap_handle;) {
+        const auto next = nodes[h].next;
+        out.emplace_back(nodes[h].id);
+
+        nodes[h].prev   = invalid_heap_handle;
+        nodes[h].next   = invalid_heap_handle;
+        nodes[h].child  = invalid_heap_handle;
+        nodes[h].bucket = invalid_heap_handle;
+
+        if (not time_domain<time>::is_infinity(nodes[first].tn))
+            --m_finite_size;
+        --m_size;
+
+        h = next;
+    }
+
+    nodes[first].child = invalid_heap_handle;
+    out.emplace_back(nodes[first].id);
+    unlink(first);
+
+    // Recompute the width if the buckets are too crowded or too sparse:
+    // more than 8 nodes or buckets visited per popped node.
+    m_popped += out.size();
+    if (m_popped >= std::max<u64>(m_size, 1024u)) {
+        if (m_visited > 8u * m_popped)
+            resize(static_cast<u32>(buckets.size()));
+
+        m_visited = 0;
+        m_popped  = 0;
+    }
+}
+
+template<typename A>
+inline time calendar_queue<A>::tn(handle elem) const noexcept
+{
+    return nodes[elem].tn;
+}
+
+template<typename A>
+inline unsigned calendar_queue<A>::size() const noexcept
+{
+    return static_cast<unsigned>(m_size);
+}
+
+template<typename A>
+inline int calendar_queue<A>::ssize() const noexcept
+{
+    return static_cast<int>(m_size);
+}
+
+template<typename A>
+inline bool calendar_queue<A>::empty() const noexcept
+{
+    return m_size == 0;
+}
+
+template<typename A>
+inline bool calendar_queue<A>::is_in_tree(handle h) const noexcept
+{
+    return h != invalid_heap_handle and std::cmp_less(h, nodes.size()) and
+           nodes[h].bucket != invalid_heap_handle;
+}
+
+template<typename A>
+inline typename calendar_queue<A>::handle calendar_queue<A>::top()
+  const noexcept
+{
+    if (m_top != invalid_heap_handle or m_size == 0)
+        return m_top;
+
+    if (m_finite_size == 0)
+        return m_top = infinity_list.head;
+
+    // Search the first bucket where the head belongs to the current day in
+    // the next year. The @c m_day is always lower or equal to the lowest day
+    // in the calendar.
+    const auto nb = static_cast<u32>(buckets.size());
+    for (u32 i = 0; i < nb; ++i) {
+        const auto d = m_day + i;
+        const auto h = buckets[bucket(d)].head;
+        ++m_visited;
+
+        if (h != invalid_heap_handle and nodes[h].day == d) {
+            m_day = d;
+            return m_top = h;
+        }
+    }
+
+    // No node in the next year, fallback to a direct search.
+    auto best = invalid_heap_handle;
+    for (u32 b = 0; b < nb; ++b) {
+        const auto h = buckets[b].head;
+        if (h != invalid_heap_handle and
+            (best == invalid_heap_handle or nodes[h].tn < nodes[best].tn))
+            best = h;
+    }
+
+    m_visited += nb;
+    m_day = nodes[best].day;
+    return m_top = best;
+}
+
+template<typename A>
+inline const typename calendar_queue<A>::node& calendar_queue<A>::operator[](
+  handle h) const noexcept
+{
+    return nodes[h];
+}
+
+template<typename A>
+inline typename calendar_queue<A>::node& calendar_queue<A>::operator[](
+  handle h) noexcept
+{
+    return nodes[h];
+}
+
+template<typename A>
+inline bool calendar_queue<A>::make_delta(calendar_queue& shadow,
+                                          delta&          d) const noexcept
+{
+    if (shadow.nodes.size() != nodes.size() or
+        shadow.buckets.size() != buckets.size())
+        return false;
+
+    d.nodes.clear();
+    d.buckets.clear();
+
+    for (u32 i = 0, e = nodes.size(); i < e; ++i) {
+        const auto& a = nodes[i];
+        const auto& b = shadow.nodes[i];
+
+        if (a.tn != b.tn or a.id != b.id or a.day != b.day or
+            a.prev != b.prev or a.next != b.next or a.child != b.child or
+            a.bucket != b.bucket) {
+            d.nodes.positions.emplace_back(i);
+            d.nodes.items.emplace_back(a);
+        }
+    }
+
+    for (u32 i = 0, e = buckets.size(); i < e; ++i) {
+        const auto& a = buckets[i];
+        const auto& b = shadow.buckets[i];
+
+        if (a.head != b.head or a.tail != b.tail) {
+            d.buckets.positions.emplace_back(i);
+            d.buckets.items.emplace_back(a);
+        }
+    }
+
+    d.infinity_list = infinity_list;
+    d.free_list     = free_list;
+    d.size          = m_size;
+    d.finite_size   = m_finite_size;
+    d.top           = m_top;
+    d.day           = m_day;
+    d.visited       = m_visited;
+    d.popped        = m_popped;
+    d.width         = m_width;
+    shadow.apply_delta(d);
+
+    return true;
+}
+
+template<typename A>
+inline void calendar_queue<A>::apply_delta(const delta& d) noexcept
+{
+    for (int i = 0, e = d.nodes.positions.ssize(); i < e; ++i)
+        nodes[d.nodes.positions[i]] = d.nodes.items[i];
+
+    for (int i = 0, e = d.buckets.positions.ssize(); i < e; ++i)
+        buckets[d.buckets.positions[i]] = d.buckets.items[i];
+
+    infinity_list = d.infinity_list;
+    free_list     = d.free_list;
+    m_size        = d.size;
+    m_finite_size = d.finite_size;
+    m_top         = d.top;
+    m_day         = d.day;
+    m_visited     = d.visited;
+    m_popped      = d.popped;
+    m_width       = d.width;
+}
+
+template<typename A>
+inline i64 calendar_queue<A>::day(time tn) const noexcept
+{
+    // Clamp the day to keep `m_day + buckets.size()` in the i64 domain.
+    constexpr time limit = 0x1p62;
+
+    const auto d = std::floor(tn / m_width);
+
+    return d < -limit  ? static_cast<i64>(-limit)
+           : d > limit ? static_cast<i64>(limit)
+                       : static_cast<i64>(d);
+}
+
+template<typename A>
+inline u32 calendar_queue<A>::bucket(i64 day) const noexcept
+{
+    return static_cast<u32>(static_cast<u64>(day) &
+                            static_cast<u64>(buckets.size() - 1u));
+}
+
+template<typename A>
+inline typename calendar_queue<A>::bucket_list& calendar_queue<A>::list(
+  const node& n) noexcept
+{
+    return n.bucket == infinity_bucket ? infinity_list : buckets[n.bucket];
+}
+
+template<typename A>
+inline void calendar_queue<A>::push_back(bucket_list& l, handle elem) noexcept
+{
+    nodes[elem].prev = l.tail;
+    nodes[elem].next = invalid_heap_handle;
+
+    if (l.tail != invalid_heap_handle)
+        nodes[l.tail].next = elem;
+    else
+        l.head = elem;
+
+    l.tail = elem;
+}
+
+template<typename A>
+inline void calendar_queue<A>::push_follower(handle leader,
+                                             handle elem) noexcept
+{
+    auto& n = nodes[elem];
+
+    n.child  = follower;
+    n.bucket = nodes[leader].bucket;
+    n.prev   = leader;
+    n.next   = nodes[leader].child;
+
+    if (n.next != invalid_heap_handle)
+        nodes[n.next].prev = elem;
+
+    nodes[leader].child = elem;
+}
+
+template<typename A>
+inline void calendar_queue<A>::link(handle elem) noexcept
+{
+    auto& n = nodes[elem];
+    n.child = invalid_heap_handle;
+
+    if (time_domain<time>::is_infinity(n.tn)) {
+        n.bucket = infinity_bucket;
+
+        if (infinity_list.head == invalid_heap_handle)
+            push_back(infinity_list, elem);
+        else
+            push_follower(infinity_list.head, elem);
+    } else {
+        n.day    = day(n.tn);
+        n.bucket = bucket(n.day);
+
+        auto& l = buckets[n.bucket];
+
+        // New nodes are generally in the future of the bucket: search the
+        // position from the tail.
+        if (l.tail == invalid_heap_handle or nodes[l.tail].tn < n.tn) {
+            push_back(l, elem);
+        } else if (nodes[l.tail].tn == n.tn) {
+            push_follower(l.tail, elem);
+        } else if (n.tn < nodes[l.head].tn) {
+            n.prev             = invalid_heap_handle;
+            n.next             = l.head;
+            nodes[l.head].prev = elem;
+            l.head             = elem;
+        } else {
+            auto h = nodes[l.tail].prev;
+            while (nodes[h].tn > n.tn) {
+                h = nodes[h].prev;
+                ++m_visited;
+            }
+
+            if (nodes[h].tn == n.tn) {
+                push_follower(h, elem);
+            } else {
+                n.prev             = h;
+                n.next             = nodes[h].next;
+                nodes[n.next].prev = elem;
+                nodes[h].next      = elem;
+            }
+        }
+
+        if (m_finite_size == 0 or n.day < m_day)
+            m_day = n.day;
+
+        ++m_finite_size;
+    }
+
+    ++m_size;
+
+    if (m_top != invalid_heap_handle and n.tn < nodes[m_top].tn)
+        m_top = elem;
+}
+
+template<typename A>
+inline void calendar_queue<A>::unlink(handle elem) noexcept
+{
+    auto& n = nodes[elem];
+
+    if (n.child == follower) {
+        if (nodes[n.prev].child == elem)
+            nodes[n.prev].child = n.next;
+        else
+            nodes[n.prev].next = n.next;
+
+        if (n.next != invalid_heap_handle)
+            nodes[n.next].prev = n.prev;
+    } else {
+        auto& l = list(n);
+
+        // The first follower, if it exists, replaces the leader.
+        auto replace = n.next;
+        if (n.child != invalid_heap_handle) {
+            replace         = n.child;
+            auto& r         = nodes[replace];
+            r.child         = r.next;
+            r.prev          = n.prev;
+            r.next          = n.next;
+            if (r.child != invalid_heap_handle)
+                nodes[r.child].prev = replace;
+            if (r.next != invalid_heap_handle)
+                nodes[r.next].prev = replace;
+            else
+                l.tail = replace;
+        } else {
+            if (n.next != invalid_heap_handle)
+                nodes[n.next].prev = n.prev;
+            else
+                l.tail = n.prev;
+        }
+
+        if (n.prev != invalid_heap_handle)
+            nodes[n.prev].next = replace;
+        else
+            l.head = replace;
+
+        if (m_top == elem)
+            m_top = n.child != invalid_heap_handle ? replace
+                                                   : invalid_heap_handle;
+    }
+
+    if (n.bucket != infinity_bucket)
+        --m_finite_size;
+
+    n.prev   = invalid_heap_handle;
+    n.next   = invalid_heap_handle;
+    n.child  = invalid_heap_handle;
+    n.bucket = invalid_heap_handle;
+
+    --m_size;
+}
+
+template<typename A>
+inline void calendar_queue<A>::resize(u32 bucket_number) noexcept
+{
+    scratch.clear();
+    if (not scratch.reserve(m_finite_size))
+        return;
+
+    for (u32 i = 0, e = static_cast<u32>(nodes.size()); i < e; ++i)
+        if (nodes[i].bucket != invalid_heap_handle and
+            nodes[i].bucket != infinity_bucket)
+            scratch.emplace_back(i);
+
+    std::sort(scratch.begin(), scratch.end(), [&](const u32 a, const u32 b) {
+        return nodes[a].tn < nodes[b].tn;
+    });
+
+    // As Brown, use three times the average separation of the next 64
+    // distinct events.
+    if (not scratch.empty()) {
+        const auto first    = nodes[scratch.front()].tn;
+        auto       last     = first;
+        int        distinct = 1;
+
+        for (auto it = scratch.begin(), et = scratch.end();
+             it != et and distinct < 64;
+             ++it) {
+            if (nodes[*it].tn != last) {
+                last = nodes[*it].tn;
+                ++distinct;
+            }
+        }
+
+        const auto sep = (last - first) / static_cast<time>(distinct - 1);
+        if (distinct > 1 and sep > zero and std::isfinite(sep))
+            m_width = three * sep;
+    }
+
+    // Rebuild the sorted buckets by appending nodes in @c tn order. The
+    // sort is not stable: the cached top may become a follower.
+    m_top = invalid_heap_handle;
+    buckets.resize(bucket_number);
+    std::fill_n(buckets.data(), buckets.size(), bucket_list{});
+
+    for (const auto h : scratch) {
+        nodes[h].day    = day(nodes[h].tn);
+        nodes[h].bucket = bucket(nodes[h].day);
+        nodes[h].child  = invalid_heap_handle;
+
+        auto& l = buckets[nodes[h].bucket];
+        if (l.tail != invalid_heap_handle and nodes[l.tail].tn == nodes[h].tn)
+            push_follower(l.tail, h);
+        else
+            push_back(l, h);
+    }
+
+    if (not scratch.empty())
+        m_day = nodes[scratch.front()].day;
+}
+
+//
+// template<typename A>
+// scheduller<A>
+//
+
+template<typename A>
+inline scheduller<A>::scheduller(
+  constrained_value<int, 512, INT_MAX> capacity) noexcept
+  : m_heap(capacity)
+  , m_capacity(static_cast<u32>(capacity.value()))
+{}
+
+template<typename A>
+inline bool scheduller<A>::reserve(std::integral auto new_capacity) noexcept
+{
+    if (std::cmp_greater(new_capacity, m_capacity))
+        m_capacity = static_cast<u32>(new_capacity);
+
+    return m_policy == scheduller_policy::pairing_heap
+             ? m_heap.reserve(new_capacity)
+             : m_calendar.reserve(new_capacity);
+}
+
+template<typename A>
+inline void scheduller<A>::clear() noexcept
+{
+    m_heap.clear();
+    m_calendar.clear();
+}
+
+template<typename A>
+inline void scheduller<A>::destroy() noexcept
+{
+    m_heap.destroy();
+    m_calendar.destroy();
+}
+
+template<typename A>
+inline bool scheduller<A>::set_policy(scheduller_policy policy) noexcept
+{
+    if (m_policy == policy)
+        return true;
+
+    clear();
+    m_policy = policy;
+
+    return reserve(m_capacity);
+}
+
+template<typename A>
+inline scheduller_policy scheduller<A>::policy() const noexcept
+{
+    return m_policy;
+}
+
+template<typename A>
+inline void scheduller<A>::alloc(model& mdl, model_id id, time tn) noexcept
+{
+    debug::ensure(mdl.handle == invalid_heap_handle);
+
+    mdl.handle = m_policy == scheduller_policy::pairing_heap
+                   ? m_heap.alloc(tn, id)
+                   : m_calendar.alloc(tn, id);
+}
+
+template<typename A>
+inline void scheduller<A>::reintegrate(model& mdl, time tn) noexcept
+{
+    debug::ensure(mdl.handle != invalid_heap_handle);
+
+    if (m_policy == scheduller_policy::pairing_heap)
+        m_heap.reintegrate(tn, mdl.handle);
+    else
+        m_calendar.reintegrate(tn, mdl.handle);
+}
+
+template<typename A>
+inline void scheduller<A>::remove(model& mdl) noexcept
+{
+    if (mdl.handle != invalid_heap_handle) {
+        if (m_policy == scheduller_policy::pairing_heap)
+            m_heap.remove(mdl.handle);
+        else
+            m_calendar.remove(mdl.handle);
+    }
+}
+
+template<typename A>
+inline void scheduller<A>::free(model& mdl) noexcept
+{
+    if (mdl.handle != invalid_heap_handle) {
+        if (m_policy == scheduller_policy::pairing_heap) {
+            m_heap.remove(mdl.handle);
+            m_heap.destroy(mdl.handle);
+        } else {
+            m_calendar.destroy(mdl.handle);
+        }
+
+        mdl.handle = invalid_heap_handle;
     }
 }
 
@@ -11341,9 +13403,9 @@ inline void scheduller<A>::update(model& mdl, time tn) noexcept
         remove(mdl);
     } else {
         if (tn < mdl.tn)
-            m_heap.decrease(tn, mdl.handle);
+            decrease(mdl, tn);
         else if (tn > mdl.tn)
-            m_heap.increase(tn, mdl.handle);
+            increase(mdl, tn);
     }
 }
 
@@ -11353,7 +13415,10 @@ inline void scheduller<A>::decrease(model& mdl, time tn) noexcept
     debug::ensure(mdl.handle != invalid_heap_handle);
     debug::ensure(tn <= mdl.tn);
 
-    m_heap.decrease(tn, mdl.handle);
+    if (m_policy == scheduller_policy::pairing_heap)
+        m_heap.decrease(tn, mdl.handle);
+    else
+        m_calendar.decrease(tn, mdl.handle);
 }
 
 template<typename A>
@@ -11362,12 +13427,20 @@ inline void scheduller<A>::increase(model& mdl, time tn) noexcept
     debug::ensure(mdl.handle != invalid_heap_handle);
     debug::ensure(tn <= mdl.tn);
 
-    m_heap.increase(tn, mdl.handle);
+    if (m_policy == scheduller_policy::pairing_heap)
+        m_heap.increase(tn, mdl.handle);
+    else
+        m_calendar.increase(tn, mdl.handle);
 }
 
 template<typename A>
 inline void scheduller<A>::pop(vector<model_id>& out) noexcept
 {
+    if (m_policy == scheduller_policy::calendar_queue) {
+        m_calendar.pop(out);
+        return;
+    }
+
     time t = tn();
 
     out.clear();
@@ -11380,37 +13453,65 @@ inline void scheduller<A>::pop(vector<model_id>& out) noexcept
 template<typename A>
 inline time scheduller<A>::tn() const noexcept
 {
-    return m_heap[m_heap.top()].tn;
+    return m_policy == scheduller_policy::pairing_heap
+             ? m_heap[m_heap.top()].tn
+             : m_calendar[m_calendar.top()].tn;
 }
 
 template<typename A>
 inline time scheduller<A>::tn(handle h) const noexcept
 {
-    return m_heap[h].tn;
+    return m_policy == scheduller_policy::pairing_heap ? m_heap[h].tn
+                                                       : m_calendar[h].tn;
 }
 
 template<typename A>
 inline bool scheduller<A>::is_in_tree(handle h) const noexcept
 {
-    return m_heap.is_in_tree(h);
+    return m_policy == scheduller_policy::pairing_heap
+             ? m_heap.is_in_tree(h)
+             : m_calendar.is_in_tree(h);
 }
 
 template<typename A>
 inline bool scheduller<A>::empty() const noexcept
 {
-    return m_heap.empty();
+    return m_policy == scheduller_policy::pairing_heap ? m_heap.empty()
+                                                       : m_calendar.empty();
 }
 
 template<typename A>
 unsigned scheduller<A>::size() const noexcept
 {
-    return m_heap.size();
+    return m_policy == scheduller_policy::pairing_heap ? m_heap.size()
+                                                       : m_calendar.size();
 }
 
 template<typename A>
 inline int scheduller<A>::ssize() const noexcept
 {
-    return static_cast<int>(m_heap.size());
+    return static_cast<int>(size());
+}
+
+template<typename A>
+inline bool scheduller<A>::make_delta(scheduller& shadow,
+                                      delta&      d) const noexcept
+{
+    if (shadow.m_policy != m_policy)
+        return false;
+
+    return m_policy == scheduller_policy::pairing_heap
+             ? m_heap.make_delta(shadow.m_heap, d.heap)
+             : m_calendar.make_delta(shadow.m_calendar, d.calendar);
+}
+
+template<typename A>
+inline void scheduller<A>::apply_delta(const delta& d) noexcept
+{
+    if (m_policy == scheduller_policy::pairing_heap)
+        m_heap.apply_delta(d.heap);
+    else
+        m_calendar.apply_delta(d.calendar);
 }
 
 //
@@ -11519,12 +13620,16 @@ inline simulation& simulation::operator=(const simulation& other) noexcept
     limits              = other.limits;
     t                   = other.t.load(std::memory_order_acquire);
 
+    connection_graph_outdated = true;
+
     return *this;
 }
 
 inline simulation& simulation::operator=(
   const simulation_snapshot& snap) noexcept
 {
+    debug::ensure(snap.keyframe);
+
     models         = snap.models;
     observers      = snap.observers;
     nodes          = snap.nodes;
@@ -11533,6 +13638,10 @@ inline simulation& simulation::operator=(
     sched          = snap.sched;
     t              = snap.t;
 
+    connection_graph_outdated = true;
+    track_changed_models      = false;
+    changed_models.clear();
+
     return *this;
 }
 
@@ -11639,6 +13748,8 @@ inline void simulation::clear() noexcept
     nodes.clear();
     output_ports.clear();
     dated_messages.clear();
+
+    connection_graph_outdated = true;
 }
 
 constexpr inline auto get_interpolate_type(const dynamics_type type) noexcept
@@ -11787,6 +13898,30 @@ constexpr inline auto get_interpolate_type(const dynamics_type type) noexcept
     unreachable();
 }
 
+/// Returns true if the @c transition function of the dynamics only reads the
+/// @c simulation::message_buffer and writes its own data. Models of these
+/// types can be transitioned concurrently in @c simulation::run(Executor&).
+/// Models using external sources, dated messages, hierarchical state machines
+/// or embedded simulations are always transitioned sequentially.
+constexpr inline bool is_parallel_transition_safe(
+  const dynamics_type type) noexcept
+{
+    switch (type) {
+    case dynamics_type::queue:
+    case dynamics_type::dynamic_queue:
+    case dynamics_type::priority_queue:
+    case dynamics_type::generator:
+    case dynamics_type::hsm_wrapper:
+    case dynamics_type::simulation_wrapper:
+        return false;
+
+    default:
+        return true;
+    }
+
+    unreachable();
+}
+
 inline status simulation::observe(model& mdl) noexcept
 {
     if (debug::check(not observers.exists(mdl.obs_id))) {
@@ -11867,6 +14002,8 @@ inline void simulation::deallocate(model_id id) noexcept
 
     sched.free(*mdl);
     models.free(*mdl);
+
+    connection_graph_outdated = true;
 }
 
 template<typename Dynamics>
@@ -11943,6 +14080,8 @@ inline status simulation::connect(output_port& port,
                                   model_id     dst,
                                   int          port_dst) noexcept
 {
+    connection_graph_outdated = true;
+
     // First, we try to add the node into the static node vector.
 
     if (port.connections.can_alloc(1)) {
@@ -12054,6 +14193,8 @@ inline void simulation::disconnect(model& src,
                                    model& dst,
                                    int    port_dst) noexcept
 {
+    connection_graph_outdated = true;
+
     dispatch(src, [&]<typename Dynamics>(Dynamics& dyn) noexcept {
         if constexpr (has_output_port<Dynamics>) {
             if (auto* y = output_ports.try_to_get(dyn.y[port_src])) {
@@ -12117,6 +14258,9 @@ inline status simulation::initialize() noexcept
     last_valid_t = limits.begin();
     t            = limits.begin();
 
+    track_changed_models = false;
+    changed_models.clear();
+
     clean();
 
     for (auto& h : hsms)
@@ -12126,15 +14270,14 @@ inline status simulation::initialize() noexcept
     for (auto& mdl : models)
         irt_check(make_initialize(mdl, t));
 
+    irt_check(build_connection_graph());
+
     for (auto& obs : observers) {
         obs.reset();
 
         if (auto* mdl = models.try_to_get(obs.model())) {
-            dispatch(*mdl, [&]<typename Dynamics>(Dynamics& dyn) {
-                if constexpr (has_observation_function<Dynamics>) {
-                    obs.observe(dyn.observation(t, t - mdl->tl));
-                }
-            });
+            if (auto* fn = get_dynamics_functions(*mdl).observation)
+                obs.observe(fn(*mdl, t, t - mdl->tl));
         } else {
             observers.free(observers.get_id(obs));
         }
@@ -12177,27 +14320,13 @@ inline status simulation::make_initialize(model& mdl, time t) noexcept
 }
 
 template<typename Dynamics>
-status simulation::make_transition(model& mdl, Dynamics& dyn, time t) noexcept
+status simulation::make_output(model& mdl, Dynamics& dyn, time t) noexcept
 {
     if constexpr (has_observation_function<Dynamics>) {
         if (mdl.obs_id != undefined<observer_id>()) {
-            if (auto* obs = observers.try_to_get(mdl.obs_id)) {
-                const auto st = obs->observe(dyn.observation(t, t - mdl.tl));
-
-                switch (st) {
-                case buffer_status::near_full:
-                    immediate_observers.push_back(mdl.obs_id);
-                    break;
-
-                case buffer_status::overflow:
-                    debug::print("raw-buffer full");
-                    immediate_observers.push_back(mdl.obs_id);
-                    break;
-
-                default:
-                    break;
-                };
-            }
+            if (auto* obs = observers.try_to_get(mdl.obs_id))
+                push_observation(
+                  *obs, mdl.obs_id, dyn.observation(t, t - mdl.tl), t);
         } else {
             mdl.obs_id = static_cast<observer_id>(0);
         }
@@ -12209,9 +14338,27 @@ status simulation::make_transition(model& mdl, Dynamics& dyn, time t) noexcept
                 irt_check(dyn.lambda(*this));
     }
 
+    return success();
+}
+
+template<typename Dynamics>
+status simulation::make_state_transition(model&    mdl,
+                                         Dynamics& dyn,
+                                         time      t) noexcept
+{
     if constexpr (has_transition_function<Dynamics>)
         irt_check(dyn.transition(*this, t, t - mdl.tl, mdl.tn - t));
 
+    end_state_transition(mdl, dyn, t);
+
+    return success();
+}
+
+template<typename Dynamics>
+void simulation::end_state_transition(model&    mdl,
+                                      Dynamics& dyn,
+                                      time      t) noexcept
+{
     if constexpr (has_input_port<Dynamics>) {
         for (auto& elem : dyn.x)
             elem.reset();
@@ -12223,6 +14370,13 @@ status simulation::make_transition(model& mdl, Dynamics& dyn, time t) noexcept
     mdl.tn = t + dyn.sigma;
     if (dyn.sigma != 0 && mdl.tn == t)
         mdl.tn = std::nextafter(t, t + irt::one);
+}
+
+template<typename Dynamics>
+status simulation::make_transition(model& mdl, Dynamics& dyn, time t) noexcept
+{
+    irt_check(make_output(mdl, dyn, t));
+    irt_check(make_state_transition(mdl, dyn, t));
 
     debug::ensure(not sched.is_in_tree(mdl.handle));
     sched.reintegrate(mdl, mdl.tn);
@@ -12232,31 +14386,26 @@ status simulation::make_transition(model& mdl, Dynamics& dyn, time t) noexcept
 
 inline status simulation::make_transition(model& mdl, time t) noexcept
 {
-    return dispatch(mdl, [this, &mdl, t]<typename Dynamics>(Dynamics& dyn) {
-        return this->make_transition(mdl, dyn, t);
-    });
+    const auto& fns = get_dynamics_functions(mdl);
+
+    irt_check(fns.output(*this, mdl, t));
+    irt_check(fns.transition(*this, mdl, t));
+
+    debug::ensure(not sched.is_in_tree(mdl.handle));
+    sched.reintegrate(mdl, mdl.tn);
+
+    return success();
 }
 
 template<typename Dynamics>
 status simulation::make_finalize(Dynamics& dyn, observer* obs, time t) noexcept
 {
     if constexpr (has_observation_function<Dynamics>) {
-        if (obs) {
-            switch (obs->observe(dyn.observation(t, t - get_model(dyn).tl))) {
-            case buffer_status::near_full:
-                immediate_observers.push_back(observers.get_id(*obs));
-                break;
-
-            case buffer_status::overflow:
-                debug::print(
-                  "raw-buffer full during observe finalize operation");
-                immediate_observers.push_back(observers.get_id(*obs));
-                break;
-
-            default:
-                break;
-            };
-        }
+        if (obs)
+            push_observation(*obs,
+                             observers.get_id(*obs),
+                             dyn.observation(t, t - get_model(dyn).tl),
+                             t);
     }
 
     if constexpr (has_finalize_function<Dynamics>) {
@@ -12266,6 +14415,35 @@ status simulation::make_finalize(Dynamics& dyn, observer* obs, time t) noexcept
     return success();
 }
 
+inline void simulation::push_observation(observer&         obs,
+                                         const observer_id id,
+                                         const raw_sample& s,
+                                         time              t) noexcept
+{
+    switch (obs.observe(s)) {
+    case buffer_status::near_full:
+        immediate_observers.push_back(id);
+        break;
+
+    case buffer_status::overflow:
+        if (obs.lossless()) {
+            // The pending sample at @c t is not committed by the resampler:
+            // the sample @c s can still replace it.
+            observers.get<resampler>(id).tick(obs, t);
+
+            [[maybe_unused]] const auto pushed = obs.raw_buffer().push(s);
+            debug::ensure(pushed);
+        } else {
+            debug::print("raw-buffer full");
+            immediate_observers.push_back(id);
+        }
+        break;
+
+    default:
+        break;
+    };
+}
+
 inline status simulation::finalize() noexcept
 {
     debug::ensure(std::isfinite(t.load()));
@@ -12312,36 +14490,222 @@ inline status simulation::run() noexcept
         if (auto* mdl = models.try_to_get(id); mdl)
             irt_check(make_transition(*mdl, t));
 
+    return route_messages();
+}
+
+template<typename Executor>
+inline status simulation::run(Executor& executor) noexcept
+{
+    debug::ensure(std::isfinite(t.load()));
+
+    immediate_models.clear();
+    immediate_observers.clear();
+
+    if (sched.empty()) {
+        t = time_domain<time>::infinity;
+        return success();
+    }
+
+    last_valid_t = t;
+    t            = sched.tn();
+
+    if (limits.expired(t)) {
+        t = limits.end();
+        return success();
+    }
+
+    sched.pop(immediate_models);
+
+    active_output_ports.clear();
+    if (std::cmp_less(immediate_models.size(), parallel_bag_threshold)) {
+        for (const auto id : immediate_models)
+            if (auto* mdl = models.try_to_get(id); mdl)
+                irt_check(make_transition(*mdl, t));
+    } else {
+        irt_check(make_parallel_transitions(executor));
+    }
+
+    return route_messages();
+}
+
+template<typename... Dynamics>
+inline status simulation::run(dynamics_set<Dynamics...> set) noexcept
+{
+    debug::ensure(std::isfinite(t.load()));
+
+    immediate_models.clear();
+    immediate_observers.clear();
+
+    if (sched.empty()) {
+        t = time_domain<time>::infinity;
+        return success();
+    }
+
+    last_valid_t = t;
+    t            = sched.tn();
+
+    if (limits.expired(t)) {
+        t = limits.end();
+        return success();
+    }
+
+    sched.pop(immediate_models);
+
+    active_output_ports.clear();
+    const auto now = t.load();
+
+    for (const auto id : immediate_models) {
+        if (auto* mdl = models.try_to_get(id); mdl) {
+            irt_check(set.dispatch(*mdl, [&]<typename T>(T& dyn) -> status {
+                return make_transition(*mdl, dyn, now);
+            }));
+        }
+    }
+
+    return route_messages<dynamics_set<Dynamics...>>();
+}
+
+template<typename Executor>
+inline status simulation::make_parallel_transitions(Executor& executor) noexcept
+{
+    const auto now = t.load();
+
+    // The observations and lambda functions are called in the bag order to
+    // keep the @c active_output_ports and the @c immediate_observers vectors
+    // identical to the sequential @c run(). Models not safe for parallel
+    // execution are fully transitioned here.
+    for (const auto id : immediate_models) {
+        if (auto* mdl = models.try_to_get(id); mdl) {
+            const auto& fns = get_dynamics_functions(*mdl);
+
+            irt_check(fns.output(*this, *mdl, now));
+
+            if (not is_parallel_transition_safe(mdl->type))
+                irt_check(fns.transition(*this, *mdl, now));
+        }
+    }
+
+    // The transition functions only read the @c message_buffer and write
+    // the model itself. Each chunk stores its own status.
+    constexpr unsigned max_chunks = 64u;
+
+    const auto     size = static_cast<unsigned>(immediate_models.size());
+    const unsigned concurrency =
+      std::clamp(static_cast<unsigned>(executor.concurrency()), 1u, max_chunks);
+    const auto chunk_size = std::max(1u, (size + concurrency - 1u) / concurrency);
+    const auto chunks     = (size + chunk_size - 1u) / chunk_size;
+
+    std::array<status, max_chunks> results;
+
+    executor.parallel_for(chunks, [&](const unsigned chunk) noexcept {
+        const auto first = chunk * chunk_size;
+        const auto last  = std::min(first + chunk_size, size);
+
+        for (auto i = first; i < last; ++i) {
+            auto* mdl = models.try_to_get(immediate_models[i]);
+            if (not mdl or not is_parallel_transition_safe(mdl->type))
+                continue;
+
+            auto ret =
+              get_dynamics_functions(*mdl).transition(*this, *mdl, now);
+
+            if (not ret) {
+                results[chunk] = ret;
+                return;
+            }
+        }
+    });
+
+    for (unsigned i = 0; i < chunks; ++i)
+        irt_check(results[i]);
+
+    // The scheduler is updated in the bag order to keep the same heap
+    // structure than the sequential @c run().
+    for (const auto id : immediate_models) {
+        if (auto* mdl = models.try_to_get(id); mdl) {
+            debug::ensure(not sched.is_in_tree(mdl->handle));
+            sched.reintegrate(*mdl, mdl->tn);
+        }
+    }
+
+    return success();
+}
+
+inline void simulation::mark_changed(const model& mdl) noexcept
+{
+    if (not track_changed_models)
+        return;
+
+    // Too many duplicates: the next snapshot is a full copy.
+    if (changed_models.size() >= 2u * models.size() or
+        not changed_models.emplace_back(models.get_id(mdl))) {
+        track_changed_models = false;
+        changed_models.clear();
+    }
+}
+
+inline void simulation::wake_up(model& mdl, const time date) noexcept
+{
+    sched.update(mdl, date);
+    mark_changed(mdl);
+}
+
+template<typename Set>
+inline status simulation::route_messages() noexcept
+{
+    if (track_changed_models)
+        for (const auto id : immediate_models)
+            if (const auto* mdl = models.try_to_get(id))
+                mark_changed(*mdl);
+
+    if (connection_graph_outdated)
+        irt_check(build_connection_graph());
+
+    if (routing == message_routing_policy::single_pass) {
+        if (route_messages_single_pass<Set>())
+            return success();
+
+        // A region overflows: the input ports already filled by the single
+        // pass are emptied before the two pass routing computes them again.
+        for (const auto y_id : active_output_ports) {
+            const auto idx = get_index(y_id);
+
+            for (auto i = connection_offsets[idx],
+                      e = connection_offsets[idx + 1];
+                 i != e;
+                 ++i) {
+                const auto& dst = connection_targets[i];
+                const auto  xs  = Set::input_ports(models.get(dst.model));
+
+                if (not xs.empty())
+                    xs[dst.port_index].reset();
+            }
+        }
+    }
+
     // First, we compute the input_port::capacity.
 
     u32 global_messages_number = 0;
 
     for (const auto y_id : active_output_ports) {
-        if (auto* y = output_ports.try_to_get(y_id)) {
-            y->for_each(
-              models,
-              nodes,
-              [](model&     mdl,
-                 const auto port_index,
-                 auto&      global_messages_number) noexcept {
-                  dispatch(
-                    mdl,
-                    []<typename Dynamics>(
-                      Dynamics&  dyn,
-                      const auto port_index,
-                      auto&      global_messages_number) noexcept {
-                        if constexpr (has_input_port<Dynamics>) {
-                            dyn.x[port_index].capacity += 1u;
-                            dyn.x[port_index].position = 0u;
-                            dyn.x[port_index].size     = 0u;
-
-                            global_messages_number += 1;
-                        }
-                    },
-                    port_index,
-                    global_messages_number);
-              },
-              global_messages_number);
+        const auto idx = get_index(y_id);
+        debug::ensure(std::cmp_less(idx + 1, connection_offsets.size()));
+
+        for (auto i = connection_offsets[idx], e = connection_offsets[idx + 1];
+             i != e;
+             ++i) {
+            const auto& dst = connection_targets[i];
+            auto&       mdl = models.get(dst.model);
+            const auto  xs  = Set::input_ports(mdl);
+
+            if (not xs.empty()) {
+                auto& x = xs[dst.port_index];
+                x.capacity += 1u;
+                x.position = 0u;
+                x.size     = 0u;
+
+                global_messages_number += 1;
+            }
         }
     }
 
@@ -12350,45 +14714,207 @@ inline status simulation::run() noexcept
     // index and position.
 
     message_buffer.resize(global_messages_number);
-    u32 global_position = 0;
+    u32        global_position = 0;
+    const auto now             = t.load();
+
+    for (const auto y_id : active_output_ports) {
+        const auto  idx = get_index(y_id);
+        const auto& msg = output_ports.get(y_id).msg;
+
+        for (auto i = connection_offsets[idx], e = connection_offsets[idx + 1];
+             i != e;
+             ++i) {
+            const auto& dst = connection_targets[i];
+            auto&       mdl = models.get(dst.model);
+            const auto  xs  = Set::input_ports(mdl);
+
+            if (not xs.empty()) {
+                auto& x = xs[dst.port_index];
+
+                if (x.size == 0) {
+                    x.position = global_position;
+                    global_position += x.capacity;
+                    wake_up(mdl, now);
+                }
+
+                const auto start_at = x.position + x.size;
+                ++x.size;
+
+                message_buffer[start_at] = msg;
+            }
+        }
+    }
+
+    return success();
+}
+
+template<typename Set>
+inline bool simulation::route_messages_single_pass() noexcept
+{
+    message_buffer.resize(connection_regions_size);
+    const auto now = t.load();
 
     for (const auto y_id : active_output_ports) {
-        if (auto* y = output_ports.try_to_get(y_id)) {
-            y->for_each(
-              models,
-              nodes,
-              [](auto&       mdl,
-                 const auto  port_index,
-                 auto&       sched,
-                 const auto  t,
-                 const auto& msg,
-                 auto&       message_buffer,
-                 auto&       global_position) {
-                  dispatch(mdl, [&]<typename Dynamics>(Dynamics& dyn) {
-                      if constexpr (has_input_port<Dynamics>) {
-                          auto& x = dyn.x[port_index];
-
-                          if (x.size == 0) {
-                              x.position = global_position;
-                              global_position += x.capacity;
-                              sched.update(mdl, t);
-                          }
-
-                          const auto start_at = x.position + x.size;
-                          ++x.size;
-
-                          message_buffer[start_at] = msg;
-                      }
-                  });
-              },
-              sched,
-              t.load(),
-              y->msg,
-              message_buffer,
-              global_position);
+        const auto  idx = get_index(y_id);
+        const auto& msg = output_ports.get(y_id).msg;
+
+        for (auto i = connection_offsets[idx], e = connection_offsets[idx + 1];
+             i != e;
+             ++i) {
+            const auto& dst    = connection_targets[i];
+            const auto& region = connection_regions[i];
+            auto&       mdl    = models.get(dst.model);
+            const auto  xs     = Set::input_ports(mdl);
+
+            if (not xs.empty()) {
+                auto& x = xs[dst.port_index];
+
+                if (x.size == 0) {
+                    x.position = region.position;
+                    wake_up(mdl, now);
+                } else if (x.size == region.capacity) {
+                    return false;
+                }
+
+                message_buffer[x.position + x.size] = msg;
+                ++x.size;
+                x.capacity = x.size;
+            }
+        }
+    }
+
+    return true;
+}
+
+inline status simulation::push_message(model&         mdl,
+                                      const int      port,
+                                      const message& msg,
+                                      const time     date) noexcept
+{
+    return dispatch(mdl, [&]<typename Dynamics>(Dynamics& dyn) -> status {
+        if constexpr (has_input_port<Dynamics>) {
+            if (not(0 <= port and port < length(dyn.x)))
+                return make_error(simulation_errc::input_port_error);
+
+            // The messages already routed to this port are moved with the
+            // new message at the end of the @c message_buffer.
+            auto&      x        = dyn.x[port];
+            const auto position = static_cast<u32>(message_buffer.size());
+
+            if (not message_buffer.resize(position + x.size + 1u))
+                return make_error(simulation_errc::messages_container_full);
+
+            if (x.size > 0)
+                std::copy_n(message_buffer.data() + x.position,
+                            x.size,
+                            message_buffer.data() + position);
+
+            x.position                        = position;
+            message_buffer[position + x.size] = msg;
+            ++x.size;
+            x.capacity = x.size;
+
+            wake_up(mdl, date);
+
+            return success();
+        } else {
+            return make_error(simulation_errc::input_port_error);
         }
+    });
+}
+
+inline status simulation::build_connection_graph() noexcept
+{
+    const auto ports = output_ports.capacity();
+
+    if (not connection_offsets.resize(ports + 1))
+        return make_error(simulation_errc::connection_container_full);
+
+    std::fill_n(connection_offsets.data(), connection_offsets.size(), 0u);
+
+    // Removes the destinations with undefined model and merges the block
+    // nodes into the output_port::connections to get the same order than
+    // the @c output_port::for_each function.
+
+    u32 total = 0;
+    for (auto& y : output_ports) {
+        y.for_each(models, nodes, [](auto&, auto) noexcept {});
+
+        u32 count = 0;
+        std::as_const(y).for_each(
+          std::as_const(models),
+          std::as_const(nodes),
+          [](const auto&, auto, auto& count) noexcept { ++count; },
+          count);
+
+        connection_offsets[get_index(output_ports.get_id(y)) + 1] = count;
+        total += count;
+    }
+
+    if (not connection_targets.resize(total))
+        return make_error(simulation_errc::connection_container_full);
+
+    for (int i = 0; i < ports; ++i)
+        connection_offsets[i + 1] += connection_offsets[i];
+
+    for (const auto& y : output_ports) {
+        auto pos = connection_offsets[get_index(output_ports.get_id(y))];
+
+        y.for_each(
+          std::as_const(models),
+          std::as_const(nodes),
+          [&](const model& mdl, const auto port_index) noexcept {
+              connection_targets[pos++] = node(models.get_id(mdl), port_index);
+          });
+    }
+
+    // Computes the region of each input port in the message buffer: @c
+    // first_input is the index of the first input port of each model and @c
+    // regions the prefix sum of the number of connections of each input
+    // port.
+
+    vector<u32> first_input;
+    if (not first_input.resize(models.capacity() + 1))
+        return make_error(simulation_errc::connection_container_full);
+
+    std::fill_n(first_input.data(), first_input.size(), 0u);
+    for (const auto& mdl : models)
+        first_input[get_index(models.get_id(mdl)) + 1] =
+          dispatch(mdl, []<typename Dynamics>(const Dynamics& dyn) -> u32 {
+              if constexpr (has_input_port<Dynamics>)
+                  return static_cast<u32>(length(dyn.x));
+              else
+                  return 0u;
+          });
+
+    for (u32 i = 0, e = models.capacity(); i < e; ++i)
+        first_input[i + 1] += first_input[i];
+
+    vector<u32> regions;
+    if (not regions.resize(first_input[models.capacity()] + 1) or
+        not connection_regions.resize(total))
+        return make_error(simulation_errc::connection_container_full);
+
+    std::fill_n(regions.data(), regions.size(), 0u);
+    for (const auto& dst : connection_targets)
+        ++regions[first_input[get_index(dst.model)] + dst.port_index + 1];
+
+    for (u32 i = 0, e = regions.size() - 1; i < e; ++i)
+        regions[i + 1] += regions[i];
+
+    for (u32 i = 0; i < total; ++i) {
+        const auto& dst = connection_targets[i];
+        const auto  key = first_input[get_index(dst.model)] + dst.port_index;
+
+        connection_regions[i] = input_region{
+            .position = regions[key],
+            .capacity = regions[key + 1] - regions[key],
+        };
     }
 
+    connection_regions_size   = total;
+    connection_graph_outdated = false;
+
     return success();
 }
 
@@ -12416,9 +14942,12 @@ inline status simulation::run_with_cb(Fn&& fn, Args&&... args) noexcept
     sched.pop(immediate_models);
 
     // emitting_output_ports.clear();
-    for (const auto id : immediate_models)
-        if (auto* mdl = models.try_to_get(id); mdl)
+    for (const auto id : immediate_models) {
+        if (auto* mdl = models.try_to_get(id); mdl) {
             irt_check(make_transition(*mdl, t));
+            mark_changed(*mdl);
+        }
+    }
 
     fn(std::as_const(*this),
        std::span(immediate_models.data(), immediate_models.size()),
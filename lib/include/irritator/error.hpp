@@ -99,6 +99,7 @@ enum class simulation_errc : std::int16_t {
 
     emitting_output_ports_full,
     hsm_unknown,
+    dynamics_unknown,
     connection_incompatible,
     connection_already_exists,
     connection_container_full,
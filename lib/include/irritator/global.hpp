@@ -97,6 +97,7 @@ struct variables {
     std::atomic<i64>       text_file_viewer_max_file_size = 1024 * 1024;
     std::atomic<int>       theme                          = 0;
     std::atomic<log_level> loglevel                       = log_level::info;
+    std::atomic<bool>      save_component_caches          = false;
 };
 
 /**
@@ -324,6 +324,8 @@ enum class write_test_simulation_result : u8 {
 ///
 /// The simulation is written in a way that it can be used as a unit test and
 /// can be directly store into unit-test.
+/// The generated simulation is a @c fixed_simulation restricted to the
+/// dynamics types used by the models of @c sim.
 /// @param os
 /// @param sim
 /// @param begin
@@ -337,6 +339,22 @@ auto write_test_simulation(std::FILE*                          os,
                            const write_test_simulation_options opts) noexcept
   -> write_test_simulation_result;
 
+/// Write a standalone C++ translation unit from the simulation into @a os
+/// output stream.
+///
+/// The models, the constant parameters and the connections of @a sim are
+/// written into the build function of a @c fixed_simulation restricted to
+/// the used dynamics types. The translation unit exports a C ABI to create
+/// and step the simulator, to read the current values of the models and the
+/// resampled samples of the observers (see the head comment of the written
+/// file). It is built with the irritator headers and library.
+auto write_standalone_simulation(std::FILE*             os,
+                                 const std::string_view name,
+                                 const simulation&      sim,
+                                 const time             begin,
+                                 const time             end) noexcept
+  -> write_test_simulation_result;
+
 } // namespace irt
 
 #endif
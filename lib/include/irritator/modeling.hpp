@@ -1395,6 +1395,16 @@ public:
 
     auto get_tn_id(const unique_id_path& path) const noexcept -> tree_node_id;
 
+    /// Assign the models of the cells of the grid @c tn to rectangular tiles
+    /// of @c tile_rows x @c tile_cols cells numbered row by row. The models
+    /// outside the grid are in the first tile. The @c partitions vector, sized
+    /// to the capacity of the @c sim models, is ready for the @c
+    /// conservative_simulation::init() function.
+    status build_grid_partitions(const tree_node& tn,
+                                 i32              tile_rows,
+                                 i32              tile_cols,
+                                 vector<u32>&     partitions) const noexcept;
+
     data_array<tree_node, tree_node_id> tree_nodes;
 
     data_array<variable_observer, variable_observer_id> variable_observers;
@@ -1475,6 +1485,11 @@ private:
     tree_node_id m_tn_head = undefined<tree_node_id>();
 };
 
+/// Read the row and the column of a grid cell from its unique identifier (see
+/// @c grid_component::make_unique_name_id()).
+std::optional<std::pair<int, int>> get_row_column(
+  const std::string_view str) noexcept;
+
 class grid_observer
 {
 public:
@@ -1491,6 +1506,14 @@ public:
 
     fraction timestep = { 1, 10 }; //!< Affect resampler::m_dt.
 
+    /// Memory budget in KiB of the history of each observer, @c 0 for an
+    /// unbounded history. Affect observer::history_budget().
+    static_bounded_value<i32, 0, 1048576> history_budget = 0;
+
+    /// If true, the simulation drains a full raw buffer instead of losing
+    /// the sample. Affect observer::lossless().
+    bool lossless = false;
+
     // Build or reuse existing observer for each pair `tn_id`, `mdl_id` and
     // reinitialize all buffers.
     void init(project&         pj,
@@ -1528,6 +1551,14 @@ public:
 
     fraction timestep = { 1, 10 }; //!< Affect resampler::m_dt.
 
+    /// Memory budget in KiB of the history of each observer, @c 0 for an
+    /// unbounded history. Affect observer::history_budget().
+    static_bounded_value<i32, 0, 1048576> history_budget = 0;
+
+    /// If true, the simulation drains a full raw buffer instead of losing
+    /// the sample. Affect observer::lossless().
+    bool lossless = false;
+
     // Build or reuse existing observer for each pair `tn_id`, `mdl_id` and
     // reinitialize all buffers.
     void init(project&         pj,
@@ -1561,12 +1592,20 @@ public:
 
     name_str                               name;
     static_bounded_value<i32, 8, 64>       max_observers          = 8;
-    static_bounded_value<i32, 8, 512>      raw_buffer_size        = 64;
+    static_bounded_value<i32, 8, 512>      raw_buffer_size        = 256;
     static_bounded_value<i32, 1024, 65536> linearized_buffer_size = 32768;
     static_bounded_floating_point<float, 1, 100, 1, 10> time_step = .01f;
 
     fraction timestep = { 1, 100 }; //!< Affect resampler::m_dt.
 
+    /// Memory budget in KiB of the history of each observer, @c 0 for an
+    /// unbounded history. Affect observer::history_budget().
+    static_bounded_value<i32, 0, 1048576> history_budget = 0;
+
+    /// If true, the simulation drains a full raw buffer instead of losing
+    /// the sample. Affect observer::lossless().
+    bool lossless = false;
+
     enum class sub_id : u32;
 
     /** A DOD structure to store sub-variable observers with:
@@ -1905,8 +1944,12 @@ public:
     /**
      * Browse the file system then reads the content of all components.
      * \param jnl A journal handler reference stores in this class.
+     * \param executor If not null, the component files are read and parsed
+     * onto the workers of this executor, else on the caller thread.
      */
-    status fill_components(journal_handler& jnl) noexcept;
+    status fill_components(
+      journal_handler&         jnl,
+      simulation_bag_executor* executor = nullptr) noexcept;
 
     /**
      * Browse the file system to search components, projects and data file in
@@ -1930,6 +1973,13 @@ public:
     shared_buffer<file_access>      files;
 
     modeling_status state = modeling_status::unmodified;
+
+    /// If true, @c fill_components writes a @c component_cache file into
+    /// each registred path with parsed components. Disabled by default: the
+    /// registred paths may be shared or under version control. The GUI uses
+    /// the @c save-component-caches option of the settings file and the CLI
+    /// the @c --cache option.
+    bool save_component_caches = false;
 };
 
 template<typename T>
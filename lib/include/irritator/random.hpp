@@ -7,6 +7,7 @@
 
 #include <irritator/macros.hpp>
 
+#include <algorithm>
 #include <array>
 #include <limits>
 #include <span>
@@ -251,6 +252,120 @@ private:
     }
 };
 
+/**
+ * A Pseudo Random Generator based on Salmon et al. (Random123) which computes
+ * @c lanes counters at once.
+ *
+ * @c philox_64_block produces the same sequence as @c philox_64 with the same
+ * @c seed, @c index and @c step. The rounds of the @c lanes counters are
+ * independent and are interleaved to fill the pipeline. Use @c generate() to
+ * fill a buffer directly or the standard random header interface.
+ */
+class philox_64_block
+{
+public:
+    using result_type = u64;
+
+    static constexpr u64 PHILOX_M0 = 0xD2B74407B1CADAC9ULL;
+    static constexpr u64 PHILOX_W0 = 0x9E3779B97F4A7C15ULL;
+    static constexpr int ROUNDS    = 10;
+    static constexpr int lanes     = 8;
+
+    constexpr philox_64_block(const u64 seed,
+                              const u64 index,
+                              const u64 step = 0) noexcept
+      : m_key{ seed }
+      , m_index{ index }
+      , m_step{ step }
+    {}
+
+    /** Build the next random number. Defined by the STL requirements for random
+     * number generators. */
+    constexpr result_type operator()() noexcept
+    {
+        if (m_buffer_pos >= m_buffer.size())
+            refill_buffer();
+
+        return m_buffer[m_buffer_pos++];
+    }
+
+    /** Fill the @c out buffer with the next random numbers. The remaining
+     * numbers of the internal buffer are discarded. */
+    constexpr void generate(std::span<u64> out) noexcept
+    {
+        m_buffer_pos = m_buffer.size();
+
+        auto it = out.begin();
+        while (out.end() - it >= std::ssize(m_buffer)) {
+            compute(std::span<u64, 2 * lanes>(it, 2 * lanes));
+            it += 2 * lanes;
+        }
+
+        if (it != out.end()) {
+            refill_buffer();
+            const auto n = static_cast<sz>(out.end() - it);
+            std::copy_n(m_buffer.begin(), n, it);
+            m_buffer_pos = n;
+        }
+    }
+
+    /** Returns the step of the next unused counter. Use this step to build a
+     * @c philox_64_block which continues the sequence. */
+    constexpr u64 step() const noexcept { return m_step; }
+
+    static constexpr result_type min() noexcept
+    {
+        return std::numeric_limits<result_type>::min();
+    }
+
+    static constexpr result_type max() noexcept
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+private:
+    u64 m_key;   /**< Global seed. */
+    u64 m_index; /**< The model_id. */
+    u64 m_step;  /**< The step of the next lane. */
+
+    std::array<u64, 2 * lanes> m_buffer{};
+    sz                         m_buffer_pos = 2 * lanes;
+
+    constexpr void compute(std::span<u64, 2 * lanes> out) noexcept
+    {
+        std::array<u64, lanes> ctr0, ctr1;
+        ctr0.fill(m_index);
+        for (int l = 0; l < lanes; ++l)
+            ctr1[l] = m_step + static_cast<u64>(l);
+
+        u64 key0 = m_key;
+        for (int i = 0; i < ROUNDS; ++i) {
+            for (int l = 0; l < lanes; ++l) {
+                u64 hi, lo;
+                details::mulhilo(PHILOX_M0, ctr0[l], lo, hi);
+
+                ctr0[l] = hi ^ key0 ^ ctr1[l];
+                ctr1[l] = lo;
+            }
+
+            key0 += PHILOX_W0;
+        }
+
+        for (int l = 0; l < lanes; ++l) {
+            out[2 * l]     = ctr0[l];
+            out[2 * l + 1] = ctr1[l];
+        }
+
+        m_step += lanes;
+    }
+
+    constexpr void refill_buffer() noexcept
+    {
+        compute(m_buffer);
+        m_buffer_pos = 0;
+    }
+};
+
 } // namespace irt
 
 #endif
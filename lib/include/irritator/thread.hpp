@@ -9,7 +9,10 @@
 #include <irritator/ext.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <thread>
@@ -126,8 +129,8 @@ public:
     ordered_worker(ordered_worker&& other) noexcept
       : m_list(other.m_list)
       , m_thread(std::move(other.m_thread))
-      , m_tasks_completed(other.m_tasks_completed)
-      , m_execution_time(other.m_execution_time)
+      , m_tasks_completed(other.m_tasks_completed.load())
+      , m_execution_time(other.m_execution_time.load())
     {}
 
     ~ordered_worker() noexcept = default;
@@ -138,11 +141,12 @@ public:
             task t;
             while (m_list->pop(t)) {
                 try {
-                    m_tasks_completed += 1;
                     const auto start = std::chrono::steady_clock::now();
                     t();
-                    m_execution_time =
-                      (std::chrono::steady_clock::now() - start).count();
+                    m_execution_time.fetch_add(
+                      (std::chrono::steady_clock::now() - start).count(),
+                      std::memory_order_relaxed);
+                    m_tasks_completed.fetch_add(1, std::memory_order_relaxed);
                 } catch (...) {
                 }
                 m_list->notify_done();
@@ -156,16 +160,159 @@ public:
             m_thread.join();
     }
 
-    u64 tasks_completed() const noexcept { return m_tasks_completed; }
+    u64 tasks_completed() const noexcept
+    {
+        return m_tasks_completed.load(std::memory_order_relaxed);
+    }
+
+    /// Sum of the durations of all the tasks executed by this worker.
+    std::chrono::nanoseconds::rep execution_time() const noexcept
+    {
+        return m_execution_time.load(std::memory_order_relaxed);
+    }
 
 private:
     ordered_task_list* m_list;
     std::thread        m_thread;
 
-    u64                           m_tasks_completed{ 0 };
-    std::chrono::nanoseconds::rep m_execution_time;
+    std::atomic<u64>                           m_tasks_completed{ 0 };
+    std::atomic<std::chrono::nanoseconds::rep> m_execution_time{ 0 };
+};
+
+/// A fixed capacity Chase-Lev work-stealing deque. Only the owner thread
+/// calls @c push() and @c pop() at the bottom of the deque, other threads use
+/// @c steal() at the top. Elements are @c u64 to be read and written
+/// atomically.
+///
+/// D. Chase and Y. Lev, Dynamic circular work-stealing deque, SPAA 2005 and
+/// N. M. Lê et al., Correct and efficient work-stealing for weak memory
+/// models, PPoPP 2013.
+class work_stealing_deque
+{
+public:
+    static constexpr i64 capacity = 256;
+
+    work_stealing_deque() noexcept = default;
+
+    /// Only valid when no thread uses the deque.
+    work_stealing_deque(work_stealing_deque&& other) noexcept
+      : m_top(other.m_top.load(std::memory_order_relaxed))
+      , m_bottom(other.m_bottom.load(std::memory_order_relaxed))
+    {
+        for (i64 i = 0; i < capacity; ++i)
+            m_buffer[i].store(
+              other.m_buffer[i].load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+    }
+
+    /// Push @c value at the bottom. Returns false if the deque is full.
+    bool push(const u64 value) noexcept
+    {
+        const auto b = m_bottom.load(std::memory_order_relaxed);
+        const auto t = m_top.load(std::memory_order_acquire);
+
+        if (b - t >= capacity)
+            return false;
+
+        m_buffer[b & mask].store(value, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Pop the bottom element. Returns false if the deque is empty or if a
+    /// thief takes the last element.
+    bool pop(u64& value) noexcept
+    {
+        const auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = m_top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        value = m_buffer[b & mask].load(std::memory_order_relaxed);
+        if (t != b)
+            return true;
+
+        const auto success = m_top.compare_exchange_strong(
+          t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return success;
+    }
+
+    /// Steal the top element. Returns false if the deque is empty or if
+    /// another thread takes the element.
+    bool steal(u64& value) noexcept
+    {
+        auto t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b = m_bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+            return false;
+
+        value = m_buffer[t & mask].load(std::memory_order_relaxed);
+        return m_top.compare_exchange_strong(
+          t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    /// Number of free places, only accurate for the owner thread.
+    i64 available() const noexcept
+    {
+        return capacity - (m_bottom.load(std::memory_order_relaxed) -
+                           m_top.load(std::memory_order_relaxed));
+    }
+
+private:
+    static constexpr i64 mask = capacity - 1;
+
+    static_assert((capacity & mask) == 0, "capacity must be a power of two");
+
+    alignas(64) std::atomic<i64> m_top{ 0 };
+    alignas(64) std::atomic<i64> m_bottom{ 0 };
+    alignas(64) std::array<std::atomic<u64>, capacity> m_buffer{};
 };
 
+/// A futex-like wake-up for idle workers. A worker reads the current epoch
+/// with @c prepare(), checks for work, then blocks in @c wait() until a
+/// producer calls @c notify(). A notification between @c prepare() and @c
+/// wait() is never lost because the epoch changed.
+class task_parking
+{
+public:
+    u32 prepare() const noexcept
+    {
+        return m_epoch.load(std::memory_order_acquire);
+    }
+
+    void wait(const u32 epoch) noexcept
+    {
+        m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+        m_epoch.wait(epoch, std::memory_order_acquire);
+        m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// Wake up all waiting workers.
+    void notify() noexcept
+    {
+        m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (m_sleepers.load(std::memory_order_seq_cst) > 0)
+            m_epoch.notify_all();
+    }
+
+private:
+    std::atomic<u32> m_epoch{ 0 };
+    std::atomic<u32> m_sleepers{ 0 };
+};
+
+/// A list of tasks executed in any order by the @c unordered_worker. Tasks
+/// are added with @c add() and the batch is started with @c submit(). During
+/// the execution, workers claim ranges of tasks without lock and the
+/// producer blocks in @c wait_completion().
 class unordered_task_list
 {
 public:
@@ -173,68 +320,115 @@ public:
 
     unordered_task_list(unordered_task_list&& other) noexcept
       : m_pending(std::move(other.m_pending))
+      , m_parking(other.m_parking)
       , m_tasks_submitted(other.m_tasks_submitted)
-      , m_tasks_completed(other.m_tasks_completed)
-      , m_batch_size(other.m_batch_size)
-      , m_next_index(other.m_next_index)
-      , m_completed(other.m_completed)
+      , m_tasks_completed(other.m_tasks_completed.load())
+      , m_cursor(other.m_cursor.load())
+      , m_completed(other.m_completed.load())
       , m_phase(other.m_phase)
-      , m_stopping(other.m_stopping)
+      , m_stopping(other.m_stopping.load())
     {}
 
+    /// Wake up the workers of the @c parking at each @c submit() and @c
+    /// shutdown().
+    void attach(task_parking& parking) noexcept { m_parking = &parking; }
+
+    /// Adds a task to the next batch. Returns false if the task is not
+    /// added: the list is stopping, a batch is executing (for example a call
+    /// from a task of this list) or the allocation failed.
     template<typename Fn>
-    void add(Fn&& fn) noexcept
+    bool add(Fn&& fn) noexcept
     {
         std::lock_guard<std::mutex> lock(m_mutex);
         if (m_stopping || m_phase != phase::accepting)
-            return;
-        m_pending.emplace_back(std::forward<Fn>(fn));
+            return false;
+        if (not m_pending.emplace_back(std::forward<Fn>(fn)))
+            return false;
         m_tasks_submitted += 1;
+        return true;
     }
 
     void submit() noexcept
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (m_stopping || m_phase != phase::accepting)
-            return;
-        m_batch_size = static_cast<u32>(m_pending.size());
-        m_next_index = 0;
-        m_completed  = 0;
-        m_phase = (m_batch_size == 0) ? phase::accepting : phase::executing;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping || m_phase != phase::accepting)
+                return;
+
+            const auto size = static_cast<u32>(m_pending.size());
+            if (size == 0)
+                return;
+
+            m_phase = phase::executing;
+            m_completed.store(0, std::memory_order_relaxed);
+            m_cursor.store(make_cursor(size, 0), std::memory_order_release);
+        }
+
+        if (m_parking)
+            m_parking->notify();
     }
 
-    bool try_steal(task& out) noexcept
+    /// Claim at most @c grain tasks. The claimed tasks are the indices
+    /// `[first, first + count[` of the @c task() function. Returns false if
+    /// all the tasks of the current batch are claimed.
+    bool try_claim(const u32 grain, u32& first, u32& count) noexcept
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (m_stopping || m_phase != phase::executing)
+        if (m_stopping.load(std::memory_order_relaxed))
             return false;
-        if (m_next_index >= m_batch_size)
-            return false;
-        out = std::move(m_pending[m_next_index++]);
-        m_tasks_completed += 1;
-        return true;
+
+        auto cursor = m_cursor.load(std::memory_order_acquire);
+        while (true) {
+            const auto size = cursor_size(cursor);
+            const auto next = cursor_next(cursor);
+            if (next >= size)
+                return false;
+
+            const auto n = std::min(grain, size - next);
+            if (m_cursor.compare_exchange_weak(cursor,
+                                               make_cursor(size, next + n),
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+                first = next;
+                count = n;
+                return true;
+            }
+        }
+    }
+
+    /// Number of tasks not yet claimed in the current batch.
+    u32 remaining() const noexcept
+    {
+        const auto cursor = m_cursor.load(std::memory_order_relaxed);
+        return cursor_size(cursor) - cursor_next(cursor);
     }
 
+    /// Access to a claimed task.
+    task& get(const u32 index) noexcept { return m_pending[index]; }
+
+    /// Must be called once for each claimed task after its execution.
     void notify_done() noexcept
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (m_phase != phase::executing)
+        m_tasks_completed.fetch_add(1, std::memory_order_relaxed);
+
+        const auto size = cursor_size(m_cursor.load(std::memory_order_relaxed));
+        if (m_completed.fetch_add(1, std::memory_order_acq_rel) + 1 != size)
             return;
-        ++m_completed;
-        if (m_completed >= m_batch_size) {
-            m_phase = phase::accepting;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
             m_pending.clear();
-            m_producer_cv.notify_all();
+            if (m_phase == phase::executing)
+                m_phase = phase::accepting;
         }
+
+        m_producer_cv.notify_all();
     }
 
     void wait_completion() noexcept
     {
         std::unique_lock<std::mutex> lock(m_mutex);
-        m_producer_cv.wait(lock, [&] {
-            return m_stopping || m_phase == phase::accepting ||
-                   (m_phase == phase::executing && m_completed >= m_batch_size);
-        });
+        m_producer_cv.wait(
+          lock, [&] { return m_stopping || m_phase == phase::accepting; });
     }
 
     void shutdown() noexcept
@@ -245,78 +439,100 @@ public:
             m_phase    = phase::shutting_down;
         }
         m_producer_cv.notify_all();
+
+        if (m_parking)
+            m_parking->notify();
     }
 
-    bool stopping() const
+    bool stopping() const noexcept
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_stopping;
+        return m_stopping.load(std::memory_order_relaxed);
     }
 
     u64 tasks_submitted() const noexcept { return m_tasks_submitted; }
-    u64 tasks_completed() const noexcept { return m_tasks_completed; }
+    u64 tasks_completed() const noexcept
+    {
+        return m_tasks_completed.load(std::memory_order_relaxed);
+    }
 
 private:
     enum class phase : uint8_t { accepting, executing, shutting_down };
 
-    vector<task> m_pending;
+    /// The cursor merges the size of the batch and the index of the next
+    /// task to claim to detect a new batch in the @c try_claim() function.
+    static constexpr u64 make_cursor(const u32 size, const u32 next) noexcept
+    {
+        return (static_cast<u64>(size) << 32) | next;
+    }
 
-    u64 m_tasks_submitted{ 0 };
-    u64 m_tasks_completed{ 0 };
-    u32 m_batch_size{ 0 };
-    u32 m_next_index{ 0 };
-    u32 m_completed{ 0 };
+    static constexpr u32 cursor_size(const u64 cursor) noexcept
+    {
+        return static_cast<u32>(cursor >> 32);
+    }
+
+    static constexpr u32 cursor_next(const u64 cursor) noexcept
+    {
+        return static_cast<u32>(cursor & 0xffffffff);
+    }
+
+    vector<task>  m_pending;
+    task_parking* m_parking = nullptr;
+
+    u64              m_tasks_submitted{ 0 };
+    std::atomic<u64> m_tasks_completed{ 0 };
+
+    alignas(64) std::atomic<u64> m_cursor{ 0 };
+    alignas(64) std::atomic<u32> m_completed{ 0 };
 
     mutable std::mutex      m_mutex;
     std::condition_variable m_producer_cv;
 
-    phase m_phase{ phase::accepting };
-    bool  m_stopping{ false };
+    phase             m_phase{ phase::accepting };
+    std::atomic<bool> m_stopping{ false };
 };
 
+/// A worker executes the tasks of all the @c unordered_task_list. Claimed
+/// tasks are pushed into its own @c work_stealing_deque where others workers
+/// can steal them. Without work, the worker waits on the @c task_parking.
 class unordered_worker
 {
 public:
-    explicit unordered_worker(std::span<unordered_task_list> lists) noexcept
+    unordered_worker(std::span<unordered_task_list> lists,
+                     std::span<unordered_worker>    workers,
+                     task_parking&                  parking,
+                     const u32                      id) noexcept
       : m_lists(lists)
+      , m_workers(workers)
+      , m_parking(&parking)
+      , m_id(id)
     {}
 
     unordered_worker(unordered_worker&& other) noexcept
       : m_lists(other.m_lists)
+      , m_workers(other.m_workers)
+      , m_parking(other.m_parking)
+      , m_id(other.m_id)
+      , m_deque(std::move(other.m_deque))
       , m_thread(std::move(other.m_thread))
-      , m_tasks_completed(other.m_tasks_completed)
-      , m_execution_time(other.m_execution_time)
+      , m_tasks_completed(other.m_tasks_completed.load())
+      , m_execution_time(other.m_execution_time.load())
     {}
 
     void start() noexcept
     {
         m_thread = std::thread([this] {
             while (true) {
-                bool found = false;
-                for (auto& l : m_lists) {
-                    task t;
-                    while (l.try_steal(t)) {
-                        found = true;
-                        try {
-                            const auto start = std::chrono::steady_clock::now();
-                            t();
-                            m_execution_time =
-                              (std::chrono::steady_clock::now() - start)
-                                .count();
-                            m_tasks_completed += 1;
-                        } catch (...) {
-                        }
-                        l.notify_done();
-                    }
-                }
-                if (!found) {
-                    if (std::all_of(m_lists.begin(),
-                                    m_lists.end(),
-                                    [](const auto& l) { return l.stopping(); }))
-                        break;
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                    // std::this_thread::yield();
-                }
+                const auto epoch = m_parking->prepare();
+
+                if (run_once())
+                    continue;
+
+                if (std::all_of(m_lists.begin(),
+                                m_lists.end(),
+                                [](const auto& l) { return l.stopping(); }))
+                    break;
+
+                m_parking->wait(epoch);
             }
         });
     }
@@ -327,14 +543,93 @@ public:
             m_thread.join();
     }
 
-    u64 tasks_completed() const noexcept { return m_tasks_completed; }
+    u64 tasks_completed() const noexcept
+    {
+        return m_tasks_completed.load(std::memory_order_relaxed);
+    }
+
+    /// Sum of the durations of all the tasks executed by this worker.
+    std::chrono::nanoseconds::rep execution_time() const noexcept
+    {
+        return m_execution_time.load(std::memory_order_relaxed);
+    }
 
 private:
+    static constexpr u64 make_item(const u32 list, const u32 index) noexcept
+    {
+        return (static_cast<u64>(list) << 32) | index;
+    }
+
+    void execute(const u64 item) noexcept
+    {
+        auto& l = m_lists[static_cast<u32>(item >> 32)];
+
+        try {
+            const auto start = std::chrono::steady_clock::now();
+            l.get(static_cast<u32>(item & 0xffffffff))();
+            m_execution_time.fetch_add(
+              (std::chrono::steady_clock::now() - start).count(),
+              std::memory_order_relaxed);
+            m_tasks_completed.fetch_add(1, std::memory_order_relaxed);
+        } catch (...) {
+        }
+
+        l.notify_done();
+    }
+
+    /// Execute at most one task from the deque, the lists or the other
+    /// workers. Returns false if no task is found.
+    bool run_once() noexcept
+    {
+        u64 item = 0;
+        if (m_deque.pop(item)) {
+            execute(item);
+            return true;
+        }
+
+        // Claims a decreasing number of tasks: large ranges at the begin of
+        // the batch, one task at the end to keep the workers balanced.
+        const auto workers = static_cast<u32>(m_workers.size());
+        for (u32 i = 0, e = static_cast<u32>(m_lists.size()); i < e; ++i) {
+            const auto grain = std::clamp<u32>(
+              m_lists[i].remaining() / (2u * workers),
+              1u,
+              static_cast<u32>(m_deque.available()));
+
+            u32 first = 0, count = 0;
+            if (m_lists[i].try_claim(grain, first, count)) {
+                for (u32 j = 1; j < count; ++j)
+                    m_deque.push(make_item(i, first + j));
+
+                if (count > 1)
+                    m_parking->notify();
+
+                execute(make_item(i, first));
+                return true;
+            }
+        }
+
+        for (u32 i = 1; i < workers; ++i) {
+            auto& victim = m_workers[(m_id + i) % workers];
+            if (victim.m_deque.steal(item)) {
+                execute(item);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     std::span<unordered_task_list> m_lists;
-    std::thread                    m_thread;
+    std::span<unordered_worker>    m_workers;
+    task_parking*                  m_parking;
+    u32                            m_id;
+
+    work_stealing_deque m_deque;
+    std::thread         m_thread;
 
-    u64                           m_tasks_completed{ 0 };
-    std::chrono::nanoseconds::rep m_execution_time;
+    std::atomic<u64>                           m_tasks_completed{ 0 };
+    std::atomic<std::chrono::nanoseconds::rep> m_execution_time{ 0 };
 };
 
 class task_manager
@@ -354,11 +649,17 @@ public:
         for (auto& l : m_ordered_lists)
             m_ordered_workers.emplace_back(l);
 
-        const auto span = std::span<unordered_task_list>(
+        for (auto& l : m_unordered_lists)
+            l.attach(m_parking);
+
+        const auto lists = std::span<unordered_task_list>(
           m_unordered_lists.data(), m_unordered_lists.size());
+        const auto workers = std::span<unordered_worker>(
+          m_unordered_workers.data(), m_unordered_workers.capacity());
 
         for (sz i = 0, e = m_unordered_workers.capacity(); i < e; ++i)
-            m_unordered_workers.emplace_back(span);
+            m_unordered_workers.emplace_back(
+              lists, workers, m_parking, static_cast<u32>(i));
     }
 
     void start()
@@ -411,16 +712,18 @@ public:
     std::chrono::nanoseconds::rep wordered_execution_time(
       std::integral auto i) const noexcept
     {
-        return m_ordered_workers[i].tasks_completed();
+        return m_ordered_workers[i].execution_time();
     }
 
     std::chrono::nanoseconds::rep wunordered_execution_time(
       std::integral auto i) const noexcept
     {
-        return m_unordered_workers[i].tasks_completed();
+        return m_unordered_workers[i].execution_time();
     }
 
 private:
+    task_parking m_parking;
+
     vector<ordered_task_list> m_ordered_lists;
     vector<ordered_worker>    m_ordered_workers;
 
@@ -428,6 +731,63 @@ private:
     vector<unordered_worker>    m_unordered_workers;
 };
 
+/// An executor for the @c simulation::run(Executor&) function. The
+/// transitions of a bag are split into tasks added to an @c
+/// unordered_task_list of the @c task_manager. The list must be reserved to
+/// this executor: tasks added by other producers between two @c
+/// parallel_for calls are executed in the same batch.
+class simulation_bag_executor
+{
+public:
+    simulation_bag_executor(task_manager& tm, std::integral auto list) noexcept
+      : m_list(&tm.unordered(list))
+      , m_concurrency(static_cast<unsigned>(tm.wunordered_size()))
+    {}
+
+    unsigned concurrency() const noexcept { return m_concurrency; }
+
+    /// Call `fn(i)` for each `i` in `[0, n[` onto the unordered workers and
+    /// wait for the completion of all tasks. The indices refused by the list
+    /// (see @c unordered_task_list::add()) run on the caller thread.
+    template<typename Fn>
+    void parallel_for(const unsigned n, Fn&& fn) noexcept
+    {
+        unsigned added = 0;
+        for (unsigned i = 0; i < n; ++i) {
+            if (m_list->add([&fn, i]() noexcept { fn(i); }))
+                ++added;
+            else
+                fn(i);
+        }
+
+        if (added > 0) {
+            m_list->submit();
+            m_list->wait_completion();
+        }
+    }
+
+private:
+    unordered_task_list* m_list;
+    unsigned             m_concurrency;
+};
+
+/// Call `fn(i)` for each `i` in `[0, n[` onto the workers of the @c
+/// executor. The loop runs on the caller thread if @c executor is null or for
+/// less than @c min_parallel iterations.
+template<typename Fn>
+void parallel_for(simulation_bag_executor* executor,
+                  const unsigned           n,
+                  Fn&&                     fn,
+                  const unsigned           min_parallel = 2) noexcept
+{
+    if (executor and n >= min_parallel) {
+        executor->parallel_for(n, fn);
+    } else {
+        for (unsigned i = 0; i < n; ++i)
+            fn(i);
+    }
+}
+
 } // namespace irt
 
 #endif
@@ -7,26 +7,53 @@
 
 #include <irritator/core.hpp>
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <span>
+#include <thread>
+
 namespace irt {
 
 /// Stores a simulation-snapshot circular buffer.
 ///
 /// This class stores simulation snapshot and build a timeline of simulations.
+/// Every @c keyframe_interval snapshots, a keyframe stores a full copy of the
+/// models, nodes, output ports, dated messages and scheduler. The others
+/// snapshots store only the elements changed since the previous snapshot:
+/// the models listed by the @c simulation::changed_models and the nodes,
+/// output ports, dated messages and scheduler nodes different from a shadow
+/// copy of the latest state. The observers are copied in each snapshot.
 class simulation_snapshot_handler
 {
 public:
     using size_type  = vector<simulation_snapshot>::size_type;
     using index_type = std::make_signed_t<size_type>;
 
-    constexpr simulation_snapshot_handler() noexcept = default;
-    explicit simulation_snapshot_handler(const int capacity) noexcept;
+    simulation_snapshot_handler() noexcept = default;
+    explicit simulation_snapshot_handler(
+      const int capacity,
+      const int keyframe_interval = 16) noexcept;
 
     bool reserve(const int capacity) noexcept;
-    void emplace_back(const simulation& sim) noexcept;
+
+    /// Append a snapshot of @c sim. The oldest snapshot is removed if the
+    /// ring-buffer is full. Enables the @c simulation::track_changed_models
+    /// of @c sim and clears its @c simulation::changed_models.
+    void emplace_back(simulation& sim) noexcept;
+
+    /// Assign to @c sim the state of the snapshot @c snap: the nearest
+    /// keyframe older or equal to @c snap and the following deltas.
+    void restore(simulation&                sim,
+                 const simulation_snapshot& snap) const noexcept;
 
     /// Clear the ring-buffer without deallocation.
     constexpr void reset() noexcept;
 
+    /// Remove the oldest element if the ring-buffer is not empty. If the
+    /// next element is a delta, it becomes a keyframe.
+    void pop_front() noexcept;
+
     /// Return nullptr if empty otherwise the oldest element.
     constexpr simulation_snapshot*       front() noexcept;
     constexpr const simulation_snapshot* front() const noexcept;
@@ -51,20 +78,338 @@ public:
     constexpr const simulation_snapshot* ptr_from_index(int idx) const noexcept;
 
 private:
+    /// Allocation state of the models of the latest snapshot: a delta needs
+    /// the same identifiers at the same positions.
+    struct models_layout {
+        int      capacity = 0;
+        int      max_used = 0;
+        unsigned size     = 0;
+        u32      next_key = 0;
+
+        bool operator==(const models_layout&) const noexcept = default;
+    };
+
+    static models_layout layout_of(
+      const data_array<model, model_id>& models) noexcept;
+
     vector<simulation_snapshot> ring;
 
+    models_layout                                            m_models;
+    data_array<block_node, block_node_id>                    m_nodes;
+    data_array<output_port, output_port_id>                  m_output_ports;
+    data_array<ring_buffer<dated_message>, dated_message_id> m_dated_messages;
+    scheduller<allocator<new_delete_memory_resource>>        m_sched;
+
     std::size_t m_front    = 0;
     std::size_t m_back     = 0;
     std::size_t m_capacity = 1;
+
+    int  m_keyframe_interval = 16;
+    int  m_since_keyframe    = 0;
+    bool m_shadow_valid      = false;
+};
+
+/// A date and the index of a bag at this date. The partitioned simulations
+/// order the bags by date and by round.
+struct bag_time {
+    time t     = time_domain<time>::negative_infinity;
+    u32  round = 0;
+
+    friend bool operator==(const bag_time& a, const bag_time& b) noexcept
+    {
+        return a.t == b.t and a.round == b.round;
+    }
+
+    friend bool operator<(const bag_time& a, const bag_time& b) noexcept
+    {
+        return a.t < b.t or (a.t == b.t and a.round < b.round);
+    }
+};
+
+/// A message between two partitions sent by the bag @c round at the date @c t.
+/// @c id is unique for the sender and used by the anti-message to cancel the
+/// message.
+struct remote_message {
+    message  msg;
+    time     t;
+    u32      round;
+    u64      id;
+    model_id mdl;
+    i8       port;
+    bool     anti      = false;
+    bool     delivered = false;
+
+    /// The bag of the receiver where the message is delivered: the next round
+    /// like the zero-delay routing of the @c simulation::run() function.
+    bag_time delivery() const noexcept { return { t, round + 1u }; }
+};
+
+/// The destination of an output port in another partition.
+struct remote_node {
+    model_id mdl;
+    i8       port;
+    u32      partition;
+};
+
+/// An optimistic (Time Warp) parallel simulation.
+///
+/// The models of a simulation are split into partitions. Each partition is a
+/// copy of the simulation where the models of the others partitions are
+/// deleted and runs its own @c simulation::run() loop onto its own thread.
+/// Connections between partitions are replaced by timestamped messages. A
+/// partition receiving a message older than its last bag (a straggler)
+/// restores its latest @c simulation_snapshot older than the message, sends
+/// anti-messages to cancel the messages sent since this snapshot and executes
+/// again. The cancellation is lazy: a message sent again with the same date
+/// and value after a rollback is not cancelled. The global virtual time (GVT)
+/// is computed periodically to free the snapshots and messages no longer
+/// needed (fossil collection) and to detect the end of the simulation.
+///
+/// Bags are ordered by date and by round, the index of the bag at this date. A
+/// message sent by the round @c r is delivered in the round @c r+1 like the
+/// zero-delay routing of the sequential @c simulation::run() function: the
+/// partitions execute the same bags as the sequential simulation whatever the
+/// arrival order of the messages.
+class optimistic_simulation
+{
+public:
+    /// Number of snapshots stored by each partition. A partition with a full
+    /// ring waits for the next GVT computation before executing new bags.
+    explicit optimistic_simulation(int snapshot_capacity = 64) noexcept;
+
+    optimistic_simulation(const optimistic_simulation&)            = delete;
+    optimistic_simulation& operator=(const optimistic_simulation&) = delete;
+
+    /// Split the simulation @c sim into partitions. The partition of the model
+    /// @c id is `partitions[get_index(id)]`. Models keep their identifiers in
+    /// the partitions.
+    status init(const simulation& sim, std::span<const u32> partitions) noexcept;
+
+    /// Call the @c simulation::initialize() function of each partition and
+    /// store the initial snapshots.
+    status initialize() noexcept;
+
+    /// Run all partitions until the GVT reaches the end of the @c time_limit
+    /// of the simulation. Returns the first error of the partitions.
+    status run() noexcept;
+
+    /// Call the @c simulation::finalize() function of each partition.
+    status finalize() noexcept;
+
+    int size() const noexcept { return m_partitions.ssize(); }
+
+    /// The simulation of the partition @c i.
+    simulation& operator[](std::integral auto i) noexcept
+    {
+        return m_partitions[i].sim;
+    }
+
+    const simulation& operator[](std::integral auto i) const noexcept
+    {
+        return m_partitions[i].sim;
+    }
+
+    /// The latest global virtual time computed by the @c run() function.
+    time gvt() const noexcept { return m_gvt; }
+
+    /// Number of rollbacks of all partitions since the last @c initialize().
+    u64 rollbacks() const noexcept;
+
+    /// Duration between two computations of the GVT.
+    std::chrono::microseconds gvt_interval{ 1000 };
+
+private:
+    /// A message sent to another partition. After a rollback, the messages
+    /// not older than the straggler are @c pending: they are cancelled if the
+    /// partition does not send them again.
+    struct sent_message {
+        message  msg;
+        time     t;
+        u32      round;
+        u64      id;
+        model_id mdl;
+        i8       port;
+        u32      partition;
+        bool     pending = false;
+    };
+
+    struct partition {
+        partition() noexcept = default;
+
+        /// Only valid when no thread uses the partition.
+        partition(partition&& other) noexcept;
+
+        simulation                  sim;
+        simulation_snapshot         initial;
+        simulation_snapshot_handler snaps;
+
+        /// The destinations in the others partitions of the output port @c
+        /// id are the @c links in the range `[link_offsets[get_index(id)],
+        /// link_offsets[get_index(id) + 1][`.
+        vector<u32>         link_offsets;
+        vector<remote_node> links;
+
+        /// The received messages sorted by date. Messages are kept after the
+        /// delivery to be delivered again after a rollback.
+        vector<remote_message> inputs;
+        vector<sent_message>   outputs;
+
+        /// Messages and anti-messages sent by others partitions.
+        std::mutex              mutex;
+        std::condition_variable cv;
+        vector<remote_message>  mailbox;
+        vector<remote_message>  received;
+
+        /// Date of the last bag or negative infinity before the first bag.
+        time t_last = time_domain<time>::negative_infinity;
+        u32  round  = 0;
+
+        /// After a rollback, bags older than @c coast are executed again
+        /// without sending messages, the messages are already sent.
+        time coast = time_domain<time>::negative_infinity;
+
+        u64    sequence  = 0;
+        u64    rollbacks = 0;
+        status result;
+    };
+
+    /// Date and round of the next bag of the partition: the lowest of the
+    /// scheduller and of the messages not yet delivered.
+    bag_time next_time(const partition& p) const noexcept;
+
+    void   loop(u32 id) noexcept;
+    status receive(partition& p) noexcept;
+    status rollback(partition& p, time t) noexcept;
+    status cancel(partition& p, bag_time next) noexcept;
+    status step(u32 id, bag_time next) noexcept;
+    void   fossil_collect(partition& p, time gvt) noexcept;
+    bool   send(u32 to, const remote_message& msg) noexcept;
+    bool   wait_gvt(u32 id) noexcept;
+    void   wait_messages(u32 id) noexcept;
+
+    vector<partition> m_partitions;
+    int               m_snapshot_capacity;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    u32                     m_parked = 0;
+    u32                     m_idle   = 0;
+    u64                     m_epoch  = 0;
+    std::atomic_bool        m_pause  = false;
+    bool                    m_stop   = false;
+
+    time m_gvt = time_domain<time>::negative_infinity;
+};
+
+/// A conservative parallel simulation for models with local connections like
+/// the cells of a @c grid_component (see @c project::build_grid_partitions()).
+///
+/// The partitions are built like the @c optimistic_simulation partitions but
+/// advance in lock-step windows without rollback. Models send messages only
+/// during their internal transitions so a partition does not send messages
+/// before its next bag: during a window, each partition executes its bags
+/// older than the next bags of the partitions connected to its inputs and the
+/// oldest bag of all partitions. The messages between partitions are
+/// exchanged at the end of each window and delivered in the next round of
+/// their date. The results do not depend on the number of partitions.
+class conservative_simulation
+{
+public:
+    conservative_simulation() noexcept = default;
+
+    conservative_simulation(const conservative_simulation&)            = delete;
+    conservative_simulation& operator=(const conservative_simulation&) = delete;
+
+    /// Split the simulation @c sim into partitions. The partition of the model
+    /// @c id is `partitions[get_index(id)]`. Models keep their identifiers in
+    /// the partitions.
+    status init(const simulation& sim, std::span<const u32> partitions) noexcept;
+
+    /// Call the @c simulation::initialize() function of each partition.
+    status initialize() noexcept;
+
+    /// Run all partitions, one thread per partition, until the end of the @c
+    /// time_limit of the simulation. Returns the first error of the
+    /// partitions.
+    status run() noexcept;
+
+    /// Call the @c simulation::finalize() function of each partition.
+    status finalize() noexcept;
+
+    int size() const noexcept { return m_partitions.ssize(); }
+
+    /// The simulation of the partition @c i.
+    simulation& operator[](std::integral auto i) noexcept
+    {
+        return m_partitions[i].sim;
+    }
+
+    const simulation& operator[](std::integral auto i) const noexcept
+    {
+        return m_partitions[i].sim;
+    }
+
+    /// Number of windows executed by the last @c run().
+    u64 windows() const noexcept { return m_windows; }
+
+private:
+    struct partition {
+        partition() noexcept = default;
+
+        /// Only valid when no thread uses the partition.
+        partition(partition&& other) noexcept;
+
+        simulation sim;
+
+        /// The destinations in the others partitions of the output port @c
+        /// id are the @c links in the range `[link_offsets[get_index(id)],
+        /// link_offsets[get_index(id) + 1][`.
+        vector<u32>         link_offsets;
+        vector<remote_node> links;
+
+        /// The partitions connected to the outputs (sorted) and the messages
+        /// sent to them during the current window. Each @c outboxes element
+        /// is written by this partition during the window and read by its
+        /// destination after the window.
+        vector<u32>                    targets;
+        vector<vector<remote_message>> outboxes;
+
+        /// The partitions connected to the inputs.
+        vector<u32> sources;
+
+        /// The received messages sorted by delivery.
+        vector<remote_message> inputs;
+
+        /// Next bag computed at the beginning of the window.
+        bag_time next;
+
+        /// Date and round of the last bag.
+        time t_last = time_domain<time>::negative_infinity;
+        u32  round  = 0;
+
+        status result;
+    };
+
+    status receive(u32 id) noexcept;
+    status execute(u32 id) noexcept;
+    status step(partition& p, bag_time next) noexcept;
+    void   end_window() noexcept;
+
+    vector<partition> m_partitions;
+
+    bag_time m_next;
+    bool     m_stop    = false;
+    u64      m_windows = 0;
 };
 
 // Implementation
 
 inline constexpr void simulation_snapshot_handler::reset() noexcept
 {
-    m_front    = 0;
-    m_back     = 0;
-    m_capacity = ring.capacity() + 1;
+    m_front        = 0;
+    m_back         = 0;
+    m_capacity     = ring.empty() ? 1 : ring.size();
+    m_shadow_valid = false;
 }
 
 inline constexpr simulation_snapshot*
@@ -106,14 +451,14 @@ inline constexpr bool simulation_snapshot_handler::next(
         return true;
     }
 
-    const auto idx = ring.index_of(snap);
+    const auto idx = (*ring.index_of(snap) + 1) % m_capacity;
 
-    if ((*idx + 1) % m_capacity == m_front) {
+    if (idx == m_back) {
         snap = nullptr;
         return false;
     }
 
-    snap = std::addressof(ring[*idx + 1]);
+    snap = std::addressof(ring[idx]);
     return true;
 }
 
@@ -128,14 +473,14 @@ inline constexpr bool simulation_snapshot_handler::next(
         return true;
     }
 
-    const auto idx = ring.index_of(snap);
+    const auto idx = (*ring.index_of(snap) + 1) % m_capacity;
 
-    if ((*idx + 1) % m_capacity == m_front) {
+    if (idx == m_back) {
         snap = nullptr;
         return false;
     }
 
-    snap = std::addressof(ring[*idx + 1]);
+    snap = std::addressof(ring[idx]);
     return true;
 }
 
@@ -193,10 +538,8 @@ inline constexpr void simulation_snapshot_handler::erase_after(
 
     const auto idx = ring.index_of(snap);
 
-    if ((*idx + 1) % m_capacity == m_front)
-        return;
-
-    m_back = *idx + 1;
+    m_back         = (*idx + 1) % m_capacity;
+    m_shadow_valid = false;
 }
 
 inline constexpr simulation_snapshot_handler::size_type
@@ -4,7 +4,13 @@
 
 #include <irritator/archiver.hpp>
 #include <irritator/io.hpp>
+#include <irritator/thread.hpp>
+
+#include <atomic>
 #include <type_traits>
+#include <utility>
+
+#include <cstring>
 
 namespace irt {
 
@@ -16,10 +22,86 @@ struct file_header {
 
     i32       code    = 0x11223344;
     i32       length  = sizeof(file_header);
-    i32       version = 1;
+    i32       version = 2;
     mode_type type    = mode_type::all;
 };
 
+/// The chunks of the version 2 format. Each chunk starts with the number of
+/// elements it stores.
+enum class archive_chunk_type : u32 {
+    constant_sources,
+    binary_file_sources,
+    text_file_sources,
+    random_sources,
+    hsms,
+    models,
+    connections,
+};
+
+constexpr u32 archive_chunk_type_size = 7u;
+
+/// An entry of the table of contents of the version 2 format. The @c offset
+/// is from the beginning of the file.
+struct archive_toc_entry {
+    enum class flag_type : u32 { none = 0, compressed = 1 };
+
+    archive_chunk_type type     = archive_chunk_type::models;
+    flag_type          flags    = flag_type::none;
+    u64                offset   = 0;
+    u64                size     = 0;
+    u64                raw_size = 0;
+};
+
+/// Number of models stored in a models chunk.
+constexpr u32 archive_models_per_chunk = 65536u;
+
+/// A growable memory stream used to encode one chunk.
+struct chunk_writer {
+    vector<u8> data;
+
+    bool write(const void* buffer, i64 length) noexcept
+    {
+        const auto pos = data.ssize();
+        if (not data.resize(pos + length))
+            return false;
+
+        std::memcpy(data.data() + pos, buffer, static_cast<size_t>(length));
+        return true;
+    }
+
+    template<typename T>
+        requires(std::is_arithmetic_v<T>)
+    bool write(const T value) noexcept
+    {
+        return write(&value, sizeof(T));
+    }
+};
+
+/// A read-only memory stream over a decoded chunk or a memory-mapped file.
+struct chunk_reader {
+    std::span<const u8> data;
+    size_t              pos = 0;
+
+    bool is_eof() const noexcept { return pos == data.size(); }
+
+    bool read(void* buffer, i64 length) noexcept
+    {
+        if (length < 0 or data.size() - pos < static_cast<size_t>(length))
+            return false;
+
+        std::memcpy(buffer, data.data() + pos, static_cast<size_t>(length));
+        pos += static_cast<size_t>(length);
+        return true;
+    }
+
+    template<typename T>
+        requires(std::is_arithmetic_v<T>)
+    bool read(T& value) noexcept
+    {
+        return read(&value, sizeof(T));
+    }
+};
+
 struct archiver_tag_type {};
 struct dearchiver_tag_type {};
 
@@ -78,7 +160,7 @@ struct input_stream {
     template<typename T>
     bool operator()(T* buffer, std::integral auto size) noexcept
     {
-        return !!stream.read(buffer, size);
+        return !!stream.read(buffer, size * sizeof(T));
     }
 
     template<std::integral auto Size>
@@ -143,7 +225,7 @@ struct output_stream {
     template<typename T>
     bool operator()(const T* buffer, std::integral auto size) noexcept
     {
-        return !!stream.write(buffer, size);
+        return !!stream.write(buffer, size * sizeof(T));
     }
 
     template<std::integral auto Size>
@@ -163,16 +245,20 @@ struct output_stream {
     Support& stream;
 };
 
-using ifile = input_stream<file>;
-using ofile = output_stream<file>;
-using imem  = input_stream<memory>;
-using omem  = output_stream<memory>;
+using ifile   = input_stream<file>;
+using ofile   = output_stream<file>;
+using imem    = input_stream<memory>;
+using omem    = output_stream<memory>;
+using ichunk  = input_stream<chunk_reader>;
+using ochunk  = output_stream<chunk_writer>;
 
 template<typename T>
-concept IsInputStream = std::is_same_v<T, ifile> or std::is_same_v<T, imem>;
+concept IsInputStream = std::is_same_v<T, ifile> or std::is_same_v<T, imem> or
+                        std::is_same_v<T, ichunk>;
 
 template<typename T>
-concept IsOutputStream = std::is_same_v<T, ofile> or std::is_same_v<T, omem>;
+concept IsOutputStream = std::is_same_v<T, ofile> or
+                         std::is_same_v<T, omem> or std::is_same_v<T, ochunk>;
 
 template<typename T>
 concept IsStream = IsInputStream<T> or IsOutputStream<T>;
@@ -207,6 +293,179 @@ bool io(Stream&                   stream,
                   sizeof(decltype(*buf)) * size);
 }
 
+/// Compresses @c src into @c dst with a byte-oriented LZ77 codec close to
+/// LZ4: each sequence is a token (literals and match lengths on 4 bits,
+/// extended by runs of 255), the literals, the 16 bits offset and the
+/// match length extension. The last sequence has no match. Returns @c false
+/// if the compressed buffer is not smaller than @c src.
+static bool lz_compress(std::span<const u8> src, vector<u8>& dst) noexcept
+{
+    constexpr int    hash_log   = 14;
+    constexpr size_t min_match  = 4;
+    constexpr size_t max_offset = 65535;
+
+    const auto n = src.size();
+
+    vector<u32> hashes(1 << hash_log, 0u);
+    dst.clear();
+    if (not(hashes.ssize() == (1 << hash_log) and dst.reserve(n)))
+        return false;
+
+    const auto put_length = [&](size_t length) noexcept {
+        for (; length >= 255; length -= 255)
+            dst.push_back(255);
+        dst.push_back(static_cast<u8>(length));
+    };
+
+    const auto put_sequence = [&](size_t anchor,
+                                  size_t literals,
+                                  size_t offset,
+                                  size_t match) noexcept {
+        const auto lit = std::min<size_t>(literals, 15);
+        const auto mat = match ? std::min<size_t>(match - min_match, 15) : 0;
+        dst.push_back(static_cast<u8>((lit << 4) | mat));
+
+        if (lit == 15)
+            put_length(literals - 15);
+
+        if (literals > 0) {
+            const auto pos = dst.ssize();
+            dst.resize(pos + literals);
+            std::memcpy(dst.data() + pos, src.data() + anchor, literals);
+        }
+
+        if (match) {
+            dst.push_back(static_cast<u8>(offset & 0xff));
+            dst.push_back(static_cast<u8>(offset >> 8));
+
+            if (mat == 15)
+                put_length(match - min_match - 15);
+        }
+    };
+
+    size_t anchor = 0;
+    size_t i      = 0;
+
+    while (i + min_match <= n) {
+        u32 sequence;
+        std::memcpy(&sequence, src.data() + i, sizeof(sequence));
+
+        const auto h   = (sequence * 2654435761u) >> (32 - hash_log);
+        const auto ref = hashes[h];
+        hashes[h]      = static_cast<u32>(i + 1);
+
+        if (ref != 0 and i - (ref - 1) <= max_offset and
+            std::memcmp(src.data() + ref - 1, src.data() + i, min_match) ==
+              0) {
+            const auto from  = static_cast<size_t>(ref - 1);
+            auto       match = min_match;
+            while (i + match < n and src[from + match] == src[i + match])
+                ++match;
+
+            put_sequence(anchor, i - anchor, i - from, match);
+            i += match;
+            anchor = i;
+
+            if (dst.size() >= n)
+                return false;
+        } else {
+            ++i;
+        }
+    }
+
+    put_sequence(anchor, n - anchor, 0, 0);
+
+    return dst.size() < n;
+}
+
+/// Decompresses the @c src buffer build by @c lz_compress into @c dst.
+/// Returns @c false if @c src is corrupted or if the decompressed size is not
+/// the size of @c dst.
+static bool lz_decompress(std::span<const u8> src, std::span<u8> dst) noexcept
+{
+    constexpr size_t min_match = 4;
+
+    const auto n  = src.size();
+    size_t     ip = 0;
+    size_t     op = 0;
+
+    const auto get_length = [&](size_t& length) noexcept {
+        u8 byte = 0;
+        do {
+            if (ip >= n)
+                return false;
+            byte = src[ip++];
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (ip < n) {
+        const auto token    = src[ip++];
+        size_t     literals = token >> 4;
+
+        if (literals == 15 and not get_length(literals))
+            return false;
+
+        if (literals > n - ip or literals > dst.size() - op)
+            return false;
+
+        std::memcpy(dst.data() + op, src.data() + ip, literals);
+        ip += literals;
+        op += literals;
+
+        if (ip == n)
+            break;
+
+        if (n - ip < 2)
+            return false;
+
+        const size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+        ip += 2;
+
+        size_t match = token & 15;
+        if (match == 15 and not get_length(match))
+            return false;
+        match += min_match;
+
+        if (offset == 0 or offset > op or match > dst.size() - op)
+            return false;
+
+        if (offset >= match) {
+            std::memcpy(dst.data() + op, dst.data() + op - offset, match);
+            op += match;
+        } else {
+            for (size_t j = 0; j < match; ++j, ++op)
+                dst[op] = dst[op - offset];
+        }
+    }
+
+    return op == dst.size();
+}
+
+/// Builds the dynamics of a model allocated with @c data_array::alloc() and
+/// a @c type already assigned, like @c simulation::alloc() does.
+static void construct_dynamics(model& mdl) noexcept
+{
+    mdl.handle = invalid_heap_handle;
+
+    dispatch(mdl, []<typename Dynamics>(Dynamics& dyn) -> void {
+        std::construct_at(&dyn);
+
+        if constexpr (has_input_port<Dynamics>)
+            for (int i = 0, e = length(dyn.x); i != e; ++i)
+                dyn.x[i].reset();
+
+        if constexpr (has_output_port<Dynamics>)
+            for (int i = 0, e = length(dyn.y); i != e; ++i)
+                dyn.y[i] = undefined<output_port_id>();
+
+        if constexpr (std::is_same_v<Dynamics, hsm_wrapper>) {
+            dyn.id = undefined<hsm_id>();
+        }
+    });
+}
+
 struct binary_archiver::impl {
     binary_archiver& self;
 
@@ -214,23 +473,43 @@ struct binary_archiver::impl {
       : self(self_)
     {}
 
+    /// A chunk of the version 2 format. The encoder uses @c raw, @c packed
+    /// and @c models, the decoder uses @c decoded, @c view, @c count and @c
+    /// first (the rank of the first element among the chunks of same type).
+    struct chunk {
+        archive_toc_entry         entry;
+        chunk_writer              raw;
+        vector<u8>                packed;
+        std::span<const model_id> models;
+
+        vector<u8>          decoded;
+        std::span<const u8> view;
+        u32                 count = 0;
+        u32                 first = 0;
+    };
+
+    static constexpr u64 toc_entry_size = 32u;
+
     bool save(simulation& sim, file& f) noexcept
     {
-        ofile       ofs(f);
-        file_header fh;
+        vector<chunk>    chunks;
+        vector<model_id> ids;
 
-        if (not(ofs(fh.code) and ofs(fh.length) and ofs(fh.version) and
-                ofs(fh.type)))
-            self.report_error(error_code::header_error);
+        if (not encode_chunks(sim, chunks, ids))
+            return self.report_error(error_code::not_enough_memory);
 
-        return do_serialize(sim, ofs);
+        return write_archive(f, chunks);
     }
 
     bool save(simulation& sim, memory& m) noexcept
     {
-        omem ofs(m);
+        vector<chunk>    chunks;
+        vector<model_id> ids;
+
+        if (not encode_chunks(sim, chunks, ids))
+            return self.report_error(error_code::not_enough_memory);
 
-        return do_serialize(sim, ofs);
+        return write_archive(m, chunks);
     }
 
     bool load(simulation& sim, file& f) noexcept
@@ -244,17 +523,395 @@ struct binary_archiver::impl {
             return self.report_error(error_code::format_error);
 
         if (not(fh.code == 0x11223344 and fh.length == sizeof(file_header) and
-                fh.version == 1 and fh.type == file_header::mode_type::all))
+                (fh.version == 1 or fh.version == 2) and
+                fh.type == file_header::mode_type::all))
             return self.report_error(error_code::header_error);
 
-        return do_deserialize(self, sim, ifs);
+        if (fh.version == 1)
+            return do_deserialize(self, sim, ifs);
+
+        const auto length = f.length();
+        vector<u8> buffer;
+        if (not(length > 0 and length <= INT32_MAX and buffer.resize(length)))
+            return self.report_error(error_code::not_enough_memory);
+
+        f.rewind();
+        if (not f.read(buffer.data(), length))
+            return self.report_error(error_code::read_error);
+
+        return decode_archive(sim, std::span<const u8>(buffer.data(), length));
     }
 
     bool load(simulation& sim, memory& m) noexcept
     {
-        imem ifs(m);
+        const auto view = std::span<const u8>(m.data.data() + m.pos,
+                                              m.data.size() - m.pos);
+
+        i32 code = 0;
+        if (view.size() >= sizeof(code))
+            std::memcpy(&code, view.data(), sizeof(code));
+
+        if (code != file_header{}.code) {
+            imem ifs(m);
+
+            return do_deserialize(self, sim, ifs);
+        }
+
+        return decode_archive(sim, view);
+    }
+
+    bool load(simulation& sim, const std::filesystem::path& p) noexcept
+    {
+        const auto map = mapped_file::open(p);
+        if (not map.has_value())
+            return self.report_error(error_code::read_error);
+
+        return decode_archive(
+          sim,
+          std::span<const u8>(reinterpret_cast<const u8*>(map->data()),
+                              map->size()));
+    }
+
+    /// Splits the simulation into chunks (one per external source type, one
+    /// for the hierarchical state machines, blocks of @c
+    /// archive_models_per_chunk models and one for the connections) and
+    /// encodes and compresses them onto the @c executor.
+    bool encode_chunks(simulation&       sim,
+                       vector<chunk>&    chunks,
+                       vector<model_id>& ids) noexcept
+    {
+        if (not ids.reserve(sim.models.size()))
+            return false;
+
+        {
+            model* mdl = nullptr;
+            while (sim.models.next(mdl))
+                ids.emplace_back(sim.models.get_id(*mdl));
+        }
+
+        const auto per_chunk = archive_models_per_chunk;
+        const auto models    = static_cast<u32>(ids.size());
+        const auto blocks    = (models + per_chunk - 1) / per_chunk;
+
+        if (not chunks.resize(6u + blocks))
+            return false;
+
+        chunks[0].entry.type = archive_chunk_type::constant_sources;
+        chunks[1].entry.type = archive_chunk_type::binary_file_sources;
+        chunks[2].entry.type = archive_chunk_type::text_file_sources;
+        chunks[3].entry.type = archive_chunk_type::random_sources;
+        chunks[4].entry.type = archive_chunk_type::hsms;
+
+        for (u32 i = 0; i < blocks; ++i) {
+            const auto first = i * per_chunk;
+
+            chunks[5 + i].entry.type = archive_chunk_type::models;
+            chunks[5 + i].models =
+              std::span<const model_id>(ids.data() + first,
+                                        std::min(per_chunk, models - first));
+        }
+
+        chunks.back().entry.type = archive_chunk_type::connections;
+
+        std::atomic<bool> success = true;
+
+        parallel_for(self.executor,
+                     static_cast<unsigned>(chunks.size()),
+                     [&](const unsigned i) noexcept {
+                         auto&  c = chunks[i];
+                         ochunk os(c.raw);
+
+                         if (not encode_chunk(sim, c, os)) {
+                             success = false;
+                             return;
+                         }
+
+                         const auto raw = std::span<const u8>(
+                           c.raw.data.data(), c.raw.data.size());
+
+                         c.entry.raw_size = raw.size();
+                         if (self.compress and lz_compress(raw, c.packed))
+                             c.entry.flags =
+                               archive_toc_entry::flag_type::compressed;
+                     });
+
+        return success;
+    }
+
+    bool encode_chunk(simulation& sim, chunk& c, ochunk& os) noexcept
+    {
+        switch (c.entry.type) {
+        case archive_chunk_type::constant_sources:
+            return os(static_cast<u32>(sim.srcs.constant_sources.size())) and
+                   do_serialize_constant_sources(os, sim);
+
+        case archive_chunk_type::binary_file_sources:
+            return os(static_cast<u32>(sim.srcs.binary_file_sources.size())) and
+                   do_serialize_binary_file_sources(os, sim);
+
+        case archive_chunk_type::text_file_sources:
+            return os(static_cast<u32>(sim.srcs.text_file_sources.size())) and
+                   do_serialize_text_file_sources(os, sim);
+
+        case archive_chunk_type::random_sources:
+            return os(static_cast<u32>(sim.srcs.random_sources.size())) and
+                   do_serialize_random_sources(os, sim);
+
+        case archive_chunk_type::hsms:
+            return os(static_cast<u32>(sim.hsms.size())) and
+                   do_serialize_hsms(os, sim);
+
+        case archive_chunk_type::models:
+            if (not os(static_cast<u32>(c.models.size())))
+                return false;
+
+            for (const auto id : c.models) {
+                const auto index = static_cast<u32>(get_index(id));
+
+                if (not(os(index) and do_serialize_model(
+                                        os,
+                                        sim.models.get(id),
+                                        sim.parameters[index])))
+                    return false;
+            }
+            return true;
+
+        case archive_chunk_type::connections:
+            return do_serialize_connections(os, sim);
+        }
+
+        unreachable();
+    }
+
+    /// Writes the header, the table of contents and the chunks.
+    template<typename Support>
+    bool write_archive(Support& io, const vector<chunk>& chunks) noexcept
+    {
+        output_stream<Support> ofs(io);
+        file_header            fh;
+
+        const auto count = static_cast<u32>(chunks.size());
+
+        if (not(ofs(fh.code) and ofs(fh.length) and ofs(fh.version) and
+                ofs(fh.type) and ofs(count)))
+            return self.report_error(error_code::header_error);
+
+        auto offset = sizeof(file_header) + sizeof(count) +
+                      static_cast<u64>(count) * toc_entry_size;
+
+        for (const auto& c : chunks) {
+            const auto size =
+              c.entry.flags == archive_toc_entry::flag_type::compressed
+                ? static_cast<u64>(c.packed.size())
+                : c.entry.raw_size;
+
+            if (not(ofs(c.entry.type) and ofs(c.entry.flags) and
+                    ofs(offset) and ofs(size) and ofs(c.entry.raw_size)))
+                return self.report_error(error_code::write_error);
+
+            offset += size;
+        }
+
+        for (const auto& c : chunks) {
+            const auto& data =
+              c.entry.flags == archive_toc_entry::flag_type::compressed
+                ? c.packed
+                : c.raw.data;
+
+            if (not ofs(data.data(), data.size()))
+                return self.report_error(error_code::write_error);
+        }
 
-        return do_deserialize(self, sim, ifs);
+        return true;
+    }
+
+    /// Reads the table of contents of the @c archive buffer, decompresses
+    /// the chunks in parallel then decodes the sources, the state machines
+    /// and the models chunks in parallel. The connections are built at the
+    /// end.
+    bool decode_archive(simulation& sim, std::span<const u8> archive) noexcept
+    {
+        chunk_reader header{ archive };
+        ichunk       is(header);
+        file_header  fh;
+        u32          count = 0;
+
+        if (not(is(fh.code) and is(fh.length) and is(fh.version) and
+                is(fh.type) and is(count)))
+            return self.report_error(error_code::format_error);
+
+        if (not(fh.code == 0x11223344 and fh.length == sizeof(file_header) and
+                fh.version == 2 and fh.type == file_header::mode_type::all))
+            return self.report_error(error_code::header_error);
+
+        if (count > (archive.size() - header.pos) / toc_entry_size)
+            return self.report_error(error_code::format_error);
+
+        vector<chunk> chunks;
+        if (not chunks.resize(count))
+            return self.report_error(error_code::not_enough_memory);
+
+        std::array<u32, archive_chunk_type_size> chunk_numbers{};
+        for (auto& c : chunks) {
+            auto& e = c.entry;
+
+            if (not(is(e.type) and is(e.flags) and is(e.offset) and
+                    is(e.size) and is(e.raw_size)))
+                return self.report_error(error_code::format_error);
+
+            if (ordinal(e.type) >= archive_chunk_type_size or
+                e.offset > archive.size() or
+                e.size > archive.size() - e.offset or e.raw_size > INT32_MAX)
+                return self.report_error(error_code::format_error);
+
+            ++chunk_numbers[ordinal(e.type)];
+        }
+
+        // Only models and connections can be split: sources and state machines
+        // are allocated by one thread per data_array.
+        for (u32 i = 0; i < ordinal(archive_chunk_type::models); ++i)
+            if (chunk_numbers[i] > 1)
+                return self.report_error(error_code::format_error);
+
+        std::atomic<bool> success = true;
+
+        parallel_for(self.executor, count, [&](const unsigned i) noexcept {
+            auto&      c   = chunks[i];
+            const auto src = archive.subspan(c.entry.offset, c.entry.size);
+
+            if (c.entry.flags != archive_toc_entry::flag_type::compressed) {
+                c.view = src;
+                return;
+            }
+
+            if (not(c.decoded.resize(c.entry.raw_size) and
+                    lz_decompress(src,
+                                  std::span<u8>(c.decoded.data(),
+                                                c.decoded.size())))) {
+                success = false;
+                return;
+            }
+
+            c.view = std::span<const u8>(c.decoded.data(), c.decoded.size());
+        });
+
+        if (not success)
+            return self.report_error(error_code::format_error);
+
+        std::array<u32, archive_chunk_type_size> numbers{};
+        for (auto& c : chunks) {
+            chunk_reader r{ c.view };
+            if (not r.read(c.count) or c.count > c.view.size())
+                return self.report_error(error_code::format_error);
+
+            c.first = numbers[ordinal(c.entry.type)];
+            numbers[ordinal(c.entry.type)] += c.count;
+        }
+
+        const auto models = numbers[ordinal(archive_chunk_type::models)];
+        const auto hsms   = numbers[ordinal(archive_chunk_type::hsms)];
+
+        self.clear_cache();
+        sim.clean();
+
+        sim.srcs.constant_sources.clear();
+        sim.srcs.binary_file_sources.clear();
+        sim.srcs.text_file_sources.clear();
+        sim.srcs.random_sources.clear();
+        sim.models.clear();
+        sim.hsms.clear();
+
+        if (not(sim.srcs.constant_sources.reserve(
+                  numbers[ordinal(archive_chunk_type::constant_sources)]) and
+                sim.srcs.binary_file_sources.reserve(
+                  numbers[ordinal(archive_chunk_type::binary_file_sources)]) and
+                sim.srcs.text_file_sources.reserve(
+                  numbers[ordinal(archive_chunk_type::text_file_sources)]) and
+                sim.srcs.random_sources.reserve(
+                  numbers[ordinal(archive_chunk_type::random_sources)]) and
+                sim.hsms.reserve(hsms) and sim.grow_models_to(models) and
+                self.to_models.data.resize(models)))
+            return self.report_error(error_code::not_enough_memory);
+
+        // Models are allocated here in the file order: the decoder of a models
+        // chunk only builds the dynamics and the parameters of its models.
+        vector<model_id> ids(models, reserve_tag);
+        for (u32 i = 0; i < models; ++i)
+            ids.emplace_back(sim.models.get_id(sim.models.alloc()));
+
+        parallel_for(self.executor, count, [&](const unsigned i) noexcept {
+            auto&        c = chunks[i];
+            chunk_reader r{ c.view, sizeof(u32) };
+            ichunk       in(r);
+
+            if (not decode_chunk(sim, c, in, ids))
+                success = false;
+        });
+
+        if (not success) {
+            sim.models.clear();
+            return self.report_error(error_code::format_error);
+        }
+
+        self.to_models.sort();
+
+        for (auto& c : chunks) {
+            if (c.entry.type == archive_chunk_type::connections) {
+                chunk_reader r{ c.view, sizeof(u32) };
+                ichunk       in(r);
+
+                if (not do_deserialize_connections(in, sim, c.count))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool decode_chunk(simulation&               sim,
+                      chunk&                    c,
+                      ichunk&                   is,
+                      std::span<const model_id> ids) noexcept
+    {
+        switch (c.entry.type) {
+        case archive_chunk_type::constant_sources:
+            return do_deserialize_constant_sources(is, sim, c.count);
+
+        case archive_chunk_type::binary_file_sources:
+            return do_deserialize_binary_file_sources(
+              is, sim, c.count, false);
+
+        case archive_chunk_type::text_file_sources:
+            return do_deserialize_text_file_sources(is, sim, c.count, true);
+
+        case archive_chunk_type::random_sources:
+            return do_deserialize_random_sources(is, sim, c.count);
+
+        case archive_chunk_type::hsms:
+            return do_deserialize_hsms(is, sim, c.count);
+
+        case archive_chunk_type::models:
+            for (u32 i = 0; i < c.count; ++i) {
+                u32 index = 0;
+                if (not is(index))
+                    return false;
+
+                const auto id  = ids[c.first + i];
+                auto&      mdl = sim.models.get(id);
+
+                if (not do_deserialize_model(is, sim, mdl))
+                    return false;
+
+                self.to_models.data[c.first + i].id    = index;
+                self.to_models.data[c.first + i].value = id;
+            }
+            return true;
+
+        case archive_chunk_type::connections:
+            return true;
+        }
+
+        unreachable();
     }
 
     template<typename Stream>
@@ -311,7 +968,9 @@ struct binary_archiver::impl {
                 return false;
         }
 
-        return io(hsm.top_state);
+        return io(hsm.top_state) and
+               io(hsm.constants.data(), hsm.constants.size()) and
+               io(hsm.flags);
     }
 
     template<typename Stream>
@@ -354,9 +1013,9 @@ struct binary_archiver::impl {
             if (not(io(size) and size > 0))
                 return false;
 
-            buffer.resize(size);
-            io(buffer.data(), size);
-            buffer[size] = '\0';
+            if (not(buffer.resize(size) and io(buffer.data(), size)))
+                return false;
+
             src.file_path.assign(buffer.begin(), buffer.end());
             return true;
         } else {
@@ -383,9 +1042,9 @@ struct binary_archiver::impl {
             if (not(io(size) and size > 0))
                 return false;
 
-            buffer.resize(size);
-            io(buffer.data(), size);
-            buffer[size] = '\0';
+            if (not(buffer.resize(size) and io(buffer.data(), size)))
+                return false;
+
             src.file_path.assign(buffer.begin(), buffer.end());
             return true;
         } else {
@@ -406,117 +1065,309 @@ struct binary_archiver::impl {
     }
 
     template<typename Stream>
-    bool do_serialize(simulation& sim, Stream& io) noexcept
-    {
-        auto constant_external_source = sim.srcs.constant_sources.ssize();
-        auto binary_external_source   = sim.srcs.binary_file_sources.ssize();
-        auto text_external_source     = sim.srcs.text_file_sources.ssize();
-        auto random_external_source   = sim.srcs.random_sources.ssize();
-        auto models                   = sim.models.ssize();
-        auto hsms                     = sim.hsms.ssize();
-
-        if (not(io(constant_external_source) and io(binary_external_source) and
-                io(text_external_source) and io(random_external_source) and
-                io(models) and io(hsms)))
-            return false;
+    bool do_serialize_constant_sources(Stream& io, simulation& sim) noexcept
+    {
+        constant_source* src = nullptr;
+        while (sim.srcs.constant_sources.next(src)) {
+            auto id    = sim.srcs.constant_sources.get_id(src);
+            auto index = static_cast<u32>(get_index(id));
 
-        {
-            constant_source* src = nullptr;
-            while (sim.srcs.constant_sources.next(src)) {
-                auto id    = sim.srcs.constant_sources.get_id(src);
-                auto index = get_index(id);
+            if (not(io(index) and io(src->length) and
+                    do_serialize_external_source(io, *src)))
+                return false;
+        }
 
-                if (not(io(index) and io(src->length) and
-                        do_serialize_external_source(io, *src)))
-                    return false;
-            }
+        return true;
+    }
+
+    template<typename Stream>
+    bool do_serialize_binary_file_sources(Stream& io, simulation& sim) noexcept
+    {
+        binary_file_source* src = nullptr;
+        while (sim.srcs.binary_file_sources.next(src)) {
+            auto id    = sim.srcs.binary_file_sources.get_id(src);
+            auto index = static_cast<u32>(get_index(id));
+
+            if (not(io(index) and do_serialize_external_source(io, *src)))
+                return false;
         }
 
-        {
-            binary_file_source* src = nullptr;
-            while (sim.srcs.binary_file_sources.next(src)) {
-                auto id    = sim.srcs.binary_file_sources.get_id(src);
-                auto index = get_index(id);
+        return true;
+    }
 
-                if (not(io(index) and io(src->max_clients) and
-                        do_serialize_external_source(io, *src)))
-                    return false;
-            }
+    template<typename Stream>
+    bool do_serialize_text_file_sources(Stream& io, simulation& sim) noexcept
+    {
+        text_file_source* src = nullptr;
+        while (sim.srcs.text_file_sources.next(src)) {
+            auto id    = sim.srcs.text_file_sources.get_id(src);
+            auto index = static_cast<u32>(get_index(id));
+
+            if (not(io(index) and io(src->use_binary_cache) and
+                    do_serialize_external_source(io, *src)))
+                return false;
         }
 
-        {
-            text_file_source* src = nullptr;
-            while (sim.srcs.text_file_sources.next(src)) {
-                auto id    = sim.srcs.text_file_sources.get_id(src);
-                auto index = get_index(id);
+        return true;
+    }
 
-                if (not(io(index) and do_serialize_external_source(io, *src)))
-                    return false;
-            }
+    template<typename Stream>
+    bool do_serialize_random_sources(Stream& io, simulation& sim) noexcept
+    {
+        random_source* src = nullptr;
+        while (sim.srcs.random_sources.next(src)) {
+            auto id    = sim.srcs.random_sources.get_id(src);
+            auto index = static_cast<u32>(get_index(id));
+
+            if (not(io(index) and do_serialize_external_source(io, *src)))
+                return false;
         }
 
-        {
-            random_source* src = nullptr;
-            while (sim.srcs.random_sources.next(src)) {
-                auto id    = sim.srcs.random_sources.get_id(src);
-                auto index = get_index(id);
+        return true;
+    }
 
-                if (not(io(index) and do_serialize_external_source(io, *src)))
-                    return false;
-            }
+    template<typename Stream>
+    bool do_serialize_hsms(Stream& io, simulation& sim) noexcept
+    {
+        hierarchical_state_machine* hsm = nullptr;
+        while (sim.hsms.next(hsm)) {
+            auto id    = sim.hsms.get_id(*hsm);
+            auto index = static_cast<u32>(get_index(id));
+
+            if (not(io(index) and do_serialize(io, *hsm)))
+                return false;
         }
 
-        {
-            hierarchical_state_machine* hsm = nullptr;
-            while (sim.hsms.next(hsm)) {
-                auto id    = sim.hsms.get_id(*hsm);
-                auto index = get_index(id);
+        return true;
+    }
 
-                if (not(io(index) and do_serialize(io, *hsm)))
-                    return false;
-            }
+    /// Writes the number of connections then the output model index, the
+    /// output port, the input model index and the input port of each
+    /// connection.
+    bool do_serialize_connections(ochunk& io, simulation& sim) noexcept
+    {
+        u32  count   = 0;
+        bool written = io(count);
+
+        model* mdl = nullptr;
+        while (written and sim.models.next(mdl)) {
+            const auto out =
+              static_cast<u32>(get_index(sim.models.get_id(*mdl)));
+
+            dispatch(*mdl, [&]<typename Dynamics>(Dynamics& dyn) -> void {
+                if constexpr (has_output_port<Dynamics>) {
+                    for (int i = 0, e = length(dyn.y); i != e; ++i) {
+                        std::as_const(sim).for_each(
+                          dyn.y[i],
+                          [&](const model& dst, const auto port_index) {
+                              const auto in = static_cast<u32>(
+                                get_index(sim.models.get_id(dst)));
+
+                              written = written and io(out) and
+                                        io(static_cast<i8>(i)) and io(in) and
+                                        io(static_cast<i8>(port_index));
+                              ++count;
+                          });
+                    }
+                }
+            });
         }
 
-        {
-            model* mdl = nullptr;
-            while (sim.models.next(mdl)) {
-                const auto id    = sim.models.get_id(*mdl);
-                const auto index = get_index(id);
+        if (written)
+            std::memcpy(io.stream.data.data(), &count, sizeof(count));
 
-                if (not(io(index) and
-                        do_serialize_model(io, *mdl, sim.parameters[index])))
-                    return false;
-            }
+        return written;
+    }
+
+    template<typename Stream>
+    bool do_deserialize_constant_sources(Stream&     io,
+                                         simulation& sim,
+                                         const u32   number) noexcept
+    {
+        if (not self.to_constant.data.reserve(number))
+            return false;
+
+        for (u32 i = 0; i < number; ++i) {
+            u32 index = 0u;
+            if (not io(index))
+                return false;
+
+            auto& src = sim.srcs.constant_sources.alloc();
+            auto  id  = sim.srcs.constant_sources.get_id(src);
+            self.to_constant.data.emplace_back(index, id);
+
+            if (not(io(src.length) and do_serialize_external_source(io, src)))
+                return false;
         }
 
-        //{
-        //    for (auto& mdl : sim.models) {
-        //        dispatch(mdl, [&]<typename Dynamics>(Dynamics& dyn) {
-        //            if constexpr (has_output_port<Dynamics>) {
-        //                i8         i      = 0;
-        //                const auto out_id = sim.models.get_id(mdl);
-
-        //                for (const auto& elem : dyn.y) {
-        //                    sim.for_each(
-        //                      elem,
-        //                      [&](const auto& mdl, const auto port_index) {
-        //                          auto in = get_index(sim.get_id(mdl));
-
-        //                          io(out_id);
-        //                          io(i);
-        //                          io(in);
-        //                          io(port_index);
-        //                          ++i;
-        //                      });
-        //                }
-        //            }
-        //        });
-        //    }
-        //}
+        self.to_constant.sort();
+        return true;
+    }
+
+    /// The version 1 format stores an unused number of clients: use @c
+    /// with_clients to true to skip it.
+    template<typename Stream>
+    bool do_deserialize_binary_file_sources(Stream&     io,
+                                            simulation& sim,
+                                            const u32   number,
+                                            const bool  with_clients) noexcept
+    {
+        if (not self.to_binary.data.reserve(number))
+            return false;
 
+        for (u32 i = 0; i < number; ++i) {
+            u32 index   = 0u;
+            u32 clients = 0u;
+
+            if (not(io(index) and (not with_clients or io(clients))))
+                return false;
+
+            auto& src = sim.srcs.binary_file_sources.alloc();
+            auto  id  = sim.srcs.binary_file_sources.get_id(src);
+            self.to_binary.data.emplace_back(index, id);
+
+            if (not do_serialize_external_source(io, src))
+                return false;
+        }
+
+        self.to_binary.sort();
+        return true;
+    }
+
+    /// The version 1 format does not store the @c use_binary_cache flag: use
+    /// @c with_cache_flag to false.
+    template<typename Stream>
+    bool do_deserialize_text_file_sources(Stream&     io,
+                                          simulation& sim,
+                                          const u32   number,
+                                          const bool  with_cache_flag) noexcept
+    {
+        if (not self.to_text.data.reserve(number))
+            return false;
+
+        for (u32 i = 0; i < number; ++i) {
+            u32  index = 0u;
+            bool cache = false;
+            if (not(io(index) and (not with_cache_flag or io(cache))))
+                return false;
+
+            auto& src = sim.srcs.text_file_sources.alloc();
+            auto  id  = sim.srcs.text_file_sources.get_id(src);
+            self.to_text.data.emplace_back(index, id);
+            src.use_binary_cache = cache;
+
+            if (not do_serialize_external_source(io, src))
+                return false;
+        }
+
+        self.to_text.sort();
         return true;
     }
 
+    template<typename Stream>
+    bool do_deserialize_random_sources(Stream&     io,
+                                       simulation& sim,
+                                       const u32   number) noexcept
+    {
+        if (not self.to_random.data.reserve(number))
+            return false;
+
+        for (u32 i = 0; i < number; ++i) {
+            u32 index = 0u;
+            if (not io(index))
+                return false;
+
+            auto& src = sim.srcs.random_sources.alloc();
+            auto  id  = sim.srcs.random_sources.get_id(src);
+            self.to_random.data.emplace_back(index, id);
+
+            if (not do_serialize_external_source(io, src))
+                return false;
+        }
+
+        self.to_random.sort();
+        return true;
+    }
+
+    template<typename Stream>
+    bool do_deserialize_hsms(Stream&     io,
+                             simulation& sim,
+                             const u32   number) noexcept
+    {
+        for (u32 i = 0; i < number; ++i) {
+            u32 index = 0u;
+            if (not io(index))
+                return false;
+
+            auto& hsm = sim.hsms.alloc();
+            if (not do_serialize(io, hsm))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Reads the type and the parameter of the model @c mdl allocated by @c
+    /// data_array::alloc() then builds its dynamics.
+    template<typename Stream>
+    bool do_deserialize_model(Stream& io, simulation& sim, model& mdl) noexcept
+    {
+        const auto index = get_index(sim.models.get_id(mdl));
+
+        if (not do_serialize_model(io, mdl, sim.parameters[index]))
+            return false;
+
+        if (not(std::cmp_greater_equal(ordinal(mdl.type), 0) and
+                std::cmp_less(ordinal(mdl.type), dynamics_type_size())))
+            return false;
+
+        construct_dynamics(mdl);
+        return true;
+    }
+
+    template<typename Stream>
+    bool do_deserialize_connections(Stream&     io,
+                                    simulation& sim,
+                                    const u32   number) noexcept
+    {
+        for (u32 i = 0; i < number; ++i)
+            if (not do_deserialize_connection(io, sim))
+                return false;
+
+        return true;
+    }
+
+    template<typename Stream>
+    bool do_deserialize_connection(Stream& io, simulation& sim) noexcept
+    {
+        u32 out = 0, in = 0;
+        i8  port_out = 0, port_in = 0;
+
+        if (not(io(out) and io(port_out) and io(in) and io(port_in)))
+            return self.report_error(error_code::format_error);
+
+        auto* out_id = self.to_models.get(out);
+        auto* in_id  = self.to_models.get(in);
+        if (!out_id || !in_id)
+            return self.report_error(error_code::unknown_model_error);
+
+        auto* mdl_src = sim.models.try_to_get(*out_id);
+        if (!mdl_src)
+            return self.report_error(error_code::unknown_model_error);
+
+        auto* mdl_dst = sim.models.try_to_get(*in_id);
+        if (!mdl_dst)
+            return self.report_error(error_code::unknown_model_error);
+
+        if (sim.connect(*mdl_src, port_out, *mdl_dst, port_in).has_error())
+            return self.report_error(error_code::unknown_model_port_error);
+
+        return true;
+    }
+
+    /// Reads the version 1 format: the numbers of elements then the external
+    /// sources, the state machines, the models and the connections until the
+    /// end of the stream.
     template<typename Stream>
     bool do_deserialize(binary_archiver& bin,
                         simulation&      sim,
@@ -550,6 +1401,7 @@ struct binary_archiver::impl {
             if (hsms < 0)
                 return bin.report_error(error_code::format_error);
 
+            bin.clear_cache();
             sim.clean();
 
             sim.srcs.constant_sources.clear();
@@ -563,7 +1415,7 @@ struct binary_archiver::impl {
             sim.srcs.binary_file_sources.reserve(binary_external_source);
             sim.srcs.text_file_sources.reserve(text_external_source);
             sim.srcs.random_sources.reserve(random_external_source);
-            sim.models.reserve(models);
+            sim.grow_models_to(models);
             sim.hsms.reserve(hsms);
 
             if (not sim.srcs.constant_sources.can_alloc() or
@@ -575,121 +1427,39 @@ struct binary_archiver::impl {
                   binary_archiver::error_code::not_enough_memory);
         }
 
-        if (constant_external_source > 0) {
-            self.to_constant.data.reserve(constant_external_source);
-            for (i32 i = 0; i < constant_external_source; ++i) {
-                u32 index = 0u;
-                io(index);
-
-                auto& src = sim.srcs.constant_sources.alloc();
-                auto  id  = sim.srcs.constant_sources.get_id(src);
-                self.to_constant.data.emplace_back(index, id);
-
-                do_serialize_external_source(io, src);
-            }
-            self.to_constant.sort();
-        }
-
-        if (binary_external_source > 0) {
-            self.to_binary.data.reserve(binary_external_source);
-            for (i32 i = 0; i < binary_external_source; ++i) {
-                u32 index = 0u;
-                io(index);
-
-                u32 max_clients = 0;
-                io(max_clients);
-
-                auto& src = sim.srcs.binary_file_sources.alloc();
-                auto  id  = sim.srcs.binary_file_sources.get_id(src);
-                self.to_binary.data.emplace_back(index, id);
-                src.max_clients = max_clients;
-
-                do_serialize_external_source(io, src);
-            }
-            self.to_binary.sort();
-        }
-
-        if (text_external_source > 0) {
-            self.to_text.data.reserve(text_external_source);
-            for (i32 i = 0u; i < text_external_source; ++i) {
-                u32 index = 0u;
-                io(index);
-
-                auto& src = sim.srcs.text_file_sources.alloc();
-                auto  id  = sim.srcs.text_file_sources.get_id(src);
-                self.to_text.data.emplace_back(index, id);
-
-                do_serialize_external_source(io, src);
-            }
-            self.to_text.sort();
-        }
-
-        if (random_external_source > 0) {
-            self.to_random.data.reserve(random_external_source);
-            for (i32 i = 0u; i < random_external_source; ++i) {
-                u32 index = 0u;
-                io(index);
-
-                auto& src = sim.srcs.random_sources.alloc();
-                auto  id  = sim.srcs.random_sources.get_id(src);
-                self.to_random.data.emplace_back(index, id);
-
-                do_serialize_external_source(io, src);
-            }
-            self.to_random.sort();
-        }
+        if (not(do_deserialize_constant_sources(
+                  io, sim, static_cast<u32>(constant_external_source)) and
+                do_deserialize_binary_file_sources(
+                  io, sim, static_cast<u32>(binary_external_source), true) and
+                do_deserialize_text_file_sources(
+                  io, sim, static_cast<u32>(text_external_source), false) and
+                do_deserialize_random_sources(
+                  io, sim, static_cast<u32>(random_external_source)) and
+                do_deserialize_hsms(io, sim, static_cast<u32>(hsms))))
+            return bin.report_error(error_code::format_error);
 
         if (models > 0) {
             self.to_models.data.reserve(models);
             for (i32 i = 0u; i < models; ++i) {
                 u32 index = 0;
-                io(index);
+                if (not io(index))
+                    return bin.report_error(error_code::format_error);
 
                 auto& mdl = sim.models.alloc();
                 auto  id  = sim.models.get_id(mdl);
                 self.to_models.data.emplace_back(index, id);
-                do_serialize_model(io, mdl, sim.parameters[index]);
+
+                if (not do_deserialize_model(io, sim, mdl)) {
+                    sim.models.clear();
+                    return bin.report_error(error_code::format_error);
+                }
             }
             self.to_models.sort();
         }
 
-        while (not io.stream.is_eof()) {
-            u32 out = 0, in = 0;
-            i8  port_out = 0, port_in = 0;
-
-            if (not(io(out) and io(port_out) and io(in) and io(port_in)))
-                return bin.report_error(error_code::unknown_model_error);
-
-            auto* out_id = self.to_models.get(out);
-            auto* in_id  = self.to_models.get(in);
-            if (!out_id || !in_id)
-                return bin.report_error(error_code::unknown_model_error);
-
-            debug::ensure(out_id && in_id);
-
-            auto* mdl_src = sim.models.try_to_get(enum_cast<model_id>(*out_id));
-            if (!mdl_src)
-                return bin.report_error(error_code::unknown_model_error);
-
-            auto* mdl_dst = sim.models.try_to_get(enum_cast<model_id>(*in_id));
-            if (!mdl_dst)
-                return bin.report_error(error_code::unknown_model_error);
-
-            // block_node_id* pout = nullptr;
-            // message_id*    pin  = nullptr;
-
-            // if (auto ret = get_output_port(*mdl_src, port_out, pout); !ret)
-            //     return
-            //     bin.report_error(error_code::unknown_model_port_error);
-            // if (auto ret = get_input_port(*mdl_dst, port_in, pin); !ret)
-            //     return
-            //     bin.report_error(error_code::unknown_model_port_error);
-            // if (auto ret = sim.connect(*mdl_src, port_out, *mdl_dst,
-            // port_in);
-            //     !ret)
-            //     return
-            //     bin.report_error(error_code::unknown_model_port_error);
-        }
+        while (not io.stream.is_eof())
+            if (not do_deserialize_connection(io, sim))
+                return false;
 
         return true;
     }
@@ -747,6 +1517,14 @@ bool binary_archiver::simulation_load(simulation& sim, memory& m) noexcept
     return impl.load(sim, m);
 }
 
+bool binary_archiver::simulation_load(simulation&                  sim,
+                                      const std::filesystem::path& p) noexcept
+{
+    binary_archiver::impl impl(*this);
+
+    return impl.load(sim, p);
+}
+
 void binary_archiver::clear_cache() noexcept
 {
     to_models.data.clear();
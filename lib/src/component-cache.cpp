@@ -0,0 +1,1264 @@
+// Copyright (c) 2025 INRAE Distributed under the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <irritator/archiver.hpp>
+#include <irritator/helpers.hpp>
+#include <irritator/modeling.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <type_traits>
+
+#include <cstring>
+
+namespace irt {
+
+// The cache file is a header followed by one record per component file:
+//
+// header: u32 magic, u32 version, u32 entries.
+// entry:  str dir, str file, u64 size, i64 mtime, u64 hash, block deps, block
+//         data.
+//
+// A @c str is an u16 length followed by the characters, a @c block is an u32
+// length followed by the bytes. Numbers use the native byte order, the
+// version changes with the layout of the component data.
+
+static constexpr u32 cache_magic   = 0x43435249; // "IRCC"
+static constexpr u32 cache_version = 1;
+
+/// Appends numbers, strings and blocks to a @c vector<char>.
+struct cache_writer {
+    vector<char>& out;
+    bool          ok = true;
+
+    void append(const void* src, const std::size_t len) noexcept
+    {
+        const auto old = out.size();
+
+        if (ok and out.resize(old + len))
+            std::memcpy(out.data() + old, src, len);
+        else
+            ok = false;
+    }
+
+    template<typename T>
+        requires(std::is_arithmetic_v<T> or std::is_enum_v<T>)
+    void operator()(const T v) noexcept
+    {
+        append(&v, sizeof(T));
+    }
+
+    void operator()(const std::string_view str) noexcept
+    {
+        const auto len = static_cast<u16>(
+          std::min<std::size_t>(str.size(), std::numeric_limits<u16>::max()));
+
+        append(&len, sizeof(len));
+        append(str.data(), len);
+    }
+
+    /// Writes an u32 placeholder for the length of the next block and
+    /// returns its position.
+    std::size_t begin_block() noexcept
+    {
+        const auto pos = out.size();
+        operator()(u32{});
+        return pos;
+    }
+
+    void end_block(const std::size_t pos) noexcept
+    {
+        if (ok) {
+            const auto len =
+              static_cast<u32>(out.size() - pos - sizeof(u32));
+            std::memcpy(out.data() + pos, &len, sizeof(len));
+        }
+    }
+};
+
+/// Reads numbers, strings and blocks from a memory-mapped cache file.
+struct cache_reader {
+    std::span<const char> buf;
+    std::size_t           pos = 0;
+    bool                  ok  = true;
+
+    const char* take(const std::size_t len) noexcept
+    {
+        if (not ok or buf.size() - pos < len) {
+            ok = false;
+            return nullptr;
+        }
+
+        const auto* ptr = buf.data() + pos;
+        pos += len;
+        return ptr;
+    }
+
+    template<typename T>
+        requires(std::is_arithmetic_v<T> or std::is_enum_v<T>)
+    bool operator()(T& v) noexcept
+    {
+        if (const auto* ptr = take(sizeof(T))) {
+            std::memcpy(&v, ptr, sizeof(T));
+            return true;
+        }
+
+        return false;
+    }
+
+    bool operator()(std::string_view& str) noexcept
+    {
+        u16 len = 0;
+        if (operator()(len))
+            if (const auto* ptr = take(len)) {
+                str = std::string_view(ptr, len);
+                return true;
+            }
+
+        return false;
+    }
+
+    template<std::size_t Length>
+    bool operator()(small_string<Length>& str) noexcept
+    {
+        std::string_view sv;
+        if (not operator()(sv))
+            return false;
+
+        str = sv;
+        return true;
+    }
+
+    bool operator()(std::span<const char>& block) noexcept
+    {
+        u32 len = 0;
+        if (operator()(len))
+            if (const auto* ptr = take(len)) {
+                block = std::span<const char>(ptr, len);
+                return true;
+            }
+
+        return false;
+    }
+};
+
+/// Writes the component data of a cache entry. References to components
+/// and files are written with the names of the registred path, the
+/// directory and the file, ports with their names. Returns @c false if the
+/// component references a component without file.
+struct cache_encoder {
+    cache_writer&           w;
+    const file_access&      files;
+    const component_access& ids;
+
+    bool write_file(const file_path_id id) noexcept
+    {
+        const auto* f = files.file_paths.try_to_get(id);
+        const auto* d = f ? files.dir_paths.try_to_get(f->parent) : nullptr;
+        const auto* r = d ? files.registred_paths.try_to_get(d->parent)
+                          : nullptr;
+
+        if (not r)
+            return false;
+
+        w(u8{ 1 });
+        w(r->name.sv());
+        w(d->path.sv());
+        w(f->path.sv());
+        return true;
+    }
+
+    bool write_component(const component_id id) noexcept
+    {
+        if (not ids.exists(id)) {
+            w(u8{ 0 });
+            return true;
+        }
+
+        return write_file(ids.component_file_paths[id].file);
+    }
+
+    void write_ports(const component::port_type& ports) noexcept
+    {
+        w(static_cast<u32>(ports.size()));
+        for (const auto id : ports) {
+            w(ports.get<port_str>(id).sv());
+            w(ports.get<port_option>(id));
+            w(ports.get<position>(id).x);
+            w(ports.get<position>(id).y);
+        }
+    }
+
+    static std::string_view port_name(const component::port_type& ports,
+                                      const port_id id) noexcept
+    {
+        return ports.exists(id) ? ports.get<port_str>(id).sv()
+                                : std::string_view();
+    }
+
+    /// Writes a model port index or the name of a component child port.
+    void write_port(const generic_component::child& c,
+                    const connection::port          p,
+                    const bool                      input) noexcept
+    {
+        if (c.type == child_type::model) {
+            w(static_cast<i32>(p.model));
+        } else if (ids.exists(c.id.compo_id)) {
+            const auto& compo = ids.components[c.id.compo_id];
+            w(port_name(input ? compo.x : compo.y, p.compo));
+        } else {
+            w(std::string_view());
+        }
+    }
+
+    bool write_parameter(const component&                compo,
+                         const generic_component::child& c,
+                         const parameter&                p) noexcept
+    {
+        w(c.id.mdl_type);
+        for (const auto r : p.reals)
+            w(r);
+        for (const auto i : p.integers)
+            w(i);
+
+        switch (c.id.mdl_type) {
+        case dynamics_type::hsm_wrapper:
+            return write_component(
+              enum_cast<component_id>(p.integers[hsm_wrapper_tag::id]));
+
+        case dynamics_type::simulation_wrapper:
+            return write_component(enum_cast<component_id>(
+              p.integers[simulation_wrapper_tag::id]));
+
+        case dynamics_type::constant: {
+            const auto type = enum_cast<constant::init_type>(
+              p.integers[constant_tag::i_type]);
+            const auto port =
+              enum_cast<port_id>(p.integers[constant_tag::i_port]);
+
+            if (type == constant::init_type::incoming_component_n)
+                w(port_name(compo.x, port));
+            else if (type == constant::init_type::outcoming_component_n)
+                w(port_name(compo.y, port));
+            return true;
+        }
+
+        default:
+            return true;
+        }
+    }
+
+    bool write_generic(const component&         compo,
+                       const generic_component& gen) noexcept
+    {
+        vector<u32> index(gen.children.capacity(), 0u);
+
+        w(static_cast<u32>(gen.children.size()));
+        u32 i = 0;
+        for (const auto& c : gen.children) {
+            const auto id  = gen.children.get_id(c);
+            const auto idx = get_index(id);
+            index[idx]     = i++;
+
+            w(c.type);
+            w(static_cast<u32>(c.flags.to_unsigned()));
+            w(gen.children_positions[idx].x);
+            w(gen.children_positions[idx].y);
+            w(gen.children_names[idx].sv());
+
+            if (c.type == child_type::model) {
+                if (not write_parameter(
+                      compo, c, gen.children_parameters[idx]))
+                    return false;
+            } else if (not write_component(c.id.compo_id)) {
+                return false;
+            }
+        }
+
+        w(static_cast<u32>(gen.connections.size()));
+        for (const auto& con : gen.connections) {
+            w(index[get_index(con.src)]);
+            write_port(gen.children.get(con.src), con.index_src, false);
+            w(index[get_index(con.dst)]);
+            write_port(gen.children.get(con.dst), con.index_dst, true);
+        }
+
+        w(static_cast<u32>(gen.input_connections.size()));
+        for (const auto& con : gen.input_connections) {
+            w(port_name(compo.x, con.x));
+            w(index[get_index(con.dst)]);
+            write_port(gen.children.get(con.dst), con.port, true);
+        }
+
+        w(static_cast<u32>(gen.output_connections.size()));
+        for (const auto& con : gen.output_connections) {
+            w(port_name(compo.y, con.y));
+            w(index[get_index(con.src)]);
+            write_port(gen.children.get(con.src), con.port, false);
+        }
+
+        return true;
+    }
+
+    std::string_view child_port_name(const component_id id,
+                                     const port_id      port,
+                                     const bool         input) const noexcept
+    {
+        if (not ids.exists(id))
+            return std::string_view();
+
+        const auto& c = ids.components[id];
+        return port_name(input ? c.x : c.y, port);
+    }
+
+    bool write_grid(const component& compo, const grid_component& grid) noexcept
+    {
+        w(grid.row());
+        w(grid.column());
+        w(grid.in_connection_type);
+        w(grid.out_connection_type);
+
+        for (const auto id : grid.children())
+            if (not write_component(id))
+                return false;
+
+        w(static_cast<u32>(grid.input_connections.size()));
+        for (const auto& con : grid.input_connections) {
+            const auto id = grid.children()[grid.pos(con.row, con.col)];
+            w(port_name(compo.x, con.x));
+            w(con.row);
+            w(con.col);
+            w(child_port_name(id, con.id, true));
+        }
+
+        w(static_cast<u32>(grid.output_connections.size()));
+        for (const auto& con : grid.output_connections) {
+            const auto id = grid.children()[grid.pos(con.row, con.col)];
+            w(port_name(compo.y, con.y));
+            w(con.row);
+            w(con.col);
+            w(child_port_name(id, con.id, false));
+        }
+
+        return true;
+    }
+
+    bool write_graph(const component&       compo,
+                     const graph_component& graph) noexcept
+    {
+        w(graph.g_type);
+
+        if (graph.g_type == graph_component::graph_type::dot_file) {
+            if (not write_file(graph.dot.file))
+                return false;
+        }
+
+        w(graph.scale.alpha);
+        w(graph.scale.beta);
+        w(static_cast<i32>(graph.scale.nodes));
+        w(graph.small.probability);
+        w(graph.small.k);
+        w(static_cast<i32>(graph.small.nodes));
+
+        w(static_cast<u32>(graph.g.nodes.size()));
+        for (const auto id : graph.g.nodes)
+            if (not write_component(graph.g.node_components[id]))
+                return false;
+
+        w(static_cast<u32>(graph.input_connections.size()));
+        for (const auto& con : graph.input_connections) {
+            w(port_name(compo.x, con.x));
+            w(static_cast<u32>(get_index(con.v)));
+            w(child_port_name(graph.g.node_components[con.v], con.id, true));
+        }
+
+        w(static_cast<u32>(graph.output_connections.size()));
+        for (const auto& con : graph.output_connections) {
+            w(port_name(compo.y, con.y));
+            w(static_cast<u32>(get_index(con.v)));
+            w(child_port_name(graph.g.node_components[con.v], con.id, false));
+        }
+
+        return true;
+    }
+
+    bool write_packs(const component&               compo,
+                     const vector<connection_pack>& packs,
+                     const bool                     input) noexcept
+    {
+        w(static_cast<u32>(packs.size()));
+        for (const auto& p : packs) {
+            w(port_name(input ? compo.x : compo.y, p.parent_port));
+            if (not write_component(p.child_component))
+                return false;
+            w(child_port_name(p.child_component, p.child_port, input));
+        }
+
+        return true;
+    }
+
+    bool write(const component_id id) noexcept
+    {
+        const auto& compo = ids.components[id];
+
+        w(compo.name.sv());
+        for (const auto c : ids.component_colors[id])
+            w(c);
+        w(compo.type);
+        write_ports(compo.x);
+        write_ports(compo.y);
+
+        switch (compo.type) {
+        case component_type::generic:
+            if (const auto* g = ids.generic_components.try_to_get(
+                  compo.id.generic_id);
+                not(g and write_generic(compo, *g)))
+                return false;
+            break;
+
+        case component_type::grid:
+            if (const auto* g = ids.grid_components.try_to_get(compo.id.grid_id);
+                not(g and write_grid(compo, *g)))
+                return false;
+            break;
+
+        case component_type::graph:
+            if (const auto* g =
+                  ids.graph_components.try_to_get(compo.id.graph_id);
+                not(g and write_graph(compo, *g)))
+                return false;
+            break;
+
+        default:
+            return false;
+        }
+
+        return write_packs(compo, compo.input_connection_pack, true) and
+               write_packs(compo, compo.output_connection_pack, false) and
+               w.ok;
+    }
+};
+
+/// Builds a component from the data of a cache entry. The functions return
+/// @c false on error, @c missing is set if a referenced component is not yet
+/// read.
+struct cache_decoder {
+    cache_reader&      r;
+    const file_access& files;
+    component_access&  ids;
+
+    table<file_path_id, component_id> by_file;
+    bool                              missing = false;
+
+    bool read_file(file_path_id& out) noexcept
+    {
+        u8 defined = 0;
+        if (not r(defined))
+            return false;
+
+        out = undefined<file_path_id>();
+        if (defined == 0)
+            return true;
+
+        std::string_view reg, dir, file;
+        if (not(r(reg) and r(dir) and r(file)))
+            return false;
+
+        out = files.find_file(reg, dir, file);
+        return is_defined(out);
+    }
+
+    bool read_component(component_id& out) noexcept
+    {
+        out         = undefined<component_id>();
+        auto f_id   = undefined<file_path_id>();
+        if (not read_file(f_id))
+            return false;
+
+        if (is_undefined(f_id))
+            return true;
+
+        if (by_file.data.empty()) {
+            by_file.data.reserve(ids.ssize());
+            for (const auto id : ids)
+                by_file.data.emplace_back(ids.component_file_paths[id].file,
+                                          id);
+            by_file.sort();
+        }
+
+        const auto* id = by_file.get(f_id);
+        if (not id)
+            return false;
+
+        if (ids.components[*id].state != component_status::unmodified) {
+            missing = true;
+            return false;
+        }
+
+        out = *id;
+        return true;
+    }
+
+    bool read_ports(component::port_type& ports) noexcept
+    {
+        u32 n = 0;
+        if (not r(n) or not(ports.can_alloc(n) or ports.reserve(n)))
+            return false;
+
+        for (u32 i = 0; i < n; ++i) {
+            const auto id = ports.alloc_id();
+            if (not(r(ports.get<port_str>(id)) and
+                    r(ports.get<port_option>(id)) and
+                    r(ports.get<position>(id).x) and
+                    r(ports.get<position>(id).y)))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool read_port_name(port_id&                    out,
+                        const component::port_type& ports) noexcept
+    {
+        std::string_view name;
+        if (not r(name))
+            return false;
+
+        out = undefined<port_id>();
+        for (const auto id : ports)
+            if (ports.get<port_str>(id).sv() == name)
+                out = id;
+
+        return true;
+    }
+
+    bool read_child_port_name(port_id&           out,
+                              const component_id id,
+                              const bool         input) noexcept
+    {
+        if (ids.exists(id)) {
+            const auto& c = ids.components[id];
+            return read_port_name(out, input ? c.x : c.y);
+        }
+
+        std::string_view ignored;
+        out = undefined<port_id>();
+        return r(ignored);
+    }
+
+    bool read_port(connection::port&               p,
+                   const generic_component::child& c,
+                   const bool                      input) noexcept
+    {
+        p.clear();
+
+        if (c.type == child_type::model) {
+            i32 model = 0;
+            if (not r(model))
+                return false;
+
+            p.model = model;
+            return true;
+        }
+
+        return read_child_port_name(p.compo, c.id.compo_id, input);
+    }
+
+    bool read_parameter(component&     compo,
+                        parameter&     p,
+                        dynamics_type& type) noexcept
+    {
+        if (not r(type) or
+            std::cmp_greater_equal(ordinal(type), dynamics_type_size()))
+            return false;
+
+        for (auto& v : p.reals)
+            if (not r(v))
+                return false;
+        for (auto& v : p.integers)
+            if (not r(v))
+                return false;
+
+        switch (type) {
+        case dynamics_type::hsm_wrapper: {
+            auto id = undefined<component_id>();
+            if (not read_component(id))
+                return false;
+            if (is_defined(id))
+                p.integers[hsm_wrapper_tag::id] = static_cast<i64>(id);
+            return true;
+        }
+
+        case dynamics_type::simulation_wrapper: {
+            auto id = undefined<component_id>();
+            if (not read_component(id))
+                return false;
+            if (is_defined(id))
+                p.integers[simulation_wrapper_tag::id] = static_cast<i64>(id);
+            return true;
+        }
+
+        case dynamics_type::constant: {
+            const auto init = enum_cast<constant::init_type>(
+              p.integers[constant_tag::i_type]);
+            const auto input =
+              init == constant::init_type::incoming_component_n;
+
+            if (input or init == constant::init_type::outcoming_component_n) {
+                auto port = undefined<port_id>();
+                if (not read_port_name(port, input ? compo.x : compo.y))
+                    return false;
+                p.integers[constant_tag::i_port] = ordinal(port);
+            }
+            return true;
+        }
+
+        default:
+            return true;
+        }
+    }
+
+    template<typename DataArray>
+    static bool reserve(DataArray& d, const u32 n) noexcept
+    {
+        return d.can_alloc(n) or d.reserve(n);
+    }
+
+    bool read_generic(component& compo, generic_component& gen) noexcept
+    {
+        u32 n = 0;
+        if (not r(n) or not reserve(gen.children, n) or
+            not gen.children_positions.resize(gen.children.capacity()) or
+            not gen.children_names.resize(gen.children.capacity()) or
+            not gen.children_parameters.resize(gen.children.capacity()))
+            return false;
+
+        vector<child_id> children(n, reserve_tag);
+        for (u32 i = 0; i < n; ++i) {
+            auto type  = child_type::model;
+            u32  flags = 0;
+
+            if (not r(type))
+                return false;
+
+            auto&      c   = gen.children.alloc(undefined<component_id>());
+            const auto id  = gen.children.get_id(c);
+            const auto idx = get_index(id);
+            children.emplace_back(id);
+
+            c.type  = type;
+            c.flags = bitflags<child_flags>(0);
+            gen.children_parameters[idx].clear();
+
+            if (not(r(flags) and r(gen.children_positions[idx].x) and
+                    r(gen.children_positions[idx].y) and
+                    r(gen.children_names[idx])))
+                return false;
+
+            c.flags = bitflags<child_flags>(flags);
+
+            if (type == child_type::model) {
+                if (not read_parameter(
+                      compo, gen.children_parameters[idx], c.id.mdl_type))
+                    return false;
+            } else if (type == child_type::component) {
+                if (not read_component(c.id.compo_id))
+                    return false;
+            } else {
+                return false;
+            }
+        }
+
+        const auto child = [&](const u32 i) noexcept
+          -> const generic_component::child* {
+            return i < children.size() ? &gen.children.get(children[i])
+                                       : nullptr;
+        };
+
+        if (not r(n) or not reserve(gen.connections, n))
+            return false;
+
+        for (u32 i = 0; i < n; ++i) {
+            u32              src = 0, dst = 0;
+            connection::port p_src, p_dst;
+
+            if (not r(src) or not child(src) or
+                not read_port(p_src, *child(src), false) or not r(dst) or
+                not child(dst) or not read_port(p_dst, *child(dst), true))
+                return false;
+
+            gen.connections.alloc(children[src], p_src, children[dst], p_dst);
+        }
+
+        if (not r(n) or not reserve(gen.input_connections, n))
+            return false;
+
+        for (u32 i = 0; i < n; ++i) {
+            auto             x   = undefined<port_id>();
+            u32              dst = 0;
+            connection::port p;
+
+            if (not read_port_name(x, compo.x) or not r(dst) or
+                not child(dst) or not read_port(p, *child(dst), true))
+                return false;
+
+            gen.input_connections.alloc(x, children[dst], p);
+        }
+
+        if (not r(n) or not reserve(gen.output_connections, n))
+            return false;
+
+        for (u32 i = 0; i < n; ++i) {
+            auto             y   = undefined<port_id>();
+            u32              src = 0;
+            connection::port p;
+
+            if (not read_port_name(y, compo.y) or not r(src) or
+                not child(src) or not read_port(p, *child(src), false))
+                return false;
+
+            gen.output_connections.alloc(y, children[src], p);
+        }
+
+        return true;
+    }
+
+    bool read_grid(component& compo, grid_component& grid) noexcept
+    {
+        i32  rows = 0, cols = 0;
+        auto in  = grid_component::type::name;
+        auto out = grid_component::type::in_out;
+
+        if (not(r(rows) and r(cols) and r(in) and r(out)))
+            return false;
+
+        if (rows < grid_component::slimit::lower_bound() or
+            rows >= grid_component::slimit::upper_bound() or
+            cols < grid_component::slimit::lower_bound() or
+            cols >= grid_component::slimit::upper_bound())
+            return false;
+
+        grid.resize(rows, cols, undefined<component_id>());
+        grid.in_connection_type  = in;
+        grid.out_connection_type = out;
+
+        for (auto& id : grid.children())
+            if (not read_component(id))
+                return false;
+
+        u32 n = 0;
+        if (not r(n) or not reserve(grid.input_connections, n))
+            return false;
+
+        for (u32 i = 0; i < n; ++i) {
+            auto x = undefined<port_id>(), id = undefined<port_id>();
+            i32  row = 0, col = 0;
+
+            if (not(read_port_name(x, compo.x) and r(row) and r(col)) or
+                row < 0 or row >= rows or col < 0 or col >= cols or
+                not read_child_port_name(
+                  id, grid.children()[grid.pos(row, col)], true))
+                return false;
+
+            grid.input_connections.alloc(x, row, col, id);
+        }
+
+        if (not r(n) or not reserve(grid.output_connections, n))
+            return false;
+
+        for (u32 i = 0; i < n; ++i) {
+            auto y = undefined<port_id>(), id = undefined<port_id>();
+            i32  row = 0, col = 0;
+
+            if (not(read_port_name(y, compo.y) and r(row) and r(col)) or
+                row < 0 or row >= rows or col < 0 or col >= cols or
+                not read_child_port_name(
+                  id, grid.children()[grid.pos(row, col)], false))
+                return false;
+
+            grid.output_connections.alloc(y, row, col, id);
+        }
+
+        return true;
+    }
+
+    /// Rebuilds the graph from the dot file or the random graph parameters
+    /// like the json dearchiver.
+    bool build_graph(graph_component& graph) noexcept
+    {
+        switch (graph.g_type) {
+        case graph_component::graph_type::dot_file:
+            for (const auto& g : ids.graphs) {
+                if (g.file == graph.dot.file) {
+                    graph.g = g;
+                    graph.update_position();
+                    return true;
+                }
+            }
+            return false;
+
+        case graph_component::graph_type::scale_free:
+            if (graph.g
+                  .init_scale_free_graph(graph.scale.alpha,
+                                         graph.scale.beta,
+                                         graph.scale.id,
+                                         graph.scale.nodes,
+                                         graph.rng)
+                  .has_value()) {
+                graph.assign_grid_position();
+                return true;
+            }
+            return false;
+
+        case graph_component::graph_type::small_world:
+            if (graph.g
+                  .init_small_world_graph(graph.small.probability,
+                                          graph.small.k,
+                                          graph.small.id,
+                                          graph.small.nodes,
+                                          graph.rng)
+                  .has_value()) {
+                graph.assign_grid_position();
+                return true;
+            }
+            return false;
+        }
+
+        return false;
+    }
+
+    bool read_graph(component& compo, graph_component& graph) noexcept
+    {
+        i32 scale_nodes = 0, small_nodes = 0;
+
+        if (not r(graph.g_type) or
+            ordinal(graph.g_type) >
+              ordinal(graph_component::graph_type::small_world))
+            return false;
+
+        if (graph.g_type == graph_component::graph_type::dot_file and
+            not read_file(graph.dot.file))
+            return false;
+
+        if (not(r(graph.scale.alpha) and r(graph.scale.beta) and
+                r(scale_nodes) and r(graph.small.probability) and
+                r(graph.small.k) and r(small_nodes)))
+            return false;
+
+        graph.scale.nodes = scale_nodes;
+        graph.small.nodes = small_nodes;
+
+        if (not build_graph(graph))
+            return false;
+
+        u32 n = 0;
+        if (not r(n))
+            return false;
+
+        u32 i = 0;
+        for (const auto id : graph.g.nodes) {
+            if (i++ >= n)
+                break;
+
+            if (not read_component(graph.g.node_components[id]))
+                return false;
+        }
+
+        for (; i < n; ++i) {
+            auto ignored = undefined<component_id>();
+            if (not read_component(ignored))
+                return false;
+        }
+
+        if (not r(n) or not reserve(graph.input_connections, n))
+            return false;
+
+        for (i = 0; i < n; ++i) {
+            auto x = undefined<port_id>(), id = undefined<port_id>();
+            u32  v = 0;
+
+            if (not read_port_name(x, compo.x) or not r(v))
+                return false;
+
+            const auto node = graph.g.nodes.get_from_index(v);
+            if (is_undefined(node) or
+                not read_child_port_name(
+                  id, graph.g.node_components[node], true))
+                return false;
+
+            graph.input_connections.alloc(x, node, id);
+        }
+
+        if (not r(n) or not reserve(graph.output_connections, n))
+            return false;
+
+        for (i = 0; i < n; ++i) {
+            auto y = undefined<port_id>(), id = undefined<port_id>();
+            u32  v = 0;
+
+            if (not read_port_name(y, compo.y) or not r(v))
+                return false;
+
+            const auto node = graph.g.nodes.get_from_index(v);
+            if (is_undefined(node) or
+                not read_child_port_name(
+                  id, graph.g.node_components[node], false))
+                return false;
+
+            graph.output_connections.alloc(y, node, id);
+        }
+
+        return true;
+    }
+
+    bool read_packs(component&               compo,
+                    vector<connection_pack>& packs,
+                    const bool               input) noexcept
+    {
+        u32 n = 0;
+        if (not r(n))
+            return false;
+
+        for (u32 i = 0; i < n; ++i) {
+            connection_pack p;
+
+            if (not read_port_name(p.parent_port, input ? compo.x : compo.y) or
+                not read_component(p.child_component) or
+                not read_child_port_name(p.child_port, p.child_component, input))
+                return false;
+
+            packs.push_back(p);
+        }
+
+        return true;
+    }
+
+    bool read(const component_id id) noexcept
+    {
+        auto& compo = ids.components[id];
+        compo       = component{};
+
+        if (not r(compo.name))
+            return false;
+
+        for (auto& c : ids.component_colors[id])
+            if (not r(c))
+                return false;
+
+        auto type = component_type::none;
+        if (not(r(type) and read_ports(compo.x) and read_ports(compo.y)))
+            return false;
+
+        switch (type) {
+        case component_type::generic: {
+            if (not ids.can_alloc_generic_component(1))
+                return false;
+
+            auto& g             = ids.generic_components.alloc();
+            compo.type          = component_type::generic;
+            compo.id.generic_id = ids.generic_components.get_id(g);
+            if (not read_generic(compo, g))
+                return false;
+        } break;
+
+        case component_type::grid: {
+            if (not ids.can_alloc_grid_component(1))
+                return false;
+
+            auto& g          = ids.grid_components.alloc();
+            compo.type       = component_type::grid;
+            compo.id.grid_id = ids.grid_components.get_id(g);
+            if (not read_grid(compo, g))
+                return false;
+        } break;
+
+        case component_type::graph: {
+            if (not ids.can_alloc_graph_component(1))
+                return false;
+
+            auto& g           = ids.graph_components.alloc();
+            compo.type        = component_type::graph;
+            compo.id.graph_id = ids.graph_components.get_id(g);
+            if (not read_graph(compo, g))
+                return false;
+        } break;
+
+        default:
+            return false;
+        }
+
+        return read_packs(compo, compo.input_connection_pack, true) and
+               read_packs(compo, compo.output_connection_pack, false);
+    }
+};
+
+static auto entry_less(const component_cache::entry& e,
+                       const std::string_view        dir,
+                       const std::string_view        file) noexcept -> bool
+{
+    return e.dir != dir ? e.dir < dir : e.file < file;
+}
+
+component_cache::~component_cache() noexcept { close(); }
+
+component_cache::component_cache(component_cache&& other) noexcept
+  : m_entries(std::move(other.m_entries))
+  , m_map(std::move(other.m_map))
+{}
+
+component_cache& component_cache::operator=(component_cache&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_entries = std::move(other.m_entries);
+        m_map     = std::move(other.m_map);
+    }
+
+    return *this;
+}
+
+void component_cache::close() noexcept
+{
+    m_entries.clear();
+    m_map.close();
+}
+
+status component_cache::open(const registred_path& reg) noexcept
+{
+    close();
+
+    try {
+        const auto path = std::filesystem::path(reg.path.sv()) / filename;
+        auto       ec   = std::error_code{};
+        if (not std::filesystem::exists(path, ec))
+            return success();
+
+        auto ret = mapped_file::open(path);
+        if (not ret.has_value())
+            return make_error(modeling_errc::file_error);
+
+        m_map = std::move(*ret);
+    } catch (...) {
+        return make_error(modeling_errc::memory_error);
+    }
+
+    cache_reader r{ .buf = std::span<const char>(
+                      reinterpret_cast<const char*>(m_map.data()),
+                      m_map.size()) };
+
+    u32 magic = 0, version = 0, n = 0;
+    if (not(r(magic) and r(version) and r(n)) or magic != cache_magic or
+        version != cache_version or not m_entries.reserve(n)) {
+        close();
+        return success();
+    }
+
+    for (u32 i = 0; i < n; ++i) {
+        entry e;
+        if (not(r(e.dir) and r(e.file) and r(e.size) and r(e.mtime) and
+                r(e.hash) and r(e.deps) and r(e.data))) {
+            close();
+            return success();
+        }
+
+        m_entries.emplace_back(e);
+    }
+
+    std::sort(
+      m_entries.begin(), m_entries.end(), [](const auto& a, const auto& b) {
+          return entry_less(a, b.dir, b.file);
+      });
+
+    return success();
+}
+
+const component_cache::entry* component_cache::find(
+  const std::string_view dir,
+  const std::string_view file) const noexcept
+{
+    const auto it = std::lower_bound(
+      m_entries.begin(),
+      m_entries.end(),
+      std::make_pair(dir, file),
+      [](const auto& e, const auto& p) { return entry_less(e, p.first, p.second); });
+
+    return it != m_entries.end() and it->dir == dir and it->file == file
+             ? it
+             : nullptr;
+}
+
+void component_cache::read_dependencies(const file_access&    files,
+                                        const entry&          e,
+                                        vector<file_path_id>& deps) noexcept
+{
+    cache_reader r{ .buf = e.deps };
+
+    u32 n = 0;
+    if (not r(n))
+        return;
+
+    for (u32 i = 0; i < n; ++i) {
+        std::string_view reg, dir, file;
+        if (not(r(reg) and r(dir) and r(file)))
+            return;
+
+        if (const auto id = files.find_file(reg, dir, file); is_defined(id))
+            deps.emplace_back(id);
+    }
+}
+
+status component_cache::read(const file_access& files,
+                             component_access&  ids,
+                             const component_id id,
+                             const entry&       e) noexcept
+{
+    if (not ids.exists(id))
+        return make_error(modeling_errc::component_load_error);
+
+    cache_reader  r{ .buf = e.data };
+    cache_decoder d{ .r = r, .files = files, .ids = ids, .by_file = {} };
+
+    if (d.read(id) and r.pos == r.buf.size()) {
+        ids.components[id].state = component_status::unmodified;
+        return success();
+    }
+
+    ids.clear(id);
+    ids.components[id].state = component_status::unread;
+
+    return error_code(d.missing ? modeling_errc::component_not_found
+                                : modeling_errc::component_load_error);
+}
+
+status component_cache::write(const file_access&      files,
+                              const component_access& ids,
+                              const registred_path&   reg,
+                              std::span<const record> records) noexcept
+{
+    vector<char> buffer(64 * 1024, reserve_tag);
+    vector<char> data(16 * 1024, reserve_tag);
+    cache_writer w{ .out = buffer };
+
+    w(cache_magic);
+    w(cache_version);
+    const auto count_pos = buffer.size();
+    w(u32{});
+
+    u32 n = 0;
+    for (const auto& rec : records) {
+        if (not ids.exists(rec.id) or
+            not is_cacheable(ids.components[rec.id]))
+            continue;
+
+        const auto* f = files.file_paths.try_to_get(
+          ids.component_file_paths[rec.id].file);
+        const auto* d = f ? files.dir_paths.try_to_get(f->parent) : nullptr;
+        if (not d or files.registred_paths.try_to_get(d->parent) != &reg)
+            continue;
+
+        data.clear();
+        cache_writer  dw{ .out = data };
+        cache_encoder enc{ .w = dw, .files = files, .ids = ids };
+        if (not enc.write(rec.id))
+            continue;
+
+        w(d->path.sv());
+        w(f->path.sv());
+        w(rec.size);
+        w(rec.mtime);
+        w(rec.hash);
+
+        const auto deps = w.begin_block();
+        u32        dn   = 0;
+        const auto dnp  = buffer.size();
+        w(dn);
+        for (const auto dep : rec.deps) {
+            const auto a = files.get_full_access(dep);
+            if (is_undefined(a.file_id))
+                continue;
+
+            w(files.registred_paths.get(a.reg_id).name.sv());
+            w(files.dir_paths.get(a.dir_id).path.sv());
+            w(files.file_paths.get(a.file_id).path.sv());
+            ++dn;
+        }
+        if (w.ok)
+            std::memcpy(buffer.data() + dnp, &dn, sizeof(dn));
+        w.end_block(deps);
+
+        w(static_cast<u32>(data.size()));
+        w.append(data.data(), data.size());
+        ++n;
+    }
+
+    if (not w.ok)
+        return make_error(modeling_errc::memory_error);
+
+    std::memcpy(buffer.data() + count_pos, &n, sizeof(n));
+
+    try {
+        const auto path = std::filesystem::path(reg.path.sv()) / filename;
+        auto       tmp  = path;
+        tmp += ".tmp";
+
+        {
+            auto f = file::open(tmp, file_mode{ file_open_options::write });
+            if (not f.has_value())
+                return f.error();
+
+            if (not f->write(buffer.data(), buffer.ssize()))
+                return make_error(modeling_errc::file_error);
+        }
+
+        auto ec = std::error_code{};
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp, ec);
+            return make_error(modeling_errc::file_error);
+        }
+    } catch (...) {
+        return make_error(modeling_errc::memory_error);
+    }
+
+    return success();
+}
+
+bool component_cache::is_cacheable(const component& compo) noexcept
+{
+    return (compo.type == component_type::generic or
+            compo.type == component_type::grid or
+            compo.type == component_type::graph) and
+           compo.srcs.data.empty() and
+           compo.state == component_status::unmodified;
+}
+
+u64 component_cache::hash(std::span<const char> buffer) noexcept
+{
+    u64 h = 0xcbf29ce484222325ull;
+
+    for (const auto c : buffer) {
+        h ^= static_cast<u8>(c);
+        h *= 0x100000001b3ull;
+    }
+
+    return h;
+}
+
+std::pair<u64, i64> component_cache::stat(
+  const std::filesystem::path& p) noexcept
+{
+    auto       ec   = std::error_code{};
+    const auto size = std::filesystem::file_size(p, ec);
+    if (ec)
+        return { 0, 0 };
+
+    const auto time = std::filesystem::last_write_time(p, ec);
+    if (ec)
+        return { 0, 0 };
+
+    return { static_cast<u64>(size),
+             static_cast<i64>(time.time_since_epoch().count()) };
+}
+
+} // namespace irt
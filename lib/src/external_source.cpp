@@ -7,11 +7,15 @@
 #include <irritator/ext.hpp>
 #include <irritator/random.hpp>
 
+#include <charconv>
 #include <filesystem>
 #include <fstream>
+#include <numbers>
 #include <random>
 #include <utility>
 
+#include <cstring>
+
 namespace irt {
 
 external_source_definition::constant_source&
@@ -137,15 +141,13 @@ binary_file_source::binary_file_source(const std::filesystem::path& p) noexcept
   : file_path(p)
 {}
 
+binary_file_source::~binary_file_source() noexcept { finalize(); }
+
 binary_file_source::binary_file_source(const binary_file_source& other) noexcept
   : name(other.name)
-  , buffers(other.buffers)
-  , offsets(other.offsets)
-  , max_clients(other.max_clients)
   , max_reals(other.max_reals)
   , file_path(other.file_path)
   , next_client(other.next_client)
-  , next_offset(other.next_offset)
 {}
 
 binary_file_source& binary_file_source::operator=(
@@ -162,137 +164,89 @@ binary_file_source& binary_file_source::operator=(
 void binary_file_source::swap(binary_file_source& other) noexcept
 {
     std::swap(name, other.name);
-    std::swap(buffers, other.buffers);
-    std::swap(offsets, other.offsets);
-    std::swap(max_clients, other.max_clients);
     std::swap(max_reals, other.max_reals);
     std::swap(file_path, other.file_path);
     std::swap(next_client, other.next_client);
-    std::swap(next_offset, other.next_offset);
+    std::swap(m_reals, other.m_reals);
+    std::swap(m_map, other.m_map);
 }
 
 status binary_file_source::init() noexcept
 {
-    next_client = 0;
-    next_offset = 0;
-
-    if (max_clients <= 1)
-        max_clients = default_max_client_number;
+    finalize();
 
-    buffers.resize(max_clients);
-    offsets.resize(max_clients);
-
-    if (ifs.is_open())
-        ifs.close();
-
-    try {
-        std::error_code ec;
-
-        auto size = std::filesystem::file_size(file_path, ec);
-        if (!ec)
-            return make_error(external_source_errc::binary_file_access_error);
+    next_client = 0;
+    max_reals   = 0;
 
-        auto number = size / sizeof(double);
-        if (number <= 0)
-            return make_error(external_source_errc::binary_file_size_error);
+    auto ret = mapped_file::open(file_path);
+    if (not ret.has_value())
+        return make_error(ret.error() == error_code(file_errc::empty)
+                            ? external_source_errc::binary_file_size_error
+                            : external_source_errc::binary_file_access_error);
 
-        auto chunks = number / external_source_chunk_size;
-        if (chunks < max_clients)
-            return make_error(external_source_errc::binary_file_size_error);
+    m_map   = std::move(*ret);
+    m_reals = reinterpret_cast<const double*>(m_map.data());
 
-        max_reals = static_cast<u64>(number);
-    } catch (const std::exception& /*e*/) {
-        return make_error(external_source_errc::binary_file_access_error);
+    const auto number = m_map.size() / sizeof(double);
+    if (number < static_cast<u64>(external_source_chunk_size)) {
+        finalize();
+        return make_error(external_source_errc::binary_file_size_error);
     }
 
-    ifs.open(file_path);
-
-    if (!ifs)
-        return make_error(external_source_errc::binary_file_access_error);
+    max_reals = number;
 
     return success();
 }
 
 void binary_file_source::finalize() noexcept
 {
-    if (ifs)
-        ifs.close();
+    m_map.close();
+    m_reals = nullptr;
 }
 
-bool binary_file_source::seekg(const long to_seek) noexcept
+/// Points the @c source::buffer to the chunk at @c data.chunk_id[1]. Models
+/// only read the buffer so the @c const_cast never leads to a write into the
+/// read-only pages.
+static status binary_file_source_view(const double*      reals,
+                                      const u64          max_reals,
+                                      source&            src,
+                                      const source_data& data) noexcept
 {
-    return ifs.seekg(to_seek).good();
-}
-
-bool binary_file_source::read(source& src, const int length) noexcept
-{
-    return ifs.read(reinterpret_cast<char*>(src.buffer.data()), length).good();
-}
-
-int binary_file_source::tellg() noexcept
-{
-    return static_cast<int>(ifs.tellg());
-}
-
-static status binary_file_source_fill_buffer(binary_file_source& ext,
-                                             source&             src,
-                                             source_data&        data) noexcept
-{
-    const auto to_seek = data.chunk_id[1] * sizeof(double);
-
-    if (!ext.seekg(static_cast<long>(to_seek)))
-        return make_error(external_source_errc::binary_file_eof_error);
-
-    if (!ext.read(src, external_source_chunk_size))
-        return make_error(external_source_errc::binary_file_eof_error);
+    const auto offset = data.chunk_id[1];
 
-    const auto tellg = ext.tellg();
-    if (tellg < 0)
+    if (not reals or offset + external_source_chunk_size > max_reals)
         return make_error(external_source_errc::binary_file_eof_error);
 
-    const auto current_position = static_cast<u64>(tellg) / sizeof(double);
-    data.chunk_id[1]            = current_position;
-    ext.offsets[numeric_cast<int>(data.chunk_id[0])] = current_position;
+    src.buffer = std::span(const_cast<double*>(reals + offset),
+                           external_source_chunk_size);
 
     return success();
 }
 
 status binary_file_source::init(source& src, source_data& data) noexcept
 {
-    src.buffer       = std::span(buffers[next_client]);
     src.index        = 0;
     data.chunk_id[0] = next_client;
-    data.chunk_id[1] = next_offset;
-    offsets[numeric_cast<int>(data.chunk_id[0])] = next_offset;
+    data.chunk_id[1] = next_client * external_source_chunk_size;
 
     next_client += 1;
-    next_offset += external_source_chunk_size;
-
-    if (!(next_offset < max_reals))
-        return make_error(external_source_errc::binary_file_eof_error);
 
-    return binary_file_source_fill_buffer(*this, src, data);
+    return binary_file_source_view(m_reals, max_reals, src, data);
 }
 
 status binary_file_source::update(source& src, source_data& data) noexcept
 {
-    const auto distance = external_source_chunk_size * max_clients;
-    const auto next     = data.chunk_id[1] + distance;
-
-    if (!(next + external_source_chunk_size < max_reals))
-        return make_error(external_source_errc::binary_file_eof_error);
-
+    // All the clients are attached during the initialization: the stride is
+    // the number of clients.
+    data.chunk_id[1] += external_source_chunk_size * next_client;
     src.index = 0;
 
-    return binary_file_source_fill_buffer(*this, src, data);
+    return binary_file_source_view(m_reals, max_reals, src, data);
 }
 
 status binary_file_source::restore(source& src, source_data& data) noexcept
 {
-    if (offsets[numeric_cast<int>(data.chunk_id[0])] != data.chunk_id[1])
-        return binary_file_source_fill_buffer(*this, src, data);
-
-    return success();
+    return binary_file_source_view(m_reals, max_reals, src, data);
 }
 
 status binary_file_source::finalize(source& src, source_data&) noexcept
@@ -306,10 +260,13 @@ text_file_source::text_file_source(const std::filesystem::path& p) noexcept
   : file_path(p)
 {}
 
+text_file_source::~text_file_source() noexcept { finalize(); }
+
 text_file_source::text_file_source(const text_file_source& other) noexcept
   : name(other.name)
   , buffer(other.buffer)
   , offset(other.offset)
+  , use_binary_cache(other.use_binary_cache)
   , file_path(other.file_path)
 {}
 
@@ -318,34 +275,221 @@ void text_file_source::swap(text_file_source& other) noexcept
     std::swap(name, other.name);
     std::swap(buffer, other.buffer);
     std::swap(offset, other.offset);
+    std::swap(use_binary_cache, other.use_binary_cache);
     std::swap(file_path, other.file_path);
+    std::swap(m_block, other.m_block);
+    std::swap(m_block_offset, other.m_block_offset);
+    std::swap(m_block_pos, other.m_block_pos);
+    std::swap(m_block_len, other.m_block_len);
+    std::swap(m_reals, other.m_reals);
+    std::swap(m_map, other.m_map);
+    std::swap(m_max_reals, other.m_max_reals);
+}
+
+std::filesystem::path text_file_source::binary_cache_path() const noexcept
+{
+    auto cache = file_path;
+    cache += ".bin";
+
+    return cache;
+}
+
+/// Moves the unread part of the block at the beginning of the block and
+/// appends the next bytes of the file. Returns false if nothing was read.
+bool text_file_source::fill_block() noexcept
+{
+    const auto remaining = m_block_len - m_block_pos;
+    if (remaining > 0 and m_block_pos > 0)
+        std::memmove(m_block.data(), m_block.data() + m_block_pos, remaining);
+
+    m_block_offset += m_block_pos;
+    m_block_pos = 0;
+    m_block_len = remaining;
+
+    if (not ifs.is_open() or ifs.eof() or m_block_len == block_size)
+        return false;
+
+    ifs.read(m_block.data() + m_block_len,
+             static_cast<std::streamsize>(block_size - m_block_len));
+
+    const auto read = static_cast<u32>(ifs.gcount());
+    m_block_len += read;
+
+    return read > 0;
+}
+
+/// Reads the next real of the text file. Reals are separated by white spaces
+/// and parsed by @c std::from_chars.
+bool text_file_source::read_real(double& value) noexcept
+{
+    constexpr auto is_space = [](const char c) noexcept {
+        return c == ' ' or c == '\n' or c == '\t' or c == '\r' or
+               c == '\v' or c == '\f';
+    };
+
+    for (;;) {
+        while (m_block_pos < m_block_len and
+               is_space(m_block[static_cast<sz>(m_block_pos)]))
+            ++m_block_pos;
+
+        auto end = m_block_pos;
+        while (end < m_block_len and not is_space(m_block[static_cast<sz>(end)]))
+            ++end;
+
+        // The token may continue in the next block of the file.
+        if (end == m_block_len and not ifs.eof()) {
+            if (fill_block())
+                continue;
+
+            if (m_block_len == block_size)
+                return false;
+        }
+
+        if (m_block_pos == end)
+            return false;
+
+        const auto* first = m_block.data() + m_block_pos;
+        const auto* last  = m_block.data() + end;
+        if (*first == '+')
+            ++first;
+
+        const auto ret = std::from_chars(first, last, value);
+        if (ret.ec != std::errc{} or ret.ptr != last)
+            return false;
+
+        m_block_pos = end;
+        return true;
+    }
+}
+
+bool text_file_source::seek(const u64 position) noexcept
+{
+    if (not is_numeric_castable<std::ifstream::off_type>(position))
+        return false;
+
+    ifs.clear();
+    if (not ifs.seekg(numeric_cast<std::ifstream::off_type>(position)))
+        return false;
+
+    m_block_offset = position;
+    m_block_pos    = 0;
+    m_block_len    = 0;
+
+    return true;
+}
+
+status text_file_source::convert_to_binary_cache() noexcept
+{
+    const auto cache = binary_cache_path();
+    auto       tmp   = cache;
+    tmp += ".tmp";
+
+    {
+        std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+        if (not ofs)
+            return make_error(external_source_errc::text_file_access_error);
+
+        double value = 0;
+        while (read_real(value))
+            if (not ofs.write(reinterpret_cast<const char*>(&value),
+                              sizeof(value)))
+                return make_error(
+                  external_source_errc::text_file_access_error);
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, cache, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return make_error(external_source_errc::text_file_access_error);
+    }
+
+    return success();
+}
+
+/// Returns true if the binary cache exists and is not older than the text
+/// file.
+static bool is_binary_cache_valid(const std::filesystem::path& file,
+                                  const std::filesystem::path& cache) noexcept
+{
+    std::error_code ec;
+
+    const auto cache_time = std::filesystem::last_write_time(cache, ec);
+    if (ec)
+        return false;
+
+    const auto file_time = std::filesystem::last_write_time(file, ec);
+
+    return not ec and file_time <= cache_time;
 }
 
 status text_file_source::init() noexcept
 {
-    if (ifs.is_open())
-        ifs.close();
+    finalize();
+
+    offset = 0;
+    m_block.resize(block_size);
+    m_block_offset = 0;
+    m_block_pos    = 0;
+    m_block_len    = 0;
 
-    ifs.open(file_path);
+    ifs.open(file_path, std::ios::binary);
     if (!ifs)
         return make_error(external_source_errc::text_file_access_error);
 
-    offset = 0;
+    if (use_binary_cache) {
+        const auto cache = binary_cache_path();
+
+        // If the binary cache can not be written (read-only directory for
+        // example) or mapped, the text file is parsed.
+        if (is_binary_cache_valid(file_path, cache) or
+            convert_to_binary_cache().has_value()) {
+            if (auto ret = mapped_file::open(cache); ret.has_value()) {
+                ifs.close();
+
+                m_map       = std::move(*ret);
+                m_reals     = reinterpret_cast<const double*>(m_map.data());
+                m_max_reals = m_map.size() / sizeof(double);
+
+                return success();
+            }
+        }
+
+        if (not seek(0))
+            return make_error(external_source_errc::text_file_access_error);
+    }
 
     return success();
 }
 
 bool text_file_source::read_chunk() noexcept
 {
-    for (int i = 0; i < external_source_chunk_size; ++i)
-        if (not(ifs >> buffer[static_cast<sz>(i)]))
+    for (auto& value : buffer)
+        if (not read_real(value))
             return false;
+
     return true;
 }
 
+/// Reads or, with the binary cache, points the @c source::buffer to the chunk
+/// at the @c offset position.
 static status text_file_source_fill_buffer(text_file_source& ext,
-                                           source& /*src*/) noexcept
+                                           const double*     reals,
+                                           const u64         max_reals,
+                                           source&           src) noexcept
 {
+    if (reals) {
+        if (ext.offset + external_source_chunk_size > max_reals)
+            return make_error(external_source_errc::text_file_eof_error);
+
+        src.buffer = std::span(const_cast<double*>(reals + ext.offset),
+                               external_source_chunk_size);
+
+        return success();
+    }
+
+    src.buffer = std::span(ext.buffer);
+
     if (not ext.read_chunk())
         return make_error(external_source_errc::text_file_eof_error);
 
@@ -365,58 +509,50 @@ text_file_source& text_file_source::operator=(
 
 status text_file_source::init(source& src, source_data& data) noexcept
 {
-    src.buffer = std::span(buffer);
-    src.index  = 0;
-
-    const auto tellg = ifs.tellg();
-    if (tellg == -1)
-        return make_error(external_source_errc::text_file_eof_error);
+    src.index = 0;
 
-    data.chunk_id[0] = static_cast<u64>(tellg);
-    offset           = static_cast<u64>(tellg);
+    offset           = m_reals ? 0u : tell();
+    data.chunk_id[0] = offset;
 
-    return text_file_source_fill_buffer(*this, src);
+    return text_file_source_fill_buffer(*this, m_reals, m_max_reals, src);
 }
 
 void text_file_source::finalize() noexcept
 {
-    if (ifs)
+    if (ifs.is_open())
         ifs.close();
+
+    m_map.close();
+    m_reals     = nullptr;
+    m_max_reals = 0;
 }
 
 status text_file_source::update(source& src, source_data& data) noexcept
 {
     src.index = 0;
 
-    const auto tellg = ifs.tellg();
-    if (tellg == -1)
-        return make_error(external_source_errc::text_file_eof_error);
-
-    data.chunk_id[0] = static_cast<u64>(tellg);
-    offset           = static_cast<u64>(tellg);
+    offset = m_reals ? offset + external_source_chunk_size : tell();
+    data.chunk_id[0] = offset;
 
-    return text_file_source_fill_buffer(*this, src);
+    return text_file_source_fill_buffer(*this, m_reals, m_max_reals, src);
 }
 
 status text_file_source::restore(source& src, source_data& data) noexcept
 {
-    src.buffer = std::span(buffer);
-
-    if (offset != data.chunk_id[0]) {
-        if (!(is_numeric_castable<std::ifstream::off_type>(data.chunk_id[0])))
-            return make_error(external_source_errc::text_file_eof_error);
-
-        if (!ifs.seekg(numeric_cast<std::ifstream::off_type>(data.chunk_id[0])))
-            return make_error(external_source_errc::text_file_eof_error);
+    // The buffer already stores the chunk read at this position.
+    if (offset == data.chunk_id[0]) {
+        src.buffer = m_reals ? std::span(const_cast<double*>(m_reals + offset),
+                                         external_source_chunk_size)
+                             : std::span(buffer);
+        return success();
+    }
 
-        const auto tellg = ifs.tellg();
-        if (!(tellg < 0))
-            return make_error(external_source_errc::text_file_eof_error);
+    if (not m_reals and not seek(data.chunk_id[0]))
+        return make_error(external_source_errc::text_file_eof_error);
 
-        offset = static_cast<u64>(tellg);
-    }
+    offset = data.chunk_id[0];
 
-    return text_file_source_fill_buffer(*this, src);
+    return text_file_source_fill_buffer(*this, m_reals, m_max_reals, src);
 }
 
 status text_file_source::finalize(source& src, source_data&) noexcept
@@ -440,6 +576,8 @@ random_source::random_source(const random_source& other) noexcept
   , reals(other.reals)
   , ints(other.ints)
   , distribution(other.distribution)
+  , m_pages(other.m_pages)
+  , m_steps(other.m_steps)
 {}
 
 random_source& random_source::operator=(const random_source& other) noexcept
@@ -460,162 +598,255 @@ void random_source::swap(random_source& other) noexcept
     std::swap(ints[0], other.ints[0]);
     std::swap(ints[1], other.ints[1]);
     std::swap(distribution, other.distribution);
+    std::swap(m_pages, other.m_pages);
+    std::swap(m_steps, other.m_steps);
 }
 
-status random_source::init() noexcept { return success(); }
-
-status random_source::finalize(source& /*src*/, source_data& data) noexcept
+status random_source::init() noexcept
 {
-    data.chunk_id[2] = 0;
+    m_pages.clear();
+    m_steps.clear();
 
     return success();
 }
 
-status random_source::init(const u64      sim_seed,
-                           const model_id mdl_id,
-                           source&        src,
-                           source_data&   data) noexcept
+status random_source::finalize(source& /*src*/, source_data& data) noexcept
 {
-    src.buffer = std::span(data.chunk_real);
-    src.index  = 0;
-
-    data.chunk_id[0] = sim_seed;
-    data.chunk_id[1] = ordinal(mdl_id);
-    data.chunk_id[2] = 0u; // step
-    data.chunk_id[3] = 0u; // index
-    data.chunk_id[4] = 0u; // First random generator
-    data.chunk_id[5] = 0u; // Second random generator
-
-    data.chunk_real[0] = 0.0;
-    data.chunk_real[1] = 0.0;
+    data.chunk_id[2] = 0;
 
     return success();
 }
 
-status random_source::update(source& src, source_data& data) noexcept
+/// Returns a real in the open interval (0, 1) from the 53 upper bits of @c x.
+static constexpr double to_open_unit(const u64 x) noexcept
 {
-    philox_64_view rng{ data.chunk_id };
-    src.index = 0;
+    return (static_cast<double>(x >> 11) + 0.5) * 0x1.0p-53;
+}
 
-    switch (distribution) {
-    case distribution_type::uniform_int:
-        data.chunk_real[0] =
-          std::uniform_int_distribution(ints[0], ints[1])(rng);
-        data.chunk_real[1] =
-          std::uniform_int_distribution(ints[0], ints[1])(rng);
-        break;
+/// Fills @c out with @c dist applied to each number of @c rng.
+template<typename Distribution>
+static void random_source_transform(std::span<real> out,
+                                    philox_64_block& rng,
+                                    Distribution&&   dist) noexcept
+{
+    for (auto& value : out)
+        value = static_cast<real>(dist(rng));
+}
 
+/// Fills @c out from the @c rng. The common distributions are computed by
+/// inverse-CDF or Box-Muller transforms over a block of random numbers,
+/// the others use the standard distributions.
+static void random_source_generate(const distribution_type    type,
+                                   const std::array<real, 2>& reals,
+                                   const std::array<i32, 2>&  ints,
+                                   std::span<real>            out,
+                                   philox_64_block&           rng) noexcept
+{
+    std::array<u64, external_source_chunk_size> raw;
+
+    const auto generate = [&](const auto op) noexcept {
+        for (sz first = 0; first < out.size(); first += raw.size()) {
+            const auto n = std::min(raw.size(), out.size() - first);
+            rng.generate(std::span(raw.data(), n));
+
+            for (sz i = 0; i < n; ++i)
+                out[first + i] = static_cast<real>(op(to_open_unit(raw[i])));
+        }
+    };
+
+    const auto box_muller = [&](const double mean, const double stddev) {
+        for (sz first = 0; first < out.size(); first += raw.size()) {
+            const auto n = std::min(raw.size(), out.size() - first);
+            rng.generate(std::span(raw.data(), n + (n & 1u)));
+
+            for (sz i = 0; i < n; i += 2) {
+                const auto r =
+                  std::sqrt(-2.0 * std::log(to_open_unit(raw[i])));
+                const auto theta =
+                  2.0 * std::numbers::pi * to_open_unit(raw[i + 1]);
+
+                out[first + i] =
+                  static_cast<real>(mean + stddev * r * std::cos(theta));
+                if (i + 1 < n)
+                    out[first + i + 1] =
+                      static_cast<real>(mean + stddev * r * std::sin(theta));
+            }
+        }
+    };
+
+    const double a = reals[0];
+    const double b = reals[1];
+
+    switch (type) {
     case distribution_type::uniform_real:
-        data.chunk_real[0] =
-          std::uniform_real_distribution(reals[0], reals[1])(rng);
-        data.chunk_real[1] =
-          std::uniform_real_distribution(reals[0], reals[1])(rng);
+        generate([a, b](const double u) noexcept { return a + (b - a) * u; });
         break;
 
     case distribution_type::bernouilli:
-        data.chunk_real[0] = std::bernoulli_distribution(reals[0])(rng);
-        data.chunk_real[1] = std::bernoulli_distribution(reals[0])(rng);
+        generate([a](const double u) noexcept { return u < a ? 1.0 : 0.0; });
         break;
 
-    case distribution_type::binomial:
-        data.chunk_real[0] = std::binomial_distribution(ints[0], reals[0])(rng);
-        data.chunk_real[1] = std::binomial_distribution(ints[0], reals[0])(rng);
+    case distribution_type::exponential:
+        generate([a](const double u) noexcept { return -std::log(u) / a; });
         break;
 
-    case distribution_type::negative_binomial:
-        data.chunk_real[0] =
-          std::negative_binomial_distribution(ints[0], reals[0])(rng);
-        data.chunk_real[0] =
-          std::negative_binomial_distribution(ints[0], reals[0])(rng);
+    case distribution_type::weibull:
+        generate([a, b](const double u) noexcept {
+            return b * std::pow(-std::log(u), 1.0 / a);
+        });
         break;
 
-    case distribution_type::geometric:
-        data.chunk_real[0] = std::geometric_distribution(reals[0])(rng);
-        data.chunk_real[1] = std::geometric_distribution(reals[0])(rng);
+    case distribution_type::exterme_value:
+        generate([a, b](const double u) noexcept {
+            return a - b * std::log(-std::log(u));
+        });
         break;
 
-    case distribution_type::poisson:
-        data.chunk_real[0] = std::poisson_distribution(reals[0])(rng);
-        data.chunk_real[1] = std::poisson_distribution(reals[0])(rng);
+    case distribution_type::cauchy:
+        generate([a, b](const double u) noexcept {
+            return a + b * std::tan(std::numbers::pi * (u - 0.5));
+        });
         break;
 
-    case distribution_type::exponential:
-        data.chunk_real[0] = std::exponential_distribution(reals[0])(rng);
-        data.chunk_real[1] = std::exponential_distribution(reals[0])(rng);
+    case distribution_type::normal:
+        box_muller(a, b);
         break;
 
-    case distribution_type::gamma:
-        data.chunk_real[0] = std::gamma_distribution(reals[0], reals[1])(rng);
-        data.chunk_real[1] = std::gamma_distribution(reals[0], reals[1])(rng);
+    case distribution_type::lognormal:
+        box_muller(a, b);
+        for (auto& value : out)
+            value = static_cast<real>(std::exp(value));
         break;
 
-    case distribution_type::weibull:
-        data.chunk_real[0] = std::weibull_distribution(reals[0], reals[1])(rng);
-        data.chunk_real[1] = std::weibull_distribution(reals[0], reals[1])(rng);
+    case distribution_type::uniform_int:
+        random_source_transform(
+          out, rng, std::uniform_int_distribution(ints[0], ints[1]));
         break;
 
-    case distribution_type::exterme_value:
-        data.chunk_real[0] =
-          std::extreme_value_distribution(reals[0], reals[1])(rng);
-        data.chunk_real[0] =
-          std::extreme_value_distribution(reals[0], reals[1])(rng);
+    case distribution_type::binomial:
+        random_source_transform(
+          out, rng, std::binomial_distribution(ints[0], reals[0]));
         break;
 
-    case distribution_type::normal:
-        data.chunk_real[0] = std::normal_distribution(reals[0], reals[1])(rng);
-        data.chunk_real[1] = std::normal_distribution(reals[0], reals[1])(rng);
+    case distribution_type::negative_binomial:
+        random_source_transform(
+          out, rng, std::negative_binomial_distribution(ints[0], reals[0]));
         break;
 
-    case distribution_type::lognormal:
-        data.chunk_real[0] =
-          std::lognormal_distribution(reals[0], reals[1])(rng);
-        data.chunk_real[0] =
-          std::lognormal_distribution(reals[0], reals[1])(rng);
+    case distribution_type::geometric:
+        random_source_transform(
+          out, rng, std::geometric_distribution(reals[0]));
         break;
 
-    case distribution_type::chi_squared:
-        data.chunk_real[0] = std::chi_squared_distribution(reals[0])(rng);
-        data.chunk_real[1] = std::chi_squared_distribution(reals[0])(rng);
+    case distribution_type::poisson:
+        random_source_transform(out, rng, std::poisson_distribution(reals[0]));
         break;
 
-    case distribution_type::cauchy:
-        data.chunk_real[0] = std::cauchy_distribution(reals[0], reals[1])(rng);
-        data.chunk_real[1] = std::cauchy_distribution(reals[0], reals[1])(rng);
+    case distribution_type::gamma:
+        random_source_transform(
+          out, rng, std::gamma_distribution(reals[0], reals[1]));
+        break;
+
+    case distribution_type::chi_squared:
+        random_source_transform(
+          out, rng, std::chi_squared_distribution(reals[0]));
         break;
 
     case distribution_type::fisher_f:
-        data.chunk_real[0] =
-          std::fisher_f_distribution(reals[0], reals[1])(rng);
-        data.chunk_real[1] =
-          std::fisher_f_distribution(reals[0], reals[1])(rng);
+        random_source_transform(
+          out, rng, std::fisher_f_distribution(reals[0], reals[1]));
         break;
 
     case distribution_type::student_t:
-        data.chunk_real[0] = std::student_t_distribution(reals[0])(rng);
-        data.chunk_real[1] = std::student_t_distribution(reals[0])(rng);
+        random_source_transform(
+          out, rng, std::student_t_distribution(reals[0]));
         break;
     }
+}
 
-    return success();
+std::span<real> random_source::client_buffer(const u64 client) noexcept
+{
+    auto& page = m_pages[static_cast<sz>(client / page_size)];
+
+    return std::span(page[static_cast<sz>(client % page_size)]);
 }
 
-void random_source::fill(std::span<real>    buffer,
-                         const source&      src,
-                         const source_data& data) noexcept
+/// Generates the block of the client from the step of the current block and
+/// stores the step of the next block.
+void random_source::fill_client(source& src, source_data& data) noexcept
 {
-    source      source_copy{ src };
-    source_data source_data{ data };
+    const auto client = static_cast<sz>(data.chunk_id[3]);
+
+    philox_64_block rng{ data.chunk_id[0], data.chunk_id[1], data.chunk_id[2] };
+    src.buffer = client_buffer(client);
+    random_source_generate(distribution, reals, ints, src.buffer, rng);
+
+    data.chunk_id[4] = rng.step();
+    m_steps[client]  = data.chunk_id[2];
+}
 
-    for (sz i = 0u; i < buffer.size(); i += 2u) {
-        update(source_copy, source_data);
+status random_source::init(const u64      sim_seed,
+                           const model_id mdl_id,
+                           source&        src,
+                           source_data&   data) noexcept
+{
+    const auto client = m_steps.size();
 
-        buffer[i]     = source_data.chunk_real[0];
-        buffer[i + 1] = source_data.chunk_real[1];
+    if (client % page_size == 0u) {
+        auto* page = m_pages.emplace_back();
+        if (not page or not page->resize(page_size))
+            return make_error(external_source_errc::memory_error);
     }
+
+    if (not m_steps.emplace_back(0u))
+        return make_error(external_source_errc::memory_error);
+
+    src.index = 0;
+
+    data.chunk_id[0] = sim_seed;
+    data.chunk_id[1] = ordinal(mdl_id);
+    data.chunk_id[2] = 0u; // step of the current block
+    data.chunk_id[3] = client;
+    data.chunk_id[4] = 0u; // step of the next block
+    data.chunk_id[5] = 0u;
+
+    fill_client(src, data);
+
+    return success();
+}
+
+status random_source::update(source& src, source_data& data) noexcept
+{
+    if (not(data.chunk_id[3] < m_steps.size()))
+        return make_error(external_source_errc::random_unknown);
+
+    src.index        = 0;
+    data.chunk_id[2] = data.chunk_id[4];
+
+    fill_client(src, data);
+
+    return success();
+}
+
+void random_source::fill(std::span<real>    buffer,
+                         const source&      /*src*/,
+                         const source_data& data) noexcept
+{
+    philox_64_block rng{ data.chunk_id[0], data.chunk_id[1], data.chunk_id[2] };
+    random_source_generate(distribution, reals, ints, buffer, rng);
 }
 
-status random_source::restore(source& /*src*/, source_data& /*data*/) noexcept
+status random_source::restore(source& src, source_data& data) noexcept
 {
+    const auto client = data.chunk_id[3];
+    if (not(client < m_steps.size()))
+        return make_error(external_source_errc::random_unknown);
+
+    if (m_steps[static_cast<sz>(client)] != data.chunk_id[2])
+        fill_client(src, data);
+    else
+        src.buffer = client_buffer(client);
+
     return success();
 }
 
@@ -648,8 +879,8 @@ void external_source::finalize() noexcept
 external_source::external_source(
   const external_source_reserve_definition& res) noexcept
   : constant_sources{ res.constant_nb.value() }
-  , binary_file_sources{ res.text_file_nb.value() }
-  , text_file_sources{ res.binary_file_nb.value() }
+  , binary_file_sources{ res.binary_file_nb.value() }
+  , text_file_sources{ res.text_file_nb.value() }
   , random_sources{ res.random_nb.value() }
   , binary_file_max_client{ res.binary_file_max_client.value() }
   , random_max_client{ res.random_max_client.value() }
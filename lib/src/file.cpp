@@ -25,7 +25,10 @@
 #else
 #include <windows.h>
 #endif
+#include <winioctl.h>
 #else
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -767,6 +770,204 @@ std::FILE* file::to_file() const noexcept
 
 file_mode file::get_mode() const noexcept { return mode; }
 
+mapped_file::~mapped_file() noexcept { close(); }
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+  : m_data(std::exchange(other.m_data, nullptr))
+  , m_size(std::exchange(other.m_size, 0))
+{}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+{
+    if (this != &other) {
+        close();
+
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+
+    return *this;
+}
+
+expected<mapped_file> mapped_file::open(
+  const std::filesystem::path& path) noexcept
+{
+#if defined(_WIN32)
+    auto* file = ::CreateFileW(path.c_str(),
+                               GENERIC_READ,
+                               FILE_SHARE_READ,
+                               nullptr,
+                               OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL,
+                               nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return make_error(file_errc::open_error);
+
+    LARGE_INTEGER size;
+    if (not ::GetFileSizeEx(file, &size)) {
+        ::CloseHandle(file);
+        return make_error(file_errc::open_error);
+    }
+
+    if (size.QuadPart == 0) {
+        ::CloseHandle(file);
+        return make_error(file_errc::empty);
+    }
+
+    auto* mapping =
+      ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    ::CloseHandle(file);
+    if (not mapping)
+        return make_error(file_errc::open_error);
+
+    auto* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (not view)
+        return make_error(file_errc::memory_error);
+
+    const auto bytes = static_cast<u64>(size.QuadPart);
+#else
+    const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return make_error(file_errc::open_error);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return make_error(file_errc::open_error);
+    }
+
+    if (st.st_size == 0) {
+        ::close(fd);
+        return make_error(file_errc::empty);
+    }
+
+    const auto bytes = static_cast<u64>(st.st_size);
+    auto*      view =
+      ::mmap(nullptr, static_cast<size_t>(bytes), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return make_error(file_errc::memory_error);
+#endif
+
+    mapped_file ret;
+    ret.m_data = static_cast<std::byte*>(view);
+    ret.m_size = bytes;
+
+    return ret;
+}
+
+expected<mapped_file> mapped_file::open(const std::filesystem::path& path,
+                                        const u64                    offset,
+                                        const u64                    bytes,
+                                        const bool truncate) noexcept
+{
+    if (bytes == 0)
+        return make_error(file_errc::empty);
+
+    const auto end = offset + bytes;
+
+#if defined(_WIN32)
+    auto* file = ::CreateFileW(path.c_str(),
+                               GENERIC_READ | GENERIC_WRITE,
+                               FILE_SHARE_READ,
+                               nullptr,
+                               truncate ? CREATE_ALWAYS : OPEN_ALWAYS,
+                               FILE_ATTRIBUTE_NORMAL,
+                               nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return make_error(file_errc::open_error);
+
+    // Without the sparse attribute, the file mapping allocates all the disk
+    // blocks of the file.
+    DWORD returned = 0;
+    ::DeviceIoControl(
+      file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returned, nullptr);
+
+    LARGE_INTEGER size;
+    if (not ::GetFileSizeEx(file, &size)) {
+        ::CloseHandle(file);
+        return make_error(file_errc::open_error);
+    }
+
+    if (static_cast<u64>(size.QuadPart) < end) {
+        size.QuadPart = static_cast<LONGLONG>(end);
+        if (not ::SetFilePointerEx(file, size, nullptr, FILE_BEGIN) or
+            not ::SetEndOfFile(file)) {
+            ::CloseHandle(file);
+            return make_error(file_errc::memory_error);
+        }
+    }
+
+    auto* mapping = ::CreateFileMappingW(file,
+                                         nullptr,
+                                         PAGE_READWRITE,
+                                         static_cast<DWORD>(end >> 32),
+                                         static_cast<DWORD>(end),
+                                         nullptr);
+    ::CloseHandle(file);
+    if (not mapping)
+        return make_error(file_errc::memory_error);
+
+    auto* view = ::MapViewOfFile(mapping,
+                                 FILE_MAP_ALL_ACCESS,
+                                 static_cast<DWORD>(offset >> 32),
+                                 static_cast<DWORD>(offset),
+                                 static_cast<SIZE_T>(bytes));
+    ::CloseHandle(mapping);
+    if (not view)
+        return make_error(file_errc::memory_error);
+#else
+    const auto flags = O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+    const auto fd    = ::open(path.c_str(), flags, 0644);
+    if (fd < 0)
+        return make_error(file_errc::open_error);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return make_error(file_errc::open_error);
+    }
+
+    if (static_cast<u64>(st.st_size) < end and
+        ::ftruncate(fd, static_cast<off_t>(end)) != 0) {
+        ::close(fd);
+        return make_error(file_errc::memory_error);
+    }
+
+    auto* view = ::mmap(nullptr,
+                        static_cast<size_t>(bytes),
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED,
+                        fd,
+                        static_cast<off_t>(offset));
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return make_error(file_errc::memory_error);
+#endif
+
+    mapped_file ret;
+    ret.m_data = static_cast<std::byte*>(view);
+    ret.m_size = bytes;
+
+    return ret;
+}
+
+void mapped_file::close() noexcept
+{
+    if (not m_data)
+        return;
+
+#if defined(_WIN32)
+    ::UnmapViewOfFile(m_data);
+#else
+    ::munmap(m_data, static_cast<size_t>(m_size));
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
 memory::memory(const i64 length) noexcept
   : data(static_cast<i32>(length), static_cast<i32>(length))
   , pos(0)
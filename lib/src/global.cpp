@@ -118,6 +118,9 @@ static std::error_code do_write(const variables& vars, std::FILE* file) noexcept
     fmt::print(file,
                "text-file-viewer-max-file-size={}\n",
                vars.text_file_viewer_max_file_size.load());
+    fmt::print(file,
+               "save-component-caches={}\n",
+               vars.save_component_caches.load());
 
     fmt::print(file, "[themes]\n");
     fmt::print(file, "selected={}\n", themes[vars.theme]);
@@ -254,6 +257,15 @@ static bool do_read_affect(variables&             vars,
         return true;
     }
 
+    if (current_section.test(section_options) and
+        key == "save-component-caches") {
+        if (val != "true" and val != "false")
+            return false;
+
+        vars.save_component_caches.store(val == "true");
+        return true;
+    }
+
     return false;
 }
 
@@ -46,6 +46,14 @@ static void build_graph(graph_observer&  graph_obs,
 
                     sim.observe(*mdl, graph_obs.timestep.to_double());
 
+                    if (auto* obs = sim.observers.try_to_get(mdl->obs_id)) {
+                        obs->history_budget(
+                          static_cast<std::size_t>(
+                            graph_obs.history_budget.value()) *
+                          1024u);
+                        obs->lossless(graph_obs.lossless);
+                    }
+
                     graph_obs.observers[index] = mdl->obs_id;
                 } else {
                     jn.push(log_level::warning, [&](auto& t, auto& m) noexcept {
@@ -85,6 +85,15 @@ static void build_grid_observer(grid_observer&   grid_obs,
 
                     grid_obs.observers[index] = init_or_reuse_observer(
                       sim, *mdl, grid_obs.timestep, w.first, w.second);
+
+                    if (auto* obs = sim.observers.try_to_get(
+                          grid_obs.observers[index])) {
+                        obs->history_budget(
+                          static_cast<std::size_t>(
+                            grid_obs.history_budget.value()) *
+                          1024u);
+                        obs->lossless(grid_obs.lossless);
+                    }
                 } else {
                     jn.push(log_level::warning, [&](auto& t, auto& m) noexcept {
                         t = "Grid observer error";
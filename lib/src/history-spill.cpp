@@ -0,0 +1,166 @@
+// Copyright (c) 2025 INRAE Distributed under the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <irritator/core.hpp>
+#include <irritator/format.hpp>
+
+#include <filesystem>
+#include <utility>
+
+namespace irt {
+
+// The spill file is a sequence of pages without header:
+//
+// page: real dates[page_size], real values[page_size].
+//
+// The file is sparse and mapped by segments of doubling size: the segment @c
+// k starts at the page @c first * (2^k - 1). Disk blocks are only allocated
+// for the written pages and the file is truncated to the written pages at
+// close. The page size is a multiple of the mapping granularity of the
+// systems, so each segment offset is valid.
+
+static_assert(history_spill::page_bytes % 65536u == 0);
+
+history_spill::~history_spill() noexcept { close(); }
+
+history_spill::history_spill(history_spill&& other) noexcept
+  : m_segments{ std::move(other.m_segments) }
+  , m_path{ std::move(other.m_path) }
+  , m_first{ std::exchange(other.m_first, 0) }
+  , m_capacity{ std::exchange(other.m_capacity, 0) }
+  , m_pages{ std::exchange(other.m_pages, 0) }
+  , m_mapped{ std::exchange(other.m_mapped, 0) }
+{}
+
+history_spill& history_spill::operator=(history_spill&& other) noexcept
+{
+    if (this != &other) {
+        close();
+
+        m_segments = std::move(other.m_segments);
+        m_path     = std::move(other.m_path);
+        m_first    = std::exchange(other.m_first, 0);
+        m_capacity = std::exchange(other.m_capacity, 0);
+        m_pages    = std::exchange(other.m_pages, 0);
+        m_mapped   = std::exchange(other.m_mapped, 0);
+    }
+
+    return *this;
+}
+
+status history_spill::open(const std::filesystem::path& path,
+                           const u64                    initial_samples) noexcept
+{
+    close();
+
+    const auto first = (initial_samples + page_size - 1) / page_size;
+    if (first == 0)
+        return make_error(file_errc::memory_error);
+
+    auto ret = mapped_file::open(path, 0, first * page_bytes, true);
+    if (not ret.has_value())
+        return ret.error();
+
+    try {
+        m_path = path;
+    } catch (...) {
+        return make_error(file_errc::memory_error);
+    }
+
+    m_segments[0] = std::move(*ret);
+    m_first       = first;
+    m_capacity    = first;
+    m_pages       = 0;
+    m_mapped      = 1;
+
+    return success();
+}
+
+void history_spill::close() noexcept
+{
+    if (not is_open())
+        return;
+
+    for (auto& segment : m_segments)
+        segment.close();
+
+    std::error_code ec;
+    std::filesystem::resize_file(m_path, m_pages * page_bytes, ec);
+
+    m_first    = 0;
+    m_capacity = 0;
+    m_pages    = 0;
+    m_mapped   = 0;
+}
+
+bool history_spill::grow() noexcept
+{
+    if (m_mapped >= max_segments)
+        return false;
+
+    const auto pages = m_first << m_mapped;
+    auto       ret   = mapped_file::open(
+      m_path, m_capacity * page_bytes, pages * page_bytes, false);
+    if (not ret.has_value())
+        return false;
+
+    m_segments[m_mapped] = std::move(*ret);
+    m_capacity += pages;
+    ++m_mapped;
+
+    return true;
+}
+
+bool history_spill::write(const u64                         page,
+                          std::span<const resampled_sample> samples) noexcept
+{
+    debug::ensure(samples.size() == page_size);
+
+    if (not is_open())
+        return false;
+
+    while (page >= m_capacity)
+        if (not grow())
+            return false;
+
+    if (page >= m_pages)
+        m_pages = page + 1;
+
+    const auto [k, index] = locate(page);
+
+    auto* dates  = reinterpret_cast<real*>(m_segments[k].data() +
+                                          index * page_bytes);
+    auto* values = dates + page_size;
+
+    for (u32 i = 0; i < page_size; ++i) {
+        dates[i]  = samples[i].t;
+        values[i] = samples[i].value;
+    }
+
+    return true;
+}
+
+status simulation::spill_observers(const std::filesystem::path& dir,
+                                   vector<history_spill>&       spills,
+                                   const u64 initial_samples) noexcept
+{
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+
+    spills.clear();
+    if (not spills.resize(observers.capacity()))
+        return make_error(file_errc::memory_error);
+
+    for (auto& obs : observers) {
+        const auto idx  = get_index(observers.get_id(obs));
+        const auto name = format_n<32>("observer-{}.data", idx);
+
+        irt_check(spills[idx].open(dir / name.sv(), initial_samples));
+        obs.spill(&spills[idx]);
+    }
+
+    return success();
+}
+
+} // namespace irt
@@ -477,19 +477,49 @@ private:
     std::array<std::string, 4> m_integers = {};
 };
 
+/// Writes the type of the simulation: a @c fixed_simulation restricted to
+/// the dynamics types used by the models of @c sim.
+static void write_test_simulation_type(std::FILE*        os,
+                                       const simulation& sim) noexcept
+{
+    std::array<bool, dynamics_type_size()> used{};
+    for (const auto& mdl : sim.models)
+        used[ordinal(mdl.type)] = true;
+
+    if (std::ranges::none_of(used, [](const auto b) { return b; })) {
+        fmt::print(os, "irt::simulation");
+        return;
+    }
+
+    fmt::print(os, "irt::fixed_simulation<");
+
+    auto first = true;
+    for (std::size_t i = 0; i < used.size(); ++i) {
+        if (used[i]) {
+            fmt::print(os,
+                       "{}\n      irt::{}",
+                       first ? "" : ",",
+                       dynamics_type_names[i]);
+            first = false;
+        }
+    }
+
+    fmt::print(os, ">");
+}
+
 static void write_test_simulation_header(std::FILE*             os,
                                          const std::string_view name,
                                          const simulation&      sim) noexcept
 {
+    fmt::print(os, "\n\"{}\"_test = [] {{\n    ", name);
+    write_test_simulation_type(os, sim);
+    fmt::print(os, "\n      sim;\n");
+
     fmt::print(os,
                R"(
-"{}"_test = [] {{
-    irt::simulation sim;
-
     expect(fatal(sim.can_alloc({})));
     expect(fatal(sim.hsms.can_alloc({})));
 )",
-               name,
                sim.models.ssize(),
                sim.hsms.ssize());
 }
@@ -907,7 +937,7 @@ static void write_test_simulation_constant_source(
 
     fmt::print(os,
                R"(
-    auto& constant_src_{} = sim.srcs.constant_sources.alloc());
+    auto& constant_src_{} = sim.srcs.constant_sources.alloc();
     format(constant_src_{}.name, "source-{}", src_index);
     constant_src_{}.length = {};
     constant_src_{}.buffer = {{ )",
@@ -1162,7 +1192,7 @@ auto write_test_simulation(std::FILE*                          os,
                       if constexpr (std::is_same_v<Dynamics, irt::counter>) {
                           fmt::print(os,
                                      R"(
-    expect(eq(mdl_{}.number, static_cast<irt::i64>({})));
+    expect(eq(mdl_{}.event_number, static_cast<irt::i64>({})));
     expect(eq(mdl_{}.last_value, {:g}));
 )",
                                      idx,
@@ -1179,8 +1209,314 @@ auto write_test_simulation(std::FILE*                          os,
 
     fmt::print(os, "}};\n");
 
-    return std::ferror(os) ? write_test_simulation_result::success
-                           : write_test_simulation_result::output_error;
+    return std::ferror(os) ? write_test_simulation_result::output_error
+                           : write_test_simulation_result::success;
+}
+
+static void write_standalone_simulation_header(std::FILE*             os,
+                                               const std::string_view name,
+                                               const simulation& sim) noexcept
+{
+    fmt::print(os,
+               R"(// Standalone simulator of the "{}" simulation generated by irritator.
+//
+// Build it with the irritator headers and library, for example:
+//
+//   c++ -std=c++20 -O3 -fPIC -shared -I<irritator>/lib/include <file.cpp>
+//       <irritator>/lib/libirritator.a -o <simulator.so>
+//
+// C ABI (see the functions at the end of the file):
+//
+//   irt_simulator* irt_simulator_create(void);
+//   void           irt_simulator_destroy(irt_simulator* s);
+//   int            irt_simulator_step(irt_simulator* s, double until);
+//   double         irt_simulator_time(const irt_simulator* s);
+//   int            irt_simulator_models(const irt_simulator* s);
+//   int            irt_simulator_value(const irt_simulator* s, int model,
+//                                      double* value);
+//   int            irt_simulator_observers(const irt_simulator* s);
+//   int            irt_simulator_observations(irt_simulator* s, int observer,
+//                                             int first, double* dates,
+//                                             double* values, int capacity);
+//
+// Models:
+//
+)",
+               name);
+
+    int i = 0;
+    for (const auto& mdl : sim.models)
+        fmt::print(os,
+                   "//   {:>4}: mdl_{} ({})\n",
+                   i++,
+                   get_index(sim.models.get_id(mdl)),
+                   dynamics_type_names[ordinal(mdl.type)]);
+
+    fmt::print(os, "//\n// Observers:\n//\n");
+
+    i = 0;
+    for (const auto& obs : sim.observers)
+        if (const auto* mdl = sim.models.try_to_get(obs.model()))
+            fmt::print(os,
+                       "//   {:>4}: mdl_{}\n",
+                       i++,
+                       get_index(sim.models.get_id(*mdl)));
+
+    fmt::print(os,
+               R"(
+#include <irritator/core.hpp>
+
+#include <array>
+#include <new>
+
+#if defined(_WIN32)
+#define IRT_SIMULATOR_API extern "C" __declspec(dllexport)
+#else
+#define IRT_SIMULATOR_API extern "C" __attribute__((visibility("default")))
+#endif
+
+namespace {{
+
+using simulation_type = )");
+
+    write_test_simulation_type(os, sim);
+
+    fmt::print(os, ";\n\n}} // namespace\n");
+}
+
+static void write_standalone_simulation_struct(std::FILE*        os,
+                                               const simulation& sim,
+                                               const int observers) noexcept
+{
+    fmt::print(os,
+               R"(
+struct irt_simulator {{
+    simulation_type sim{{ irt::simulation_reserve_definition{{
+      .models      = {},
+      .connections = {},
+      .hsms        = {} }} }};
+
+    std::array<irt::model_id, {}>    models{{}};
+    std::array<irt::observer_id, {}> observers{{}};
+
+    bool finalized = false;
+
+    bool build() noexcept;
+}};
+
+bool irt_simulator::build() noexcept
+{{
+    auto       ok     = true;
+    const auto expect = [&ok](const bool b) noexcept {{ ok = ok and b; }};
+
+    if (not sim.can_alloc({}) or not sim.hsms.can_alloc({}))
+        return false;
+)",
+               std::max(sim.models.ssize(), 512),
+               std::max(sim.output_ports.ssize(), 1024),
+               std::max(sim.hsms.ssize(), 16),
+               sim.models.ssize(),
+               observers,
+               sim.models.ssize(),
+               sim.hsms.ssize());
+}
+
+static void write_standalone_simulation_build(std::FILE*        os,
+                                              const simulation& sim,
+                                              const time        begin,
+                                              const time        end) noexcept
+{
+    fmt::print(os, "\n\n    models = {{ {{");
+    for (const auto& mdl : sim.models)
+        fmt::print(
+          os, "\n      sim.get_id(mdl_{}),", get_index(sim.models.get_id(mdl)));
+    fmt::print(os, " }} }};\n");
+
+    // Observers are lossless: no sample is lost between two readings.
+    int i = 0;
+    for (const auto& obs : sim.observers) {
+        if (const auto* mdl = sim.models.try_to_get(obs.model())) {
+            fmt::print(
+              os,
+              R"(
+    expect(sim.observe(irt::get_model(mdl_{}), {:.{}g}).has_value());
+    observers[{}] = irt::get_model(mdl_{}).obs_id;
+    if (auto* obs = sim.observers.try_to_get(observers[{}]))
+        obs->lossless(true);
+)",
+              get_index(sim.models.get_id(*mdl)),
+              sim.observers.get<resampler>(sim.observers.get_id(obs))
+                .time_step(),
+              std::numeric_limits<real>::max_digits10,
+              i,
+              get_index(sim.models.get_id(*mdl)),
+              i);
+            ++i;
+        }
+    }
+
+    fmt::print(os,
+               R"(
+    sim.limits.set_bound({:.{}g}, {:.{}g});
+
+    return ok and sim.srcs.prepare().has_value() and
+           sim.initialize().has_value();
+}}
+)",
+               begin,
+               std::numeric_limits<real>::max_digits10,
+               end,
+               std::numeric_limits<real>::max_digits10);
+}
+
+static void write_standalone_simulation_api(std::FILE* os) noexcept
+{
+    fmt::print(os,
+               R"(
+/// Allocates and initializes the simulator. Returns nullptr on error.
+IRT_SIMULATOR_API irt_simulator* irt_simulator_create(void)
+{{
+    auto* s = new (std::nothrow) irt_simulator;
+
+    if (s and not s->build()) {{
+        delete s;
+        return nullptr;
+    }}
+
+    return s;
+}}
+
+IRT_SIMULATOR_API void irt_simulator_destroy(irt_simulator* s) {{ delete s; }}
+
+/// Runs the events until the date @c until (included). Returns 0 if the
+/// simulation can continue, 1 if the simulation is finished and -1 on
+/// error.
+IRT_SIMULATOR_API int irt_simulator_step(irt_simulator* s, double until)
+{{
+    auto& sim = s->sim;
+
+    while (not sim.current_time_expired() and not sim.sched.empty() and
+           sim.sched.tn() <= until)
+        if (not sim.run())
+            return -1;
+
+    if (not sim.current_time_expired() and not sim.sched.empty())
+        return 0;
+
+    if (not s->finalized) {{
+        s->finalized = true;
+        if (not sim.finalize())
+            return -1;
+    }}
+
+    return 1;
+}}
+
+IRT_SIMULATOR_API double irt_simulator_time(const irt_simulator* s)
+{{
+    return s->sim.current_time();
+}}
+
+IRT_SIMULATOR_API int irt_simulator_models(const irt_simulator* s)
+{{
+    return static_cast<int>(s->models.size());
+}}
+
+/// Writes the current value of the model @c model into @c value. Returns
+/// -1 if the model does not exist or is not observable.
+IRT_SIMULATOR_API int irt_simulator_value(const irt_simulator* s,
+                                          int                  model,
+                                          double*              value)
+{{
+    if (model < 0 or std::cmp_greater_equal(model, s->models.size()))
+        return -1;
+
+    const auto* mdl = s->sim.models.try_to_get(s->models[model]);
+    if (not mdl)
+        return -1;
+
+    const auto fn = irt::get_dynamics_functions(*mdl).observation;
+    if (not fn)
+        return -1;
+
+    const auto t = s->sim.current_time();
+    const auto e = std::isfinite(t) ? t - mdl->tl : 0.0;
+    *value       = fn(*mdl, mdl->tl + e, e).value;
+
+    return 0;
+}}
+
+IRT_SIMULATOR_API int irt_simulator_observers(const irt_simulator* s)
+{{
+    return static_cast<int>(s->observers.size());
+}}
+
+/// Copies at most @c capacity resampled samples of the observer @c observer
+/// starting at the sample @c first into @c dates and @c values. Returns the
+/// number of copied samples or -1 if the observer does not exist.
+IRT_SIMULATOR_API int irt_simulator_observations(irt_simulator* s,
+                                                 int            observer,
+                                                 int            first,
+                                                 double*        dates,
+                                                 double*        values,
+                                                 int            capacity)
+{{
+    if (observer < 0 or std::cmp_greater_equal(observer, s->observers.size()))
+        return -1;
+
+    auto&      sim = s->sim;
+    const auto id  = s->observers[observer];
+    auto*      obs = sim.observers.try_to_get(id);
+    if (not obs)
+        return -1;
+
+    const auto t = sim.current_time();
+    sim.observers.get<irt::resampler>(id).tick(
+      *obs, s->finalized ? std::numeric_limits<double>::infinity() : t);
+
+    int copied = 0;
+    obs->read_history([&](const auto& h, const auto) {{
+        for (auto i = first; i < h.ssize() and copied < capacity; ++i) {{
+            dates[copied]  = h[i].t;
+            values[copied] = h[i].value;
+            ++copied;
+        }}
+    }});
+
+    return copied;
+}}
+)");
+}
+
+auto write_standalone_simulation(std::FILE*             os,
+                                 const std::string_view name,
+                                 const simulation&      sim,
+                                 const time             begin,
+                                 const time             end) noexcept
+  -> write_test_simulation_result
+{
+    auto observers = 0;
+    for (const auto& obs : sim.observers)
+        if (sim.models.try_to_get(obs.model()))
+            ++observers;
+
+    write_standalone_simulation_header(os, name, sim);
+    write_standalone_simulation_struct(os, sim, observers);
+
+    if (not sim.srcs.constant_sources.empty() and
+        not write_constant_sources(os, sim))
+        return write_test_simulation_result::external_source_error;
+
+    if (not sim.hsms.empty() and not write_test_simulation_hsm(os, sim))
+        return write_test_simulation_result::hsm_error;
+
+    write_test_simulation_models(os, sim);
+    write_test_simulation_connections(os, sim);
+    write_standalone_simulation_build(os, sim, begin, end);
+    write_standalone_simulation_api(os);
+
+    return std::ferror(os) ? write_test_simulation_result::output_error
+                           : write_test_simulation_result::success;
 }
 
 } // namespace irt
@@ -23,13 +23,16 @@
 #include <rapidjson/reader.h>
 #include <rapidjson/writer.h>
 
+#include <algorithm>
 #include <limits>
+#include <new>
 #include <optional>
 #include <string_view>
 #include <utility>
 
 #include <cerrno>
 #include <cstdint>
+#include <cstdio>
 
 using namespace std::literals;
 
@@ -43,6 +46,261 @@ enum class connection_type : u8 {
     output_pack
 };
 
+/// A pull parser over a json file built on the iterative parser of
+/// rapidjson. Only the read buffer and the current token are kept in memory:
+/// @c read() materializes the value starting at the current token into a
+/// small document to reuse the DOM readers of @c json_dearchiver::impl.
+class json_stream_reader
+{
+public:
+    enum class token_type : u8 {
+        none,
+        null,
+        boolean,
+        int32,
+        uint32,
+        int64,
+        uint64,
+        real,
+        string,
+        key,
+        object_begin,
+        object_end,
+        array_begin,
+        array_end
+    };
+
+    json_stream_reader(std::FILE* fp, std::span<char> buffer) noexcept
+      : is(fp, buffer.data(), buffer.size())
+    {
+        reader.IterativeParseInit();
+    }
+
+    /// Reads the next token. Returns @c false at the end of the document or
+    /// if a parse error occurred.
+    bool next() noexcept
+    {
+        tok.type = token_type::none;
+
+        if (reader.IterativeParseComplete())
+            return false;
+
+        if (not reader.IterativeParseNext<rapidjson::kParseNanAndInfFlag>(is,
+                                                                          tok))
+            return false;
+
+        return tok.type != token_type::none;
+    }
+
+    token_type type() const noexcept { return tok.type; }
+
+    /// The string of the current @c key or @c string token.
+    std::string_view str() const noexcept { return tok.str; }
+
+    /// Builds in @c doc the value starting at the current token and moves to
+    /// the last token of this value.
+    bool read(rapidjson::Document& doc) noexcept
+    {
+        generator g{ *this };
+        doc.Populate(g);
+
+        return g.success;
+    }
+
+    /// Moves to the last token of the value starting at the current token.
+    bool skip() noexcept
+    {
+        int depth = 0;
+
+        do {
+            depth += depth_delta(tok.type);
+            if (depth == 0)
+                return tok.type != token_type::none;
+        } while (next());
+
+        return false;
+    }
+
+    bool has_parse_error() const noexcept { return reader.HasParseError(); }
+
+    std::string_view parse_error() const noexcept
+    {
+        return rapidjson::GetParseError_En(reader.GetParseErrorCode());
+    }
+
+    sz parse_error_offset() const noexcept { return reader.GetErrorOffset(); }
+
+private:
+    struct token {
+        token_type  type  = token_type::none;
+        bool        b     = false;
+        i64         i     = 0;
+        u64         u     = 0;
+        double      d     = 0.0;
+        unsigned    count = 0;
+        std::string str;
+
+        bool Null() noexcept { return set(token_type::null); }
+
+        bool Bool(bool v) noexcept
+        {
+            b = v;
+            return set(token_type::boolean);
+        }
+
+        bool Int(int v) noexcept
+        {
+            i = v;
+            return set(token_type::int32);
+        }
+
+        bool Uint(unsigned v) noexcept
+        {
+            u = v;
+            return set(token_type::uint32);
+        }
+
+        bool Int64(std::int64_t v) noexcept
+        {
+            i = v;
+            return set(token_type::int64);
+        }
+
+        bool Uint64(std::uint64_t v) noexcept
+        {
+            u = v;
+            return set(token_type::uint64);
+        }
+
+        bool Double(double v) noexcept
+        {
+            d = v;
+            return set(token_type::real);
+        }
+
+        bool RawNumber(const char* s, rapidjson::SizeType len, bool) noexcept
+        {
+            str.assign(s, len);
+            return set(token_type::string);
+        }
+
+        bool String(const char* s, rapidjson::SizeType len, bool) noexcept
+        {
+            str.assign(s, len);
+            return set(token_type::string);
+        }
+
+        bool Key(const char* s, rapidjson::SizeType len, bool) noexcept
+        {
+            str.assign(s, len);
+            return set(token_type::key);
+        }
+
+        bool StartObject() noexcept { return set(token_type::object_begin); }
+
+        bool EndObject(rapidjson::SizeType n) noexcept
+        {
+            count = n;
+            return set(token_type::object_end);
+        }
+
+        bool StartArray() noexcept { return set(token_type::array_begin); }
+
+        bool EndArray(rapidjson::SizeType n) noexcept
+        {
+            count = n;
+            return set(token_type::array_end);
+        }
+
+        bool set(const token_type t) noexcept
+        {
+            type = t;
+            return true;
+        }
+    };
+
+    /// Replays the tokens of the current value into the handler of a
+    /// @c rapidjson::Document::Populate() call.
+    struct generator {
+        json_stream_reader& s;
+        bool                success = false;
+
+        template<typename Handler>
+        bool operator()(Handler& h) noexcept
+        {
+            int depth = 0;
+
+            do {
+                if (not s.replay(h))
+                    return false;
+
+                depth += depth_delta(s.tok.type);
+                if (depth == 0)
+                    return success = true;
+            } while (s.next());
+
+            return false;
+        }
+    };
+
+    static int depth_delta(const token_type t) noexcept
+    {
+        switch (t) {
+        case token_type::object_begin:
+        case token_type::array_begin:
+            return 1;
+        case token_type::object_end:
+        case token_type::array_end:
+            return -1;
+        default:
+            return 0;
+        }
+    }
+
+    template<typename Handler>
+    bool replay(Handler& h) noexcept
+    {
+        const auto len = static_cast<rapidjson::SizeType>(tok.str.size());
+
+        switch (tok.type) {
+        case token_type::none:
+            return false;
+        case token_type::null:
+            return h.Null();
+        case token_type::boolean:
+            return h.Bool(tok.b);
+        case token_type::int32:
+            return h.Int(static_cast<int>(tok.i));
+        case token_type::uint32:
+            return h.Uint(static_cast<unsigned>(tok.u));
+        case token_type::int64:
+            return h.Int64(tok.i);
+        case token_type::uint64:
+            return h.Uint64(tok.u);
+        case token_type::real:
+            return h.Double(tok.d);
+        case token_type::string:
+            return h.String(tok.str.data(), len, true);
+        case token_type::key:
+            return h.Key(tok.str.data(), len, true);
+        case token_type::object_begin:
+            return h.StartObject();
+        case token_type::object_end:
+            return h.EndObject(tok.count);
+        case token_type::array_begin:
+            return h.StartArray();
+        case token_type::array_end:
+            return h.EndArray(tok.count);
+        }
+
+        unreachable();
+    }
+
+    rapidjson::FileReadStream is;
+    rapidjson::Reader         reader;
+    token                     tok;
+};
+
 struct json_dearchiver::impl {
     json_dearchiver& self;
     journal_handler& jn;
@@ -2847,6 +3105,14 @@ struct json_dearchiver::impl {
                                            source_element>(id)
                                     .txt.file);
 
+                     if ("binary-cache"sv == name)
+                         return read_temp_bool(value) &&
+                                copy_bool_to(
+                                  compo.srcs.data
+                                    .get<external_source_definition::
+                                           source_element>(id)
+                                    .txt.use_binary_cache);
+
                      return true;
                  }) &&
                optional_has_value(id_in_file) and
@@ -5748,9 +6014,279 @@ struct json_dearchiver::impl {
 
         return error_code(json_errc::invalid_project_format);
     }
+
+    /*****************************************************************************
+     *
+     * project file streaming part
+     *
+     ****************************************************************************/
+
+    using token_type = json_stream_reader::token_type;
+
+    bool stream_error(const json_stream_reader& s) noexcept
+    {
+        if (s.has_parse_error())
+            return error("json parse error at offset {}: {}",
+                         s.parse_error_offset(),
+                         s.parse_error());
+
+        return error("unexpected json token");
+    }
+
+    /// Builds in @c doc the value starting at the current token. The previous
+    /// value of @c doc and the memory of its allocator are released first.
+    bool stream_read(json_stream_reader& s, rapidjson::Document& doc) noexcept
+    {
+        doc.SetNull();
+        doc.GetAllocator().Clear();
+
+        return s.read(doc) or stream_error(s);
+    }
+
+    /// Calls @c fn with the index of the member name in @c names and the
+    /// reader on the first token of the member value. Unknown members are
+    /// skipped.
+    template<size_t N, typename Function>
+    bool stream_members(json_stream_reader& s,
+                        const std::string_view (&names)[N],
+                        Function&& fn) noexcept
+    {
+        if (s.type() != token_type::object_begin)
+            return error("json value is not an object");
+
+        while (s.next()) {
+            if (s.type() == token_type::object_end)
+                return true;
+
+            if (s.type() != token_type::key)
+                return stream_error(s);
+
+            const auto x =
+              binary_find(std::begin(names), std::end(names), s.str());
+
+            if (x == std::end(names)) {
+                warning("unknown element {}", s.str());
+
+                if (not(s.next() and s.skip()))
+                    return stream_error(s);
+            } else {
+                if (not s.next())
+                    return stream_error(s);
+
+                if (not std::invoke(std::forward<Function>(fn),
+                                    std::distance(std::begin(names), x)))
+                    return false;
+            }
+        }
+
+        return stream_error(s);
+    }
+
+    /// Calls @c fn for each element of an array with the reader on the first
+    /// token of the element.
+    template<typename Function>
+    bool stream_array(json_stream_reader& s, Function&& fn) noexcept
+    {
+        if (s.type() != token_type::array_begin)
+            return error("json value is not an array");
+
+        while (s.next()) {
+            if (s.type() == token_type::array_end)
+                return true;
+
+            if (not std::invoke(std::forward<Function>(fn)))
+                return false;
+        }
+
+        return stream_error(s);
+    }
+
+    bool stream_project_parameters(json_stream_reader&  s,
+                                   rapidjson::Document& doc) noexcept
+    {
+        auto_stack a(this, "project parameters");
+
+        static constexpr std::string_view names[] = { "global" };
+
+        return stream_members(s, names, [&](const auto /*idx*/) noexcept {
+            auto_stack b(this, "project global parameters");
+
+            return stream_array(s, [&]() noexcept {
+                return project_global_parameters_can_alloc(1) and
+                       stream_read(s, doc) and read_global_parameter(doc);
+            });
+        });
+    }
+
+    bool stream_project_observations(json_stream_reader&  s,
+                                     rapidjson::Document& doc) noexcept
+    {
+        auto_stack a(this, "project observations");
+
+        static constexpr std::string_view names[] = { "global", "grid" };
+
+        return stream_members(s, names, [&](const auto idx) noexcept {
+            if (idx == 0) {
+                auto_stack b(this, "project plot observations");
+
+                return stream_array(s, [&]() noexcept {
+                    return project_variable_observers_can_alloc(1) and
+                           stream_read(s, doc) and
+                           read_project_plot_observation(doc);
+                });
+            }
+
+            auto_stack b(this, "project grid observations");
+
+            return stream_array(s, [&]() noexcept {
+                if (not(project_grid_observers_can_alloc(1) and
+                        stream_read(s, doc)))
+                    return false;
+
+                auto& grid = pj().grid_observers.alloc();
+                return read_project_grid_observation(doc, grid);
+            });
+        });
+    }
+
+    /// Reads the project members in the order of the file. Each parameter and
+    /// observation is materialized alone into @c doc. The parameters and
+    /// observations read before the @c component-path, @c
+    /// component-directory and @c component-file members are buffered into a
+    /// document and read once the top component is set: the file written by
+    /// @c json_archiver never needs this buffer.
+    bool read_project(json_stream_reader&     s,
+                      rapidjson::Document&    doc,
+                      const file_access&      files,
+                      const component_access& ids) noexcept
+    {
+        auto_stack a(this, "project");
+
+        static constexpr std::string_view names[] = {
+            "begin",          "component-directory", "component-file",
+            "component-path", "component-type",      "end",
+            "observations",   "parameters"
+        };
+
+        small_string<31>   reg_name;
+        directory_path_str dir_path;
+        file_path_str      file_path;
+        bool               is_set     = false;
+        unsigned           components = 0;
+
+        double begin = { 0 };
+        double end   = { 100 };
+
+        rapidjson::Document late;
+        late.SetObject();
+
+        const auto defer = [&](const char* name) noexcept -> bool {
+            rapidjson::Document value(&late.GetAllocator());
+            if (not s.read(value))
+                return stream_error(s);
+
+            late.AddMember(
+              rapidjson::StringRef(name), value.Move(), late.GetAllocator());
+            return true;
+        };
+
+        const auto read_late = [&]() noexcept -> bool {
+            for (const auto& m : late.GetObject())
+                if (not("parameters"sv == m.name.GetString()
+                          ? read_project_parameters(m.value)
+                          : read_project_observations(m.value)))
+                    return false;
+
+            late.RemoveAllMembers();
+            return true;
+        };
+
+        const auto set = [&]() noexcept -> bool {
+            if (is_set)
+                return true;
+
+            is_set            = true;
+            component_id c_id = undefined<component_id>();
+
+            return try_modeling_copy_component_id(files,
+                                                  ids,
+                                                  reg_name.sv(),
+                                                  dir_path.sv(),
+                                                  file_path.sv(),
+                                                  c_id) and
+                   project_set(ids, files, c_id) and read_late();
+        };
+
+        const auto can_set = [&]() noexcept -> bool {
+            return is_set or components == 0b1110u;
+        };
+
+        return s.next() and
+               stream_members(
+                 s,
+                 names,
+                 [&](const auto idx) noexcept -> bool {
+                     switch (idx) {
+                     case 0:
+                         return stream_read(s, doc) and
+                                read_temp_real(doc) and copy_real_to(begin);
+                     case 1:
+                         components |= 1u << idx;
+                         return stream_read(s, doc) and
+                                read_temp_string(doc) and
+                                copy_string_to(dir_path);
+                     case 2:
+                         components |= 1u << idx;
+                         return stream_read(s, doc) and
+                                read_temp_string(doc) and
+                                copy_string_to(file_path);
+                     case 3:
+                         components |= 1u << idx;
+                         return stream_read(s, doc) and
+                                read_temp_string(doc) and
+                                copy_string_to(reg_name);
+                     case 5:
+                         return stream_read(s, doc) and
+                                read_temp_real(doc) and copy_real_to(end);
+                     case 6:
+                         return can_set()
+                                  ? set() and stream_project_observations(s, doc)
+                                  : defer("observations");
+                     case 7:
+                         return can_set()
+                                  ? set() and stream_project_parameters(s, doc)
+                                  : defer("parameters");
+                     default:
+                         return s.skip();
+                     }
+                 }) and
+               set() and project_time_limit_affect(begin, end);
+    }
+
+    status parse_project(json_stream_reader&     s,
+                         rapidjson::Document&    doc,
+                         const file_access&      files,
+                         const component_access& ids) noexcept
+    {
+        pj().clear();
+        sim().clear();
+
+        if (read_project(s, doc, files, ids))
+            return success();
+
+        return error_code(json_errc::invalid_project_format);
+    }
 };
 
-static status read_file_to_buffer(vector<char>& buffer, file& f) noexcept
+/// Size of the read buffer of the json file streams and of the first chunk of
+/// the memory pool used to materialize the streamed project elements.
+static constexpr sz json_stream_buffer_size = 64u * 1024u;
+
+/// Checks the file @c f can be streamed and resizes @c buffer to @c size
+/// bytes.
+static status prepare_file_stream(vector<char>& buffer,
+                                  file&         f,
+                                  const sz      size) noexcept
 {
     debug::ensure(f.is_open());
     debug::ensure(f.get_mode()[file_open_options::read] or
@@ -5760,16 +6296,26 @@ static status read_file_to_buffer(vector<char>& buffer, file& f) noexcept
                              f.get_mode()[file_open_options::extended])))
         return error_code(file_errc::open_error);
 
-    const auto len = f.length();
-    if (std::cmp_less(len, 2))
+    if (std::cmp_less(f.length(), 2))
         return error_code(file_errc::empty);
 
-    buffer.resize(len);
-    if (std::cmp_less(buffer.size(), len))
+    buffer.resize(size);
+    if (std::cmp_less(buffer.size(), size))
         return error_code(file_errc::memory_error);
 
-    if (not f.read(buffer.data(), len))
-        return error_code(file_errc::memory_error);
+    return success();
+}
+
+static status parse_json_file(std::span<char>      buffer,
+                              file&                f,
+                              rapidjson::Document& doc) noexcept
+{
+    rapidjson::FileReadStream is(
+      reinterpret_cast<FILE*>(f.get_handle()), buffer.data(), buffer.size());
+    doc.ParseStream<rapidjson::kParseNanAndInfFlag>(is);
+
+    if (doc.HasParseError())
+        return error_code(json_errc::invalid_format);
 
     return success();
 }
@@ -6831,6 +7377,9 @@ struct json_archiver::impl {
             w.String(f->path.data(),
                      static_cast<rapidjson::SizeType>(f->path.size()));
         }
+
+        w.Key("binary-cache");
+        w.Bool(txt.use_binary_cache);
     }
 
     template<typename Writer>
@@ -8390,11 +8939,12 @@ status json_dearchiver::operator()(const file_access& files,
 
     rapidjson::Document doc;
 
-    if (auto ret = read_file_to_buffer(buffer, io); ret.has_error())
+    if (auto ret = prepare_file_stream(buffer, io, json_stream_buffer_size);
+        ret.has_error())
         return ret.error();
 
     if (auto ret =
-          parse_json_data(std::span(buffer.data(), buffer.size()), doc);
+          parse_json_file(std::span(buffer.data(), buffer.size()), io, doc);
         ret.has_error()) {
         compo.state = component_status::unreadable;
         return ret.error();
@@ -8425,18 +8975,20 @@ status json_dearchiver::operator()(project&                pj,
                   io.get_mode()[file_open_options::extended]);
     clear();
 
-    rapidjson::Document doc;
-
-    if (const auto ret = read_file_to_buffer(buffer, io); ret.has_error())
-        return ret.error();
-
     if (const auto ret =
-          parse_json_data(std::span(buffer.data(), buffer.size()), doc);
+          prepare_file_stream(buffer, io, 2 * json_stream_buffer_size);
         ret.has_error())
         return ret.error();
 
+    json_stream_reader s(reinterpret_cast<FILE*>(io.get_handle()),
+                         std::span(buffer.data(), json_stream_buffer_size));
+
+    rapidjson::MemoryPoolAllocator<> pool(
+      buffer.data() + json_stream_buffer_size, json_stream_buffer_size);
+    rapidjson::Document doc(&pool);
+
     json_dearchiver::impl i(*this, jn, pj.sim, pj, path);
-    return i.parse_project(doc, files, ids);
+    return i.parse_project(s, doc, files, ids);
 }
 
 status json_dearchiver::operator()(const file_access& files,
@@ -8468,6 +9020,137 @@ status json_dearchiver::operator()(const file_access& files,
     return success();
 }
 
+/// Appends to @c deps the file of each object of @c val with @c path, @c
+/// directory and @c file string members.
+static void read_dependencies(const file_access&      files,
+                              const rapidjson::Value& val,
+                              vector<file_path_id>&   deps) noexcept
+{
+    if (val.IsArray()) {
+        for (const auto& elem : val.GetArray())
+            read_dependencies(files, elem, deps);
+    } else if (val.IsObject()) {
+        const auto get = [&](const char* name) noexcept -> std::string_view {
+            if (const auto it = val.FindMember(name);
+                it != val.MemberEnd() and it->value.IsString())
+                return std::string_view(it->value.GetString(),
+                                        it->value.GetStringLength());
+
+            return std::string_view();
+        };
+
+        const auto reg  = get("path");
+        const auto dir  = get("directory");
+        const auto file = get("file");
+
+        if (not(reg.empty() or dir.empty() or file.empty()))
+            if (const auto id = files.find_file(reg, dir, file); is_defined(id))
+                deps.emplace_back(id);
+
+        for (const auto& member : val.GetObject())
+            read_dependencies(files, member.value, deps);
+    }
+}
+
+struct json_component_document::impl {
+    rapidjson::Document doc;
+};
+
+json_component_document::~json_component_document() noexcept { clear(); }
+
+json_component_document::json_component_document(
+  json_component_document&& other) noexcept
+  : m_impl(std::exchange(other.m_impl, nullptr))
+{}
+
+json_component_document& json_component_document::operator=(
+  json_component_document&& other) noexcept
+{
+    std::swap(m_impl, other.m_impl);
+    return *this;
+}
+
+status json_component_document::parse(std::span<const char> io) noexcept
+{
+    if (not m_impl) {
+        m_impl = new (std::nothrow) impl;
+        if (not m_impl)
+            return error_code(json_errc::memory_error);
+    }
+
+    m_impl->doc.Parse<rapidjson::kParseNanAndInfFlag>(io.data(), io.size());
+
+    if (m_impl->doc.HasParseError()) {
+        clear();
+        return error_code(json_errc::invalid_format);
+    }
+
+    return success();
+}
+
+void json_component_document::read_dependencies(
+  const file_access&    files,
+  vector<file_path_id>& deps) const noexcept
+{
+    deps.clear();
+
+    if (not m_impl)
+        return;
+
+    ::irt::read_dependencies(files, m_impl->doc, deps);
+
+    std::ranges::sort(deps);
+    const auto dup = std::ranges::unique(deps);
+    deps.erase(dup.begin(), dup.end());
+}
+
+void json_component_document::clear() noexcept
+{
+    delete m_impl;
+    m_impl = nullptr;
+}
+
+status json_dearchiver::read_dependencies(const file_access&    files,
+                                          std::span<const char> io,
+                                          vector<file_path_id>& deps) noexcept
+{
+    json_component_document doc;
+    irt_check(doc.parse(io));
+
+    doc.read_dependencies(files, deps);
+
+    return success();
+}
+
+status json_dearchiver::operator()(const file_access&             files,
+                                   component_access&              ids,
+                                   const component_id             compo_id,
+                                   component&                     compo,
+                                   const json_component_document& doc,
+                                   journal_handler&               jn) noexcept
+{
+    clear();
+
+    if (doc.empty()) {
+        compo.state = component_status::unreadable;
+        return error_code(json_errc::invalid_format);
+    }
+
+    json_dearchiver::impl i(*this, jn);
+
+    if (const auto ret =
+          i.parse_component(doc.m_impl->doc, files, ids, compo_id, compo);
+        ret.has_error()) {
+        if (i.has_missing_dependent_component) {
+            compo.state = component_status::unread;
+        }
+
+        return ret.error();
+    }
+
+    return success();
+}
+
 status json_dearchiver::operator()(project&                pj,
                                    const file_access&      files,
                                    const component_access& ids,
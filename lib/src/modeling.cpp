@@ -10,8 +10,10 @@
 #include <irritator/io.hpp>
 #include <irritator/modeling-helpers.hpp>
 #include <irritator/modeling.hpp>
+#include <irritator/thread.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <optional>
 
@@ -335,10 +337,33 @@ int file_access::browse_registreds(journal_handler& jn) noexcept
     return file_paths.ssize() - old;
 }
 
-static auto load_component(journal_handler&             jn,
-                           const file_access&           files,
-                           component_access&            ids,
-                           const std::filesystem::path& filename,
+/// Reads the optional description file (@c .desc) of the component.
+static void load_component_description(component_access&            ids,
+                                       const std::filesystem::path& filename,
+                                       const component_id compo_id) noexcept
+{
+    std::filesystem::path descfilename = filename;
+    descfilename.replace_extension(".desc");
+    auto ec = std::error_code{};
+
+    if (std::filesystem::exists(descfilename, ec) and not ec) {
+        auto d = file::open(descfilename, file_mode{ file_open_options::read });
+
+        if (d.has_value()) {
+            auto& desc     = ids.component_descriptions[compo_id];
+            auto  view     = std::span<char>(desc.data(), desc.capacity());
+            auto  fileview = d->read_entire_file(view);
+            desc.resize(fileview.size());
+        }
+    }
+}
+
+static auto load_component(journal_handler&               jn,
+                           json_dearchiver&               j,
+                           const file_access&             files,
+                           component_access&              ids,
+                           const std::filesystem::path&   filename,
+                           const json_component_document& doc,
                            const component_id compo_id) noexcept -> status
 {
     if (not ids.exists(compo_id))
@@ -347,36 +372,16 @@ static auto load_component(journal_handler&             jn,
     auto& compo = ids.components[compo_id];
 
     try {
-        auto f = file::open(filename, file_mode{ file_open_options::read });
-
-        if (f.has_value()) {
-            json_dearchiver j;
-
-            if (not j(files, ids, filename.string(), compo_id, compo, *f, jn)) {
-                return error_code(modeling_errc::component_load_error);
-            }
-
-            compo.state = component_status::unmodified;
-
-            std::filesystem::path descfilename = filename;
-            descfilename.replace_extension(".desc");
-            auto ec = std::error_code{};
-
-            if (std::filesystem::exists(descfilename, ec) and not ec) {
-                auto d = file::open(descfilename,
-                                    file_mode{ file_open_options::read });
-
-                if (d.has_value()) {
-                    auto& desc = ids.component_descriptions[compo_id];
-                    auto  view = std::span<char>(desc.data(), desc.capacity());
-                    auto  fileview = d->read_entire_file(view);
-                    desc.resize(fileview.size());
-                }
-            }
-        } else {
+        if (doc.empty()) {
             compo.state = component_status::unreadable;
-            return f.error();
+            return make_error(file_errc::open_error);
         }
+
+        if (not j(files, ids, compo_id, compo, doc, jn))
+            return error_code(modeling_errc::component_load_error);
+
+        compo.state = component_status::unmodified;
+        load_component_description(ids, filename, compo_id);
     } catch (const std::bad_alloc& /*e*/) {
         compo.state = component_status::unreadable;
         return make_error(modeling_errc::memory_error);
@@ -388,7 +393,271 @@ static auto load_component(journal_handler&             jn,
     return success();
 }
 
-status modeling::fill_components(journal_handler& jn) noexcept
+/// Builds the component from its binary cache entry @c e. On error, the
+/// component stays unread.
+static auto load_cached_component(journal_handler&              jn,
+                                  const file_access&            files,
+                                  component_access&             ids,
+                                  const std::filesystem::path&  filename,
+                                  const component_cache::entry& e,
+                                  const component_id compo_id) noexcept
+  -> status
+{
+    irt_check(component_cache::read(files, ids, compo_id, e));
+
+    try {
+        load_component_description(ids, filename, compo_id);
+    } catch (...) {
+        jn.push(log_level::warning, [&](auto& t, auto& m) noexcept {
+            t = "Modeling initialization error";
+            format(m,
+                   "Fail to read the description of the component `{}'",
+                   ids.components[compo_id].name.sv());
+        });
+    }
+
+    return success();
+}
+
+/// The component caches of the registred paths. The caches are opened
+/// before the prefetch and rewritten when a component file was parsed.
+struct component_caches {
+    vector<registred_path_id> regs;
+    vector<component_cache>   caches;
+    vector<u8>                dirty;
+
+    void open(const file_access& fs) noexcept
+    {
+        regs.reserve(fs.registred_paths.ssize());
+        caches.reserve(fs.registred_paths.ssize());
+        dirty.resize(fs.registred_paths.ssize(), u8{ 0 });
+
+        for (const auto& reg : fs.registred_paths) {
+            regs.emplace_back(fs.registred_paths.get_id(reg));
+            if (auto* c = caches.emplace_back(); c)
+                (void)c->open(reg);
+        }
+    }
+
+    i32 find(const registred_path_id id) const noexcept
+    {
+        for (i32 i = 0, e = regs.ssize(); i < e; ++i)
+            if (regs[i] == id)
+                return i;
+
+        return -1;
+    }
+};
+
+/// The parsed content and the referenced files of a component file.
+struct component_prefetch {
+    std::filesystem::path   path;
+    json_component_document doc;
+    vector<file_path_id>    deps;
+
+    const component_cache::entry* cached = nullptr;
+    i32                           cache  = -1;
+
+    u64 size  = 0;
+    i64 mtime = 0;
+    u64 hash  = 0;
+
+    i64 ms = 0; ///< Read and parse duration in milliseconds.
+};
+
+/// Reads and parses the files of the @c compos components on the workers of
+/// the @c executor. The json document is parsed once: the
+/// references are read from it and the component is later built from it. A
+/// component file with the size and the modification time, or the content
+/// hash, of its cache entry is not parsed: the entry is used instead. A
+/// single journal entry reports the number of files, the total read and parse
+/// time and the slowest file.
+static void prefetch_components(simulation_bag_executor*      executor,
+                                journal_handler&              jn,
+                                const file_access&            fs,
+                                const component_access&       ids,
+                                const component_caches&       caches,
+                                std::span<const component_id> compos,
+                                std::span<component_prefetch> out) noexcept
+{
+    parallel_for(
+      executor,
+      static_cast<unsigned>(compos.size()),
+      [&](const unsigned i) noexcept {
+          const auto  start    = std::chrono::steady_clock::now();
+          const auto& filepath = ids.component_file_paths[compos[i]];
+          auto&       pf       = out[i];
+
+          const auto p = make_file(fs, filepath);
+          if (not p.has_value())
+              return;
+
+          pf.path = *p;
+          std::tie(pf.size, pf.mtime) = component_cache::stat(pf.path);
+
+          const auto access = fs.get_full_access(filepath.file);
+          pf.cache          = caches.find(access.reg_id);
+          const auto* e =
+            pf.cache >= 0
+              ? caches.caches[pf.cache].find(
+                  fs.dir_paths.get(access.dir_id).path.sv(),
+                  fs.file_paths.get(access.file_id).path.sv())
+              : nullptr;
+
+          if (e and e->size == pf.size and e->mtime == pf.mtime) {
+              pf.cached = e;
+              pf.hash   = e->hash;
+          } else {
+              vector<char> buffer;
+              if (auto f = file::open(pf.path,
+                                      file_mode{ file_open_options::read });
+                  f.has_value())
+                  buffer = f->read_entire_file();
+
+              pf.hash = component_cache::hash(buffer);
+              if (e and e->hash == pf.hash)
+                  pf.cached = e;
+              else if (buffer.empty() or pf.doc.parse(buffer).has_error())
+                  return;
+          }
+
+          if (pf.cached)
+              component_cache::read_dependencies(fs, *pf.cached, pf.deps);
+          else
+              pf.doc.read_dependencies(fs, pf.deps);
+
+          pf.ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+      });
+
+    i64 total   = 0;
+    i32 cached  = 0;
+    i32 slowest = -1;
+    for (i32 i = 0, e = static_cast<i32>(out.size()); i < e; ++i) {
+        total += out[i].ms;
+        cached += out[i].cached != nullptr;
+        if (slowest < 0 or out[slowest].ms < out[i].ms)
+            slowest = i;
+    }
+
+    if (slowest < 0)
+        return;
+
+    const auto  file = ids.component_file_paths[compos[slowest]].file;
+    const auto* f    = fs.file_paths.try_to_get(file);
+
+    jn.push(log_level::debug, [&](auto& t, auto& m) noexcept {
+        t = "Modeling initialization";
+        format(m,
+               "{} components read in {} ms ({} from cache), slowest `{}' in "
+               "{} ms",
+               out.size(),
+               total,
+               cached,
+               f ? f->path.sv() : std::string_view{},
+               out[slowest].ms);
+    });
+}
+
+/// Returns the indices of the @c compos components in an order where each
+/// component follows the components it references. Components in a
+/// reference cycle are placed at the end.
+static auto sort_components(const component_access&             ids,
+                            std::span<const component_id>       compos,
+                            std::span<const component_prefetch> prefetch) noexcept
+  -> vector<i32>
+{
+    const auto n = static_cast<i32>(compos.size());
+
+    table<file_path_id, i32> files;
+    files.data.reserve(n);
+    for (i32 i = 0; i < n; ++i)
+        files.data.emplace_back(ids.component_file_paths[compos[i]].file, i);
+    files.sort();
+
+    vector<i32>         indegree(n, 0);
+    vector<vector<i32>> users(n);
+    for (i32 i = 0; i < n; ++i) {
+        for (const auto dep : prefetch[i].deps) {
+            if (const auto* j = files.get(dep); j and *j != i) {
+                users[*j].emplace_back(i);
+                ++indegree[i];
+            }
+        }
+    }
+
+    vector<i32> order(n, reserve_tag);
+    for (i32 i = 0; i < n; ++i)
+        if (indegree[i] == 0)
+            order.emplace_back(i);
+
+    for (i32 head = 0; head < order.ssize(); ++head)
+        for (const auto user : users[order[head]])
+            if (--indegree[user] == 0)
+                order.emplace_back(user);
+
+    for (i32 i = 0; i < n; ++i)
+        if (indegree[i] > 0)
+            order.emplace_back(i);
+
+    return order;
+}
+
+/// Rewrites the cache of the registred paths where a component file was
+/// parsed or touched. Read-only registred paths are skipped.
+static void write_component_caches(journal_handler&                    jn,
+                                   const file_access&                  fs,
+                                   const component_access&             ids,
+                                   component_caches&                   caches,
+                                   std::span<const component_id>       compos,
+                                   std::span<const component_prefetch> prefetch) noexcept
+{
+    for (sz i = 0; i < compos.size(); ++i) {
+        const auto& pf = prefetch[i];
+
+        if (pf.cache >= 0 and
+            ids.components[compos[i]].state == component_status::unmodified and
+            (not pf.cached or pf.cached->size != pf.size or
+             pf.cached->mtime != pf.mtime))
+            caches.dirty[pf.cache] = 1;
+    }
+
+    for (auto& c : caches.caches)
+        c.close();
+
+    vector<component_cache::record> records(compos.size(), reserve_tag);
+
+    for (i32 r = 0; r < caches.regs.ssize(); ++r) {
+        const auto* reg = fs.registred_paths.try_to_get(caches.regs[r]);
+        if (not reg or not caches.dirty[r] or
+            reg->flags[fs_flag::read_only])
+            continue;
+
+        records.clear();
+        for (sz i = 0; i < compos.size(); ++i)
+            if (prefetch[i].cache == r)
+                records.emplace_back(compos[i],
+                                     prefetch[i].size,
+                                     prefetch[i].mtime,
+                                     prefetch[i].hash,
+                                     std::span<const file_path_id>(
+                                       prefetch[i].deps.data(),
+                                       prefetch[i].deps.size()));
+
+        if (const auto ret = component_cache::write(fs, ids, *reg, records);
+            ret.has_error())
+            jn.push(log_level::warning, [&](auto& t, auto& m) noexcept {
+                t = "Modeling initialization";
+                format(m,
+                       "Fail to write the component cache of `{}'",
+                       reg->path.sv());
+            });
+    }
+}
+
+status modeling::fill_components(journal_handler&         jn,
+                                 simulation_bag_executor* executor) noexcept
 {
     return ids.write([&](auto& ids) noexcept -> status {
         const auto file_read_status =
@@ -454,21 +723,59 @@ status modeling::fill_components(journal_handler& jn) noexcept
             return file_read_status.error();
 
         return files.read([&](const auto& fs, auto) noexcept -> status {
-            auto have_unread_component = ids.ssize() > 0;
+            vector<component_id> compos(ids.ssize(), reserve_tag);
+            for (const auto id : ids)
+                if (ids.components[id].state != component_status::unmodified)
+                    compos.emplace_back(id);
+
+            vector<component_prefetch> prefetch(compos.ssize());
+            if (prefetch.ssize() != compos.ssize())
+                return make_error(modeling_errc::memory_error);
+
+            component_caches caches;
+            caches.open(fs);
+
+            prefetch_components(
+              executor, jn, fs, ids, caches, compos, prefetch);
+            const auto order = sort_components(ids, compos, prefetch);
+
+            json_dearchiver j;
+            auto            have_unread_component = not compos.empty();
 
             while (have_unread_component) {
                 auto component_read   = 0;
                 have_unread_component = false;
 
-                for (auto id : ids) {
-                    auto& compo = ids.components[id];
+                for (const auto i : order) {
+                    const auto id    = compos[i];
+                    auto&      compo = ids.components[id];
                     if (compo.state == component_status::unmodified)
                         continue;
 
-                    auto& filepath = ids.component_file_paths[id];
-                    if (const auto f = make_file(fs, filepath); f.has_value()) {
-                        if (const auto ret =
-                              load_component(jn, fs, ids, *f, id);
+                    auto& pf = prefetch[i];
+                    if (not pf.path.empty()) {
+                        if (const auto ret = [&]() noexcept -> status {
+                                if (pf.cached) {
+                                    const auto r = load_cached_component(
+                                      jn, fs, ids, pf.path, *pf.cached, id);
+                                    if (r.has_value() or
+                                        r.error() ==
+                                          error_code(
+                                            modeling_errc::component_not_found))
+                                        return r;
+
+                                    pf.cached = nullptr;
+                                    if (auto f = file::open(
+                                          pf.path,
+                                          file_mode{ file_open_options::read });
+                                        pf.doc.empty() and f.has_value())
+                                        (void)pf.doc.parse(
+                                          f->read_entire_file());
+                                }
+
+                                return load_component(
+                                  jn, j, fs, ids, pf.path, pf.doc, id);
+                            }();
                             ret.has_error()) {
                             switch (compo.state) {
                             case component_status::unread:
@@ -505,6 +812,7 @@ status modeling::fill_components(journal_handler& jn) noexcept
                                 break;
                             }
                         } else {
+                            pf.doc.clear();
                             ++component_read;
                         }
                     } else {
@@ -513,9 +821,13 @@ status modeling::fill_components(journal_handler& jn) noexcept
                 }
 
                 if (component_read == 0)
-                    return success();
+                    break;
             }
 
+            if (save_component_caches)
+                write_component_caches(
+                  jn, fs, ids, caches, compos, prefetch);
+
             return success();
         });
 
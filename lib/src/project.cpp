@@ -1047,9 +1047,10 @@ static status external_source_copy(const file_access&                fs,
             const auto p =
               fs.get_fs_path(n_src.file).value_or(std::filesystem::path{});
 
-            auto& n_res   = dst.text_file_sources.alloc(p);
-            n_res.name    = src_names[id];
-            auto n_res_id = dst.text_file_sources.get_id(n_res);
+            auto& n_res            = dst.text_file_sources.alloc(p);
+            n_res.name             = src_names[id];
+            n_res.use_binary_cache = n_src.use_binary_cache;
+            auto n_res_id          = dst.text_file_sources.get_id(n_res);
 
             v.emplace_back(id, n_res_id);
         } break;
@@ -2550,6 +2551,55 @@ auto project::get_tn_id(const unique_id_path& path) const noexcept
     return undefined<tree_node_id>();
 }
 
+status project::build_grid_partitions(const tree_node& tn,
+                                      const i32        tile_rows,
+                                      const i32        tile_cols,
+                                      vector<u32>&     partitions) const noexcept
+{
+    debug::ensure(tile_rows > 0 and tile_cols > 0);
+
+    const auto rows = std::max(tile_rows, 1);
+    const auto cols = std::max(tile_cols, 1);
+
+    if (not partitions.resize(sim.models.capacity()))
+        return make_error(project_errc::memory_error);
+
+    std::fill_n(partitions.data(), partitions.size(), 0u);
+
+    auto columns = 0;
+    for (auto* cell = tn.tree.get_child(); cell; cell = cell->tree.get_sibling())
+        if (const auto w = get_row_column(cell->unique_id.sv()); w.has_value())
+            columns = std::max(columns, w->second + 1);
+
+    const auto tiles_per_row = (columns + cols - 1) / cols;
+
+    vector<const tree_node*> stack;
+    for (auto* cell = tn.tree.get_child(); cell;
+         cell       = cell->tree.get_sibling()) {
+        const auto w = get_row_column(cell->unique_id.sv());
+        if (not w.has_value())
+            continue;
+
+        const auto tile =
+          static_cast<u32>(w->first / rows * tiles_per_row + w->second / cols);
+
+        stack.emplace_back(cell);
+        while (not stack.empty()) {
+            const auto* cur = stack.back();
+            stack.pop_back();
+
+            for (const auto& ch : cur->children) {
+                if (ch.is_model())
+                    partitions[get_index(ch.mdl)] = tile;
+                else if (ch.is_tree_node())
+                    stack.emplace_back(ch.tn);
+            }
+        }
+    }
+
+    return success();
+}
+
 auto project::get_parameter(const tree_node_id tn_id,
                             const model_id     mdl_id) noexcept
   -> global_parameter_id
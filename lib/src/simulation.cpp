@@ -6,6 +6,7 @@
 #include <irritator/format.hpp>
 #include <irritator/observation.hpp>
 #include <irritator/random.hpp>
+#include <irritator/thread.hpp>
 
 #include <fmt/ranges.h>
 
@@ -31,12 +32,18 @@ static status copy_history(
 
         if (debug::check(vec != nullptr)) {
             obs.read_history([&vec, &ok](const auto& h, const auto) {
-                if (not vec->values.reserve(h.size())) {
+                if (not vec->values.reserve(h.spilled() + h.size())) {
                     ok &= false;
                     return;
                 }
 
-                vec->values = h;
+                vec->values.clear();
+                h.for_each_spilled_page(
+                  [&](const auto dates, const auto values) noexcept {
+                      for (sz i = 0, e = dates.size(); i != e; ++i)
+                          vec->values.emplace_back(dates[i], values[i]);
+                  });
+                vec->values.insert(vec->values.end(), h.begin(), h.end());
             });
 
             if (not ok)
@@ -48,149 +55,197 @@ static status copy_history(
     return success();
 }
 
-static status run_complete(simulation_wrapper& wrapper) noexcept
+/// Calls @c fn(id) for each embedded simulation @c id. The embedded
+/// simulations are independent: the calls are dispatched onto the workers of
+/// the @c executor (see @c simulation::embedded_executor), or run on the
+/// caller thread when there are less than @c min_parallel_embedded_sims
+/// simulations. Returns the error of the first embedded simulation in error.
+template<typename Fn>
+static status for_each_embedded_sim(
+  simulation_bag_executor*                            executor,
+  const simulation_wrapper::embedded_simulation_type& embedded_sims,
+  Fn&&                                                fn) noexcept
+{
+    constexpr unsigned min_parallel_embedded_sims = 4u;
+
+    const auto n = static_cast<unsigned>(embedded_sims.size());
+
+    vector<simulation_wrapper::sub_id> ids(n, reserve_tag);
+    vector<status>                     results(n);
+    if (std::cmp_less(ids.capacity(), n) or std::cmp_less(results.size(), n))
+        return make_error(simulation_errc::simulation_wrapper_not_enough_memory);
+
+    for (const auto id : embedded_sims)
+        ids.emplace_back(id);
+
+    parallel_for(
+      executor,
+      n,
+      [&](const unsigned i) noexcept { results[i] = fn(ids[i]); },
+      min_parallel_embedded_sims);
+
+    for (const auto& ret : results)
+        irt_check(ret);
+
+    return success();
+}
+
+static status run_complete(simulation_wrapper&      wrapper,
+                           simulation_bag_executor* executor) noexcept
 {
     auto& sims = wrapper.embedded_sims.get<simulation>();
     auto& sim_obs =
       wrapper.embedded_sims.get<simulation_wrapper::simulation_observation>();
 
-    for (const auto id : wrapper.embedded_sims) {
-        const auto idx   = get_index(id);
-        auto&      sim   = sims[idx];
-        auto&      sim_o = sim_obs[idx];
+    return for_each_embedded_sim(
+      executor, wrapper.embedded_sims, [&](const auto id) noexcept -> status {
+          const auto idx   = get_index(id);
+          auto&      sim   = sims[idx];
+          auto&      sim_o = sim_obs[idx];
 
-        if (sim.current_time_expired())
-            continue;
+          if (sim.current_time_expired())
+              return success();
 
-        do {
-            irt_check(sim.run());
-            update_observations(sim);
-        } while (not sim.current_time_expired());
+          do {
+              irt_check(sim.run());
+              update_observations(sim);
+          } while (not sim.current_time_expired());
 
-        if (sim.current_time_expired()) {
-            irt_check(sim.finalize());
-            copy_history(sim, sim_o);
-        }
-    }
+          if (sim.current_time_expired()) {
+              irt_check(sim.finalize());
+              copy_history(sim, sim_o);
+          }
 
-    return success();
+          return success();
+      });
 }
 
-static status run_bag(simulation_wrapper& wrapper) noexcept
+static status run_bag(simulation_wrapper&      wrapper,
+                      simulation_bag_executor* executor) noexcept
 {
     auto& sims = wrapper.embedded_sims.get<simulation>();
     auto& sim_obs =
       wrapper.embedded_sims.get<simulation_wrapper::simulation_observation>();
 
-    for (const auto id : wrapper.embedded_sims) {
-        const auto idx   = get_index(id);
-        auto&      sim   = sims[idx];
-        auto&      sim_o = sim_obs[idx];
+    return for_each_embedded_sim(
+      executor, wrapper.embedded_sims, [&](const auto id) noexcept -> status {
+          const auto idx   = get_index(id);
+          auto&      sim   = sims[idx];
+          auto&      sim_o = sim_obs[idx];
 
-        if (sim.current_time_expired())
-            continue;
+          if (sim.current_time_expired())
+              return success();
 
-        irt_check(sim.run());
-        update_observations(sim);
+          irt_check(sim.run());
+          update_observations(sim);
 
-        if (sim.current_time_expired()) {
-            irt_check(sim.finalize());
-        }
+          if (sim.current_time_expired()) {
+              irt_check(sim.finalize());
+          }
 
-        copy_history(sim, sim_o);
-    }
+          copy_history(sim, sim_o);
 
-    return success();
+          return success();
+      });
 }
 
-static status run_time(simulation_wrapper& wrapper) noexcept
+static status run_time(simulation_wrapper&      wrapper,
+                       simulation_bag_executor* executor) noexcept
 {
     auto& sims = wrapper.embedded_sims.get<simulation>();
     auto& sim_obs =
       wrapper.embedded_sims.get<simulation_wrapper::simulation_observation>();
 
-    for (const auto id : wrapper.embedded_sims) {
-        const auto idx   = get_index(id);
-        auto&      sim   = sims[idx];
-        auto&      sim_o = sim_obs[idx];
-        const auto t     = sim.current_time();
+    return for_each_embedded_sim(
+      executor, wrapper.embedded_sims, [&](const auto id) noexcept -> status {
+          const auto idx   = get_index(id);
+          auto&      sim   = sims[idx];
+          auto&      sim_o = sim_obs[idx];
+          const auto t     = sim.current_time();
 
-        if (sim.current_time_expired())
-            continue;
+          if (sim.current_time_expired())
+              return success();
 
-        while (not sim.current_time_expired() and sim.current_time() == t) {
-            irt_check(sim.run());
-            update_observations(sim);
-        }
+          while (not sim.current_time_expired() and sim.current_time() == t) {
+              irt_check(sim.run());
+              update_observations(sim);
+          }
 
-        if (sim.current_time_expired()) {
-            irt_check(sim.finalize());
-        }
+          if (sim.current_time_expired()) {
+              irt_check(sim.finalize());
+          }
 
-        copy_history(sim, sim_o);
-    }
+          copy_history(sim, sim_o);
 
-    return success();
+          return success();
+      });
 }
 
-static status run_until(simulation_wrapper& wrapper, const time until) noexcept
+static status run_until(simulation_wrapper&      wrapper,
+                        simulation_bag_executor* executor,
+                        const time               until) noexcept
 {
     auto& sims = wrapper.embedded_sims.get<simulation>();
     auto& sim_obs =
       wrapper.embedded_sims.get<simulation_wrapper::simulation_observation>();
 
-    for (const auto id : wrapper.embedded_sims) {
-        const auto idx   = get_index(id);
-        auto&      sim   = sims[idx];
-        auto&      sim_o = sim_obs[idx];
+    return for_each_embedded_sim(
+      executor, wrapper.embedded_sims, [&](const auto id) noexcept -> status {
+          const auto idx   = get_index(id);
+          auto&      sim   = sims[idx];
+          auto&      sim_o = sim_obs[idx];
 
-        if (sim.current_time_expired())
-            continue;
+          if (sim.current_time_expired())
+              return success();
 
-        while (not sim.current_time_expired() and sim.current_time() < until) {
-            irt_check(sim.run());
-            update_observations(sim);
-        }
+          while (not sim.current_time_expired() and
+                 sim.current_time() < until) {
+              irt_check(sim.run());
+              update_observations(sim);
+          }
 
-        if (sim.current_time_expired()) {
-            irt_check(sim.finalize());
-        }
+          if (sim.current_time_expired()) {
+              irt_check(sim.finalize());
+          }
 
-        copy_history(sim, sim_o);
-    }
+          copy_history(sim, sim_o);
 
-    return success();
+          return success();
+      });
 }
 
-static status run_during(simulation_wrapper& wrapper,
-                         const time          during) noexcept
+static status run_during(simulation_wrapper&      wrapper,
+                         simulation_bag_executor* executor,
+                         const time               during) noexcept
 {
     auto& sims = wrapper.embedded_sims.get<simulation>();
     auto& sim_obs =
       wrapper.embedded_sims.get<simulation_wrapper::simulation_observation>();
 
-    for (const auto id : wrapper.embedded_sims) {
-        const auto idx   = get_index(id);
-        auto&      sim   = sims[idx];
-        auto&      sim_o = sim_obs[idx];
-        const auto limit = sim.current_time() + during;
+    return for_each_embedded_sim(
+      executor, wrapper.embedded_sims, [&](const auto id) noexcept -> status {
+          const auto idx   = get_index(id);
+          auto&      sim   = sims[idx];
+          auto&      sim_o = sim_obs[idx];
+          const auto limit = sim.current_time() + during;
 
-        if (sim.current_time_expired())
-            continue;
+          if (sim.current_time_expired())
+              return success();
 
-        while (not sim.current_time_expired() and sim.current_time() < limit) {
-            irt_check(sim.run());
-            update_observations(sim);
-        }
+          while (not sim.current_time_expired() and
+                 sim.current_time() < limit) {
+              irt_check(sim.run());
+              update_observations(sim);
+          }
 
-        if (sim.current_time_expired()) {
-            irt_check(sim.finalize());
-        }
+          if (sim.current_time_expired()) {
+              irt_check(sim.finalize());
+          }
 
-        copy_history(sim, sim_o);
-    }
+          copy_history(sim, sim_o);
 
-    return success();
+          return success();
+      });
 }
 
 static status embedded_sims_alloc(simulation_wrapper& wrapper,
@@ -423,8 +478,9 @@ static status embedded_sims_copy_parameters(simulation_wrapper& wrapper,
     return success();
 }
 
-static status embedded_sims_init(simulation_wrapper& wrapper,
-                                 const simulation&   sim_src) noexcept
+static status embedded_sims_init(simulation_wrapper&      wrapper,
+                                 simulation_bag_executor* executor,
+                                 const simulation&        sim_src) noexcept
 {
     auto& sims = wrapper.embedded_sims.get<simulation>();
     auto& sim_obs =
@@ -437,29 +493,30 @@ static status embedded_sims_init(simulation_wrapper& wrapper,
             sim_obs[idx].data[i].value.values.clear();
     }
 
-    for (const auto id : wrapper.embedded_sims) {
-        const auto idx = get_index(id);
-        sims[idx].observers.clear();
+    return for_each_embedded_sim(
+      executor, wrapper.embedded_sims, [&](const auto id) noexcept -> status {
+          const auto idx = get_index(id);
+          sims[idx].observers.clear();
 
-        for (const auto sel_id : sim_src.selections) {
-            const auto mdl_id = sim_src.selections.get<model_id>(sel_id);
-            debug::ensure(sims[idx].models.exists(mdl_id));
+          for (const auto sel_id : sim_src.selections) {
+              const auto mdl_id = sim_src.selections.get<model_id>(sel_id);
+              debug::ensure(sims[idx].models.exists(mdl_id));
 
-            sims[idx].observe(sims[idx].models.get(mdl_id));
-        }
+              sims[idx].observe(sims[idx].models.get(mdl_id));
+          }
 
-        if (sims[idx].srcs.prepare().has_error())
-            return make_error(
-              simulation_errc::
-                simulation_wrapper_embedded_simulation_source_error);
+          if (sims[idx].srcs.prepare().has_error())
+              return make_error(
+                simulation_errc::
+                  simulation_wrapper_embedded_simulation_source_error);
 
-        if (sims[idx].initialize().has_error())
-            return make_error(
-              simulation_errc::
-                simulation_wrapper_embedded_simulation_initialization_error);
-    }
+          if (sims[idx].initialize().has_error())
+              return make_error(
+                simulation_errc::
+                  simulation_wrapper_embedded_simulation_initialization_error);
 
-    return success();
+          return success();
+      });
 }
 
 simulation_wrapper::simulation_wrapper(const simulation_wrapper& other) noexcept
@@ -521,7 +578,7 @@ status simulation_wrapper::initialize(simulation& sim) noexcept
 
     return embedded_sims_alloc(*this, *sim_src, nb_sims)
       .and_then(embedded_sims_copy_parameters, *this, *sim_src, nb_sims)
-      .and_then(embedded_sims_init, *this, *sim_src);
+      .and_then(embedded_sims_init, *this, sim.embedded_executor, *sim_src);
 }
 
 status simulation_wrapper::transition(simulation&           sim,
@@ -550,7 +607,8 @@ status simulation_wrapper::transition(simulation&           sim,
     if (not init_msg.empty()) {
         const auto ret =
           embedded_sims_copy_parameters(*this, *sim_src, embedded_sims.size())
-            .and_then(embedded_sims_init, *this, *sim_src);
+            .and_then(
+              embedded_sims_init, *this, sim.embedded_executor, *sim_src);
 
         if (ret.has_error())
             return ret.error();
@@ -567,23 +625,23 @@ status simulation_wrapper::transition(simulation&           sim,
         case run_type::complete:
             if (state == run_state::initialized) {
                 state   = run_state::running;
-                auto st = run_complete(*this);
+                auto st = run_complete(*this, sim.embedded_executor);
                 state   = run_state::finish;
                 return st;
             }
             break;
 
         case run_type::bag:
-            return run_bag(*this);
+            return run_bag(*this, sim.embedded_executor);
 
         case run_type::time:
-            return run_time(*this);
+            return run_time(*this, sim.embedded_executor);
 
         case run_type::until:
-            return run_until(*this, time_param);
+            return run_until(*this, sim.embedded_executor, time_param);
 
         case run_type::during:
-            return run_during(*this, time_param);
+            return run_during(*this, sim.embedded_executor, time_param);
         }
     }
 
@@ -804,7 +862,8 @@ static auto send(const simulation_wrapper&        sim_wrapper,
 // -------------------------------------------------------------------------
 static auto compute_embedded_simulation_results(
   const simulation&                                   sim_src,
-  const simulation_wrapper::embedded_simulation_type& embedded_sims) noexcept
+  const simulation_wrapper::embedded_simulation_type& embedded_sims,
+  simulation_bag_executor*                            executor) noexcept
   -> expected<vector<real>>
 {
     const auto objective_fn_size = sim_src.selections.size();
@@ -828,19 +887,25 @@ static auto compute_embedded_simulation_results(
     auto& sim_obs =
       embedded_sims.get<simulation_wrapper::simulation_observation>();
 
-    for (const auto sub_id : embedded_sims) {
-        for (const auto obj_fn_id : sim_src.selections) {
-            const auto type = sim_src.selections.get<criteria_type>(obj_fn_id);
-            const auto mdl_id = sim_src.selections.get<model_id>(obj_fn_id);
+    // Each embedded simulation writes its own range of the objective
+    // function.
+    irt_check(for_each_embedded_sim(
+      executor, embedded_sims, [&](const auto sub_id) noexcept -> status {
+          for (const auto obj_fn_id : sim_src.selections) {
+              const auto type =
+                sim_src.selections.get<criteria_type>(obj_fn_id);
+              const auto mdl_id = sim_src.selections.get<model_id>(obj_fn_id);
 
-            if (const auto* ptr = sim_obs[sub_id].get(mdl_id)) {
-                const auto val = ptr->compute_result(type);
-                const auto idx = pos(sub_id, obj_fn_id);
+              if (const auto* ptr = sim_obs[sub_id].get(mdl_id)) {
+                  const auto val = ptr->compute_result(type);
+                  const auto idx = pos(sub_id, obj_fn_id);
 
-                objective_fn[idx] = val;
-            }
-        }
-    }
+                  objective_fn[idx] = val;
+              }
+          }
+
+          return success();
+      }));
 
     fmt::println("print full observation");
     for (const auto obj_fn_id : sim_src.selections) {
@@ -1020,7 +1085,8 @@ static auto do_weighted_sum_optimization(const simulation_wrapper& sim_wrapper,
                   optimization_method::weighted_sum);
 
     auto objective_fn_ret =
-      compute_embedded_simulation_results(sim_src, sim_wrapper.embedded_sims);
+      compute_embedded_simulation_results(
+        sim_src, sim_wrapper.embedded_sims, sim.embedded_executor);
 
     if (objective_fn_ret.has_error())
         return objective_fn_ret.error();
@@ -1134,7 +1200,8 @@ static auto do_epsilon_constrained_optimization(
       sim_src.objective.epsilon_constrained_params.primary));
 
     auto objective_fn_ret =
-      compute_embedded_simulation_results(sim_src, sim_wrapper.embedded_sims);
+      compute_embedded_simulation_results(
+        sim_src, sim_wrapper.embedded_sims, sim.embedded_executor);
 
     if (objective_fn_ret.has_error())
         return objective_fn_ret.error();
@@ -1164,7 +1231,8 @@ static auto do_simple_optimization(const simulation_wrapper& sim_wrapper,
     const pos_in_objective_function pos(sim_src.selections.size());
 
     auto objective_fn_ret =
-      compute_embedded_simulation_results(sim_src, sim_wrapper.embedded_sims);
+      compute_embedded_simulation_results(
+        sim_src, sim_wrapper.embedded_sims, sim.embedded_executor);
 
     if (objective_fn_ret.has_error())
         return objective_fn_ret.error();
@@ -1219,29 +1287,32 @@ status simulation_wrapper::lambda(simulation& sim) noexcept
     return success();
 }
 
-status simulation_wrapper::finalize(simulation& /*sim*/) noexcept
+status simulation_wrapper::finalize(simulation& parent) noexcept
 {
     auto& sims    = embedded_sims.get<simulation>();
     auto& sim_obs = embedded_sims.get<simulation_observation>();
 
-    for (const auto id : embedded_sims) {
-        const auto idx   = get_index(id);
-        auto&      sim   = sims[idx];
-        auto&      sim_o = sim_obs[idx];
-
-        if (sim.finalize().has_error())
-            return make_error(
-              simulation_errc::
-                simulation_wrapper_embedded_simulation_finalization_error);
-
-        update_observations(sim);
-        if (copy_history(sim, sim_o).has_error())
-            return make_error(
-              simulation_errc::
-                simulation_wrapper_embedded_simulation_finalization_error);
-    }
-
-    return success();
+    return for_each_embedded_sim(
+      parent.embedded_executor,
+      embedded_sims,
+      [&](const auto id) noexcept -> status {
+          const auto idx   = get_index(id);
+          auto&      sim   = sims[idx];
+          auto&      sim_o = sim_obs[idx];
+
+          if (sim.finalize().has_error())
+              return make_error(
+                simulation_errc::
+                  simulation_wrapper_embedded_simulation_finalization_error);
+
+          update_observations(sim);
+          if (copy_history(sim, sim_o).has_error())
+              return make_error(
+                simulation_errc::
+                  simulation_wrapper_embedded_simulation_finalization_error);
+
+          return success();
+      });
 }
 
 raw_sample simulation_wrapper::observation(time t, time /*e*/) const noexcept
@@ -5,6 +5,11 @@
 #include <irritator/core.hpp>
 #include <irritator/timeline.hpp>
 
+#include <algorithm>
+#include <barrier>
+
+#include <cstring>
+
 namespace irt {
 
 simulation_snapshot::simulation_snapshot(const simulation& sim) noexcept
@@ -27,25 +32,133 @@ simulation_snapshot& simulation_snapshot::operator=(
     dated_messages = sim.dated_messages;
     sched          = sim.sched;
     t              = sim.current_time();
+    keyframe       = true;
+
+    models_delta.clear();
+    nodes_delta.clear();
+    output_ports_delta.clear();
+    dated_messages_delta.clear();
+    sched_delta.clear();
 
     return *this;
 }
 
+static bool is_equal(const small_vector<node, 4>& a,
+                     const small_vector<node, 4>& b) noexcept
+{
+    return std::equal(
+      a.begin(), a.end(), b.begin(), b.end(), [](const auto& x, const auto& y) {
+          return x.model == y.model and x.port_index == y.port_index;
+      });
+}
+
+static bool is_equal(const block_node& a, const block_node& b) noexcept
+{
+    return a.next == b.next and is_equal(a.nodes, b.nodes);
+}
+
+static bool is_equal(const output_port& a, const output_port& b) noexcept
+{
+    return a.next == b.next and a.msg == b.msg and
+           is_equal(a.connections, b.connections);
+}
+
+static bool is_equal(const ring_buffer<dated_message>& a,
+                     const ring_buffer<dated_message>& b) noexcept
+{
+    return a.capacity() == b.capacity() and
+           std::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+/// Returns @c true if no element was allocated or released between the two
+/// data_array: the same identifiers are stored at the same positions.
+template<typename T, typename Identifier>
+static bool same_layout(const data_array<T, Identifier>& a,
+                        const data_array<T, Identifier>& b) noexcept
+{
+    return a.capacity() == b.capacity() and a.max_used() == b.max_used() and
+           a.size() == b.size() and a.next_key() == b.next_key();
+}
+
+/// Stores into @c delta the models @c changed since the previous snapshot.
+static void make_delta(const data_array<model, model_id>& src,
+                       vector<model_id>&                  changed,
+                       simulation_snapshot_delta<model>&  delta) noexcept
+{
+    delta.clear();
+
+    std::sort(changed.begin(), changed.end());
+    const auto last = std::unique(changed.begin(), changed.end());
+
+    for (auto it = changed.begin(); it != last; ++it) {
+        if (const auto* mdl = src.try_to_get(*it)) {
+            delta.positions.emplace_back(get_index(*it));
+            delta.items.emplace_back(*mdl);
+        }
+    }
+
+    changed.clear();
+}
+
+/// Stores into @c delta the elements of @c src different from the @c shadow
+/// copy and updates the @c shadow.
+template<typename T, typename Identifier>
+static void make_delta(const data_array<T, Identifier>& src,
+                       data_array<T, Identifier>&       shadow,
+                       simulation_snapshot_delta<T>&    delta) noexcept
+{
+    delta.clear();
+
+    for (int i = 0, e = src.max_used(); i < e; ++i) {
+        const auto* elem = src.try_to_get_from_pos(i);
+        if (not elem)
+            continue;
+
+        auto* copy = shadow.try_to_get_from_pos(i);
+        debug::ensure(copy != nullptr);
+
+        if (not is_equal(*elem, *copy)) {
+            delta.positions.emplace_back(static_cast<u32>(i));
+            delta.items.emplace_back(*elem);
+
+            if constexpr (std::is_trivially_copyable_v<T>)
+                std::memcpy(static_cast<void*>(copy), elem, sizeof(T));
+            else
+                *copy = *elem;
+        }
+    }
+}
+
+template<typename T, typename Identifier>
+static void apply_delta(data_array<T, Identifier>&          dst,
+                        const simulation_snapshot_delta<T>& delta) noexcept
+{
+    for (int i = 0, e = delta.positions.ssize(); i < e; ++i) {
+        auto* elem = dst.try_to_get_from_pos(delta.positions[i]);
+        debug::ensure(elem != nullptr);
+
+        if (elem)
+            *elem = delta.items[i];
+    }
+}
+
 simulation_snapshot_handler::simulation_snapshot_handler(
-  const int capacity) noexcept
+  const int capacity,
+  const int keyframe_interval) noexcept
+  : m_keyframe_interval(std::max(keyframe_interval, 1))
 {
     if (capacity > 0) {
         m_capacity = capacity + 1;
         m_front    = 0;
         m_back     = 0;
 
-        ring.resize(capacity);
+        ring.resize(m_capacity);
     }
 }
 
 bool simulation_snapshot_handler::reserve(const int capacity) noexcept
 {
-    if (std::cmp_less(m_capacity, capacity)) {
+    if (std::cmp_less(m_capacity - 1, capacity)) {
         vector<simulation_snapshot> new_buffer(capacity + 1, reserve_tag);
         if (std::cmp_less(new_buffer.capacity(), capacity))
             return false;
@@ -54,6 +167,9 @@ bool simulation_snapshot_handler::reserve(const int capacity) noexcept
         while (next(ptr))
             new_buffer.push_back(*ptr);
 
+        if (not new_buffer.resize(capacity + 1))
+            return false;
+
         const auto new_capacity = capacity + 1;
         const auto new_front    = 0;
         const auto new_back     = ssize();
@@ -67,13 +183,988 @@ bool simulation_snapshot_handler::reserve(const int capacity) noexcept
     return true;
 }
 
-void simulation_snapshot_handler::emplace_back(const simulation& sim) noexcept
+simulation_snapshot_handler::models_layout
+simulation_snapshot_handler::layout_of(
+  const data_array<model, model_id>& models) noexcept
+{
+    return models_layout{
+        .capacity = models.capacity(),
+        .max_used = models.max_used(),
+        .size     = models.size(),
+        .next_key = models.next_key(),
+    };
+}
+
+void simulation_snapshot_handler::emplace_back(simulation& sim) noexcept
 {
     if ((m_back + 1) % m_capacity == m_front)
-        m_front = (m_front + 1) % m_capacity;
+        pop_front();
+
+    auto& snap = ring[m_back];
+
+    // The scheduller delta is the last condition: it updates the shadow
+    // scheduller, a failure is followed by a keyframe.
+    if (not empty() and m_shadow_valid and sim.track_changed_models and
+        m_since_keyframe < m_keyframe_interval and
+        layout_of(sim.models) == m_models and
+        same_layout(sim.nodes, m_nodes) and
+        same_layout(sim.output_ports, m_output_ports) and
+        same_layout(sim.dated_messages, m_dated_messages) and
+        sim.sched.make_delta(m_sched, snap.sched_delta)) {
+        make_delta(sim.models, sim.changed_models, snap.models_delta);
+        make_delta(sim.nodes, m_nodes, snap.nodes_delta);
+        make_delta(sim.output_ports, m_output_ports, snap.output_ports_delta);
+        make_delta(
+          sim.dated_messages, m_dated_messages, snap.dated_messages_delta);
+
+        snap.models.destroy();
+        snap.nodes.destroy();
+        snap.output_ports.destroy();
+        snap.dated_messages.destroy();
+        snap.sched.destroy();
+
+        snap.observers = sim.observers;
+        snap.t         = sim.current_time();
+        snap.keyframe  = false;
+        ++m_since_keyframe;
+    } else {
+        snap             = sim;
+        m_models         = layout_of(sim.models);
+        m_nodes          = sim.nodes;
+        m_output_ports   = sim.output_ports;
+        m_dated_messages = sim.dated_messages;
+        m_sched          = sim.sched;
+        m_shadow_valid   = true;
+        m_since_keyframe = 0;
+    }
+
+    sim.track_changed_models = true;
+    sim.changed_models.clear();
+
+    m_back = (m_back + 1) % m_capacity;
+}
+
+void simulation_snapshot_handler::pop_front() noexcept
+{
+    if (empty())
+        return;
+
+    auto& old = ring[m_front];
+    m_front   = (m_front + 1) % m_capacity;
+
+    // The oldest snapshot is always a keyframe: the next delta takes the
+    // arrays of the removed keyframe and applies its changes.
+    if (not empty() and not ring[m_front].keyframe) {
+        auto& snap = ring[m_front];
+        debug::ensure(old.keyframe);
+
+        snap.models.swap(old.models);
+        snap.nodes.swap(old.nodes);
+        snap.output_ports.swap(old.output_ports);
+        snap.dated_messages.swap(old.dated_messages);
+        std::swap(snap.sched, old.sched);
+
+        apply_delta(snap.models, snap.models_delta);
+        apply_delta(snap.nodes, snap.nodes_delta);
+        apply_delta(snap.output_ports, snap.output_ports_delta);
+        apply_delta(snap.dated_messages, snap.dated_messages_delta);
+        snap.sched.apply_delta(snap.sched_delta);
+
+        snap.models_delta.clear();
+        snap.nodes_delta.clear();
+        snap.output_ports_delta.clear();
+        snap.dated_messages_delta.clear();
+        snap.sched_delta.clear();
+        snap.keyframe = true;
+    }
+}
+
+void simulation_snapshot_handler::restore(
+  simulation&                sim,
+  const simulation_snapshot& snap) const noexcept
+{
+    if (snap.keyframe) {
+        sim = snap;
+        return;
+    }
+
+    const auto last  = static_cast<std::size_t>(*ring.index_of(&snap));
+    auto       first = last;
+    while (not ring[first].keyframe) {
+        debug::ensure(first != m_front);
+        first = first == 0 ? m_capacity - 1 : first - 1;
+    }
+
+    sim = ring[first];
+
+    auto i = first;
+    do {
+        i = (i + 1) % m_capacity;
+        apply_delta(sim.models, ring[i].models_delta);
+        apply_delta(sim.nodes, ring[i].nodes_delta);
+        apply_delta(sim.output_ports, ring[i].output_ports_delta);
+        apply_delta(sim.dated_messages, ring[i].dated_messages_delta);
+        sim.sched.apply_delta(ring[i].sched_delta);
+    } while (i != last);
+
+    sim.observers = snap.observers;
+    sim.current_time(snap.t);
+}
+
+optimistic_simulation::partition::partition(partition&& other) noexcept
+  : sim(other.sim)
+  , initial(std::move(other.initial))
+  , snaps(std::move(other.snaps))
+  , link_offsets(std::move(other.link_offsets))
+  , links(std::move(other.links))
+  , inputs(std::move(other.inputs))
+  , outputs(std::move(other.outputs))
+  , mailbox(std::move(other.mailbox))
+  , received(std::move(other.received))
+  , t_last(other.t_last)
+  , round(other.round)
+  , coast(other.coast)
+  , sequence(other.sequence)
+  , rollbacks(other.rollbacks)
+  , result(other.result)
+{}
+
+/// Copies the simulation @c sim into the partitions @c out. Each copy keeps the
+/// models of its partition with their identifiers, their output ports and
+/// connection nodes and stores the connections to the others partitions into
+/// the @c link_offsets and @c links vectors.
+template<typename Partition>
+static status split_simulation(const simulation&    sim,
+                               std::span<const u32> partitions,
+                               vector<Partition>&   out) noexcept
+{
+    u32 number = 0;
+    for (const auto& mdl : sim.models) {
+        const auto idx = get_index(sim.models.get_id(mdl));
+        if (std::cmp_greater_equal(idx, partitions.size()))
+            return make_error(simulation_errc::models);
+
+        number = std::max(number, partitions[idx] + 1u);
+    }
+
+    if (number == 0)
+        return make_error(simulation_errc::models);
+
+    out = vector<Partition>(number);
+    if (std::cmp_less(out.size(), number))
+        return make_error(simulation_errc::models_container_full);
+
+    // The partition of each output port and connection node is the partition
+    // of the model that owns them.
+    constexpr auto unowned = std::numeric_limits<u32>::max();
+
+    vector<u32> port_owners(sim.output_ports.capacity(), unowned);
+    vector<u32> node_owners(sim.nodes.capacity(), unowned);
+    if (std::cmp_less(port_owners.size(), sim.output_ports.capacity()) or
+        std::cmp_less(node_owners.size(), sim.nodes.capacity()))
+        return make_error(simulation_errc::connection_container_full);
+
+    for (const auto& mdl : sim.models) {
+        const auto from = partitions[get_index(sim.models.get_id(mdl))];
+
+        dispatch(mdl, [&]<typename Dynamics>(const Dynamics& dyn) {
+            if constexpr (has_output_port<Dynamics>) {
+                for (const auto y_id : dyn.y) {
+                    const auto* y = sim.output_ports.try_to_get(y_id);
+                    if (not y)
+                        continue;
+
+                    port_owners[get_index(y_id)] = from;
+                    for (auto* n = sim.nodes.try_to_get(y->next); n;
+                         n       = sim.nodes.try_to_get(n->next))
+                        node_owners[get_index(sim.nodes.get_id(*n))] = from;
+                }
+            }
+        });
+    }
+
+    for (u32 i = 0; i < number; ++i) {
+        auto& p = out[i].sim;
+
+        if (not p.models.assign_if(sim.models, [&](const auto id) noexcept {
+                return partitions[get_index(id)] == i;
+            }) or
+            not p.parameters.resize(p.models.capacity()) or
+            not p.sched.reserve(p.models.capacity()))
+            return make_error(simulation_errc::models_container_full);
+
+        if (not p.output_ports.assign_if(
+              sim.output_ports,
+              [&](const auto id) noexcept {
+                  return port_owners[get_index(id)] == i;
+              }) or
+            not p.nodes.assign_if(sim.nodes, [&](const auto id) noexcept {
+                return node_owners[get_index(id)] == i;
+            }))
+            return make_error(simulation_errc::connection_container_full);
+
+        for (const auto& mdl : p.models) {
+            const auto id    = p.models.get_id(mdl);
+            p.parameters[id] = sim.parameters[id];
+        }
+
+        // The scheduller is filled and the observers of the others
+        // partitions are freed by the next @c simulation::initialize().
+        p.hsms           = sim.hsms;
+        p.sims           = sim.sims;
+        p.observers      = sim.observers;
+        p.dated_messages = sim.dated_messages;
+        p.srcs           = sim.srcs;
+        p.limits         = sim.limits;
+
+        p.parallel_bag_threshold = sim.parallel_bag_threshold;
+        p.routing                = sim.routing;
+
+        auto& offsets = out[i].link_offsets;
+        if (not offsets.resize(p.output_ports.capacity() + 1))
+            return make_error(simulation_errc::connection_container_full);
+
+        std::fill_n(offsets.data(), offsets.size(), 0u);
+    }
+
+    // Calls @c fn for each connection between two partitions.
+    const auto for_each_link = [&](auto&& fn) noexcept {
+        for (const auto& src : sim.models) {
+            const auto from = partitions[get_index(sim.models.get_id(src))];
+
+            dispatch(src, [&]<typename Dynamics>(const Dynamics& dyn) {
+                if constexpr (has_output_port<Dynamics>) {
+                    for (const auto y_id : dyn.y) {
+                        if (const auto* y = sim.output_ports.try_to_get(y_id)) {
+                            y->for_each(
+                              sim.models,
+                              sim.nodes,
+                              [&](const model& dst, const auto port) noexcept {
+                                  const auto dst_id = sim.models.get_id(dst);
+                                  const auto to =
+                                    partitions[get_index(dst_id)];
+
+                                  if (from != to)
+                                      fn(out[from],
+                                         get_index(y_id),
+                                         remote_node{ dst_id, port, to });
+                              });
+                        }
+                    }
+                }
+            });
+        }
+    };
+
+    for_each_link([](auto& p, const auto idx, const auto&) noexcept {
+        ++p.link_offsets[idx + 1];
+    });
+
+    for (auto& p : out) {
+        const auto ports = p.sim.output_ports.capacity();
+
+        for (int i = 0; i < ports; ++i)
+            p.link_offsets[i + 1] += p.link_offsets[i];
+
+        if (not p.links.resize(p.link_offsets[ports]))
+            return make_error(simulation_errc::connection_container_full);
+    }
+
+    // Fills the @c links with the @c link_offsets as insertion positions
+    // then shifts the @c link_offsets to restore the begin of the ranges.
+    for_each_link([](auto& p, const auto idx, const auto& node) noexcept {
+        p.links[p.link_offsets[idx]++] = node;
+    });
+
+    for (auto& p : out) {
+        for (auto i = p.sim.output_ports.capacity(); i > 0; --i)
+            p.link_offsets[i] = p.link_offsets[i - 1];
+        p.link_offsets[0] = 0;
+    }
+
+    return success();
+}
+
+/// Date and round of the next bag of the partition @c p: the lowest of the
+/// scheduller and of the messages not yet delivered.
+static bag_time next_bag(const auto& p) noexcept
+{
+    // Models scheduled at the date of the last bag are woken up by the
+    // zero-delay routing of this bag.
+    auto next = bag_time{ .t = time_domain<time>::infinity };
+    if (not p.sim.sched.empty()) {
+        next.t     = p.sim.sched.tn();
+        next.round = next.t == p.t_last ? p.round + 1 : 0;
+    }
+
+    // @c inputs are sorted by delivery, the first message not delivered is
+    // the oldest.
+    for (const auto& in : p.inputs) {
+        if (not in.delivered) {
+            next = std::min(next, in.delivery());
+            break;
+        }
+    }
+
+    return next;
+}
+
+optimistic_simulation::optimistic_simulation(
+  const int snapshot_capacity) noexcept
+  : m_snapshot_capacity(std::max(snapshot_capacity, 2))
+{}
+
+status optimistic_simulation::init(const simulation&    sim,
+                                   std::span<const u32> partitions) noexcept
+{
+    irt_check(split_simulation(sim, partitions, m_partitions));
+
+    for (auto& p : m_partitions)
+        p.snaps = simulation_snapshot_handler(m_snapshot_capacity);
+
+    return success();
+}
+
+status optimistic_simulation::initialize() noexcept
+{
+    for (auto& p : m_partitions) {
+        irt_check(p.sim.initialize());
+
+        p.initial = p.sim;
+        p.snaps.reset();
+        p.inputs.clear();
+        p.outputs.clear();
+        p.mailbox.clear();
+        p.received.clear();
+        p.t_last    = time_domain<time>::negative_infinity;
+        p.round     = 0;
+        p.coast     = time_domain<time>::negative_infinity;
+        p.sequence  = 0;
+        p.rollbacks = 0;
+        p.result    = success();
+    }
+
+    m_gvt = time_domain<time>::negative_infinity;
+
+    return success();
+}
+
+status optimistic_simulation::run() noexcept
+{
+    const auto n = static_cast<u32>(m_partitions.size());
+    if (n == 0)
+        return success();
+
+    m_parked = 0;
+    m_idle   = 0;
+    m_stop   = false;
+    m_pause.store(false, std::memory_order_release);
+
+    vector<std::thread> threads(n, reserve_tag);
+    for (u32 i = 0; i < n; ++i)
+        threads.emplace_back([this, i]() noexcept { loop(i); });
+
+    const auto& limits = m_partitions[0].sim.limits;
+
+    std::unique_lock lock(m_mutex);
+    while (not m_stop) {
+        m_cv.wait_for(lock, gvt_interval, [&] { return m_idle == n; });
+
+        // Stops all partitions to compute the GVT without transient
+        // messages: the lowest date of the next bags, of the pending
+        // cancellations and of the messages not yet received.
+        m_pause.store(true, std::memory_order_release);
+        lock.unlock();
+
+        for (auto& p : m_partitions) {
+            std::lock_guard<std::mutex> guard(p.mutex);
+            p.cv.notify_all();
+        }
+
+        lock.lock();
+        m_cv.wait(lock, [&] { return m_parked == n; });
+
+        auto gvt   = time_domain<time>::infinity;
+        bool error = false;
+        for (const auto& p : m_partitions) {
+            gvt = std::min(gvt, next_time(p).t);
+
+            for (const auto& msg : p.mailbox)
+                gvt = std::min(gvt, msg.t);
+
+            for (const auto& out : p.outputs)
+                if (out.pending)
+                    gvt = std::min(gvt, out.t);
+
+            if (not p.result)
+                error = true;
+        }
+
+        m_gvt    = gvt;
+        m_stop   = error or limits.expired(gvt);
+        m_parked = 0;
+        m_pause.store(false, std::memory_order_release);
+        ++m_epoch;
+        m_cv.notify_all();
+    }
+    lock.unlock();
+
+    for (auto& t : threads)
+        t.join();
+
+    for (const auto& p : m_partitions)
+        if (not p.result)
+            return p.result.error();
+
+    return success();
+}
+
+status optimistic_simulation::finalize() noexcept
+{
+    for (auto& p : m_partitions)
+        irt_check(p.sim.finalize());
+
+    return success();
+}
+
+u64 optimistic_simulation::rollbacks() const noexcept
+{
+    u64 ret = 0;
+    for (const auto& p : m_partitions)
+        ret += p.rollbacks;
+
+    return ret;
+}
+
+bag_time optimistic_simulation::next_time(const partition& p) const noexcept
+{
+    return next_bag(p);
+}
+
+void optimistic_simulation::loop(const u32 id) noexcept
+{
+    auto& p = m_partitions[id];
+
+    while (true) {
+        if (m_pause.load(std::memory_order_acquire)) {
+            if (wait_gvt(id))
+                return;
+
+            continue;
+        }
+
+        if (p.result)
+            p.result = receive(p);
+
+        if (p.result)
+            p.result = cancel(p, next_time(p));
+
+        if (p.result) {
+            // Without snapshot space, the partition waits for the fossil
+            // collection of the next GVT computation.
+            const auto next = next_time(p);
+            const auto full = p.t_last != time_domain<time>::negative_infinity
+                              and next.t > p.t_last and
+                              p.snaps.size() >= p.snaps.capacity();
+
+            if (not p.sim.limits.expired(next.t) and not full) {
+                p.result = step(id, next);
+                continue;
+            }
+        } else {
+            std::lock_guard<std::mutex> guard(p.mutex);
+            p.mailbox.clear();
+        }
+
+        wait_messages(id);
+    }
+}
+
+status optimistic_simulation::receive(partition& p) noexcept
+{
+    {
+        std::lock_guard<std::mutex> guard(p.mutex);
+        std::swap(p.mailbox, p.received);
+    }
+
+    const auto last      = bag_time{ .t = p.t_last, .round = p.round };
+    auto       straggler = time_domain<time>::infinity;
+
+    for (const auto& msg : p.received) {
+        if (msg.anti) {
+            const auto it =
+              std::find_if(p.inputs.begin(), p.inputs.end(), [&](const auto& in) {
+                  return in.id == msg.id;
+              });
+
+            if (it != p.inputs.end()) {
+                if (it->delivered)
+                    straggler = std::min(straggler, it->t);
+
+                p.inputs.erase(it);
+            }
+        } else {
+            const auto it = std::upper_bound(
+              p.inputs.begin(),
+              p.inputs.end(),
+              msg.delivery(),
+              [](const bag_time t, const auto& in) {
+                  return t < in.delivery();
+              });
+
+            p.inputs.insert(it, msg);
+            if (not(last < msg.delivery()))
+                straggler = std::min(straggler, msg.t);
+        }
+    }
+
+    p.received.clear();
+
+    if (straggler != time_domain<time>::infinity)
+        return rollback(p, straggler);
+
+    return success();
+}
+
+status optimistic_simulation::rollback(partition& p, const time t) noexcept
+{
+    // Restores the latest snapshot older than @c t or the initial state.
+    // Snapshots are taken before the first bag of a new date so all messages
+    // older or equal to the date of the snapshot are already delivered.
+    simulation_snapshot* target = nullptr;
+    for (simulation_snapshot* snap = nullptr; p.snaps.next(snap);) {
+        if (snap->t < t)
+            target = snap;
+        else
+            break;
+    }
+
+    if (target) {
+        p.snaps.restore(p.sim, *target);
+        p.t_last = target->t;
+        p.snaps.erase_after(target);
+    } else {
+        p.sim    = p.initial;
+        p.t_last = time_domain<time>::negative_infinity;
+        p.snaps.reset();
+    }
+
+    // The next bag is at a new date, the round is not used.
+    p.round = 0;
+
+    for (auto& in : p.inputs)
+        if (in.t > p.t_last)
+            in.delivered = false;
+
+    p.coast = t;
+    for (auto& out : p.outputs) {
+        if (out.t >= t)
+            out.pending = true;
+
+        if (out.pending)
+            p.coast = std::min(p.coast, out.t);
+    }
+
+    ++p.rollbacks;
+
+    return success();
+}
+
+status optimistic_simulation::cancel(partition& p, const bag_time next) noexcept
+{
+    const auto cancelled = [next](const auto& out) noexcept {
+        return out.pending and
+               bag_time{ .t = out.t, .round = out.round } < next;
+    };
+
+    for (const auto& out : p.outputs) {
+        if (cancelled(out)) {
+            if (not send(out.partition,
+                         remote_message{ .msg   = out.msg,
+                                         .t     = out.t,
+                                         .round = out.round,
+                                         .id    = out.id,
+                                         .mdl   = out.mdl,
+                                         .port  = out.port,
+                                         .anti  = true }))
+                return make_error(simulation_errc::messages_container_full);
+        }
+    }
+
+    p.outputs.erase_if(cancelled);
+
+    return success();
+}
+
+status optimistic_simulation::step(const u32 id, const bag_time next) noexcept
+{
+    auto& p = m_partitions[id];
+
+    if (p.t_last != time_domain<time>::negative_infinity and next.t > p.t_last)
+        p.snaps.emplace_back(p.sim);
+
+    for (auto& in : p.inputs) {
+        if (next < in.delivery())
+            break;
+
+        if (not in.delivered) {
+            if (auto* mdl = p.sim.models.try_to_get(in.mdl))
+                irt_check(p.sim.push_message(*mdl, in.port, in.msg, next.t));
+
+            in.delivered = true;
+        }
+    }
+
+    irt_check(p.sim.run());
+    p.t_last = next.t;
+    p.round  = next.round;
+
+    if (next.t < p.coast)
+        return success();
+
+    for (const auto y_id : p.sim.active_output_ports) {
+        const auto  idx = get_index(y_id);
+        const auto& msg = p.sim.output_ports.get(y_id).msg;
+
+        for (auto i = p.link_offsets[idx], e = p.link_offsets[idx + 1]; i != e;
+             ++i) {
+            const auto& dst = p.links[i];
+
+            const auto it = std::find_if(
+              p.outputs.begin(), p.outputs.end(), [&](const auto& out) {
+                  return out.pending and out.t == next.t and
+                         out.round == next.round and
+                         out.partition == dst.partition and
+                         out.mdl == dst.mdl and out.port == dst.port and
+                         out.msg == msg;
+              });
+
+            if (it != p.outputs.end()) {
+                it->pending = false;
+                continue;
+            }
+
+            const auto uid = (static_cast<u64>(id) << 48) | p.sequence++;
+
+            if (not p.outputs.push_back(sent_message{ .msg       = msg,
+                                                      .t         = next.t,
+                                                      .round     = next.round,
+                                                      .id        = uid,
+                                                      .mdl       = dst.mdl,
+                                                      .port      = dst.port,
+                                                      .partition = dst.partition }))
+                return make_error(simulation_errc::messages_container_full);
+
+            if (not send(dst.partition,
+                         remote_message{ .msg   = msg,
+                                         .t     = next.t,
+                                         .round = next.round,
+                                         .id    = uid,
+                                         .mdl   = dst.mdl,
+                                         .port  = dst.port }))
+                return make_error(simulation_errc::messages_container_full);
+        }
+    }
+
+    return success();
+}
+
+void optimistic_simulation::fossil_collect(partition& p, const time gvt) noexcept
+{
+    // Keeps the latest snapshot older than the GVT, the rollbacks never
+    // restore an older state.
+    while (p.snaps.size() >= 2) {
+        simulation_snapshot* second = p.snaps.front();
+        if (p.snaps.next(second) and second->t < gvt)
+            p.snaps.pop_front();
+        else
+            break;
+    }
+
+    if (const auto* front = p.snaps.front(); front and front->t < gvt) {
+        const auto t = front->t;
+        p.inputs.erase_if([t](const auto& in) noexcept { return in.t <= t; });
+    }
+
+    p.outputs.erase_if(
+      [gvt](const auto& out) noexcept { return not out.pending and out.t < gvt; });
+}
+
+bool optimistic_simulation::send(const u32 to, const remote_message& msg) noexcept
+{
+    auto& dst = m_partitions[to];
+
+    {
+        std::lock_guard<std::mutex> guard(dst.mutex);
+        if (not dst.mailbox.push_back(msg))
+            return false;
+    }
+
+    dst.cv.notify_one();
+    return true;
+}
+
+bool optimistic_simulation::wait_gvt(const u32 id) noexcept
+{
+    const auto n = static_cast<u32>(m_partitions.size());
+
+    std::unique_lock lock(m_mutex);
+    const auto epoch = m_epoch;
+
+    if (++m_parked == n)
+        m_cv.notify_all();
+
+    m_cv.wait(lock, [&] { return m_epoch != epoch; });
+
+    const auto gvt  = m_gvt;
+    const auto stop = m_stop;
+    lock.unlock();
+
+    if (not stop)
+        fossil_collect(m_partitions[id], gvt);
+
+    return stop;
+}
+
+void optimistic_simulation::wait_messages(const u32 id) noexcept
+{
+    const auto n = static_cast<u32>(m_partitions.size());
+    auto&      p = m_partitions[id];
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (++m_idle == n)
+            m_cv.notify_all();
+    }
+
+    {
+        std::unique_lock lock(p.mutex);
+        p.cv.wait(lock, [&] {
+            return not p.mailbox.empty() or
+                   m_pause.load(std::memory_order_acquire);
+        });
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        --m_idle;
+    }
+}
+
+conservative_simulation::partition::partition(partition&& other) noexcept
+  : sim(other.sim)
+  , link_offsets(std::move(other.link_offsets))
+  , links(std::move(other.links))
+  , targets(std::move(other.targets))
+  , outboxes(std::move(other.outboxes))
+  , sources(std::move(other.sources))
+  , inputs(std::move(other.inputs))
+  , next(other.next)
+  , t_last(other.t_last)
+  , round(other.round)
+  , result(other.result)
+{}
+
+status conservative_simulation::init(const simulation&    sim,
+                                     std::span<const u32> partitions) noexcept
+{
+    irt_check(split_simulation(sim, partitions, m_partitions));
+
+    const auto n = static_cast<u32>(m_partitions.size());
+
+    for (auto& p : m_partitions) {
+        for (const auto& node : p.links)
+            if (std::ranges::find(p.targets, node.partition) == p.targets.end())
+                if (not p.targets.push_back(node.partition))
+                    return make_error(simulation_errc::connection_container_full);
+
+        std::ranges::sort(p.targets);
+
+        if (not p.outboxes.resize(p.targets.size()))
+            return make_error(simulation_errc::connection_container_full);
+    }
+
+    for (u32 i = 0; i < n; ++i)
+        for (const auto to : m_partitions[i].targets)
+            if (not m_partitions[to].sources.push_back(i))
+                return make_error(simulation_errc::connection_container_full);
+
+    return success();
+}
+
+status conservative_simulation::initialize() noexcept
+{
+    for (auto& p : m_partitions) {
+        irt_check(p.sim.initialize());
+
+        for (auto& box : p.outboxes)
+            box.clear();
+
+        p.inputs.clear();
+        p.next   = bag_time{};
+        p.t_last = time_domain<time>::negative_infinity;
+        p.round  = 0;
+        p.result = success();
+    }
+
+    m_windows = 0;
+
+    return success();
+}
+
+status conservative_simulation::run() noexcept
+{
+    const auto n = static_cast<u32>(m_partitions.size());
+    if (n == 0)
+        return success();
+
+    m_stop = false;
+
+    std::barrier window(n, [this]() noexcept { end_window(); });
+    std::barrier exchange(n);
+
+    vector<std::thread> threads(n, reserve_tag);
+    for (u32 i = 0; i < n; ++i) {
+        threads.emplace_back([this, i, &window, &exchange]() noexcept {
+            auto& p = m_partitions[i];
+
+            while (true) {
+                if (p.result)
+                    p.result = receive(i);
+
+                p.next = next_bag(p);
+
+                window.arrive_and_wait();
+                if (m_stop)
+                    return;
+
+                if (p.result)
+                    p.result = execute(i);
+
+                exchange.arrive_and_wait();
+            }
+        });
+    }
+
+    for (auto& t : threads)
+        t.join();
+
+    for (const auto& p : m_partitions)
+        if (not p.result)
+            return p.result.error();
+
+    return success();
+}
+
+status conservative_simulation::finalize() noexcept
+{
+    for (auto& p : m_partitions)
+        irt_check(p.sim.finalize());
+
+    return success();
+}
+
+void conservative_simulation::end_window() noexcept
+{
+    auto error = false;
+
+    m_next = bag_time{ .t = time_domain<time>::infinity };
+    for (const auto& p : m_partitions) {
+        m_next = std::min(m_next, p.next);
+        error  = error or not p.result;
+    }
+
+    m_stop = error or m_next.t == time_domain<time>::infinity or
+             m_partitions[0].sim.limits.expired(m_next.t);
+
+    if (not m_stop)
+        ++m_windows;
+}
+
+status conservative_simulation::receive(const u32 id) noexcept
+{
+    auto& p = m_partitions[id];
+
+    for (const auto from : p.sources) {
+        auto&      src = m_partitions[from];
+        const auto it  = std::ranges::lower_bound(src.targets, id);
+        auto&      box = src.outboxes[std::distance(src.targets.begin(), it)];
+
+        for (const auto& msg : box)
+            if (not p.inputs.push_back(msg))
+                return make_error(simulation_errc::messages_container_full);
+
+        box.clear();
+    }
+
+    std::stable_sort(
+      p.inputs.begin(), p.inputs.end(), [](const auto& a, const auto& b) {
+          return a.delivery() < b.delivery();
+      });
+
+    return success();
+}
+
+status conservative_simulation::execute(const u32 id) noexcept
+{
+    auto& p = m_partitions[id];
+
+    // Sources send messages during their own bags, not before the next bag
+    // computed at the beginning of the window.
+    auto bound = time_domain<time>::infinity;
+    for (const auto from : p.sources)
+        bound = std::min(bound, m_partitions[from].next.t);
+
+    for (auto next = p.next; not p.sim.limits.expired(next.t);
+         next      = next_bag(p)) {
+        if (not(next.t < bound or next == m_next))
+            break;
+
+        irt_check(step(p, next));
+    }
+
+    return success();
+}
+
+status conservative_simulation::step(partition& p, const bag_time next) noexcept
+{
+    for (auto& in : p.inputs) {
+        if (next < in.delivery())
+            break;
+
+        if (auto* mdl = p.sim.models.try_to_get(in.mdl))
+            irt_check(p.sim.push_message(*mdl, in.port, in.msg, next.t));
+
+        in.delivered = true;
+    }
+
+    p.inputs.erase_if([](const auto& in) noexcept { return in.delivered; });
+
+    irt_check(p.sim.run());
+    p.t_last = next.t;
+    p.round  = next.round;
+
+    for (const auto y_id : p.sim.active_output_ports) {
+        const auto  idx = get_index(y_id);
+        const auto& msg = p.sim.output_ports.get(y_id).msg;
+
+        for (auto i = p.link_offsets[idx], e = p.link_offsets[idx + 1]; i != e;
+             ++i) {
+            const auto& dst = p.links[i];
+            const auto  it  = std::ranges::lower_bound(p.targets, dst.partition);
+            auto& box = p.outboxes[std::distance(p.targets.begin(), it)];
+
+            if (not box.push_back(remote_message{ .msg   = msg,
+                                                  .t     = next.t,
+                                                  .round = next.round,
+                                                  .id    = 0,
+                                                  .mdl   = dst.mdl,
+                                                  .port  = dst.port }))
+                return make_error(simulation_errc::messages_container_full);
+        }
+    }
 
-    ring[m_back] = sim;
-    m_back       = (m_back + 1) % m_capacity;
+    return success();
 }
 
 } // namespace irt
@@ -31,6 +31,14 @@ status variable_observer::init(project& pj, simulation& sim) noexcept
                 sim.observe(*mdl, timestep.to_double());
             }
 
+            if (auto* o = sim.observers.try_to_get(mdl->obs_id)) {
+                o->raw_buffer_capacity(
+                  static_cast<u32>(raw_buffer_size.value()));
+                o->history_budget(
+                  static_cast<std::size_t>(history_budget.value()) * 1024u);
+                o->lossless(lossless);
+            }
+
             subs.get<observer_id>(id) = mdl->obs_id;
         }
     }
@@ -1927,6 +1927,39 @@ int main()
         expect(neq(b.try_to_get(a4_id), nullptr));
     };
 
+    "data-array-assign-if"_test = [] {
+        irt::data_array<int, test_id> a(8);
+
+        irt::vector<test_id> ids;
+        for (int i = 0; i < 6; ++i)
+            ids.emplace_back(a.get_id(a.alloc(i)));
+
+        irt::data_array<int, test_id> b;
+        expect(b.assign_if(a, [&](const auto id) noexcept {
+            return a.get(id) % 2 == 0;
+        }));
+
+        expect(eq(b.ssize(), 3));
+        expect(eq(b.capacity(), 5));
+        for (int i = 0; i < 6; ++i) {
+            if (i % 2 == 0)
+                expect(eq(b.get(ids[i]), i));
+            else
+                expect(eq(b.try_to_get(ids[i]), nullptr));
+        }
+
+        // The free slots are reused in increasing order of index.
+        auto& c1 = b.alloc(10);
+        auto& c2 = b.alloc(11);
+        expect(eq(irt::get_index(b.get_id(c1)), irt::get_index(ids[1])));
+        expect(eq(irt::get_index(b.get_id(c2)), irt::get_index(ids[3])));
+        expect(b.get_id(c1) != ids[1]);
+
+        expect(b.assign_if(a, [](const auto) noexcept { return false; }));
+        expect(eq(b.ssize(), 0));
+        expect(eq(b.capacity(), 0));
+    };
+
     "data-array-freelist-copyable"_test = [] {
         struct copyable {
             copyable() noexcept = default;
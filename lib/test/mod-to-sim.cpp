@@ -9,9 +9,18 @@
 #include <irritator/format.hpp>
 #include <irritator/io.hpp>
 #include <irritator/modeling.hpp>
+#include <irritator/timeline.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <numeric>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
 
 #include <boost/ut.hpp>
 
@@ -110,6 +119,22 @@ static auto get_input_connection_number(const irt::simulation& sim,
 //     }
 // }
 
+/// The peak resident set size of the process in KiB or 0 if unavailable.
+static long peak_rss_kib() noexcept
+{
+#if defined(__linux__)
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#elif defined(__APPLE__)
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss / 1024;
+#endif
+
+    return 0;
+}
+
 template<std::size_t length>
 static bool get_temp_registred_path(irt::small_string<length>& str) noexcept
 {
@@ -124,6 +149,106 @@ static bool get_temp_registred_path(irt::small_string<length>& str) noexcept
     }
 }
 
+/// Returns a sorted description of the components of @c mod where the
+/// components are named by their files: two modeling loading the same files
+/// give the same lines.
+static std::vector<std::string> describe_components(irt::modeling& mod)
+{
+    return mod.ids.read([&](const irt::component_access& ids, auto) {
+        return mod.files.read([&](const irt::file_access& fs, auto) {
+            const auto file_of = [&](const irt::component_id id) {
+                const auto* f =
+                  fs.file_paths.try_to_get(ids.component_file_paths[id].file);
+                return f ? std::string(f->path.sv()) : std::string("?");
+            };
+
+            std::vector<std::string> lines;
+            for (const auto id : ids) {
+                const auto& c    = ids.components[id];
+                const auto  file = file_of(id);
+
+                lines.emplace_back(fmt::format("{} {} type={} state={}",
+                                               file,
+                                               c.name.sv(),
+                                               irt::ordinal(c.type),
+                                               irt::ordinal(c.state)));
+
+                for (const auto p : c.x)
+                    lines.emplace_back(fmt::format(
+                      "{} x {}", file, c.x.get<irt::port_str>(p).sv()));
+                for (const auto p : c.y)
+                    lines.emplace_back(fmt::format(
+                      "{} y {}", file, c.y.get<irt::port_str>(p).sv()));
+
+                switch (c.type) {
+                case irt::component_type::generic: {
+                    const auto& g =
+                      ids.generic_components.get(c.id.generic_id);
+
+                    for (const auto& ch : g.children) {
+                        const auto  ch_id = g.children.get_id(ch);
+                        const auto& p     = g.children_parameters[ch_id];
+
+                        lines.emplace_back(
+                          ch.type == irt::child_type::model
+                            ? fmt::format("{} child {} model={} {} {} {} {}",
+                                          file,
+                                          g.children_names[ch_id].sv(),
+                                          irt::ordinal(ch.id.mdl_type),
+                                          p.reals[0],
+                                          p.reals[1],
+                                          p.integers[0],
+                                          p.integers[1])
+                            : fmt::format("{} child {} component={}",
+                                          file,
+                                          g.children_names[ch_id].sv(),
+                                          file_of(ch.id.compo_id)));
+                    }
+
+                    lines.emplace_back(
+                      fmt::format("{} connections {} {} {}",
+                                  file,
+                                  g.connections.size(),
+                                  g.input_connections.size(),
+                                  g.output_connections.size()));
+                } break;
+
+                case irt::component_type::grid: {
+                    const auto& g = ids.grid_components.get(c.id.grid_id);
+
+                    lines.emplace_back(fmt::format(
+                      "{} grid {} {}", file, g.row(), g.column()));
+                    for (const auto ch : g.children())
+                        lines.emplace_back(
+                          fmt::format("{} cell {}", file, file_of(ch)));
+                } break;
+
+                case irt::component_type::graph: {
+                    const auto& g = ids.graph_components.get(c.id.graph_id);
+
+                    lines.emplace_back(
+                      fmt::format("{} graph {} {} nodes={} edges={}",
+                                  file,
+                                  irt::ordinal(g.g_type),
+                                  irt::ordinal(g.type),
+                                  g.g.nodes.size(),
+                                  g.g.edges.size()));
+                    for (const auto n : g.g.nodes)
+                        lines.emplace_back(fmt::format(
+                          "{} node {}", file, file_of(g.g.node_components[n])));
+                } break;
+
+                default:
+                    break;
+                }
+            }
+
+            std::ranges::sort(lines);
+            return lines;
+        });
+    });
+}
+
 static void simulation_component_tester(
   const std::span<const irt::real> c1,
   const std::span<const irt::real> c2,
@@ -431,6 +556,25 @@ static void simulation_component_tester(
 
         ++i;
     }
+
+    // The settings of a plot observer are applied to the simulation
+    // observers.
+    auto& plot           = pj.alloc_variable_observer();
+    plot.raw_buffer_size = 128;
+    plot.history_budget  = 64;
+    plot.lossless        = true;
+    for (const auto mdl_id : cpts)
+        plot.push_back(pj.tree_nodes.get_id(*pj.tn_head()), mdl_id);
+
+    expect(fatal(pj.simulation_initialize().has_value()));
+    for (const auto mdl_id : cpts) {
+        const auto* obs =
+          pj.sim.observers.try_to_get(pj.sim.models.get(mdl_id).obs_id);
+        expect(fatal(obs != nullptr));
+        expect(eq(obs->raw_buffer_capacity(), 128u));
+        expect(eq(obs->history_budget(), std::size_t(64u * 1024u)));
+        expect(obs->lossless());
+    }
 }
 
 int main()
@@ -772,6 +916,511 @@ int main()
         }
     };
 
+    "component-cache"_test = [] {
+        irt::registred_path_str temp_path;
+        expect(fatal(get_temp_registred_path(temp_path)));
+
+        const auto init_files =
+          [&](auto& fs, auto& ids, auto c1, auto c2, auto cg) {
+            const auto reg_id = fs.alloc_registred("temp", 0);
+            auto&      reg    = fs.registred_paths.get(reg_id);
+            reg.path          = temp_path;
+
+            const auto dir_id = fs.alloc_dir(reg_id);
+            auto&      dir    = fs.dir_paths.get(dir_id);
+            dir.path          = "test-cache";
+            dir.parent        = reg_id;
+
+            fs.create_directories(reg_id);
+            fs.create_directories(dir_id);
+
+            ids.component_file_paths[c1].file =
+              fs.alloc_file(dir_id, "c1.irt", irt::file_type::component_file);
+            ids.component_file_paths[c2].file =
+              fs.alloc_file(dir_id, "c2.irt", irt::file_type::component_file);
+            ids.component_file_paths[cg].file =
+              fs.alloc_file(dir_id, "cg.irt", irt::file_type::component_file);
+
+            return reg_id;
+        };
+
+        irt::modeling mod1;
+        mod1.ids.write([&](auto& ids) {
+            auto  c1_id = ids.alloc_generic_component();
+            auto& c1    = ids.components[c1_id];
+            auto& s1    = ids.generic_components.get(c1.id.generic_id);
+            auto& ch1   = s1.alloc(irt::dynamics_type::counter);
+            auto& ch2   = s1.alloc(irt::dynamics_type::time_func);
+            auto  p1_id = c1.get_or_add_x("in");
+            auto  p2_id = c1.get_or_add_y("out");
+            expect(!!s1.connect_input(
+              p1_id, ch1, irt::connection::port{ .model = 0 }));
+            expect(!!s1.connect_output(
+              p2_id, ch2, irt::connection::port{ .model = 0 }));
+            expect(!!s1.connect(ch2,
+                                irt::connection::port{ .model = 0 },
+                                ch1,
+                                irt::connection::port{ .model = 0 }));
+
+            auto  c2_id = ids.alloc_generic_component();
+            auto& c2    = ids.components[c2_id];
+            auto& s2    = ids.generic_components.get(c2.id.generic_id);
+            auto& ch21  = s2.alloc(c1_id);
+            auto& ch22  = s2.alloc(c1_id);
+            expect(!!s2.connect(ch21,
+                                irt::connection::port{ .compo = p2_id },
+                                ch22,
+                                irt::connection::port{ .compo = p1_id }));
+
+            auto  cg_id = ids.alloc_grid_component();
+            auto& cg    = ids.components[cg_id];
+            auto& g     = ids.grid_components.get(cg.id.grid_id);
+            g.resize(3, 4, c1_id);
+
+            c1.state = irt::component_status::unmodified;
+            c2.state = irt::component_status::unmodified;
+            cg.state = irt::component_status::unmodified;
+
+            mod1.files.write([&](auto& fs) {
+                const auto reg_id = init_files(fs, ids, c1_id, c2_id, cg_id);
+                const auto& reg   = fs.registred_paths.get(reg_id);
+
+                const irt::file_path_id c1_deps[] = {
+                    ids.component_file_paths[c1_id].file
+                };
+
+                const irt::component_cache::record records[] = {
+                    { .id    = c1_id,
+                      .size  = 1,
+                      .mtime = 2,
+                      .hash  = 11,
+                      .deps  = {} },
+                    { .id    = c2_id,
+                      .size  = 1,
+                      .mtime = 2,
+                      .hash  = 12,
+                      .deps  = c1_deps },
+                    { .id    = cg_id,
+                      .size  = 1,
+                      .mtime = 2,
+                      .hash  = 13,
+                      .deps  = c1_deps },
+                };
+
+                expect(fatal(
+                  irt::component_cache::write(fs, ids, reg, records)
+                    .has_value()));
+            });
+        });
+
+        irt::modeling mod2;
+        mod2.ids.write([&](auto& ids) {
+            const auto c1_id = ids.alloc_component();
+            const auto c2_id = ids.alloc_component();
+            const auto cg_id = ids.alloc_component();
+
+            mod2.files.write([&](auto& fs) {
+                const auto  reg_id = init_files(fs, ids, c1_id, c2_id, cg_id);
+                const auto& reg    = fs.registred_paths.get(reg_id);
+
+                irt::component_cache cache;
+                expect(fatal(cache.open(reg).has_value()));
+
+                const auto* e1 = cache.find("test-cache", "c1.irt");
+                const auto* e2 = cache.find("test-cache", "c2.irt");
+                const auto* eg = cache.find("test-cache", "cg.irt");
+                expect(fatal(e1 != nullptr and e2 != nullptr and
+                             eg != nullptr));
+                expect(cache.find("test-cache", "c4.irt") == nullptr);
+                expect(eq(e1->hash, 11u));
+                expect(eq(e2->hash, 12u));
+                expect(eq(eg->hash, 13u));
+                expect(eq(e2->mtime, irt::i64{ 2 }));
+
+                irt::vector<irt::file_path_id> deps;
+                irt::component_cache::read_dependencies(fs, *e2, deps);
+                expect(fatal(eq(deps.ssize(), 1)));
+                expect(deps[0] == ids.component_file_paths[c1_id].file);
+
+                expect(!irt::component_cache::read(fs, ids, c2_id, *e2));
+                expect(ids.components[c2_id].state ==
+                       irt::component_status::unread);
+
+                expect(!!irt::component_cache::read(fs, ids, c1_id, *e1));
+                ids.components[c1_id].state =
+                  irt::component_status::unmodified;
+                expect(!!irt::component_cache::read(fs, ids, c2_id, *e2));
+                expect(!!irt::component_cache::read(fs, ids, cg_id, *eg));
+            });
+
+            const auto& c1 = ids.components[c1_id];
+            const auto& c2 = ids.components[c2_id];
+            const auto& cg = ids.components[cg_id];
+            expect(fatal(c1.type == irt::component_type::generic));
+            expect(fatal(c2.type == irt::component_type::generic));
+            expect(fatal(cg.type == irt::component_type::grid));
+
+            const auto& s1 = ids.generic_components.get(c1.id.generic_id);
+            const auto& s2 = ids.generic_components.get(c2.id.generic_id);
+            const auto& g  = ids.grid_components.get(cg.id.grid_id);
+
+            expect(eq(s1.children.ssize(), 2));
+            expect(eq(s1.connections.ssize(), 1));
+            expect(eq(c1.x.ssize(), 1));
+            expect(eq(c1.y.ssize(), 1));
+            expect(eq(c1.input_connection_pack.ssize(), 0));
+            expect(eq(s1.input_connections.ssize(), 1));
+            expect(eq(s1.output_connections.ssize(), 1));
+
+            expect(eq(s2.children.ssize(), 2));
+            expect(eq(s2.connections.ssize(), 1));
+            for (const auto& ch : s2.children) {
+                expect(ch.type == irt::child_type::component);
+                expect(ch.id.compo_id == c1_id);
+            }
+
+            expect(eq(g.row(), 3));
+            expect(eq(g.column(), 4));
+            for (const auto id : g.children())
+                expect(id == c1_id);
+        });
+    };
+
+    "component-cache-round-trip"_test = [] {
+        // Saves a component of each type in json. A first modeling reads the
+        // json files and writes the cache, a second one reads the cache and
+        // must build the same components. The hsm component is not cacheable
+        // and is read from json by both.
+        constexpr std::string_view cacheable[] = {
+            "leaf.irt", "coupled.irt", "grid.irt", "graph.irt"
+        };
+        constexpr std::string_view machine = "machine.irt";
+
+        irt::journal_handler jn;
+
+        std::error_code ec;
+        const auto      reg_dir =
+          std::filesystem::temp_directory_path(ec) / "reg-cache-temp";
+        std::filesystem::remove_all(reg_dir, ec);
+
+        {
+            irt::modeling                    mod;
+            std::array<irt::file_path_id, 5> files{};
+
+            mod.files.write([&](auto& fs) {
+                const auto reg_id = fs.alloc_registred("cache", 0);
+                fs.registred_paths.get(reg_id).path = reg_dir.string().c_str();
+
+                const auto dir_id               = fs.alloc_dir(reg_id);
+                fs.dir_paths.get(dir_id).parent = reg_id;
+                fs.dir_paths.get(dir_id).path   = "round-trip";
+
+                fs.create_directories(reg_id);
+                fs.create_directories(dir_id);
+
+                for (int i = 0; i < 4; ++i)
+                    files[i] = fs.alloc_file(
+                      dir_id, cacheable[i], irt::file_type::component_file);
+                files[4] = fs.alloc_file(
+                  dir_id, machine, irt::file_type::component_file);
+            });
+
+            mod.ids.write([&](auto& ids) {
+                const auto leaf_id = ids.alloc_generic_component();
+                auto&      leaf    = ids.components[leaf_id];
+                auto&      s = ids.generic_components.get(leaf.id.generic_id);
+                leaf.name    = "leaf";
+
+                auto& qss = s.alloc(irt::dynamics_type::qss1_integrator);
+                auto& cst = s.alloc(irt::dynamics_type::constant);
+                auto& cnt = s.alloc(irt::dynamics_type::counter);
+                s.children_parameters[s.children.get_id(qss)].set_integrator(
+                  1.0, 0.01);
+                s.children_parameters[s.children.get_id(cst)].set_constant(3.0);
+                s.children_names[s.children.get_id(cst)] = "cst";
+
+                const auto in  = leaf.get_or_add_x("in");
+                const auto out = leaf.get_or_add_y("out");
+                expect(!!s.connect_input(
+                  in, qss, irt::connection::port{ .model = 0 }));
+                expect(!!s.connect_output(
+                  out, qss, irt::connection::port{ .model = 0 }));
+                expect(!!s.connect(qss,
+                                   irt::connection::port{ .model = 0 },
+                                   cnt,
+                                   irt::connection::port{ .model = 0 }));
+
+                const auto coupled_id = ids.alloc_generic_component();
+                auto&      coupled    = ids.components[coupled_id];
+                auto& s2 = ids.generic_components.get(coupled.id.generic_id);
+                coupled.name = "coupled";
+
+                auto& ch1 = s2.alloc(leaf_id);
+                auto& ch2 = s2.alloc(leaf_id);
+                expect(!!s2.connect(ch1,
+                                    irt::connection::port{ .compo = out },
+                                    ch2,
+                                    irt::connection::port{ .compo = in }));
+
+                const auto grid_id = ids.alloc_grid_component();
+                auto&      grid    = ids.components[grid_id];
+                grid.name          = "grid";
+                ids.grid_components.get(grid.id.grid_id).resize(3, 4, leaf_id);
+
+                const auto graph_id = ids.alloc_graph_component();
+                auto&      graph    = ids.components[graph_id];
+                auto&      g = ids.graph_components.get(graph.id.graph_id);
+                graph.name   = "graph";
+
+                g.g_type      = irt::graph_component::graph_type::small_world;
+                g.type        = irt::graph_component::connection_type::in_out;
+                g.small       = irt::graph_component::small_world_param{};
+                g.small.nodes = 9;
+                g.small.id    = leaf_id;
+
+                const auto machine_id = ids.alloc_hsm_component();
+                auto&      hsm        = ids.components[machine_id];
+                auto&      h = ids.hsm_components.get(hsm.id.hsm_id);
+                hsm.name     = "machine";
+
+                expect(!!h.machine.set_state(
+                  0u, irt::hierarchical_state_machine::invalid_state_id, 1u));
+                expect(!!h.machine.set_state(1u, 0u));
+
+                const irt::component_id compos[] = {
+                    leaf_id, coupled_id, grid_id, graph_id, machine_id
+                };
+
+                mod.files.read([&](const auto& fs, auto) {
+                    for (int i = 0; i < 5; ++i) {
+                        ids.component_file_paths[compos[i]].file = files[i];
+                        ids.components[compos[i]].state =
+                          irt::component_status::unmodified;
+                    }
+
+                    for (const auto id : compos)
+                        expect(fatal(mod.save(ids, fs, id, jn).has_value()));
+                });
+            });
+        }
+
+        const auto add_registred = [&](irt::modeling& mod) {
+            mod.files.write([&](auto& fs) {
+                const auto reg_id = fs.alloc_registred("cache", 0);
+                fs.registred_paths.get(reg_id).path = reg_dir.string().c_str();
+            });
+        };
+
+        irt::modeling json_mod;
+        json_mod.save_component_caches = true;
+        add_registred(json_mod);
+        expect(fatal(json_mod.fill_components(jn).has_value()));
+
+        json_mod.files.read([&](const auto& fs, auto) {
+            for (const auto& reg : fs.registred_paths) {
+                irt::component_cache cache;
+                expect(fatal(cache.open(reg).has_value()));
+
+                for (const auto file : cacheable)
+                    expect(cache.find("round-trip", file) != nullptr) << file;
+                expect(cache.find("round-trip", machine) == nullptr);
+            }
+        });
+
+        // Blanks the json of the cacheable components without changing their
+        // size and modification time: only the cache can build them.
+        for (const auto file : cacheable) {
+            const auto p    = reg_dir / "round-trip" / file;
+            const auto size = std::filesystem::file_size(p, ec);
+            const auto time = std::filesystem::last_write_time(p, ec);
+            expect(fatal(not ec));
+
+            {
+                auto f = irt::file::open(
+                  p, irt::file_mode{ irt::file_open_options::write });
+                expect(fatal(f.has_value()));
+                const auto blank = std::string(size, ' ');
+                expect(fatal(f->write(std::string_view(blank))));
+            }
+
+            std::filesystem::last_write_time(p, time, ec);
+            expect(fatal(not ec));
+        }
+
+        // The cached components are read onto the workers of an executor.
+        irt::task_manager tm(0, 1);
+        tm.start();
+        irt::simulation_bag_executor executor(tm, 0);
+
+        irt::modeling cache_mod;
+        add_registred(cache_mod);
+        expect(fatal(cache_mod.fill_components(jn, &executor).has_value()));
+        tm.shutdown();
+
+        const auto expected = describe_components(json_mod);
+        const auto result   = describe_components(cache_mod);
+
+        const auto unmodified = std::ranges::count_if(expected, [](auto& l) {
+            return l.ends_with(fmt::format(
+              "state={}", irt::ordinal(irt::component_status::unmodified)));
+        });
+        expect(eq(unmodified, 5));
+
+        expect(fatal(eq(result.size(), expected.size())));
+        for (std::size_t i = 0; i < expected.size(); ++i)
+            expect(result[i] == expected[i]) << result[i] << expected[i];
+
+        std::filesystem::remove_all(reg_dir, ec);
+    };
+
+    "project-stream-load"_test = [] {
+        constexpr int n = 4096;
+
+        irt::journal_handler jn;
+        irt::modeling        mod;
+
+        irt::registred_path_str temp_path;
+        expect(fatal(get_temp_registred_path(temp_path)));
+
+        irt::file_path_id compo_file_id{ 0 };
+        irt::file_path_id project_file_id{ 0 };
+        irt::file_path_id late_file_id{ 0 };
+
+        mod.files.write([&](auto& fs) {
+            const auto reg_id = fs.alloc_registred("temp", 0);
+            fs.registred_paths.get(reg_id).path = temp_path;
+
+            const auto dir_id               = fs.alloc_dir(reg_id);
+            fs.dir_paths.get(dir_id).parent = reg_id;
+            fs.dir_paths.get(dir_id).path   = "test-stream";
+
+            fs.create_directories(reg_id);
+            fs.create_directories(dir_id);
+
+            compo_file_id = fs.alloc_file(
+              dir_id, "stream.irt", irt::file_type::component_file);
+            project_file_id = fs.alloc_file(
+              dir_id, "stream.pirt", irt::file_type::project_file);
+            late_file_id = fs.alloc_file(
+              dir_id, "stream-late.pirt", irt::file_type::project_file);
+        });
+
+        mod.ids.write([&](auto& ids) {
+            const auto compo_id = ids.alloc_generic_component();
+            auto&      compo    = ids.components[compo_id];
+            auto&      gen = ids.generic_components.get(compo.id.generic_id);
+
+            for (int i = 0; i < n; ++i) {
+                expect(fatal(gen.grow_children()));
+
+                auto&      ch = gen.alloc(irt::dynamics_type::constant);
+                const auto id = gen.children.get_id(ch);
+
+                ch.flags = irt::child_flags::configurable;
+                format(gen.children_names[id], "c{}", i);
+                gen.children_parameters[id].set_constant(irt::real(i));
+            }
+
+            ids.component_file_paths[compo_id].file = compo_file_id;
+
+            mod.files.write([&](auto& fs) {
+                expect(fatal(mod.save(ids, fs, compo_id, jn).has_value()));
+
+                irt::project pj;
+                pj.file = project_file_id;
+                expect(fatal(pj.set(ids, fs, compo_id, jn).has_value()));
+                expect(eq(pj.parameters.ssize(), n));
+                expect(fatal(pj.save(fs, ids, jn).has_value()));
+            });
+        });
+
+        const auto sum = [](const irt::project& pj) noexcept {
+            irt::real r = 0;
+            for (const auto id : pj.parameters)
+                r += pj.parameters.get<irt::parameter>(id).reals[0];
+            return r;
+        };
+
+        const auto dir = std::filesystem::path(temp_path.sv()) / "test-stream";
+
+        mod.ids.read([&](const auto& ids, auto) {
+            mod.files.read([&](const auto& fs, auto) {
+                // The peak resident set size only grows: the stream load is
+                // measured first and the dom load reports its growth over
+                // the stream peak.
+                irt::real stream_sum = 0;
+                const auto rss0      = peak_rss_kib();
+                const auto t0        = std::chrono::steady_clock::now();
+                {
+                    auto stream_pj =
+                      irt::project::load(fs, ids, project_file_id, jn);
+                    expect(fatal(stream_pj.has_value()));
+                    expect(eq(stream_pj->parameters.ssize(), n));
+                    stream_sum = sum(*stream_pj);
+                }
+                const auto t1   = std::chrono::steady_clock::now();
+                const auto rss1 = peak_rss_kib();
+
+                auto f = irt::file::open(
+                  dir / "stream.pirt",
+                  irt::file_mode{ irt::file_open_options::read });
+                expect(fatal(f.has_value()));
+
+                irt::vector<char> buffer(f->length());
+                expect(fatal(f->read(buffer.data(), buffer.size())));
+
+                const auto t2     = std::chrono::steady_clock::now();
+                auto       dom_pj = irt::project::load(
+                  fs, ids, std::span(buffer.data(), buffer.size()), jn);
+                const auto t3   = std::chrono::steady_clock::now();
+                const auto rss2 = peak_rss_kib();
+
+                expect(fatal(dom_pj.has_value()));
+                expect(eq(dom_pj->parameters.ssize(), n));
+                expect(eq(stream_sum, sum(*dom_pj)));
+                expect(eq(stream_sum, irt::real(n * (n - 1) / 2)));
+                expect(ge(rss2, rss1));
+
+                using ms = std::chrono::milliseconds;
+                fmt::print("project-stream-load: {} bytes, stream {}ms "
+                           "(peak rss +{}KiB), dom {}ms (peak rss +{}KiB over "
+                           "the stream)\n",
+                           buffer.size(),
+                           std::chrono::duration_cast<ms>(t1 - t0).count(),
+                           rss1 - rss0,
+                           std::chrono::duration_cast<ms>(t3 - t2).count(),
+                           rss2 - rss1);
+
+                // Moves the component members after the parameters and the
+                // observations: the stream reader buffers them.
+                std::string text(buffer.data(), buffer.size());
+                const auto  first = text.find("\"component-type\"");
+                const auto  last  = text.find("\"parameters\"");
+                const auto  close = text.rfind('}');
+                expect(fatal(first < last and last < close));
+
+                auto compo = text.substr(first, last - first);
+                compo.erase(compo.find_last_not_of(" \t\r\n,") + 1);
+                auto rest = text.substr(last, close - last);
+                rest.erase(rest.find_last_not_of(" \t\r\n") + 1);
+                text = text.substr(0, first) + rest + ",\n" + compo + "\n}\n";
+
+                {
+                    auto late = irt::file::open(
+                      dir / "stream-late.pirt",
+                      irt::file_mode{ irt::file_open_options::write });
+                    expect(fatal(late.has_value()));
+                    expect(fatal(late->write(std::string_view(text))));
+                }
+
+                auto late_pj = irt::project::load(fs, ids, late_file_id, jn);
+                expect(fatal(late_pj.has_value()));
+                expect(eq(late_pj->parameters.ssize(), n));
+                expect(eq(sum(*late_pj), stream_sum));
+            });
+        });
+    };
+
     "no-connection"_test = [] {
         irt::journal_handler jn;
         irt::modeling        mod;
@@ -1598,6 +2247,110 @@ int main()
         expect(eq(nb_constant_model, cell_number));
     };
 
+    "grid-5x5-tiles"_test = [] {
+        irt::journal_handler jn;
+        irt::modeling        mod;
+        irt::project         pj;
+
+        const auto cg_id = mod.ids.write([&](auto& ids) noexcept {
+            auto  c1_id = ids.alloc_generic_component();
+            auto& c1    = ids.components[c1_id];
+            auto& s1    = ids.generic_components.get(c1.id.generic_id);
+            auto& ch1   = s1.alloc(irt::dynamics_type::counter);
+
+            auto p1_id = c1.get_or_add_x("in");
+            expect(!!s1.connect_input(
+              p1_id, ch1, irt::connection::port{ .model = 0 }));
+
+            auto  c2_id = ids.alloc_generic_component();
+            auto& c2    = ids.components[c2_id];
+            auto& s2    = ids.generic_components.get(c2.id.generic_id);
+            auto& ch2   = s2.alloc(irt::dynamics_type::time_func);
+            auto  p2_id = c2.get_or_add_y("out");
+            expect(!!s2.connect_output(
+              p2_id, ch2, irt::connection::port{ .model = 0 }));
+            s2.children_parameters[irt::get_index(s2.children.get_id(ch2))]
+              .set_time_func(0.0, 0.1, 2);
+
+            auto  c3_id  = ids.alloc_generic_component();
+            auto& c3     = ids.components[c3_id];
+            auto& s3     = ids.generic_components.get(c3.id.generic_id);
+            auto& ch3    = s3.alloc(c2_id);
+            auto& ch4    = s3.alloc(c1_id);
+            auto  p31_id = c3.get_or_add_x("in");
+            auto  p32_id = c3.get_or_add_y("out");
+
+            expect(!!s3.connect(ch3,
+                                irt::connection::port{ .compo = p2_id },
+                                ch4,
+                                irt::connection::port{ .compo = p1_id }));
+            expect(!!s3.connect_input(
+              p31_id, ch4, irt::connection::port{ .compo = p1_id }));
+            expect(!!s3.connect_output(
+              p32_id, ch3, irt::connection::port{ .compo = p2_id }));
+
+            auto  cg_id = ids.alloc_grid_component();
+            auto& cg    = ids.components[cg_id];
+            auto& g     = ids.grid_components.get(cg.id.grid_id);
+            g.resize(5, 5, c3_id);
+            g.opts                = irt::grid_component::options::none;
+            g.in_connection_type  = irt::grid_component::type::in_out;
+            g.out_connection_type = irt::grid_component::type::in_out;
+            g.neighbors           = irt::grid_component::neighborhood::four;
+
+            return cg_id;
+        });
+
+        mod.ids.read([&](const auto& ids, auto) {
+            mod.files.read([&](const auto& fs, auto) {
+                expect(!!pj.set(ids, fs, cg_id, jn));
+            });
+        });
+
+        // Tiles of 2x2 cells: the last row and the last column of tiles have
+        // only one row or one column of cells.
+        irt::vector<irt::u32> partitions;
+        expect(!!pj.build_grid_partitions(*pj.tn_head(), 2, 2, partitions));
+
+        std::array<int, 9> models{};
+        for (const auto& mdl : pj.sim.models) {
+            const auto id = pj.sim.models.get_id(mdl);
+            expect(fatal(lt(partitions[irt::get_index(id)], 9u)));
+            ++models[partitions[irt::get_index(id)]];
+        }
+
+        expect(eq(models[0], 4 * 2));
+        expect(eq(models[2], 2 * 2));
+        expect(eq(models[8], 1 * 2));
+
+        pj.sim.limits.set_bound(0, 10);
+
+        irt::conservative_simulation cs;
+        expect(fatal(cs.init(pj.sim, partitions).has_value()));
+        expect(fatal(cs.initialize().has_value()));
+        expect(fatal(cs.run().has_value()));
+        expect(eq(cs.size(), 9));
+        expect(gt(cs.windows(), 0u));
+
+        expect(fatal(pj.sim.initialize().has_value()));
+        do {
+            expect(fatal(pj.sim.run().has_value()));
+        } while (not pj.sim.current_time_expired());
+
+        for (const auto& mdl : pj.sim.models) {
+            if (mdl.type == irt::dynamics_type::counter) {
+                const auto  id   = pj.sim.models.get_id(mdl);
+                const auto& tile = cs[partitions[irt::get_index(id)]];
+                const auto& dyn  = irt::get_dyn<irt::counter>(mdl);
+
+                expect(gt(dyn.event_number, 0));
+                expect(eq(
+                  dyn.event_number,
+                  irt::get_dyn<irt::counter>(tile.models.get(id)).event_number));
+            }
+        }
+    };
+
     "grid-3x3-constant-model-init-port-n"_test = [] {
         irt::vector<char> buffer;
 
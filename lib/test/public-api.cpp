@@ -13,6 +13,7 @@
 
 #include <fmt/format.h>
 
+#include <chrono>
 #include <numbers>
 #include <random>
 
@@ -1200,6 +1201,88 @@ int main()
         expect(eq(h[h.top()].tn, 0.0));
     };
 
+    "calendar-queue-order"_test = [] {
+        using namespace irt::literals;
+
+        irt::calendar_queue q(512);
+        irt::vector<irt::model_id> out;
+
+        for (int t = 0; t < 100; ++t)
+            q.alloc(irt::to_real(t) * 0.1, static_cast<irt::model_id>(t));
+
+        q.alloc(5.0, irt::model_id{ 502 });
+        q.alloc(5.0, irt::model_id{ 503 });
+        q.alloc(irt::time_domain<irt::time>::infinity, irt::model_id{ 504 });
+        q.alloc(irt::time_domain<irt::time>::infinity, irt::model_id{ 505 });
+
+        expect(eq(q.size(), 104u));
+
+        for (int t = 0; t < 100; ++t) {
+            expect(eq(q[q.top()].tn, irt::to_real(t) * 0.1));
+            q.pop(out);
+            expect(eq(out.ssize(), t == 50 ? 3 : 1));
+        }
+
+        expect(irt::time_domain<irt::time>::is_infinity(q[q.top()].tn));
+        q.pop(out);
+        expect(eq(out.ssize(), 2));
+        expect(q.empty());
+    };
+
+    "calendar-queue-remove-decrease"_test = [] {
+        using namespace irt::literals;
+
+        irt::calendar_queue q(512);
+        irt::vector<irt::model_id> out;
+
+        for (int t = 0; t < 100; ++t)
+            q.alloc(irt::to_real(t), static_cast<irt::model_id>(t));
+
+        for (irt::u32 i = 0u; i < 100u; i += 2u)
+            q.remove(i);
+
+        expect(eq(q.size(), 50u));
+        expect(not q.is_in_tree(0u));
+        expect(q.is_in_tree(1u));
+        expect(eq(q[q.top()].tn, 1.0));
+
+        for (irt::u32 i = 0u; i < 100u; i += 2u)
+            q.reintegrate(irt::to_real(i), i);
+
+        q.decrease(-1.0, 99u);
+        expect(eq(q.top(), 99u));
+        q.increase(1000.0, 99u);
+
+        for (int t = 0; t < 99; ++t) {
+            expect(eq(q[q.top()].tn, irt::to_real(t)));
+            q.pop(out);
+        }
+
+        expect(eq(q[q.top()].tn, 1000.0));
+        q.destroy(q.top());
+        expect(q.empty());
+    };
+
+    "calendar-queue-resize-groups"_test = [] {
+        irt::calendar_queue q(4096);
+        irt::vector<irt::model_id> out;
+
+        // The @c top() is cached before each insertion and the buckets are
+        // rebuilt several times while groups of nodes share the same tn.
+        for (int i = 0; i < 1000; ++i) {
+            q.alloc(irt::to_real(3 - i % 4), static_cast<irt::model_id>(i));
+            expect(eq(q[q.top()].tn, i < 3 ? irt::to_real(3 - i) : 0.0));
+        }
+
+        for (int t = 0; t < 4; ++t) {
+            expect(eq(q[q.top()].tn, irt::to_real(t)));
+            q.pop(out);
+            expect(eq(out.ssize(), 250));
+        }
+
+        expect(q.empty());
+    };
+
     "hierarchy-simple"_test = [] {
         struct data_type {
             explicit data_type(int i_) noexcept
@@ -1290,6 +1373,180 @@ int main()
         expect(eq(cnt.event_number, static_cast<irt::i64>(2)));
     };
 
+    "connection_graph_simulation"_test = [] {
+        irt::simulation sim;
+
+        auto& c1 = sim.alloc<irt::constant>();
+        auto& c2 = sim.alloc<irt::constant>();
+
+        get_p(sim, c1).set_constant(0, 0);
+        get_p(sim, c2).set_constant(0, 1);
+
+        // More than 4 connections to use the block_node linked list.
+        std::array<irt::model_id, 6> cnts;
+        for (auto& id : cnts) {
+            auto& cnt = sim.alloc<irt::counter>();
+            id        = sim.get_id(cnt);
+
+            expect(!!sim.connect_dynamics(c1, 0, cnt, 0));
+            expect(!!sim.connect_dynamics(c2, 0, cnt, 0));
+        }
+
+        expect(!!sim.initialize());
+        expect(!!sim.run());
+
+        // The connection graph must be rebuilt before the next routing.
+        sim.disconnect(get_model(c2), 0, sim.models.get(cnts[5]), 0);
+        sim.deallocate(cnts[4]);
+
+        do {
+            expect(!!sim.run());
+        } while (not sim.current_time_expired());
+
+        for (int i = 0; i < 4; ++i)
+            expect(eq(
+              irt::get_dyn<irt::counter>(sim.models.get(cnts[i])).event_number,
+              static_cast<irt::i64>(2)));
+
+        expect(eq(
+          irt::get_dyn<irt::counter>(sim.models.get(cnts[5])).event_number,
+          static_cast<irt::i64>(1)));
+    };
+
+    "dynamics_function_table"_test = [] {
+        irt::simulation sim;
+
+        expect(sim.can_alloc(3));
+
+        auto& sum   = get_model(sim.alloc<irt::qss1_sum_3>());
+        auto& cst   = get_model(sim.alloc<irt::constant>());
+        auto& queue = get_model(sim.alloc<irt::queue>());
+
+        const auto& f_sum   = irt::get_dynamics_functions(sum);
+        const auto& f_cst   = irt::get_dynamics_functions(cst);
+        const auto& f_queue = irt::get_dynamics_functions(queue);
+
+        expect(eq(f_sum.input_ports(sum).size(), 3u));
+        expect(f_cst.input_ports(cst).empty());
+        expect(eq(f_queue.input_ports(queue).size(), 1u));
+
+        expect(f_sum.observation != nullptr);
+        expect(f_cst.observation != nullptr);
+        expect(f_queue.observation == nullptr);
+
+        get_p(sim, irt::get_dyn<irt::constant>(cst)).set_constant(10, 0);
+        expect(sim.initialize().has_value());
+        expect(eq(f_cst.observation(cst, 0, 0).value, 10.0));
+    };
+
+    "fixed_simulation"_test = [] {
+        const auto oscillator = [](auto& sim) {
+            expect(fatal(sim.can_alloc(4)));
+
+            auto& x   = sim.template alloc<irt::qss2_integrator>();
+            auto& v   = sim.template alloc<irt::qss2_integrator>();
+            auto& k   = sim.template alloc<irt::qss2_gain>();
+            auto& cnt = sim.template alloc<irt::counter>();
+
+            get_p(sim, x).set_integrator(1.0, 0.01);
+            get_p(sim, v).set_integrator(0.0, 0.01);
+            get_p(sim, k).set_gain(-1.0);
+
+            expect(!!sim.connect_dynamics(v, 0, x, 0));
+            expect(!!sim.connect_dynamics(x, 0, k, 0));
+            expect(!!sim.connect_dynamics(k, 0, v, 0));
+            expect(!!sim.connect_dynamics(x, 0, cnt, 0));
+
+            sim.limits.set_bound(0, 10);
+            expect(fatal(sim.initialize().has_value()));
+
+            do {
+                expect(fatal(sim.run().has_value()));
+            } while (not sim.current_time_expired());
+
+            return std::make_pair(cnt.event_number, cnt.last_value);
+        };
+
+        irt::simulation sim;
+        irt::fixed_simulation<irt::qss2_integrator, irt::qss2_gain, irt::counter>
+          fixed;
+
+        const auto expected = oscillator(sim);
+        const auto result   = oscillator(fixed);
+
+        expect(gt(expected.first, 0));
+        expect(eq(result.first, expected.first));
+        expect(eq(result.second, expected.second));
+
+        auto* os = std::tmpfile();
+        expect(fatal(os != nullptr));
+        expect(irt::write_test_simulation(
+                 os,
+                 "oscillator",
+                 fixed,
+                 0,
+                 10,
+                 irt::write_test_simulation_options::none) ==
+               irt::write_test_simulation_result::success);
+
+        std::string code(static_cast<std::size_t>(std::ftell(os)), '\0');
+        std::rewind(os);
+        expect(eq(std::fread(code.data(), 1, code.size(), os), code.size()));
+        std::fclose(os);
+
+        expect(code.find("irt::fixed_simulation<\n"
+                         "      irt::qss2_integrator,\n"
+                         "      irt::qss2_gain,\n"
+                         "      irt::counter>") != std::string::npos);
+
+        irt::fixed_simulation<irt::counter> counters;
+        expect(fatal(counters.can_alloc(2)));
+        (void)counters.alloc<irt::counter>();
+        auto& cst =
+          static_cast<irt::simulation&>(counters).alloc<irt::constant>();
+        expect(not counters.initialize().has_value());
+        expect(not irt::dynamics_set<irt::counter>::dispatch(
+                     irt::get_model(cst),
+                     [](auto&) -> irt::status { return irt::success(); })
+                     .has_value());
+    };
+
+    "standalone_simulation"_test = [] {
+        irt::simulation sim;
+
+        expect(fatal(sim.can_alloc(2)));
+
+        auto& x = sim.alloc<irt::qss1_integrator>();
+        auto& c = sim.alloc<irt::constant>();
+
+        get_p(sim, x).set_integrator(0.0, 0.01);
+        get_p(sim, c).set_constant(1.0, 0.0);
+
+        expect(!!sim.connect_dynamics(c, 0, x, 0));
+        expect(sim.observe(get_model(x), 0.5).has_value());
+
+        auto* os = std::tmpfile();
+        expect(fatal(os != nullptr));
+        expect(irt::write_standalone_simulation(os, "ramp", sim, 0, 10) ==
+               irt::write_test_simulation_result::success);
+
+        std::string code(static_cast<std::size_t>(std::ftell(os)), '\0');
+        std::rewind(os);
+        expect(eq(std::fread(code.data(), 1, code.size(), os), code.size()));
+        std::fclose(os);
+
+        expect(code.find("using simulation_type = irt::fixed_simulation<\n"
+                         "      irt::qss1_integrator,\n"
+                         "      irt::constant>;") != std::string::npos);
+        expect(code.find("std::array<irt::model_id, 2>") != std::string::npos);
+        expect(code.find("sim.observe(irt::get_model(mdl_0), 0.5)") !=
+               std::string::npos);
+        expect(code.find("sim.connect_dynamics(mdl_1, 0, mdl_0, 0)") !=
+               std::string::npos);
+        expect(code.find("IRT_SIMULATOR_API int irt_simulator_step(") !=
+               std::string::npos);
+    };
+
     "observation_simulation"_test = [] {
         irt::simulation sim;
 
@@ -1337,6 +1594,176 @@ int main()
         });
     };
 
+    "observer-history-budget"_test = [] {
+        constexpr int         n      = 100000;
+        constexpr std::size_t budget = 4096;
+
+        irt::observer  bounded(irt::model_id{ 1 });
+        irt::observer  unbounded(irt::model_id{ 2 });
+        irt::resampler r1(0.5, irt::interpolate_type::none);
+        irt::resampler r2(0.5, irt::interpolate_type::none);
+        bounded.history_budget(budget);
+
+        for (int i = 0; i < n; ++i) {
+            const auto t = static_cast<irt::real>(i) * 0.5;
+            const auto v = std::sin(t) + static_cast<irt::real>(i);
+            expect(bounded.observe(irt::raw_sample{ t, v }) !=
+                   irt::buffer_status::overflow);
+            expect(unbounded.observe(irt::raw_sample{ t, v }) !=
+                   irt::buffer_status::overflow);
+
+            if (i % 128 == 0) {
+                r1.tick(bounded, t);
+                r2.tick(unbounded, t);
+            }
+        }
+
+        const auto inf = std::numeric_limits<irt::real>::infinity();
+        r1.tick(bounded, inf);
+        r2.tick(unbounded, inf);
+
+        unbounded.read_history([&](const auto& h, const auto) {
+            expect(eq(h.ssize(), n));
+            expect(h.level(0).empty());
+        });
+
+        bounded.read_history([&](const auto& h, const auto) {
+            expect(le(h.allocated(), 4 * budget));
+            expect(fatal(not h.empty()));
+            expect(eq(h.back().t, static_cast<irt::real>(n - 1) * 0.5));
+
+            // The whole time range is available and the levels are sorted:
+            // the last level stores the oldest dates.
+            irt::real count = static_cast<irt::real>(h.size());
+            irt::real t     = -1;
+            for (int i = irt::observer_history::lod_levels - 1; i >= 0; --i) {
+                for (const auto& b : h.level(i)) {
+                    expect(b.t_begin > t);
+                    expect(b.min <= b.mean and b.mean <= b.max);
+                    t = b.t_end;
+                    count += b.count;
+                }
+            }
+
+            expect(eq(h.level(irt::observer_history::lod_levels - 1)[0].t_begin,
+                      0.0));
+            expect(h.front().t > t);
+            expect(eq(count, static_cast<irt::real>(n)));
+
+            const auto v = h.samples(h.back().t - 5.0, h.back().t);
+            expect(eq(v.size(), 12u));
+        });
+    };
+
+    "observer-history-spill"_test = [] {
+        constexpr int n = 3 * irt::history_spill::page_size + 100;
+
+        const auto path =
+          std::filesystem::temp_directory_path() / "irt-history-spill.data";
+
+        // The first segment maps one page, the spill maps two segments to
+        // write two pages.
+        irt::history_spill spill;
+        expect(fatal(spill.open(path, 1).has_value()));
+        expect(eq(spill.capacity(), 1u));
+
+        irt::observer  obs(irt::model_id{ 1 });
+        irt::resampler r(0.5, irt::interpolate_type::none);
+        obs.spill(&spill);
+
+        for (int i = 0; i < n; ++i) {
+            const auto v = static_cast<irt::real>(i);
+            expect(obs.observe(irt::raw_sample{ v * 0.5, v }) !=
+                   irt::buffer_status::overflow);
+
+            if (i % 128 == 0)
+                r.tick(obs, v * 0.5);
+        }
+
+        r.tick(obs, std::numeric_limits<irt::real>::infinity());
+
+        obs.read_history([&](const auto& h, const auto) {
+            expect(fatal(eq(h.spilled(), 2u * irt::history_spill::page_size)));
+            expect(eq(h.spilled() + h.size(), static_cast<irt::u64>(n)));
+            expect(eq(h.front().value, static_cast<irt::real>(h.spilled())));
+
+            irt::real i = 0;
+            h.for_each_spilled_page([&](const auto dates, const auto values) {
+                for (std::size_t j = 0; j < dates.size(); ++j, ++i) {
+                    expect(eq(dates[j], i * 0.5));
+                    expect(eq(values[j], i));
+                }
+            });
+        });
+
+        expect(eq(spill.capacity(), 3u));
+
+        spill.close();
+        expect(eq(std::filesystem::file_size(path),
+                  2u * irt::history_spill::page_bytes));
+        std::filesystem::remove(path);
+    };
+
+    "observer-lossless"_test = [] {
+        irt::simulation sim;
+
+        expect(sim.can_alloc(3));
+
+        auto& f1 = sim.alloc<irt::time_func>();
+        auto& f2 = sim.alloc<irt::time_func>();
+        auto& f3 = sim.alloc<irt::time_func>();
+        get_p(sim, f1).set_time_func(0, 0.1, 2);
+        get_p(sim, f2).set_time_func(0, 0.1, 2);
+        get_p(sim, f3).set_time_func(0, 0.1, 2);
+
+        expect(sim.observe(get_model(f1), 0.05).has_value());
+        expect(sim.observe(get_model(f2), 0.05).has_value());
+        expect(sim.observe(get_model(f3), 0.05).has_value());
+
+        auto& ref      = *sim.observers.try_to_get(get_model(f1).obs_id);
+        auto& lossless = *sim.observers.try_to_get(get_model(f2).obs_id);
+        auto& lossy    = *sim.observers.try_to_get(get_model(f3).obs_id);
+        static_assert(not std::is_default_constructible_v<
+                      irt::observer::raw_buffer_type>);
+        expect(eq(ref.raw_buffer_capacity(), irt::observer::raw_buffer_size));
+        ref.raw_buffer_capacity(512);
+        lossless.raw_buffer_capacity(16);
+        lossless.lossless(true);
+        lossy.raw_buffer_capacity(16);
+        expect(eq(lossless.raw_buffer_capacity(), 16u));
+
+        // No copy task: only the lossless observer is drained during the
+        // simulation.
+        sim.limits.set_bound(0, 30);
+        expect(!!sim.initialize());
+        do {
+            expect(!!sim.run());
+        } while (not sim.current_time_expired());
+        expect(sim.finalize().has_value());
+
+        expect(eq(ref.overflows(), 0u));
+        expect(gt(ref.raw_buffer_peak(), 256u));
+        expect(gt(lossless.overflows(), 0u));
+        expect(le(lossless.raw_buffer_peak(), 16u));
+        expect(gt(lossy.overflows(), 0u));
+
+        sim.tick_resamplers();
+
+        ref.read_history([&](const auto& h, const auto) {
+            lossless.read_history([&](const auto& l, const auto) {
+                expect(fatal(eq(h.size(), l.size())));
+                for (std::size_t i = 0; i < h.size(); ++i) {
+                    expect(eq(h[i].t, l[i].t));
+                    expect(eq(h[i].value, l[i].value));
+                }
+            });
+
+            lossy.read_history([&](const auto& l, const auto) {
+                expect(lt(l.size(), h.size()));
+            });
+        });
+    };
+
     "cross_simulation"_test = [] {
         fmt::print("cross_simulation\n");
         irt::simulation sim;
@@ -2062,6 +2489,204 @@ int main()
         expect(str_t.size() > static_cast<size_t>(1024) * 2);
     };
 
+    "mapped-file"_test = [] {
+        const auto p =
+          std::filesystem::temp_directory_path() / "irt-mapped-file.bin";
+
+        {
+            auto rw = irt::mapped_file::open(p, 0u, 4096u, true);
+            expect(fatal(rw.has_value()));
+            expect(eq(rw->size(), static_cast<irt::u64>(4096u)));
+
+            for (irt::u64 i = 0; i < rw->size(); ++i)
+                rw->data()[i] = static_cast<std::byte>(i % 251u);
+        }
+
+        {
+            auto grow = irt::mapped_file::open(p, 0u, 8192u, false);
+            expect(fatal(grow.has_value()));
+            expect(eq(static_cast<int>(grow->data()[4095]), 4095 % 251));
+            expect(eq(static_cast<int>(grow->data()[8191]), 0));
+        }
+
+        {
+            auto tail = irt::mapped_file::open(p, 65536u, 4096u, false);
+            expect(fatal(tail.has_value()));
+            expect(eq(tail->size(), static_cast<irt::u64>(4096u)));
+            tail->data()[0] = std::byte{ 42 };
+        }
+
+        auto ro = irt::mapped_file::open(p);
+        expect(fatal(ro.has_value()));
+        expect(eq(ro->size(), static_cast<irt::u64>(65536u + 4096u)));
+        expect(eq(static_cast<int>(ro->data()[65536]), 42));
+        expect(eq(static_cast<int>(ro->data()[1000]), 1000 % 251));
+
+        irt::mapped_file moved(std::move(*ro));
+        expect(not ro->is_open());
+        expect(moved.is_open());
+        moved.close();
+        expect(not moved.is_open());
+
+        std::filesystem::resize_file(p, 0);
+        expect(not irt::mapped_file::open(p).has_value());
+
+        std::filesystem::remove(p);
+    };
+
+    "binary-file-source-mapped"_test = [] {
+        const auto p =
+          std::filesystem::temp_directory_path() / "irt-binary-source.bin";
+
+        // More chunks than the old 32 clients limit.
+        constexpr int chunks = 2 * (irt::default_max_client_number + 1);
+
+        {
+            auto f = irt::file::open(p, irt::file_mode{
+                                          irt::file_open_options::write });
+            expect(fatal(f.has_value()));
+
+            for (int i = 0; i < irt::external_source_chunk_size * chunks; ++i)
+                expect(f->write(static_cast<double>(i)));
+        }
+
+        const auto chunk = [](const int i) noexcept {
+            return static_cast<double>(i * irt::external_source_chunk_size);
+        };
+
+        irt::binary_file_source bin(p);
+        expect(fatal(bin.init().has_value()));
+        expect(bin.is_mapped());
+        expect(eq(bin.max_reals,
+                  static_cast<irt::u64>(irt::external_source_chunk_size *
+                                        chunks)));
+
+        std::array<irt::source, 3>      srcs;
+        std::array<irt::source_data, 3> datas;
+
+        for (auto i = 0u; i < 3u; ++i) {
+            expect(fatal(bin.init(srcs[i], datas[i]).has_value()));
+            expect(eq(srcs[i].buffer.size(),
+                      static_cast<std::size_t>(
+                        irt::external_source_chunk_size)));
+            expect(eq(srcs[i].buffer[0], chunk(i)));
+        }
+
+        // The clients read the chunks k, k + 3, k + 6, etc.
+        expect(bin.update(srcs[0], datas[0]).has_value());
+        expect(eq(srcs[0].buffer[0], chunk(3)));
+
+        const auto saved = datas[2];
+        expect(bin.update(srcs[2], datas[2]).has_value());
+        expect(eq(srcs[2].buffer[1], chunk(5) + 1.0));
+
+        datas[2] = saved;
+        expect(bin.restore(srcs[2], datas[2]).has_value());
+        expect(eq(srcs[2].buffer[0], chunk(2)));
+
+        irt::binary_file_source copy(bin);
+        expect(not copy.is_mapped());
+        expect(fatal(copy.init().has_value()));
+        expect(eq(copy.max_reals, bin.max_reals));
+
+        // The number of clients is unlimited: the last client of the copy
+        // reads its second chunk at the end of the file, then reaches the
+        // end of the file.
+        constexpr int clients = irt::default_max_client_number + 1;
+
+        std::array<irt::source, clients>      many_srcs;
+        std::array<irt::source_data, clients> many_datas;
+
+        for (int i = 0; i < clients; ++i) {
+            expect(fatal(copy.init(many_srcs[i], many_datas[i]).has_value()));
+            expect(eq(many_srcs[i].buffer[0], chunk(i)));
+        }
+
+        auto& last      = many_srcs[clients - 1];
+        auto& last_data = many_datas[clients - 1];
+        expect(copy.update(last, last_data).has_value());
+        expect(eq(last.buffer[0], chunk(chunks - 1)));
+        expect(not copy.update(last, last_data).has_value());
+
+        bin.finalize();
+        copy.finalize();
+        expect(not bin.is_mapped());
+
+        std::filesystem::remove(p);
+    };
+
+    "text-file-source"_test = [] {
+        const auto p =
+          std::filesystem::temp_directory_path() / "irt-text-source.txt";
+
+        {
+            auto f = irt::file::open(
+              p, irt::file_mode{ irt::file_open_options::write });
+            expect(fatal(f.has_value()));
+
+            for (int i = 0; i < irt::external_source_chunk_size * 3; ++i)
+                expect(f->write(fmt::format(
+                  "{}{}", i + 0.5, i % 7 == 0 ? "\n" : (i % 3 ? " " : "\t"))));
+        }
+
+        for (const auto cache : { false, true }) {
+            irt::text_file_source txt(p);
+            txt.use_binary_cache = cache;
+            expect(fatal(txt.init().has_value()));
+
+            irt::source      src;
+            irt::source_data data;
+            expect(fatal(txt.init(src, data).has_value()));
+            expect(eq(src.buffer[0], 0.5));
+            expect(eq(src.buffer[511], 511.5));
+
+            expect(fatal(txt.update(src, data).has_value()));
+            expect(eq(src.buffer[0], 512.5));
+
+            const auto saved = data;
+            expect(fatal(txt.update(src, data).has_value()));
+            expect(eq(src.buffer[0], 1024.5));
+            expect(not txt.update(src, data).has_value());
+
+            data = saved;
+            expect(fatal(txt.restore(src, data).has_value()));
+            expect(eq(src.buffer[0], 512.5));
+            expect(eq(src.buffer[511], 1023.5));
+
+            expect(fatal(txt.update(src, data).has_value()));
+            expect(eq(src.buffer[0], 1024.5));
+
+            txt.finalize();
+            expect(eq(std::filesystem::exists(txt.binary_cache_path()),
+                      cache));
+        }
+
+        irt::text_file_source txt(p);
+        std::filesystem::remove(txt.binary_cache_path());
+
+        // A directory in place of the temporary file of the cache makes the
+        // conversion fail: the text file is parsed.
+        auto tmp = txt.binary_cache_path();
+        tmp += ".tmp";
+        std::filesystem::create_directory(tmp);
+
+        txt.use_binary_cache = true;
+        expect(fatal(txt.init().has_value()));
+
+        irt::source      src;
+        irt::source_data data;
+        expect(fatal(txt.init(src, data).has_value()));
+        expect(eq(src.buffer[0], 0.5));
+        expect(fatal(txt.update(src, data).has_value()));
+        expect(eq(src.buffer[0], 512.5));
+
+        txt.finalize();
+        expect(not std::filesystem::exists(txt.binary_cache_path()));
+
+        std::filesystem::remove(tmp);
+        std::filesystem::remove(p);
+    };
+
     "binary-memory-io"_test = [] {
         auto f = irt::memory::make(256);
 
@@ -2091,6 +2716,150 @@ int main()
         expect(f->tell() == 0);
     };
 
+    "binary-archiver-chunks"_test = [] {
+        constexpr int n        = 100000;
+        constexpr int counters = 16;
+
+        irt::simulation sim(
+          irt::simulation_reserve_definition{
+            .models         = n + counters,
+            .connections    = n,
+            .hsms           = 16,
+            .dated_messages = 0,
+          },
+          irt::external_source_reserve_definition{ .constant_nb  = 1,
+                                                   .text_file_nb = 1 });
+
+        std::array<irt::model_id, counters> cnts;
+        for (auto& id : cnts)
+            id = sim.get_id(sim.alloc<irt::counter>());
+
+        for (int i = 0; i < n; ++i) {
+            auto& c   = sim.alloc<irt::constant>();
+            auto& cnt = sim.models.get(cnts[i % counters]);
+            get_p(sim, c).set_constant(static_cast<irt::real>(i), 0);
+            expect(!!sim.connect_dynamics(
+              c, 0, irt::get_dyn<irt::counter>(cnt), 0));
+        }
+
+        auto& hsm     = sim.hsms.alloc();
+        hsm.top_state = 0;
+        hsm.flags.set(irt::hierarchical_state_machine::option::use_source);
+
+        auto& cst  = sim.srcs.constant_sources.alloc();
+        cst.length = 3;
+        cst.buffer[2] = 42.0;
+
+        auto& txt            = sim.srcs.text_file_sources.alloc();
+        txt.file_path        = "irt-archiver-text.txt";
+        txt.use_binary_cache = true;
+
+        const auto p =
+          std::filesystem::temp_directory_path() / "irt-binary-archiver.irt";
+
+        const auto check = [&](irt::simulation& loaded) {
+            expect(fatal(eq(loaded.models.size(), sim.models.size())));
+            expect(eq(loaded.hsms.size(), 1u));
+            expect(eq(loaded.srcs.constant_sources.size(), 1u));
+
+            const irt::hierarchical_state_machine* h = nullptr;
+            expect(fatal(loaded.hsms.next(h)));
+            expect(eq(h->top_state, 0));
+            expect(
+              h->flags[irt::hierarchical_state_machine::option::use_source]);
+
+            const irt::constant_source* src = nullptr;
+            expect(fatal(loaded.srcs.constant_sources.next(src)));
+            expect(eq(src->length, 3u));
+            expect(eq(src->buffer[2], 42.0));
+
+            const irt::text_file_source* t = nullptr;
+            expect(fatal(loaded.srcs.text_file_sources.next(t)));
+            expect(t->use_binary_cache);
+
+            double sum = 0.0;
+            for (const auto& mdl : loaded.models)
+                if (mdl.type == irt::dynamics_type::constant)
+                    sum += loaded.parameters[loaded.models.get_id(mdl)]
+                             .reals[0];
+            expect(eq(sum, static_cast<double>(n) * (n - 1) / 2.0));
+
+            expect(!!loaded.initialize());
+            do {
+                expect(!!loaded.run());
+            } while (not loaded.current_time_expired());
+
+            irt::i64 events = 0;
+            for (const auto& mdl : loaded.models)
+                if (mdl.type == irt::dynamics_type::counter)
+                    events += irt::get_dyn<irt::counter>(mdl).event_number;
+            expect(eq(events, static_cast<irt::i64>(n)));
+        };
+
+        // The compressed archive is encoded and decoded onto the workers.
+        irt::task_manager tm(0, 1);
+        tm.start();
+        irt::simulation_bag_executor executor(tm, 0);
+
+        for (const auto compress : { false, true }) {
+            irt::binary_archiver bin;
+            bin.compress = compress;
+            bin.executor = compress ? &executor : nullptr;
+
+            auto start = std::chrono::steady_clock::now();
+            {
+                auto f = irt::file::open(
+                  p, irt::file_mode{ irt::file_open_options::write });
+                expect(fatal(f.has_value()));
+                expect(fatal(bin.simulation_save(sim, *f)));
+            }
+            const auto save_us =
+              std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+            const auto size = std::filesystem::file_size(p);
+
+            {
+                irt::simulation loaded;
+                auto            f = irt::file::open(
+                  p, irt::file_mode{ irt::file_open_options::read });
+                expect(fatal(f.has_value()));
+                expect(fatal(bin.simulation_load(loaded, *f)));
+                check(loaded);
+            }
+
+            start = std::chrono::steady_clock::now();
+            irt::simulation mapped;
+            expect(fatal(bin.simulation_load(mapped, p)));
+            const auto load_us =
+              std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+            check(mapped);
+
+            {
+                auto m = irt::memory::make(static_cast<irt::i64>(size));
+                expect(fatal(m.has_value()));
+                expect(fatal(bin.simulation_save(sim, *m)));
+                m->rewind();
+
+                irt::simulation loaded;
+                expect(fatal(bin.simulation_load(loaded, *m)));
+                check(loaded);
+            }
+
+            fmt::print("binary-archiver compress={}: {} bytes, save {} us, "
+                       "mapped load {} us\n",
+                       compress,
+                       size,
+                       save_us,
+                       load_us);
+        }
+
+        tm.shutdown();
+        std::filesystem::remove(p);
+    };
+
     "random-philox-64"_test = [] {
         constexpr irt::u64 seed   = 0x1234567890123456;
         constexpr irt::u64 mdl_id = 0xffffffff00000001;
@@ -2167,6 +2936,86 @@ int main()
         expect(eq(sum_1, sum_2));
     };
 
+    "random-philox-64-block"_test = [] {
+        constexpr irt::u64 seed   = 0x1234567890123456;
+        constexpr irt::u64 mdl_id = 0xffffffff00000001;
+        constexpr irt::u64 step   = 5;
+
+        irt::philox_64       rng{ seed, mdl_id, step };
+        irt::philox_64_block block{ seed, mdl_id, step };
+
+        for (irt::u32 i = 0; i < 100; ++i)
+            expect(eq(rng(), block()));
+
+        std::array<irt::u64, 37> values;
+        irt::philox_64_block     bulk{ seed, mdl_id, step };
+        bulk.generate(values);
+
+        rng.set_state(mdl_id, step);
+        for (const auto v : values)
+            expect(eq(v, rng()));
+
+        expect(eq(bulk.step(), step + 24u));
+    };
+
+    "random-source-block"_test = [] {
+        const std::array<irt::real, 2> reals{ 0.0, 1.0 };
+        const std::array<irt::i32, 2>  ints{ 0, 0 };
+
+        irt::random_source rnd(irt::distribution_type::normal, reals, ints);
+        expect(fatal(rnd.init().has_value()));
+
+        std::array<irt::source, 20>      srcs;
+        std::array<irt::source_data, 20> datas;
+
+        for (auto i = 0u; i < srcs.size(); ++i)
+            expect(fatal(rnd.init(0x1234,
+                                  static_cast<irt::model_id>(i + 1u),
+                                  srcs[i],
+                                  datas[i])
+                           .has_value()));
+
+        auto& src  = srcs[17];
+        auto& data = datas[17];
+        expect(eq(src.buffer.size(),
+                  static_cast<std::size_t>(irt::external_source_chunk_size)));
+
+        const auto saved = data;
+        const auto first = src.buffer[0];
+
+        irt::real sum = 0.0;
+        for (int i = 0; i < 8; ++i) {
+            for (const auto v : src.buffer)
+                sum += v;
+            expect(fatal(rnd.update(src, data).has_value()));
+        }
+
+        expect(approx(sum / (8.0 * irt::external_source_chunk_size), 0.0, 0.1));
+        expect(neq(src.buffer[0], first));
+        expect(neq(srcs[16].buffer.data(), src.buffer.data()));
+
+        data = saved;
+        expect(fatal(rnd.restore(src, data).has_value()));
+        expect(eq(src.buffer[0], first));
+
+        std::array<irt::real, irt::external_source_chunk_size> copy;
+        rnd.fill(copy, src, saved);
+        expect(eq(copy[0], first));
+
+        // The copy owns the buffers of the clients: restore() points the
+        // source into the copy and update() knows the clients.
+        irt::random_source other(rnd);
+        expect(fatal(other.restore(src, data).has_value()));
+        expect(eq(src.buffer[0], first));
+        irt::source s2(src);
+        auto        d2 = data;
+        expect(fatal(rnd.update(s2, d2).has_value()));
+        expect(neq(s2.buffer.data(), src.buffer.data()));
+        expect(eq(src.buffer[0], first));
+        expect(fatal(other.update(src, data).has_value()));
+        expect(neq(src.buffer[0], first));
+    };
+
     "id_data_array"_test = [] {
         enum class my_id : irt::u32;
 
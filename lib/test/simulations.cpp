@@ -6,6 +6,7 @@
 
 #include <fmt/format.h>
 
+#include <chrono>
 #include <cstdio>
 
 #include <boost/ut.hpp>
@@ -191,6 +192,122 @@ struct synapse make_synapse(irt::simulation* sim,
     return synapse_model;
 }
 
+/// Builds @c n harmonic oscillators (x' = y, y' = -x) and @c n @c time_func
+/// with the same timestep to produce clustered @c tn, runs the simulation
+/// with the @c policy scheduller and returns the number of steps and the
+/// duration in milliseconds.
+static auto run_scheduller_policy(const irt::scheduller_policy policy,
+                                  const int                     n) noexcept
+{
+    using namespace boost::ut;
+
+    irt::simulation sim(irt::simulation_reserve_definition{
+      .models         = n * 4,
+      .connections    = n * 3,
+      .hsms           = 0,
+      .dated_messages = 0,
+    });
+
+    for (int i = 0; i < n; ++i) {
+        auto& x    = sim.alloc<irt::qss2_integrator>();
+        auto& y    = sim.alloc<irt::qss2_integrator>();
+        auto& gain = sim.alloc<irt::qss2_gain>();
+        auto& f    = sim.alloc<irt::time_func>();
+
+        sim.parameters[sim.get_id(x)].set_integrator(1.0, 0.01);
+        sim.parameters[sim.get_id(y)].set_integrator(0.0, 0.01);
+        sim.parameters[sim.get_id(gain)].set_gain(-1.0);
+        sim.parameters[sim.get_id(f)].set_time_func(0.0, 0.01, 2);
+
+        expect(!!sim.connect_dynamics(y, 0, x, 0));
+        expect(!!sim.connect_dynamics(x, 0, gain, 0));
+        expect(!!sim.connect_dynamics(gain, 0, y, 0));
+    }
+
+    expect(fatal(sim.sched.set_policy(policy)));
+    sim.limits.set_bound(0, 10);
+    expect(fatal(sim.initialize().has_value()));
+
+    const auto start = std::chrono::steady_clock::now();
+    long       steps = 0;
+
+    do {
+        expect(fatal(sim.run().has_value()));
+        ++steps;
+    } while (not sim.current_time_expired());
+
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::make_pair(
+      steps,
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+        .count());
+}
+
+/// Builds @c n hubs: a @c qss1_wsum_4 computing the opposite of the mean of
+/// four @c qss1_integrator and sending its output to the four integrators
+/// and to @c fan_out @c counter.
+static auto run_message_routing(const irt::message_routing_policy policy,
+                                const int                         n,
+                                const int fan_out) noexcept
+{
+    using namespace boost::ut;
+
+    irt::simulation sim(irt::simulation_reserve_definition{
+      .models         = n * (5 + fan_out),
+      .connections    = n * (8 + fan_out),
+      .hsms           = 0,
+      .dated_messages = 0,
+    });
+
+    irt::vector<irt::model_id> integrators;
+
+    for (int i = 0; i < n; ++i) {
+        auto& hub = sim.alloc<irt::qss1_wsum_4>();
+        sim.parameters[sim.get_id(hub)].set_wsum4(-0.25, -0.25, -0.25, -0.25);
+
+        for (int j = 0; j < 4; ++j) {
+            auto& x = sim.alloc<irt::qss1_integrator>();
+            sim.parameters[sim.get_id(x)].set_integrator(1.0, 0.01);
+
+            expect(!!sim.connect_dynamics(x, 0, hub, j));
+            expect(!!sim.connect_dynamics(hub, 0, x, 0));
+            integrators.emplace_back(sim.get_id(x));
+        }
+
+        for (int j = 0; j < fan_out; ++j) {
+            auto& cnt = sim.alloc<irt::counter>();
+
+            expect(!!sim.connect_dynamics(hub, 0, cnt, 0));
+        }
+    }
+
+    sim.routing = policy;
+    sim.limits.set_bound(0, 5);
+    expect(fatal(sim.initialize().has_value()));
+
+    const auto start = std::chrono::steady_clock::now();
+    long       steps = 0;
+
+    do {
+        expect(fatal(sim.run().has_value()));
+        ++steps;
+    } while (not sim.current_time_expired());
+
+    const auto end = std::chrono::steady_clock::now();
+
+    irt::vector<irt::real> values;
+    for (const auto id : integrators)
+        values.emplace_back(
+          irt::get_dyn<irt::qss1_integrator>(sim.models.get(id)).X);
+
+    return std::make_tuple(
+      steps,
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+        .count(),
+      values);
+}
+
 int main()
 {
     using namespace boost::ut;
@@ -461,4 +578,124 @@ int main()
         expect(ge(mdl_27.event_number, static_cast<irt::i64>(40))); // 39
         expect(eq(mdl_27.last_value, 1));
     };
+
+    "scheduller-policy-timing"_test = [] {
+        constexpr int n = 1000;
+
+        const auto [heap_steps, heap_ms] =
+          run_scheduller_policy(irt::scheduller_policy::pairing_heap, n);
+        const auto [calendar_steps, calendar_ms] =
+          run_scheduller_policy(irt::scheduller_policy::calendar_queue, n);
+
+        expect(eq(heap_steps, calendar_steps));
+        expect(gt(heap_steps, 0l));
+
+        fmt::print("scheduller pairing-heap: {} steps in {} ms\n",
+                   heap_steps,
+                   heap_ms);
+        fmt::print("scheduller calendar-queue: {} steps in {} ms\n",
+                   calendar_steps,
+                   calendar_ms);
+    };
+
+    "message-routing-timing"_test = [] {
+        constexpr int n       = 64;
+        constexpr int fan_out = 64;
+
+        using irt::message_routing_policy;
+
+        const auto [two_steps, two_us, two_values] =
+          run_message_routing(message_routing_policy::two_pass, n, fan_out);
+        const auto [single_steps, single_us, single_values] =
+          run_message_routing(message_routing_policy::single_pass, n, fan_out);
+
+        expect(eq(two_steps, single_steps));
+        expect(gt(two_steps, 0l));
+        expect(fatal(eq(two_values.size(), single_values.size())));
+        for (int i = 0, e = two_values.ssize(); i < e; ++i)
+            expect(eq(two_values[i], single_values[i]));
+
+        fmt::print("routing two-pass: {} steps in {} us ({:.3f} us/step)\n",
+                   two_steps,
+                   two_us,
+                   static_cast<double>(two_us) / two_steps);
+        fmt::print("routing single-pass: {} steps in {} us ({:.3f} us/step)\n",
+                   single_steps,
+                   single_us,
+                   static_cast<double>(single_us) / single_steps);
+    };
+
+    "message-routing-overflow"_test = [] {
+        // The hsm_wrapper sends two messages on its output port when it
+        // enters the states 2 and 3: the single-pass regions of the
+        // counters overflow and the step falls back to the two-pass routing.
+        irt::simulation sim(
+          irt::simulation_reserve_definition(),
+          irt::external_source_reserve_definition{ .constant_nb = 2 });
+
+        expect(fatal(sim.can_alloc(4)));
+        expect(fatal(sim.hsms.can_alloc(1)));
+        expect(fatal(sim.srcs.constant_sources.can_alloc(2u)));
+
+        auto& cst_value  = sim.srcs.constant_sources.alloc();
+        cst_value.length = 3;
+        cst_value.buffer = { 1.0, 1.0, 1.0 };
+
+        auto& cst_ta  = sim.srcs.constant_sources.alloc();
+        cst_ta.length = 3;
+        cst_ta.buffer = { 1.0, 1.0, 1.0 };
+
+        auto& gen = sim.alloc<irt::generator>();
+        sim.parameters[sim.get_id(gen)]
+          .clear()
+          .set_generator_ta(irt::source_type::constant,
+                            sim.srcs.constant_sources.get_id(cst_ta))
+          .set_generator_value(irt::source_type::constant,
+                               sim.srcs.constant_sources.get_id(cst_value));
+
+        using hsm_t = irt::hierarchical_state_machine;
+
+        auto& hsm = sim.hsms.alloc();
+        expect(!!hsm.set_state(0u, hsm_t::invalid_state_id, 1u));
+        expect(!!hsm.set_state(1u, 0u));
+        hsm.states[1u].condition.set(0b1000u, 0b1000u);
+        hsm.states[1u].if_transition = 2u;
+        expect(!!hsm.set_state(2u, 0u, 3u));
+        hsm.states[2u].enter_action.set_output(hsm_t::variable::port_0, 1.0f);
+        expect(!!hsm.set_state(3u, 2u));
+        hsm.states[3u].enter_action.set_output(hsm_t::variable::port_0, 2.0f);
+
+        auto& hsmw = sim.alloc<irt::hsm_wrapper>();
+        sim.parameters[sim.get_id(hsmw)].set_hsm_wrapper(
+          irt::ordinal(sim.hsms.get_id(hsm)));
+
+        auto& cnt_1 = sim.alloc<irt::counter>();
+        auto& cnt_2 = sim.alloc<irt::counter>();
+
+        expect(!!sim.connect_dynamics(gen, 0, hsmw, 0));
+        expect(!!sim.connect_dynamics(hsmw, 0, cnt_1, 0));
+        expect(!!sim.connect_dynamics(hsmw, 0, cnt_2, 0));
+
+        sim.routing = irt::message_routing_policy::single_pass;
+        sim.limits.set_bound(0, 10);
+        expect(fatal(sim.srcs.prepare().has_value()));
+        expect(fatal(sim.initialize().has_value()));
+
+        do {
+            expect(fatal(sim.run().has_value()));
+
+            for (const auto* cnt : { &cnt_1, &cnt_2 }) {
+                expect(eq(cnt->x[0].capacity, cnt->x[0].size));
+                expect(le(cnt->x[0].position + cnt->x[0].capacity,
+                          sim.message_buffer.size()));
+            }
+        } while (not sim.current_time_expired());
+
+        // The output port keeps the last message: the counters receive
+        // twice the value 2.
+        expect(eq(cnt_1.event_number, static_cast<irt::i64>(2)));
+        expect(eq(cnt_2.event_number, static_cast<irt::i64>(2)));
+        expect(eq(cnt_1.sum_values, 4.0));
+        expect(eq(cnt_2.sum_values, 4.0));
+    };
 }
@@ -0,0 +1,197 @@
+// Copyright (c) 2026 INRA Distributed under the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// This file builds two programs. With IRT_STANDALONE_GENERATOR defined, it
+// writes the standalone simulator of the oscillator simulation into the file
+// of the first argument. Otherwise, it is linked with this generated
+// translation unit and compares the C ABI of the standalone simulator with
+// the simulation::run() function.
+
+#include <irritator/core.hpp>
+#include <irritator/io.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+/// A qss3 oscillator `x' = y, y' = 0.25 - x` with an observer on each
+/// integrator.
+static void build_oscillator(irt::simulation& sim) noexcept
+{
+    auto& x    = sim.alloc<irt::qss3_integrator>();
+    auto& y    = sim.alloc<irt::qss3_integrator>();
+    auto& gain = sim.alloc<irt::qss3_gain>();
+    auto& sum  = sim.alloc<irt::qss3_sum_2>();
+    auto& cst  = sim.alloc<irt::constant>();
+
+    sim.parameters[sim.get_id(x)].set_integrator(1.0, 0.001);
+    sim.parameters[sim.get_id(y)].set_integrator(0.0, 0.001);
+    sim.parameters[sim.get_id(gain)].set_gain(-1.0);
+    sim.parameters[sim.get_id(cst)].set_constant(0.25, 0.0);
+
+    (void)sim.connect_dynamics(y, 0, x, 0);
+    (void)sim.connect_dynamics(x, 0, gain, 0);
+    (void)sim.connect_dynamics(gain, 0, sum, 0);
+    (void)sim.connect_dynamics(cst, 0, sum, 1);
+    (void)sim.connect_dynamics(sum, 0, y, 0);
+
+    (void)sim.observe(irt::get_model(x), 0.1);
+    (void)sim.observe(irt::get_model(y), 0.1);
+}
+
+static constexpr double oscillator_begin = 0.0;
+static constexpr double oscillator_end   = 10.0;
+
+#if defined(IRT_STANDALONE_GENERATOR)
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+        return 1;
+
+    irt::simulation sim;
+    build_oscillator(sim);
+
+    auto* os = std::fopen(argv[1], "w");
+    if (not os)
+        return 1;
+
+    const auto ret = irt::write_standalone_simulation(
+      os, "oscillator", sim, oscillator_begin, oscillator_end);
+
+    return (std::fclose(os) == 0 and
+            ret == irt::write_test_simulation_result::success)
+             ? 0
+             : 1;
+}
+
+#else
+
+#include <boost/ut.hpp>
+
+#include <fmt/format.h>
+
+struct irt_simulator;
+
+extern "C" {
+irt_simulator* irt_simulator_create(void);
+void           irt_simulator_destroy(irt_simulator* s);
+int            irt_simulator_step(irt_simulator* s, double until);
+double         irt_simulator_time(const irt_simulator* s);
+int            irt_simulator_models(const irt_simulator* s);
+int irt_simulator_value(const irt_simulator* s, int model, double* value);
+int irt_simulator_observers(const irt_simulator* s);
+int irt_simulator_observations(irt_simulator* s,
+                               int            observer,
+                               int            first,
+                               double*        dates,
+                               double*        values,
+                               int            capacity);
+}
+
+/// The translation units may contract the floating point operations
+/// differently so values are compared with a relative tolerance.
+static bool near(const double a, const double b) noexcept
+{
+    return a == b or std::abs(a - b) <= 1e-12 * std::max(1.0, std::abs(a));
+}
+
+int main()
+{
+    using namespace boost::ut;
+
+    "standalone-simulator-step"_test = [] {
+        irt::simulation sim;
+        build_oscillator(sim);
+
+        irt::vector<irt::model_id> models;
+        for (const auto& mdl : sim.models)
+            models.emplace_back(sim.models.get_id(mdl));
+
+        irt::vector<irt::observer_id> observers;
+        for (const auto& obs : sim.observers)
+            observers.emplace_back(sim.observers.get_id(obs));
+
+        for (const auto id : observers)
+            sim.observers.try_to_get(id)->lossless(true);
+
+        sim.limits.set_bound(oscillator_begin, oscillator_end);
+        expect(fatal(sim.srcs.prepare().has_value()));
+        expect(fatal(sim.initialize().has_value()));
+
+        auto* s = irt_simulator_create();
+        expect(fatal(s != nullptr));
+        expect(eq(irt_simulator_models(s), models.ssize()));
+        expect(eq(irt_simulator_observers(s), observers.ssize()));
+
+        // Steps both simulations with the same dates and compares the date
+        // and the value of each model after each step.
+        auto state = 0;
+        for (auto until = 0.5; state == 0; until += 0.5) {
+            while (not sim.current_time_expired() and not sim.sched.empty() and
+                   sim.sched.tn() <= until)
+                expect(fatal(sim.run().has_value()));
+
+            state = irt_simulator_step(s, until);
+            expect(fatal(state >= 0));
+
+            if (state == 1)
+                expect(sim.finalize().has_value());
+
+            expect(near(irt_simulator_time(s), sim.current_time()));
+
+            for (int i = 0, e = models.ssize(); i < e; ++i) {
+                const auto& mdl = sim.models.get(models[i]);
+                const auto  fn  = irt::get_dynamics_functions(mdl).observation;
+
+                auto value = 0.0;
+                expect(eq(irt_simulator_value(s, i, &value), fn ? 0 : -1));
+                if (not fn)
+                    continue;
+
+                const auto t = sim.current_time();
+                const auto d = std::isfinite(t) ? t - mdl.tl : 0.0;
+                expect(near(value, fn(mdl, mdl.tl + d, d).value));
+            }
+        }
+
+        expect(eq(state, 1));
+
+        // The resampled samples of each observer are the same.
+        for (int i = 0, e = observers.ssize(); i < e; ++i) {
+            auto& obs = *sim.observers.try_to_get(observers[i]);
+            sim.observers.get<irt::resampler>(observers[i])
+              .tick(obs, std::numeric_limits<double>::infinity());
+
+            irt::vector<double> dates, values;
+            obs.read_history([&](const auto& h, const auto) {
+                for (auto j = 0; j < h.ssize(); ++j) {
+                    dates.emplace_back(h[j].t);
+                    values.emplace_back(h[j].value);
+                }
+            });
+
+            expect(fatal(not dates.empty()));
+
+            irt::vector<double> s_dates(dates.ssize() + 1, 0.0);
+            irt::vector<double> s_values(values.ssize() + 1, 0.0);
+            expect(eq(irt_simulator_observations(s,
+                                                 i,
+                                                 0,
+                                                 s_dates.data(),
+                                                 s_values.data(),
+                                                 s_dates.ssize()),
+                      dates.ssize()));
+
+            for (int j = 0, n = dates.ssize(); j < n; ++j) {
+                expect(near(s_dates[j], dates[j]));
+                expect(near(s_values[j], values[j]));
+            }
+        }
+
+        irt_simulator_destroy(s);
+    };
+}
+
+#endif
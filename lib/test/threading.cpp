@@ -4,7 +4,9 @@
 
 #include <irritator/core.hpp>
 #include <irritator/thread.hpp>
+#include <irritator/timeline.hpp>
 
+#include <cstring>
 #include <mutex>
 #include <numeric>
 #include <random>
@@ -30,6 +32,27 @@ enum class data_task_id : irt::u32;
 
 using data_task_ref = irt::lambda_function<void(void)>;
 
+/// Builds @c n identical harmonic oscillators (x' = y, y' = -x) to produce
+/// large bags of simultaneous models.
+static void make_oscillators(irt::simulation& sim, const int n) noexcept
+{
+    using namespace boost::ut;
+
+    for (int i = 0; i < n; ++i) {
+        auto& x    = sim.alloc<irt::qss2_integrator>();
+        auto& y    = sim.alloc<irt::qss2_integrator>();
+        auto& gain = sim.alloc<irt::qss2_gain>();
+
+        sim.parameters[sim.get_id(x)].set_integrator(1.0, 0.01);
+        sim.parameters[sim.get_id(y)].set_integrator(0.0, 0.01);
+        sim.parameters[sim.get_id(gain)].set_gain(-1.0);
+
+        expect(!!sim.connect_dynamics(y, 0, x, 0));
+        expect(!!sim.connect_dynamics(x, 0, gain, 0));
+        expect(!!sim.connect_dynamics(gain, 0, y, 0));
+    }
+}
+
 int main()
 {
     using namespace boost::ut;
@@ -336,6 +359,499 @@ int main()
         fmt::print("linear: {}\n", dif.count());
     };
 
+    "parallel-bag-execution"_test = [] {
+        fmt::print("parallel-bag-execution\n");
+        constexpr int n = 512;
+
+        const auto def = irt::simulation_reserve_definition{
+            .models         = n * 3,
+            .connections    = n * 3,
+            .hsms           = 0,
+            .dated_messages = 0,
+        };
+
+        irt::simulation seq(def);
+        irt::simulation par(def);
+        make_oscillators(seq, n);
+        make_oscillators(par, n);
+
+        seq.limits.set_bound(0, 10);
+        par.limits.set_bound(0, 10);
+        par.parallel_bag_threshold = 16;
+
+        irt::task_manager tm(0, 1, 4);
+        tm.start();
+        irt::simulation_bag_executor executor(tm, 0);
+
+        expect(fatal(seq.initialize().has_value()));
+        expect(fatal(par.initialize().has_value()));
+
+        do {
+            expect(fatal(seq.run().has_value()));
+            expect(fatal(par.run(executor).has_value()));
+            expect(fatal(seq.current_time() == par.current_time()));
+            expect(fatal(seq.immediate_models.size() ==
+                         par.immediate_models.size()));
+        } while (not seq.current_time_expired());
+
+        tm.shutdown();
+
+        irt::model* m_seq = nullptr;
+        irt::model* m_par = nullptr;
+        while (seq.models.next(m_seq) and par.models.next(m_par)) {
+            expect(eq(m_seq->tn, m_par->tn));
+
+            if (m_seq->type == irt::dynamics_type::qss2_integrator) {
+                const auto& d_seq = irt::get_dyn<irt::qss2_integrator>(*m_seq);
+                const auto& d_par = irt::get_dyn<irt::qss2_integrator>(*m_par);
+                expect(eq(d_seq.X, d_par.X));
+                expect(eq(d_seq.q, d_par.q));
+            }
+        }
+    };
+
+    "bag-executor-fallback"_test = [] {
+        fmt::print("bag-executor-fallback\n");
+        constexpr unsigned n = 256;
+
+        irt::task_manager tm(0, 1, 4);
+        tm.start();
+        irt::simulation_bag_executor executor(tm, 0);
+
+        std::vector<std::atomic<unsigned>> calls(n);
+        std::atomic<unsigned>              nested = 0u;
+
+        executor.parallel_for(n, [&](const unsigned i) noexcept {
+            calls[i].fetch_add(1u, std::memory_order_relaxed);
+
+            // The list is executing: the nested loop runs on the worker.
+            if (i % 32 == 0)
+                executor.parallel_for(8u, [&](const unsigned) noexcept {
+                    nested.fetch_add(1u, std::memory_order_relaxed);
+                });
+        });
+
+        for (const auto& c : calls)
+            expect(eq(c.load(), 1u));
+        expect(eq(nested.load(), 8u * (n / 32u)));
+
+        tm.shutdown();
+
+        // The stopped list refuses the tasks: the loop runs on the caller.
+        expect(not tm.unordered(0).add([]() noexcept {}));
+
+        unsigned sequential = 0u;
+        executor.parallel_for(
+          4u, [&](const unsigned i) noexcept { sequential += i; });
+        expect(eq(sequential, 6u));
+    };
+
+    "executor-parallel-for"_test = [] {
+        fmt::print("executor-parallel-for\n");
+        constexpr unsigned n = 1024;
+
+        irt::task_manager tm(0, 1);
+        tm.start();
+        irt::simulation_bag_executor executor(tm, 0);
+
+        std::vector<std::atomic<unsigned>> calls(n);
+        std::atomic<unsigned>              nested = 0u;
+
+        irt::parallel_for(&executor, n, [&](const unsigned i) noexcept {
+            calls[i].fetch_add(1u, std::memory_order_relaxed);
+
+            // A nested loop runs on the caller thread.
+            if (i % 64 == 0)
+                irt::parallel_for(&executor, 8u, [&](const unsigned) noexcept {
+                    nested.fetch_add(1u, std::memory_order_relaxed);
+                });
+        });
+
+        for (const auto& c : calls)
+            expect(eq(c.load(), 1u));
+        expect(eq(nested.load(), 8u * (n / 64u)));
+
+        tm.shutdown();
+
+        unsigned sequential = 0u;
+        irt::parallel_for(
+          &executor,
+          3u,
+          [&](const unsigned i) noexcept { sequential += i; },
+          4u);
+        irt::parallel_for(
+          nullptr, 4u, [&](const unsigned i) noexcept { sequential += i; });
+        expect(eq(sequential, 9u));
+    };
+
+    "drain-observers"_test = [] {
+        fmt::print("drain-observers\n");
+        constexpr int n = 4096;
+
+        irt::observation_system       seq(n);
+        irt::observation_system       par(n);
+        irt::vector<irt::observer_id> ids(n, irt::reserve_tag);
+
+        for (int i = 0; i < n; ++i) {
+            auto& o1 = seq.alloc(irt::model_id{ static_cast<irt::u64>(i) });
+            auto& o2 = par.alloc(irt::model_id{ static_cast<irt::u64>(i) });
+            seq.get<irt::resampler>(seq.get_id(o1)) =
+              irt::resampler(0.5, irt::interpolate_type::none);
+            par.get<irt::resampler>(par.get_id(o2)) =
+              irt::resampler(0.5, irt::interpolate_type::none);
+
+            if (i % 3 == 0)
+                ids.emplace_back(par.get_id(o2));
+        }
+
+        // Free some observers to drain a sparse observation_system.
+        for (int i = 0; i < n; i += 7) {
+            seq.free(seq.get_id(*seq.get_ids().try_to_get_from_pos(i)));
+            par.free(par.get_id(*par.get_ids().try_to_get_from_pos(i)));
+        }
+
+        irt::task_manager tm(0, 1, 4);
+        tm.start();
+        irt::simulation_bag_executor executor(tm, 0);
+
+        for (int step = 0; step < 64; ++step) {
+            const auto t = static_cast<irt::real>(step);
+
+            for (auto& o : seq)
+                (void)o.observe(irt::raw_sample{ t, t * 2 });
+            for (auto& o : par)
+                (void)o.observe(irt::raw_sample{ t, t * 2 });
+
+            if (step % 8 == 0) {
+                irt::drain_observers(seq, t);
+                irt::drain_observers(par, t, executor);
+            } else {
+                irt::drain_observers(seq, std::span(ids.data(), ids.size()), t);
+                irt::drain_observers(
+                  par, std::span(ids.data(), ids.size()), t, executor);
+            }
+        }
+
+        const auto inf = std::numeric_limits<irt::real>::infinity();
+        irt::drain_observers(seq, inf);
+        irt::drain_observers(par, inf, executor);
+        tm.shutdown();
+
+        expect(eq(seq.size(), par.size()));
+
+        auto it = par.begin();
+        for (const auto& o : seq) {
+            o.read_history([&](const auto& h, const auto) {
+                it->read_history([&](const auto& g, const auto) {
+                    expect(eq(h.size(), 64u));
+                    expect(eq(g.size(), h.size()));
+                });
+            });
+            ++it;
+        }
+    };
+
+    "optimistic-simulation"_test = [] {
+        fmt::print("optimistic-simulation\n");
+        constexpr int n = 32;
+
+        const auto def = irt::simulation_reserve_definition{
+            .models         = n * 3,
+            .connections    = n * 3,
+            .hsms           = 0,
+            .dated_messages = 0,
+        };
+
+        irt::simulation seq(def);
+        make_oscillators(seq, n);
+        seq.limits.set_bound(0, 10);
+
+        // The integrators and the gains of the oscillators are in different
+        // partitions: each oscillator is a loop between two partitions.
+        std::vector<irt::u32> partitions(seq.models.capacity(), 0u);
+        for (const auto& mdl : seq.models)
+            partitions[irt::get_index(seq.models.get_id(mdl))] =
+              mdl.type == irt::dynamics_type::qss2_gain ? 1u : 0u;
+
+        irt::optimistic_simulation tw(8);
+        expect(fatal(tw.init(seq, partitions).has_value()));
+        expect(fatal(tw.initialize().has_value()));
+        expect(fatal(tw.run().has_value()));
+        expect(eq(tw.size(), 2));
+        expect(fatal(tw.gvt() >= 10.0));
+
+        expect(fatal(seq.initialize().has_value()));
+        do {
+            expect(fatal(seq.run().has_value()));
+        } while (not seq.current_time_expired());
+
+        for (const auto& mdl : seq.models) {
+            const auto  id = seq.models.get_id(mdl);
+            const auto& p  = tw[partitions[irt::get_index(id)]];
+            const auto* m  = p.models.try_to_get(id);
+            expect(fatal(m != nullptr));
+
+            if (mdl.type == irt::dynamics_type::qss2_integrator) {
+                const auto& d_seq = irt::get_dyn<irt::qss2_integrator>(mdl);
+                const auto& d_tw  = irt::get_dyn<irt::qss2_integrator>(*m);
+                expect(eq(d_seq.X, d_tw.X));
+                expect(eq(d_seq.q, d_tw.q));
+                expect(eq(mdl.tl, m->tl));
+            }
+        }
+
+        fmt::print("rollbacks: {}\n", tw.rollbacks());
+    };
+
+    "delta-snapshots"_test = [] {
+        fmt::print("delta-snapshots\n");
+
+        // The scheduller delta depends on the container of the policy.
+        for (const auto policy : { irt::scheduller_policy::pairing_heap,
+                                   irt::scheduller_policy::calendar_queue }) {
+            constexpr int n     = 64;
+            constexpr int steps = 200;
+
+            const auto def = irt::simulation_reserve_definition{
+                .models         = n * 3,
+                .connections    = n * 3,
+                .hsms           = 0,
+                .dated_messages = 0,
+            };
+
+            irt::simulation sim(def);
+            make_oscillators(sim, n);
+            sim.limits.set_bound(0, 100);
+            expect(fatal(sim.sched.set_policy(policy)));
+
+            // Different quantum for each integrator: only a few models change
+            // at each step.
+            int i = 0;
+            for (const auto& mdl : sim.models)
+                if (mdl.type == irt::dynamics_type::qss2_integrator)
+                    sim.parameters[sim.models.get_id(mdl)].set_integrator(
+                      1.0, 0.001 * static_cast<double>(++i));
+
+            irt::simulation_snapshot_handler snaps(64, 16);
+            std::vector<irt::simulation_snapshot> copies;
+            copies.reserve(steps);
+
+            expect(fatal(sim.initialize().has_value()));
+            for (int s = 0; s < steps and not sim.current_time_expired(); ++s) {
+                expect(fatal(sim.run().has_value()));
+                snaps.emplace_back(sim);
+                copies.emplace_back(sim);
+            }
+
+            expect(fatal(copies.size() > snaps.size()));
+            expect(fatal(snaps.front()->keyframe));
+
+            std::size_t full = 0, delta = 0;
+            auto        k    = copies.size() - snaps.size();
+
+            irt::simulation restored(def);
+            const irt::simulation_snapshot* snap = nullptr;
+            while (snaps.next(snap)) {
+                const auto& ref = copies[k++];
+                expect(fatal(eq(snap->t, ref.t)));
+
+                full += ref.models.size();
+                delta += snap->keyframe ? snap->models.size()
+                                        : snap->models_delta.items.size();
+
+                if (not snap->keyframe)
+                    expect(snap->sched.empty());
+
+                snaps.restore(restored, *snap);
+                expect(fatal(eq(restored.current_time(), ref.t)));
+                expect(fatal(eq(restored.models.size(), ref.models.size())));
+                expect(fatal(eq(restored.sched.size(), ref.sched.size())));
+                expect(eq(restored.sched.tn(), ref.sched.tn()));
+
+                for (const auto& mdl : ref.models) {
+                    const auto  id = ref.models.get_id(mdl);
+                    const auto* m  = restored.models.try_to_get(id);
+                    expect(fatal(m != nullptr));
+                    expect(eq(m->tl, mdl.tl));
+                    expect(eq(m->tn, mdl.tn));
+                    expect(std::memcmp(m->dyn, mdl.dyn, sizeof(mdl.dyn)) == 0);
+                    expect(eq(restored.sched.tn(m->handle),
+                              ref.sched.tn(mdl.handle)));
+                }
+            }
+
+            expect(lt(delta, full));
+            fmt::print("models stored: {} (full copies: {})\n", delta, full);
+
+            // A restored simulation does not know its changes since the
+            // latest snapshot: the next snapshot is a keyframe.
+            snaps.restore(sim, *snaps.front());
+            expect(not sim.track_changed_models);
+            snaps.emplace_back(sim);
+            expect(snaps.back()->keyframe);
+            expect(sim.track_changed_models);
+        }
+    };
+
+    "conservative-simulation"_test = [] {
+        fmt::print("conservative-simulation\n");
+        constexpr int n = 32;
+
+        const auto def = irt::simulation_reserve_definition{
+            .models         = n * 3,
+            .connections    = n * 3,
+            .hsms           = 0,
+            .dated_messages = 0,
+        };
+
+        irt::simulation seq(def);
+        make_oscillators(seq, n);
+        seq.limits.set_bound(0, 10);
+
+        // Four partitions and each oscillator is split between partitions.
+        std::vector<irt::u32> partitions(seq.models.capacity(), 0u);
+        for (const auto& mdl : seq.models) {
+            const auto idx  = irt::get_index(seq.models.get_id(mdl));
+            partitions[idx] = idx % 4u;
+        }
+
+        irt::conservative_simulation cs;
+        expect(fatal(cs.init(seq, partitions).has_value()));
+        expect(fatal(cs.initialize().has_value()));
+        expect(fatal(cs.run().has_value()));
+        expect(eq(cs.size(), 4));
+
+        expect(fatal(seq.initialize().has_value()));
+        do {
+            expect(fatal(seq.run().has_value()));
+        } while (not seq.current_time_expired());
+
+        for (const auto& mdl : seq.models) {
+            const auto  id = seq.models.get_id(mdl);
+            const auto& p  = cs[partitions[irt::get_index(id)]];
+            const auto* m  = p.models.try_to_get(id);
+            expect(fatal(m != nullptr));
+
+            if (mdl.type == irt::dynamics_type::qss2_integrator) {
+                const auto& d_seq = irt::get_dyn<irt::qss2_integrator>(mdl);
+                const auto& d_cs  = irt::get_dyn<irt::qss2_integrator>(*m);
+                expect(eq(d_seq.X, d_cs.X));
+                expect(eq(d_seq.q, d_cs.q));
+                expect(eq(mdl.tl, m->tl));
+            }
+        }
+
+        fmt::print("windows: {}\n", cs.windows());
+    };
+
+    "work-stealing-deque"_test = [] {
+        fmt::print("work-stealing-deque\n");
+        irt::work_stealing_deque deque;
+        irt::u64                 value = 0;
+
+        expect(not deque.pop(value));
+        expect(not deque.steal(value));
+
+        for (irt::u64 i = 0; i < irt::work_stealing_deque::capacity; ++i)
+            expect(deque.push(i));
+        expect(not deque.push(0));
+        expect(eq(deque.available(), 0));
+
+        expect(deque.steal(value));
+        expect(eq(value, irt::u64(0)));
+        expect(deque.pop(value));
+        expect(eq(value, irt::u64(irt::work_stealing_deque::capacity - 1)));
+
+        while (deque.pop(value))
+            ;
+        expect(eq(deque.available(), irt::work_stealing_deque::capacity));
+
+        constexpr int      thieves = 3;
+        constexpr irt::u64 n       = 100000;
+
+        std::atomic<irt::u64> sum  = 0;
+        std::atomic<irt::u64> seen = 0;
+        std::atomic_bool      done = false;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < thieves; ++i)
+            threads.emplace_back([&] {
+                irt::u64 v = 0;
+                while (not done.load(std::memory_order_acquire)) {
+                    if (deque.steal(v)) {
+                        sum.fetch_add(v, std::memory_order_relaxed);
+                        seen.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+
+        for (irt::u64 i = 1; i <= n;) {
+            while (i <= n and deque.push(i))
+                ++i;
+
+            irt::u64 v = 0;
+            if (deque.pop(v)) {
+                sum.fetch_add(v, std::memory_order_relaxed);
+                seen.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        irt::u64 v = 0;
+        while (deque.pop(v)) {
+            sum.fetch_add(v, std::memory_order_relaxed);
+            seen.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        while (seen.load() != n)
+            std::this_thread::yield();
+
+        done.store(true, std::memory_order_release);
+        for (auto& t : threads)
+            t.join();
+
+        expect(eq(seen.load(), n));
+        expect(eq(sum.load(), n * (n + 1) / 2));
+    };
+
+    "unordered-throughput"_test = [] {
+        fmt::print("unordered-throughput\n");
+        constexpr int batches = 256;
+        constexpr int tasks   = 4096;
+
+        irt::task_manager tm(0, 1);
+        tm.start();
+
+        std::atomic_int counter = 0;
+        const auto      start   = std::chrono::steady_clock::now();
+
+        for (int b = 0; b < batches; ++b) {
+            for (int i = 0; i < tasks; ++i)
+                tm.unordered(0).add([&counter]() { function_1(counter); });
+
+            tm.unordered(0).submit();
+            tm.unordered(0).wait_completion();
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+        tm.shutdown();
+
+        expect(eq(counter.load(), batches * tasks));
+
+        irt::u64 completed = 0;
+        for (irt::sz i = 0, e = tm.wunordered_size(); i < e; ++i)
+            completed += tm.wunordered_tasks_completed(i);
+        expect(eq(completed, static_cast<irt::u64>(batches * tasks)));
+
+        const auto dif =
+          std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        fmt::print("{} workers: {} tasks in {} us ({:.1f} tasks/us)\n",
+                   tm.wunordered_size(),
+                   batches * tasks,
+                   dif.count(),
+                   static_cast<double>(batches * tasks) /
+                     static_cast<double>(std::max<long long>(1, dif.count())));
+    };
+
     "static-circular-buffer"_test = [] {
         fmt::print("static-circular-buffer\n");
         irt::task_manager tm(2, 0);